@@ -0,0 +1,659 @@
+// HC benchmark application
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "const.hh"
+#include "error.hh"
+#include "event.hh"
+#include "hcclient.hh"
+#include "hccontainer.hh"
+#include "hcserver.hh"
+#include "loopdevice.hh"
+#include "queue.hh"
+#include "semaphore.hh"
+#include "shmdevice.hh"
+#include "str.hh"
+#include "thread.hh"
+#include "timerwheel.hh"
+#include "udpdevice.hh"
+#include "unixclient.hh"
+#include "unixreactor.hh"
+#include "uringudpdevice.hh"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <string.h>
+#include <string>
+
+using namespace std;
+
+class BenchClient
+{
+public:
+  BenchClient(uint16_t srvport)
+  {
+    //Create client on its own socket
+    _cont = new HCContainer("");
+    _dev = new UDPDevice(0, 0, "127.0.0.1", srvport);
+    _cli = new HCClient(_dev, _cont, 1000);
+
+    //Initialize counts and run flag
+    _xactcount = 0;
+    _errcount = 0;
+    _run = false;
+
+    //Create transaction thread
+    _thread = new Thread<BenchClient>(this, &BenchClient::XactThread);
+  }
+
+  ~BenchClient()
+  {
+    //Cleanup
+    delete _thread;
+    delete _cli;
+    delete _dev;
+    delete _cont;
+  }
+
+  void Start(void)
+  {
+    //Start transacting
+    __atomic_store_n(&_run, true, __ATOMIC_RELEASE);
+    _thread->Start();
+  }
+
+  void Stop(void)
+  {
+    //Stop transacting and wait for last transaction to finish
+    __atomic_store_n(&_run, false, __ATOMIC_RELEASE);
+    _thread->Join();
+  }
+
+  uint32_t GetXactCount(void)
+  {
+    return _xactcount;
+  }
+
+  uint32_t GetErrCount(void)
+  {
+    return _errcount;
+  }
+
+private:
+  void XactThread(void)
+  {
+    string val;
+
+    //Get a read-only parameter back to back until stopped
+    while(__atomic_load_n(&_run, __ATOMIC_ACQUIRE))
+    {
+      if(_cli->Get(HCServer::PID_NAME, val) == ERR_NONE)
+        _xactcount++;
+      else
+        _errcount++;
+    }
+  }
+
+private:
+  HCContainer* _cont;
+  UDPDevice* _dev;
+  HCClient* _cli;
+  uint32_t _xactcount;
+  uint32_t _errcount;
+  bool _run;
+  Thread<BenchClient>* _thread;
+};
+
+template <class Q>
+class QueueProducer
+{
+public:
+  QueueProducer(Q* queue, uint32_t count)
+  {
+    //Remember queue and number of messages to write
+    _queue = queue;
+    _count = count;
+
+    //Create write thread
+    _thread = new Thread<QueueProducer>(this, &QueueProducer::WriteThread);
+  }
+
+  ~QueueProducer()
+  {
+    //Cleanup
+    delete _thread;
+  }
+
+  void Start(void)
+  {
+    _thread->Start();
+  }
+
+  void Stop(void)
+  {
+    _thread->Join();
+  }
+
+private:
+  void WriteThread(void)
+  {
+    uint8_t msg[QUEUE_MSG_SIZE];
+    uint32_t i;
+
+    //Write messages back to back (blocking while queue is full)
+    memset(msg, 0, sizeof(msg));
+    for(i=0; i<_count; i++)
+      _queue->Write(msg, sizeof(msg), WAIT_INF);
+  }
+
+public:
+  //Size (bytes) of each benchmark message
+  static const uint32_t QUEUE_MSG_SIZE = 64;
+
+private:
+  Q* _queue;
+  uint32_t _count;
+  Thread<QueueProducer>* _thread;
+};
+
+template <class Q>
+void BenchQueue(const char* label, Q* queue, uint32_t producers, uint32_t count)
+{
+  QueueProducer<Q>** prods;
+  uint8_t msg[QueueProducer<Q>::QUEUE_MSG_SIZE];
+  uint64_t start;
+  uint64_t elapsed;
+  uint32_t got;
+  uint32_t i;
+
+  //Create producers
+  prods = new QueueProducer<Q>*[producers];
+  for(i=0; i<producers; i++)
+    prods[i] = new QueueProducer<Q>(queue, count);
+
+  //Start producers and read all their messages on this thread
+  start = ThreadTimeUS();
+  for(i=0; i<producers; i++)
+    prods[i]->Start();
+
+  for(got=0; got<(producers * count); )
+    if(queue->Read(msg, sizeof(msg), 1000) == sizeof(msg))
+      got++;
+
+  elapsed = ThreadTimeUS() - start;
+
+  //Print results
+  cout << label << " producers " << producers << " msgs/s " << ((uint64_t)got * 1000000 / elapsed) << "\n";
+
+  //Cleanup
+  for(i=0; i<producers; i++)
+  {
+    prods[i]->Stop();
+    delete prods[i];
+  }
+
+  delete[] prods;
+}
+
+void BenchShards(uint16_t port, uint32_t shards, uint32_t clients, uint32_t secs, bool uring=false)
+{
+  Device* devs[HCServer::SHARD_MAX + 1];
+  HCContainer* topcont;
+  HCServer* srv;
+  BenchClient** clis;
+  uint32_t cores;
+  uint64_t xacts;
+  uint64_t errs;
+  uint64_t start;
+  uint64_t elapsed;
+  uint32_t i;
+
+  //Get number of cores to spread shards across
+  cores = ThreadNumProcsOnline();
+
+  //Create server with one socket per shard, all on the same port
+  topcont = new HCContainer("");
+  for(i=0; i<shards; i++)
+  {
+    if(uring)
+      devs[i] = new URingUDPDevice(port, 0, 0, 0, true);
+    else
+      devs[i] = new UDPDevice(port, 0, 0, 0, true);
+  }
+
+  srv = new HCServer(devs[0], topcont, "Bench", __DATE__ " " __TIME__, HCServer::PID_MAX, 0);
+  for(i=1; i<shards; i++)
+    srv->AddShard(devs[i], i % cores);
+
+  srv->Start();
+
+  //Create and start clients
+  clis = new BenchClient*[clients];
+  for(i=0; i<clients; i++)
+    clis[i] = new BenchClient(port);
+
+  start = ThreadTimeUS();
+  for(i=0; i<clients; i++)
+    clis[i]->Start();
+
+  //Let clients run
+  ThreadSleep(secs * 1000);
+
+  //Stop clients and total their transactions
+  for(i=0, xacts=0, errs=0; i<clients; i++)
+  {
+    clis[i]->Stop();
+    xacts += clis[i]->GetXactCount();
+    errs += clis[i]->GetErrCount();
+  }
+  elapsed = ThreadTimeUS() - start;
+
+  //Print results
+  cout << (uring ? "uring" : "udp") << " shards " << shards << " clients " << clients << " xacts/s " << (xacts * 1000000 / elapsed) << " errors " << errs << "\n";
+
+  //Cleanup (server stops shard threads before their sockets are closed)
+  for(i=0; i<clients; i++)
+    delete clis[i];
+
+  delete[] clis;
+  delete srv;
+
+  for(i=0; i<shards; i++)
+    delete devs[i];
+
+  delete topcont;
+}
+
+void BenchLatency(const char* label, Device* srvdev, Device* clidev, uint32_t secs)
+{
+  HCContainer* topcont;
+  HCServer* srv;
+  HCContainer* clicont;
+  HCClient* cli;
+  uint32_t* rtts;
+  uint32_t maxcount;
+  uint32_t count;
+  uint32_t errs;
+  uint64_t total;
+  uint64_t start;
+  uint64_t end;
+  uint64_t xactstart;
+  string val;
+  uint32_t i;
+
+  //Create server and a single client (one transaction in flight so round trip time is pure latency)
+  topcont = new HCContainer("");
+  srv = new HCServer(srvdev, topcont, "Bench", __DATE__ " " __TIME__);
+  srv->Start();
+  clicont = new HCContainer("");
+
+  //Check for no client device (client calls server parameters directly)
+  if(clidev != 0)
+    cli = new HCClient(clidev, clicont, 1000);
+  else
+    cli = new HCClient(srv, clicont);
+
+  //Warm up (connects stream transports and faults in buffers)
+  for(i=0; i<100; i++)
+    cli->Get(HCServer::PID_NAME, val);
+
+  //Time back to back transactions for requested duration (bounded by storage)
+  maxcount = 1000000;
+  rtts = new uint32_t[maxcount];
+  start = ThreadTimeUS();
+  end = start + (uint64_t)secs * 1000000;
+  for(count=0, errs=0; (count < maxcount) && (ThreadTimeUS() < end); )
+  {
+    xactstart = ThreadTimeUS();
+    if(cli->Get(HCServer::PID_NAME, val) == ERR_NONE)
+      rtts[count++] = (uint32_t)(ThreadTimeUS() - xactstart);
+    else
+      errs++;
+  }
+
+  //Print mean and percentiles
+  sort(rtts, rtts + count);
+  for(i=0, total=0; i<count; i++)
+    total += rtts[i];
+  if(count > 0)
+    cout << label << " xacts " << count << " rtt us mean " << (total / count) << " p50 " << rtts[count / 2] << " p99 " << rtts[(uint64_t)count * 99 / 100] << " max " << rtts[count - 1] << " errors " << errs << "\n";
+  else
+    cout << label << " no transactions completed, errors " << errs << "\n";
+
+  //Cleanup (server stops its thread before devices are deleted)
+  delete[] rtts;
+  delete cli;
+  delete clicont;
+  delete srv;
+  delete clidev;
+  delete srvdev;
+  delete topcont;
+}
+
+class SyncPeer
+{
+public:
+  SyncPeer(Event* ping, Event* pong, uint32_t count)
+  {
+    //Remember events and number of round trips
+    _ping = ping;
+    _pong = pong;
+    _count = count;
+
+    //Create echo thread
+    _thread = new Thread<SyncPeer>(this, &SyncPeer::EchoThread);
+  }
+
+  ~SyncPeer()
+  {
+    //Cleanup
+    delete _thread;
+  }
+
+  void Start(void)
+  {
+    _thread->Start();
+  }
+
+  void Stop(void)
+  {
+    _thread->Join();
+  }
+
+private:
+  void EchoThread(void)
+  {
+    uint32_t i;
+
+    //Answer each ping with a pong
+    for(i=0; i<_count; i++)
+    {
+      _ping->Wait();
+      _pong->Signal();
+    }
+  }
+
+private:
+  Event* _ping;
+  Event* _pong;
+  uint32_t _count;
+  Thread<SyncPeer>* _thread;
+};
+
+void BenchSync(uint32_t count)
+{
+  Event* ping;
+  Event* pong;
+  Event* evt;
+  Semaphore* sem;
+  SyncPeer* peer;
+  uint64_t start;
+  uint64_t elapsed;
+  uint32_t i;
+
+  //Start echo thread first so library locking takes its multithreaded path as it would in a client
+  ping = new Event();
+  pong = new Event();
+  peer = new SyncPeer(ping, pong, count / 10);
+  peer->Start();
+
+  //Uncontended event as HCClient uses it (reset, signal, wait)
+  evt = new Event();
+  start = ThreadTimeUS();
+  for(i=0; i<count; i++)
+  {
+    evt->Reset();
+    evt->Signal();
+    evt->Wait(1000);
+  }
+  elapsed = ThreadTimeUS() - start;
+  cout << "event reset+signal+wait ns " << (elapsed * 1000 / count) << "\n";
+
+  //Uncontended semaphore give and take
+  sem = new Semaphore(0);
+  start = ThreadTimeUS();
+  for(i=0; i<count; i++)
+  {
+    sem->Give();
+    sem->Wait(1000);
+  }
+  elapsed = ThreadTimeUS() - start;
+  cout << "semaphore give+wait ns " << (elapsed * 1000 / count) << "\n";
+
+  //Contended events bouncing between two threads (every wait sleeps)
+  start = ThreadTimeUS();
+  for(i=0; i<(count / 10); i++)
+  {
+    ping->Signal();
+    pong->Wait();
+  }
+  elapsed = ThreadTimeUS() - start;
+  cout << "event ping-pong round trip ns " << (elapsed * 1000 / (count / 10)) << "\n";
+
+  //Cleanup
+  peer->Stop();
+  delete peer;
+  delete sem;
+  delete evt;
+  delete pong;
+  delete ping;
+}
+
+class BenchTimerTask : public TimerTask
+{
+public:
+  BenchTimerTask(uint32_t* fired)
+  {
+    //Initialize member variables
+    _fired = fired;
+  }
+
+  virtual ~BenchTimerTask()
+  {
+  }
+
+  virtual void Run(void)
+  {
+    //Count expiry
+    __atomic_add_fetch(_fired, 1, __ATOMIC_RELAXED);
+  }
+
+private:
+  uint32_t* _fired;
+};
+
+void BenchTimer(uint32_t count)
+{
+  TimerWheel* wheel;
+  BenchTimerTask** tasks;
+  uint32_t fired;
+  uint64_t start;
+  uint64_t elapsed;
+  uint32_t val;
+  uint32_t i;
+
+  //Create wheel with one millisecond tick and timers that count their expiries
+  wheel = new TimerWheel(1000);
+  tasks = new BenchTimerTask*[count];
+  fired = 0;
+  for(i=0; i<count; i++)
+    tasks[i] = new BenchTimerTask(&fired);
+
+  //Schedule one-shot timers spread over the next second
+  start = ThreadTimeUS();
+  for(i=0; i<count; i++)
+    wheel->Schedule(tasks[i], 100000 + (i % 1000) * 1000);
+  elapsed = ThreadTimeUS() - start;
+  cout << "timer schedule ns " << (elapsed * 1000 / count) << "\n";
+
+  //Cancel every other timer
+  start = ThreadTimeUS();
+  for(i=0; i<count; i+=2)
+    wheel->Cancel(tasks[i]);
+  elapsed = ThreadTimeUS() - start;
+  cout << "timer cancel ns " << (elapsed * 2000 / count) << "\n";
+
+  //Let the rest expire
+  ThreadSleep(1500);
+  cout << "timers fired " << __atomic_load_n(&fired, __ATOMIC_RELAXED) << " of " << (count / 2) << "\n";
+  wheel->GetDrift(val);
+  cout << "timer drift us " << val << "\n";
+  wheel->GetJitter(val);
+  cout << "timer jitter us " << val << "\n";
+  wheel->GetOverrunCount(val);
+  cout << "timer overruns " << val << "\n";
+
+  //Cleanup
+  delete wheel;
+  for(i=0; i<count; i++)
+    delete tasks[i];
+  delete[] tasks;
+}
+
+void Usage(const char* appname)
+{
+  cout << "Usage: " << appname << " shards|uring|latency|impair|queue|sync|timer [SECONDS] [CLIENTS] [PORT]" << "\n";
+  cout << "  shards - Read-only transaction rate of a UDP server sharded 1, 2, 4 and 8 ways" << "\n";
+  cout << "  uring - Read-only transaction rate of a UDP server on plain sockets then io_uring, with 1 and 4 shards" << "\n";
+  cout << "  queue - Message rate through a bounded queue from 1, 2, 4 and 8 producer threads into one consumer, then single producer specialization" << "\n";
+  cout << "  sync - Cost of uncontended event and semaphore operations, then event round trip between two threads" << "\n";
+  cout << "  timer - Cost of scheduling and cancelling a million timers on a timer wheel, then drift and jitter of the ones that fire" << "\n";
+  cout << "  impair - Single client round trip time over in-memory loopback with injected latency, reordering and loss" << "\n";
+  cout << "  latency - Single client round trip time over loopback UDP, Unix sequenced packet socket, shared memory, in-memory loopback and in-process" << "\n";
+}
+
+int main(int argc, char** argv)
+{
+  uint32_t secs;
+  uint32_t clients;
+  uint16_t port;
+  uint32_t shards;
+  LoopDevice* loopdev;
+  Queue* queue;
+  SPSCQueue* spscqueue;
+  uint32_t producers;
+
+  //Check for missing benchmark name
+  if(argc < 2)
+  {
+    Usage(argv[0]);
+    return -1;
+  }
+
+  //Set defaults
+  secs = 5;
+  clients = 16;
+  port = 1700;
+
+  //Convert optional arguments and check for error
+  if(((argc > 2) && !StringConvert(argv[2], secs)) || ((argc > 3) && !StringConvert(argv[3], clients)) || ((argc > 4) && !StringConvert(argv[4], port)))
+  {
+    Usage(argv[0]);
+    return -1;
+  }
+
+  //Run requested benchmark
+  if(strcmp(argv[1], "shards") == 0)
+  {
+    //Run on a fresh port for each shard count so sockets from the last run do not take traffic
+    for(shards=1; shards<=8; shards*=2)
+      BenchShards(port++, shards, clients, secs);
+  }
+  else if(strcmp(argv[1], "uring") == 0)
+  {
+    //Check for kernel without io_uring
+    if(!URingUDPDevice::IsSupported())
+    {
+      cout << "io_uring unavailable" << "\n";
+      return -1;
+    }
+
+    //Compare transports side by side on fresh ports
+    for(shards=1; shards<=4; shards*=4)
+    {
+      BenchShards(port++, shards, clients, secs);
+      BenchShards(port++, shards, clients, secs, true);
+    }
+  }
+  else if(strcmp(argv[1], "latency") == 0)
+  {
+    //Same client and server over each local transport in turn
+    BenchLatency("udp", new UDPDevice(port), new UDPDevice(0, 0, "127.0.0.1", port), secs);
+    BenchLatency("unix", new UnixReactor("/tmp/hcbench.sock", HCMessage::OVERHEAD + HCMessage::PAYLOAD_MAX), new UnixClient("/tmp/hcbench.sock"), secs);
+    BenchLatency("shm", new SHMDevice("hcbench", true), new SHMDevice("hcbench", false), secs);
+    loopdev = new LoopDevice();
+    BenchLatency("loop", loopdev, new LoopDevice(loopdev), secs);
+    BenchLatency("local", new UDPDevice(port), 0, secs);
+  }
+  else if(strcmp(argv[1], "queue") == 0)
+  {
+    //Many producers into one consumer through the same queue
+    for(producers=1; producers<=8; producers*=2)
+    {
+      queue = new Queue(256, 64);
+      BenchQueue("queue", queue, producers, 1000000);
+      delete queue;
+    }
+
+    //Single producer into single consumer through the specialized queue
+    spscqueue = new SPSCQueue(256, 64);
+    BenchQueue("spscqueue", spscqueue, 1, 1000000);
+    delete spscqueue;
+  }
+  else if(strcmp(argv[1], "sync") == 0)
+  {
+    //Enough operations to swamp timer resolution
+    BenchSync(10000000);
+  }
+  else if(strcmp(argv[1], "timer") == 0)
+  {
+    //Enough timers to fill every slot of the lower levels
+    BenchTimer(1000000);
+  }
+  else if(strcmp(argv[1], "impair") == 0)
+  {
+    //Fixed seeds so each run sees the same impairment pattern
+    loopdev = new LoopDevice();
+    loopdev->SetLatency(100);
+    BenchLatency("loop request latency 100us", loopdev, new LoopDevice(loopdev), secs);
+
+    loopdev = new LoopDevice();
+    loopdev->SetReorder(LoopDevice::RATE_SCALE / 100);
+    loopdev->SetSeed(1);
+    BenchLatency("loop reorder 1%", loopdev, new LoopDevice(loopdev), secs);
+
+    loopdev = new LoopDevice();
+    loopdev->SetLoss(LoopDevice::RATE_SCALE / 10000);
+    loopdev->SetSeed(1);
+    BenchLatency("loop loss 0.01%", loopdev, new LoopDevice(loopdev), secs);
+  }
+  else
+  {
+    Usage(argv[0]);
+    return -1;
+  }
+
+  return 0;
+}
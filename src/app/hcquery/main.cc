@@ -100,7 +100,7 @@ private:
       //Read from device
       if((readcount = _dev->Read(readbuf, sizeof(readbuf)-1)) < 3)
       {
-        ThreadSleep(1000);
+        _dev->WaitReadable(1000);
         continue;
       }
 
@@ -38,6 +38,7 @@
 #include "pca9685.hh"
 #include "pca9685servo.hh"
 #include "piserver.hh"
+#include "timerwheel.hh"
 #include "udpdevice.hh"
 #include <getopt.h>
 #include <inttypes.h>
@@ -109,6 +110,7 @@ int main(int argc, char** argv)
 //  PCA9685Servo* leftwindow;
 //  PCA9685Servo* rightwindow;
 //  PCA9685Servo* cellardoor;
+  TimerWheel* wheel;
   PiServer* pisrv;
   HCContainer* topcont;
   UDPDevice* srvdev;
@@ -146,8 +148,11 @@ int main(int argc, char** argv)
 //  rightwindow = new PCA9685Servo(pca9685, 14, 0.027, 0.127);
 //  cellardoor = new PCA9685Servo(pca9685, 15, 0.027, 0.127);
 
+  //Create timer wheel for periodic work (10ms tick)
+  wheel = new TimerWheel(10000);
+
   //Create Raspberry Pi server object
-  pisrv = new PiServer();
+  pisrv = new PiServer(wheel);
 
   //Create top container
   topcont = new HCContainer("");
@@ -28,11 +28,15 @@
 #include "ftoi.hh"
 #include "piserver.hh"
 #include "thread.hh"
+#include <cassert>
 #include <stdio.h>
 #include <stdlib.h>
 
-PiServer::PiServer()
+PiServer::PiServer(TimerWheel* wheel)
 {
+  //Assert valid arguments
+  assert(wheel != 0);
+
   //Create relay GPIO drivers
   _relay[0] = new PiGPIO(26, true, true);
   _relay[1] = new PiGPIO(20, true, true);
@@ -40,16 +44,21 @@ PiServer::PiServer()
 
   //Initialize CPU utilization status
   _cpuutilization = 0.0;
+  _oldtotaluse = 0;
+  _oldtotal = 0;
 
-  //Create and start control thread
-  _ctlthread = new Thread<PiServer>(this, &PiServer::CtlThread);
-  _ctlthread->Start();
+  //Create sampler and run it every second
+  _wheel = wheel;
+  _sampler = new TimerMethod<PiServer>(this, &PiServer::Sample);
+  _wheel->Schedule(_sampler, 1000000, 1000000);
 }
 
 PiServer::~PiServer()
 {
-  //Delete control thread
-  delete _ctlthread;
+  //Stop sampler and wait for any run in progress before deleting it
+  _wheel->Cancel(_sampler);
+  _sampler->Wait();
+  delete _sampler;
 
   //Delete relay GPIO drivers
   delete _relay[0];
@@ -126,7 +135,7 @@ int PiServer::PulseRelayHigh(uint32_t eid)
   return ERR_NONE;
 }
 
-void PiServer::CtlThread(void)
+void PiServer::Sample(void)
 {
   uint64_t user;
   uint64_t nice;
@@ -134,41 +143,28 @@ void PiServer::CtlThread(void)
   uint64_t idle;
   uint64_t totaluse;
   uint64_t total;
-  uint64_t oldtotaluse;
-  uint64_t oldtotal;
   FILE* fp;
 
-  //Initialize old counts
-  oldtotaluse = 0;
-  oldtotal = 0;
+  //Open processor stats file and check for failure
+  if((fp = fopen("/proc/stat", "r")) == NULL)
+    return;
 
-  //Go forever
-  while(true)
+  //Read in stats and check for success
+  if(fscanf(fp, "%*s %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64, &user, &nice, &sys, &idle) == 4)
   {
-    //Sleep one second
-    ThreadSleep(1000);
-
-    //Open processor stats file and check for success
-    if((fp = fopen("/proc/stat", "r")) != NULL)
-    {
-      //Read in stats and check for success
-      if(fscanf(fp, "%*s %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64, &user, &nice, &sys, &idle) == 4)
-      {
-        //Calculate totals
-        totaluse = user + nice + sys;
-        total = totaluse + idle;
-
-        //Don't do this on the first iteration
-        if(oldtotal != 0)
-          FToU((double)(totaluse - oldtotaluse)/(double)(total - oldtotal)*100.0, _cpuutilization);
-
-        //These are now the old stats
-        oldtotaluse = totaluse;
-        oldtotal = total;
-      }
-
-      //Close processor stats file
-      fclose(fp);
-    }
+    //Calculate totals
+    totaluse = user + nice + sys;
+    total = totaluse + idle;
+
+    //Don't do this on the first sample
+    if(_oldtotal != 0)
+      FToU((double)(totaluse - _oldtotaluse)/(double)(total - _oldtotal)*100.0, _cpuutilization);
+
+    //These are now the old stats
+    _oldtotaluse = totaluse;
+    _oldtotal = total;
   }
+
+  //Close processor stats file
+  fclose(fp);
 }
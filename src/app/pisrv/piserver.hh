@@ -27,13 +27,13 @@
 #pragma once
 
 #include "pigpio.hh"
-#include "thread.hh"
+#include "timerwheel.hh"
 #include <inttypes.h>
 
 class PiServer
 {
 public:
-  PiServer();
+  PiServer(TimerWheel* wheel);
   ~PiServer();
   int GetTemperature(float& val);
   int GetCPUUtilization(uint8_t& val);
@@ -42,10 +42,13 @@ public:
   int PulseRelayHigh(uint32_t eid);
 
 private:
-  void CtlThread(void);
+  void Sample(void);
 
 private:
   PiGPIO* _relay[3];
   uint8_t _cpuutilization;
-  Thread<PiServer>* _ctlthread;
+  uint64_t _oldtotaluse;
+  uint64_t _oldtotal;
+  TimerWheel* _wheel;
+  TimerMethod<PiServer>* _sampler;
 };
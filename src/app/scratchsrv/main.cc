@@ -41,13 +41,15 @@
 #include "scratch.hh"
 #include "scratchstring.hh"
 #include "scratchvec.hh"
-#include "slipframer.hh"
+#include "shmdevice.hh"
 #include "str.hh"
 #include "system.hh"
-#include "tcpserver.hh"
+#include "tcpreactor.hh"
 #include "thread.hh"
-#include "tlsserver.hh"
+#include "tlsreactor.hh"
 #include "udpdevice.hh"
+#include "unixreactor.hh"
+#include "uringudpdevice.hh"
 #include <cassert>
 #include <getopt.h>
 #include <inttypes.h>
@@ -71,6 +73,10 @@ static struct option Longopts[] =
   { "tls", 0, NULL, 's' },
   { "port", required_argument, NULL, 'p' },
   { "qport", required_argument, NULL, 'q' },
+  { "shards", required_argument, NULL, 'k' },
+  { "uring", 0, NULL, 'u' },
+  { "shm", required_argument, NULL, 'm' },
+  { "unix", required_argument, NULL, 'x' },
   { "daemon", 0, NULL, 'd' },
   { NULL, 0, NULL, 0 }
 };
@@ -82,6 +88,10 @@ struct Args
   bool tls;
   uint16_t port;
   uint16_t qport;
+  uint32_t shards;
+  bool uring;
+  const char* shm;
+  const char* unixpath;
   bool daemon;
 };
 
@@ -96,6 +106,10 @@ void Usage()
   cout << "[-s, --tls] Use TLS for transport protocol" << "\n";
   cout << "[-p, --port] <PORT> Port number used for server (defaults to 1500)" << "\n";
   cout << "[-q, --qport] <PORT> Port number used for query server (defaults to 5555)" << "\n";
+  cout << "[-k, --shards] <COUNT> Number of UDP sockets sharing the port, one thread per core (defaults to 1)" << "\n";
+  cout << "[-m, --shm] <NAME> Use shared memory segment of this name for transport (same host clients only)" << "\n";
+  cout << "[-x, --unix] <PATH> Use Unix sequenced packet socket at this path for transport (same host clients only)" << "\n";
+  cout << "[-u, --uring] Use io_uring for UDP sockets (falls back to plain sockets if unavailable)" << "\n";
   cout << "[-d, --daemon] Spawn in background mode" << "\n";
 }
 
@@ -137,6 +151,26 @@ bool ParseOptions(int argc, char** argv, struct Args* args)
         break;
       }
 
+      break;
+    case 'k':
+      //Convert shard count and check for error
+      if(!StringConvert(optarg, args->shards) || (args->shards < 1) || (args->shards > HCServer::SHARD_MAX + 1))
+      {
+        valid = false;
+        cout << "Invalid shard count (" << optarg << ")" << "\n";
+        Usage();
+        break;
+      }
+
+      break;
+    case 'u':
+      args->uring = true;
+      break;
+    case 'm':
+      args->shm = optarg;
+      break;
+    case 'x':
+      args->unixpath = optarg;
       break;
     case 'd':
       args->daemon = true;
@@ -294,25 +328,35 @@ int main(int argc, char** argv)
   HCContainer* topcont;
   HCContainer* cont;
   Device* srvdev;
-  TCPServer* tcpsrv;
-  TLSServer* tlssrv;
   HCServer* srv;
   Device* qsrvdev;
   HCQServer* qsrv;
   HCConsole* hccons;
   struct Args args;
+  uint32_t i;
 
   //Set argument default values
   args.tcp = false;
   args.tls = false;
   args.port = 1500;
   args.qport = 5555;
+  args.shards = 1;
+  args.uring = false;
+  args.shm = 0;
+  args.unixpath = 0;
   args.daemon = false;
 
   //Parse arguments
   if(!ParseOptions(argc, argv, &args))
     return -1;
 
+  //Fall back to plain sockets if kernel cannot do io_uring
+  if(args.uring && !URingUDPDevice::IsSupported())
+  {
+    cout << "io_uring unavailable, using plain UDP sockets" << "\n";
+    args.uring = false;
+  }
+
   //Check for daemon mode
   if(args.daemon)
     if(daemon(1, 1) != 0)
@@ -350,24 +394,53 @@ int main(int argc, char** argv)
   //Check protocol to use
   if(args.tcp)
   {
-    //Create server device
-    tcpsrv = new TCPServer(args.port);
-    srvdev = new SLIPFramer(tcpsrv, 2000 + 2);
+    //Create server device (accepts many concurrent clients)
+    srvdev = new TCPReactor(args.port, 2000 + 2);
   }
   else if(args.tls)
   {
-    //Create server device
-    tlssrv = new TLSServer(args.port, "cert.pem", "key.pem", 0xB6FE1F4A); //CRC32 of "democosm:hcpass"
-    srvdev = new SLIPFramer(tlssrv, 2000 + 2);
+    //Create server device (accepts many concurrent clients)
+    srvdev = new TLSReactor(args.port, 2000 + 2, "cert.pem", "key.pem", 0xB6FE1F4A); //CRC32 of "democosm:hcpass"
+  }
+  else if(args.unixpath != 0)
+  {
+    //Create server device (accepts many concurrent clients of the same user)
+    srvdev = new UnixReactor(args.unixpath, 2000 + 2);
+  }
+  else if(args.shm != 0)
+  {
+    //Create server device (peer attaches by name)
+    srvdev = new SHMDevice(args.shm, true);
+  }
+  else if(args.shards > 1)
+  {
+    //Create first of several server devices sharing the port
+    if(args.uring)
+      srvdev = new URingUDPDevice(args.port, 0, 0, 0, true);
+    else
+      srvdev = new UDPDevice(args.port, 0, 0, 0, true);
   }
   else
   {
     //Create server device
-    srvdev = new UDPDevice(args.port);
+    if(args.uring)
+      srvdev = new URingUDPDevice(args.port);
+    else
+      srvdev = new UDPDevice(args.port);
   }
 
-  //Create server
-  srv = new HCServer(srvdev, topcont, "Scratch", __DATE__ " " __TIME__);
+  //Create server (pinned to first core when sharded)
+  srv = new HCServer(srvdev, topcont, "Scratch", __DATE__ " " __TIME__, HCServer::PID_MAX, (args.shards > 1) ? 0 : -1);
+
+  //Add remaining shards, each on its own socket and core
+  if(!args.tcp && !args.tls && (args.shm == 0) && (args.unixpath == 0))
+    for(i=1; i<args.shards; i++)
+    {
+      if(args.uring)
+        srv->AddShard(new URingUDPDevice(args.port, 0, 0, 0, true), i % ThreadNumProcsOnline());
+      else
+        srv->AddShard(new UDPDevice(args.port, 0, 0, 0, true), i % ThreadNumProcsOnline());
+    }
 
   //Add parameters
   cont = new HCContainer("system");
@@ -26,23 +26,49 @@
 
 #include "crc.hh"
 #include "device.hh"
+#include "event.hh"
+#include "executor.hh"
 #include "scratch.hh"
+#include "hcaggregator.hh"
+#include "hccall.hh"
+#include "hcconnection.hh"
 #include "hccontainer.hh"
+#include "hcfile.hh"
+#include "hcinteger.hh"
 #include "hcparameter.hh"
 #include "hcserver.hh"
 #include "hcstring.hh"
-#include "udpsocket.hh"
+#include "hcutility.hh"
+#include "loopdevice.hh"
+#include "pipe.hh"
+#include "queue.hh"
+#include "semaphore.hh"
+#include "shmdevice.hh"
+#include "slipframer.hh"
+#include "tcpclient.hh"
+#include "tcpreactor.hh"
+#include "thread.hh"
+#include "timerwheel.hh"
+#include "udpdevice.hh"
+#include "unixclient.hh"
+#include "unixreactor.hh"
+#include "uringudpdevice.hh"
 #include "gtest.h"
 #include <stdio.h>
+#include <string.h>
+#if __cplusplus >= 202002L
+#include "hccoclient.hh"
+#include "hcscheduler.hh"
+#endif
 
 using namespace std;
 
 Scratch* scratch;
-UDPSocket* srvdev;
+LoopDevice* srvdev;
 HCContainer* srvtopcont;
 HCServer* srv;
 HCParameter* param;
-UDPSocket* clidev;
+LoopDevice* clidev;
 HCContainer* clitopcont;
 HCClient* cli;
 
@@ -155,6 +181,1891 @@ TEST(HC, ControlStrings)
   ASSERT_EQ(clival, testval);
 }
 
+TEST(HC, DirectClient)
+{
+  HCContainer* dircont;
+  HCClient* dircli;
+  string testval;
+  string srvval;
+  string clival;
+  uint32_t srvcrc;
+  uint32_t clicrc;
+  uint32_t u32val;
+
+  //Create in-process client calling server parameters directly
+  dircont = new HCContainer("");
+  dircli = new HCClient(srv, dircont);
+  ASSERT_TRUE(dircli->IsDirect());
+
+  //Download SIF file and compare its CRC to server CRC
+  ASSERT_EQ(ERR_NONE, dircli->DownloadSIF(HCServer::PID_INFOFILE, ".direct-Scratch.xml"));
+  ASSERT_EQ(ERR_NONE, dircli->Get(HCServer::PID_INFOFILECRC, srvcrc));
+  clicrc = CRC32File(".direct-Scratch.xml");
+  ASSERT_EQ(clicrc, srvcrc);
+
+  testval = "Hello direct!";
+
+  //Set scratch string from client and get it directly and from client
+  ASSERT_EQ(ERR_NONE, dircli->Set(4, testval));
+  ASSERT_EQ(ERR_NONE, scratch->GetString(srvval));
+  ASSERT_EQ(ERR_NONE, dircli->Get(4, clival));
+  ASSERT_EQ(srvval, testval);
+  ASSERT_EQ(clival, testval);
+
+  //Verify wrong type and unknown PID are rejected without reaching a device
+  ASSERT_EQ(ERR_TYPE, dircli->Get(4, u32val));
+  ASSERT_EQ(ERR_PID, dircli->Get(HCServer::PID_MAX - 1, clival));
+  ASSERT_EQ(ERR_NONE, dircli->GetTypeErrCount(u32val));
+  ASSERT_EQ(u32val, (uint32_t)1);
+  ASSERT_EQ(ERR_NONE, dircli->GetPIDErrCount(u32val));
+  ASSERT_EQ(u32val, (uint32_t)1);
+
+  //Cleanup
+  delete dircli;
+  delete dircont;
+}
+
+class AsyncCounter
+{
+public:
+  AsyncCounter()
+  {
+    //Nothing completed yet
+    _count = 0;
+    _errcount = 0;
+  }
+
+  void Complete(HCAsync* xact)
+  {
+    //Count completion and any error (runs on client reader thread)
+    if(xact->GetError() != ERR_NONE)
+      __atomic_add_fetch(&_errcount, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&_count, 1, __ATOMIC_RELAXED);
+  }
+
+  uint32_t GetCount(void)
+  {
+    return __atomic_load_n(&_count, __ATOMIC_RELAXED);
+  }
+
+  uint32_t GetErrCount(void)
+  {
+    return __atomic_load_n(&_errcount, __ATOMIC_RELAXED);
+  }
+
+private:
+  uint32_t _count;
+  uint32_t _errcount;
+};
+
+TEST(HC, AsyncClient)
+{
+  AsyncCounter counter;
+  HCAsyncMethod<AsyncCounter>* xacts[8];
+  string vals[8];
+  HCStringCli* strcli;
+  HCAsync xact;
+  HCContainer* cont;
+  LoopDevice* dev;
+  LoopDevice* tdev;
+  HCClient* tcli;
+  uint32_t u32val;
+  uint32_t i;
+
+  //Set scratch string through stub without waiting then wait for result
+  strcli = new HCStringCli(cli, 4);
+  ASSERT_EQ(ERR_NONE, strcli->Set("Hello async!", &xact));
+  ASSERT_EQ(ERR_NONE, xact.Wait(1000));
+
+  //Get it and server name several times over with all transactions in flight at once
+  for(i=0; i<8; i++)
+  {
+    xacts[i] = new HCAsyncMethod<AsyncCounter>(&counter, &AsyncCounter::Complete);
+    if((i % 2) == 0)
+      ASSERT_EQ(ERR_NONE, strcli->Get(vals[i], xacts[i]));
+    else
+      ASSERT_EQ(ERR_NONE, cli->Get(HCServer::PID_NAME, vals[i], xacts[i]));
+  }
+
+  //Wait for all and check values arrived and completions ran
+  for(i=0; i<8; i++)
+  {
+    ASSERT_EQ(ERR_NONE, xacts[i]->Wait(1000));
+    ASSERT_EQ(((i % 2) == 0) ? "Hello async!" : "Scratch", vals[i]);
+  }
+  ASSERT_EQ((uint32_t)8, counter.GetCount());
+  ASSERT_EQ((uint32_t)0, counter.GetErrCount());
+  ASSERT_EQ(ERR_NONE, cli->GetAsyncCount(u32val));
+  ASSERT_EQ((uint32_t)0, u32val);
+
+  //Check wrong type is reported and value set to default
+  u32val = 1;
+  ASSERT_EQ(ERR_NONE, cli->Get(4, u32val, &xact));
+  ASSERT_EQ(ERR_TYPE, xact.Wait(1000));
+  ASSERT_EQ((uint32_t)0, u32val);
+
+  //Check transaction to server that never answers times out without blocking caller
+  cont = new HCContainer("");
+  dev = new LoopDevice();
+  tdev = new LoopDevice(dev);
+  tcli = new HCClient(tdev, cont, 50);
+  ASSERT_EQ(ERR_NONE, tcli->Get(HCServer::PID_NAME, vals[0], &xact));
+  ASSERT_FALSE(xact.IsDone());
+  ASSERT_EQ(ERR_TIMEOUT, xact.Wait());
+  ASSERT_EQ("", vals[0]);
+  ASSERT_EQ(ERR_NONE, tcli->GetTimeoutErrCount(u32val));
+  ASSERT_EQ((uint32_t)1, u32val);
+
+  //Cleanup
+  delete tcli;
+  delete cont;
+  delete tdev;
+  delete dev;
+  for(i=0; i<8; i++)
+    delete xacts[i];
+  delete strcli;
+}
+
+#if __cplusplus >= 202002L
+HCTask CoGetName(HCCoClient* cocli, string* val)
+{
+  //Get server name from nested task
+  co_return co_await cocli->GetAsync(HCServer::PID_NAME, *val);
+}
+
+HCTask CoSetGet(HCCoClient* cocli, string* val, string* name, int* err)
+{
+  uint32_t u32val;
+
+  //Set scratch string, read it back, then await nested task for server name
+  if((*err = co_await cocli->SetAsync(4, string("Hello coroutine!"))) != ERR_NONE)
+    co_return *err;
+  if((*err = co_await cocli->GetAsync(4, *val)) != ERR_NONE)
+    co_return *err;
+  if((*err = co_await CoGetName(cocli, name)) != ERR_NONE)
+    co_return *err;
+
+  //Check wrong type error is passed back through await
+  *err = co_await cocli->GetAsync(4, u32val);
+  co_return *err;
+}
+
+TEST(HC, CoroutineClient)
+{
+  HCScheduler sched;
+  HCCoClient cocli(cli);
+  string vals[4];
+  string names[4];
+  int errs[4];
+  uint32_t i;
+
+  //Spawn several tasks with transactions interleaved on one client
+  for(i=0; i<4; i++)
+    sched.Spawn(CoSetGet(&cocli, &vals[i], &names[i], &errs[i]));
+  ASSERT_EQ((uint32_t)4, sched.GetTaskCount());
+
+  //Run tasks to completion on this thread
+  sched.Run();
+  ASSERT_EQ((uint32_t)0, sched.GetTaskCount());
+
+  //Check every task saw its values and the type error
+  for(i=0; i<4; i++)
+  {
+    ASSERT_EQ(ERR_TYPE, errs[i]);
+    ASSERT_EQ("Hello coroutine!", vals[i]);
+    ASSERT_EQ("Scratch", names[i]);
+  }
+}
+#else
+TEST(HC, CoroutineClient)
+{
+  //Test app is built as C++20 with the coroutine client library, so report a build that dropped it rather than skip quietly
+  FAIL() << "Coroutine client not built (requires C++20)";
+}
+#endif
+
+TEST(HC, LoopImpairments)
+{
+  LoopDevice* dev0;
+  LoopDevice* dev1;
+  uint8_t buf[8];
+  uint64_t start;
+  uint32_t drops0;
+  uint32_t drops1;
+  uint32_t i;
+
+  //Create pair and check message goes across
+  dev0 = new LoopDevice();
+  dev1 = new LoopDevice(dev0);
+  ASSERT_EQ((uint32_t)1, dev0->Write("a", 1));
+  ASSERT_EQ(ERR_NONE, dev1->WaitReadable(100));
+  ASSERT_EQ((uint32_t)1, dev1->Read(buf, sizeof(buf)));
+  ASSERT_EQ('a', buf[0]);
+
+  //Check latency holds message back until it is due
+  dev1->SetLatency(20000);
+  start = ThreadTimeUS();
+  dev0->Write("b", 1);
+  ASSERT_EQ(ERR_TIMEOUT, dev1->WaitReadable(WAIT_NONE));
+  ASSERT_EQ((uint32_t)1, dev1->Read(buf, sizeof(buf)));
+  ASSERT_GE(ThreadTimeUS() - start, (uint64_t)20000);
+  ASSERT_EQ('b', buf[0]);
+  dev1->SetLatency(0);
+
+  //Check reorder lets second message overtake first
+  dev1->SetReorder(LoopDevice::RATE_SCALE);
+  dev0->Write("c", 1);
+  dev0->Write("d", 1);
+  ASSERT_EQ((uint32_t)1, dev1->Read(buf, sizeof(buf)));
+  ASSERT_EQ('d', buf[0]);
+  ASSERT_EQ((uint32_t)1, dev1->Read(buf, sizeof(buf)));
+  ASSERT_EQ('c', buf[0]);
+  dev1->SetReorder(0);
+
+  //Check same seed drops same messages in both directions
+  dev0->SetLoss(LoopDevice::RATE_SCALE / 2);
+  dev1->SetLoss(LoopDevice::RATE_SCALE / 2);
+  dev0->SetSeed(1234);
+  dev1->SetSeed(1234);
+  for(i=0; i<100; i++)
+  {
+    dev0->Write("e", 1);
+    dev1->Write("f", 1);
+    if(dev0->WaitReadable(WAIT_NONE) == ERR_NONE)
+      dev0->Read(buf, sizeof(buf));
+    if(dev1->WaitReadable(WAIT_NONE) == ERR_NONE)
+      dev1->Read(buf, sizeof(buf));
+  }
+  ASSERT_EQ(ERR_NONE, dev0->GetDropCount(drops0));
+  ASSERT_EQ(ERR_NONE, dev1->GetDropCount(drops1));
+  ASSERT_EQ(drops0, drops1);
+  ASSERT_GT(drops0, (uint32_t)0);
+  ASSERT_LT(drops0, (uint32_t)100);
+
+  //Cleanup
+  delete dev1;
+  delete dev0;
+}
+
+TEST(HC, AdaptiveRetransmit)
+{
+  HCContainer* xtopcont;
+  LoopDevice* xdev;
+  HCServer* xsrv;
+  HCContainer* ctopcont;
+  LoopDevice* cdev;
+  HCClient* xcli;
+  HCAsync xact;
+  string sval;
+  uint32_t u32val;
+  uint32_t good;
+  uint32_t total;
+  uint32_t i;
+
+  //Create server and client over link that delays and loses replies
+  xdev = new LoopDevice();
+  xtopcont = new HCContainer("");
+  xsrv = new HCServer(xdev, xtopcont, "Lossy", __DATE__ " " __TIME__);
+  xsrv->Start();
+  cdev = new LoopDevice(xdev);
+  cdev->SetLatency(2000);
+  cdev->SetLoss(LoopDevice::RATE_SCALE / 10);
+  cdev->SetSeed(4321);
+  ctopcont = new HCContainer("");
+  xcli = new HCClient(cdev, ctopcont, 500);
+
+  //Read server name many times over blocking and asynchronous transactions
+  good = 0;
+  for(i=0; i<100; i++)
+  {
+    if(xcli->Get(HCServer::PID_NAME, sval) == ERR_NONE)
+      good++;
+  }
+  for(i=0; i<20; i++)
+  {
+    if((xcli->Get(HCServer::PID_NAME, sval, &xact) == ERR_NONE) && (xact.Wait() == ERR_NONE))
+      good++;
+  }
+
+  //Check lost replies were recovered by sending reads again rather than timing out
+  ASSERT_GE(good, (uint32_t)115);
+  ASSERT_EQ(ERR_NONE, xcli->GetRetransmitCount(u32val));
+  ASSERT_GT(u32val, (uint32_t)0);
+  ASSERT_EQ(ERR_NONE, xcli->GetTimeoutErrCount(u32val));
+  ASSERT_EQ(120 - good, u32val);
+
+  //Check round trip time was estimated and adaptive timeout is well under whole timeout
+  ASSERT_EQ(ERR_NONE, xcli->GetSRTT(u32val));
+  ASSERT_GE(u32val, (uint32_t)2000);
+  ASSERT_EQ(ERR_NONE, xcli->GetRTO(u32val));
+  ASSERT_GE(u32val, (uint32_t)HCReplica::RTO_MIN);
+  ASSERT_LT(u32val, (uint32_t)500000);
+
+  //Check every armed timeout was counted in a bin
+  total = 0;
+  for(i=0; i<HCClient::TIMEOUT_BINS; i++)
+  {
+    ASSERT_EQ(ERR_NONE, xcli->GetTimeoutHist(i, u32val));
+    total += u32val;
+  }
+  ASSERT_GE(total, (uint32_t)120);
+  ASSERT_EQ(ERR_EID, xcli->GetTimeoutHist(HCClient::TIMEOUT_BINS, u32val));
+
+  //Check late replies to a read sent again over a suddenly slower link are duplicates rather than transaction errors
+  cdev->SetLoss(0);
+  cdev->SetLatency(30000);
+  ASSERT_EQ(ERR_NONE, xcli->Get(HCServer::PID_NAME, sval));
+  ThreadSleep(100);
+  ASSERT_EQ(ERR_NONE, xcli->GetDupReplyCount(u32val));
+  ASSERT_GT(u32val, (uint32_t)0);
+  ASSERT_EQ(ERR_NONE, xcli->GetTransactionErrCount(u32val));
+  ASSERT_EQ((uint32_t)0, u32val);
+
+  //Cleanup
+  delete xcli;
+  delete ctopcont;
+  delete xsrv;
+  delete xtopcont;
+  delete cdev;
+  delete xdev;
+}
+
+class CallCounter
+{
+public:
+  CallCounter()
+  {
+    //Not called yet
+    _count = 0;
+  }
+
+  int Call(void)
+  {
+    //Count call (runs on server thread)
+    __atomic_add_fetch(&_count, 1, __ATOMIC_RELAXED);
+    return ERR_NONE;
+  }
+
+  uint32_t GetCount(void)
+  {
+    return __atomic_load_n(&_count, __ATOMIC_RELAXED);
+  }
+
+private:
+  uint32_t _count;
+};
+
+static int SendCall(LoopDevice* dev, uint8_t transaction, uint32_t pid)
+{
+  HCMessage msg;
+  HCCell cell;
+
+  //Send call command and wait for reply
+  msg.Reset(transaction);
+  cell.Reset(HCCell::OPCODE_CALL_CMD);
+  cell.WritePID(pid);
+  msg.Write(&cell);
+  if(msg.Send(dev) != ERR_NONE)
+    return ERR_UNSPEC;
+  if(dev->WaitReadable(1000) != ERR_NONE)
+    return ERR_TIMEOUT;
+  if(msg.Recv(dev) != ERR_NONE)
+    return ERR_UNSPEC;
+
+  //Check reply is to same transaction
+  if(msg.GetTransaction() != transaction)
+    return ERR_UNSPEC;
+
+  return ERR_NONE;
+}
+
+TEST(HC, ServerReplyCache)
+{
+  CallCounter counter;
+  HCContainer* xtopcont;
+  LoopDevice* xdev;
+  HCServer* xsrv;
+  LoopDevice* cdev;
+  uint32_t u32val;
+  uint32_t i;
+
+  //Create server with call parameter (first PID after special ones) and raw peer device
+  xdev = new LoopDevice();
+  xtopcont = new HCContainer("");
+  xsrv = new HCServer(xdev, xtopcont, "Cache", __DATE__ " " __TIME__);
+  xsrv->Add(new HCCall<CallCounter>("call", &counter, &CallCounter::Call));
+  xsrv->Start();
+  cdev = new LoopDevice(xdev);
+
+  //Check call sent again with same transaction is answered without calling again
+  ASSERT_EQ(ERR_NONE, SendCall(cdev, 5, 4));
+  ASSERT_EQ(ERR_NONE, SendCall(cdev, 5, 4));
+  ASSERT_EQ((uint32_t)1, counter.GetCount());
+  ASSERT_EQ(ERR_NONE, xsrv->GetCacheHitCount(u32val));
+  ASSERT_EQ((uint32_t)1, u32val);
+
+  //Check call with new transaction is carried out
+  ASSERT_EQ(ERR_NONE, SendCall(cdev, 6, 4));
+  ASSERT_EQ((uint32_t)2, counter.GetCount());
+
+  //Check transaction number coming round again after enough other requests is a new call
+  for(i=0; i<HCReplyCache::WINDOW; i++)
+    ASSERT_EQ(ERR_NONE, SendCall(cdev, 7 + i, 4));
+  ASSERT_EQ(ERR_NONE, SendCall(cdev, 6, 4));
+  ASSERT_EQ((uint32_t)(3 + HCReplyCache::WINDOW), counter.GetCount());
+
+  //Check turning cache off carries out every call
+  ASSERT_EQ(ERR_NONE, xsrv->SetCacheAge(0));
+  ASSERT_EQ(ERR_NONE, SendCall(cdev, 100, 4));
+  ASSERT_EQ(ERR_NONE, SendCall(cdev, 100, 4));
+  ASSERT_EQ((uint32_t)(5 + HCReplyCache::WINDOW), counter.GetCount());
+  ASSERT_EQ(ERR_NONE, xsrv->GetCacheHitCount(u32val));
+  ASSERT_EQ((uint32_t)1, u32val);
+
+  //Cleanup
+  delete xsrv;
+  delete xtopcont;
+  delete cdev;
+  delete xdev;
+}
+
+TEST(HC, MessageHeaderVersions)
+{
+  HCMessage msg;
+  HCCell cell;
+  uint8_t buf[HCMessage::OVERHEAD + HCMessage::PAYLOAD_MAX];
+  uint32_t len;
+
+  //Check version 1 header carries low byte of transaction number
+  msg.Reset(0x1234);
+  cell.Reset(HCCell::OPCODE_GET_CMD);
+  cell.WritePID(HCServer::PID_NAME);
+  msg.Write(&cell);
+  ASSERT_EQ(HCMessage::OVERHEAD_V1 + HCCell::OVERHEAD + cell.GetLength(), (len = msg.Store(buf, sizeof(buf))));
+  ASSERT_EQ(ERR_NONE, msg.Load(buf, len));
+  ASSERT_EQ((uint8_t)HCMessage::VERSION_1, msg.GetVersion());
+  ASSERT_EQ((uint32_t)0x34, msg.GetTransaction());
+  ASSERT_TRUE(msg.Read(&cell));
+  ASSERT_EQ((uint8_t)HCCell::OPCODE_GET_CMD, cell.GetOpCode());
+
+  //Check version 2 header carries whole transaction number, flags and total length
+  msg.SetVersion(HCMessage::VERSION_2);
+  msg.SetFlags(HCMessage::FLAG_LENGTH);
+  msg.Reset(0x12345678);
+  cell.Reset(HCCell::OPCODE_GET_CMD);
+  cell.WritePID(HCServer::PID_NAME);
+  msg.Write(&cell);
+  ASSERT_EQ(HCMessage::OVERHEAD + HCCell::OVERHEAD + cell.GetLength(), (len = msg.Store(buf, sizeof(buf))));
+  ASSERT_EQ((uint8_t)HCMessage::MARKER, buf[1]);
+  msg.SetVersion(HCMessage::VERSION_1);
+  msg.SetFlags(0);
+  ASSERT_EQ(ERR_NONE, msg.Load(buf, len));
+  ASSERT_EQ((uint8_t)HCMessage::VERSION_2, msg.GetVersion());
+  ASSERT_EQ((uint8_t)HCMessage::FLAG_LENGTH, msg.GetFlags());
+  ASSERT_EQ((uint32_t)0x12345678, msg.GetTransaction());
+  ASSERT_TRUE(msg.Read(&cell));
+  ASSERT_EQ((uint8_t)HCCell::OPCODE_GET_CMD, cell.GetOpCode());
+
+  //Check cut short message, newer version and header without room for its length are rejected
+  ASSERT_NE(ERR_NONE, msg.Load(buf, len - 1));
+  buf[0] = HCMessage::VERSION_MAX + 1;
+  ASSERT_NE(ERR_NONE, msg.Load(buf, len));
+  buf[0] = HCMessage::VERSION_2;
+  ASSERT_NE(ERR_NONE, msg.Load(buf, HCMessage::OVERHEAD_V2));
+}
+
+TEST(HC, ProtocolNegotiation)
+{
+  CallCounter counter;
+  HCContainer* xtopcont;
+  LoopDevice* xdev;
+  HCServer* xsrv;
+  HCContainer* pcont;
+  HCConnection* conn;
+  HCClient* xcli;
+  HCAsync xact;
+  string sval;
+  uint32_t i;
+
+  //Create server and connect to it (server information file advertises version 2)
+  xdev = new LoopDevice();
+  xtopcont = new HCContainer("");
+  xsrv = new HCServer(xdev, xtopcont, "Versioned", __DATE__ " " __TIME__);
+  xsrv->Add(new HCCall<CallCounter>("call", &counter, &CallCounter::Call));
+  xsrv->Start();
+  pcont = new HCContainer("");
+  conn = new HCConnection(new LoopDevice(xdev), pcont, "versioned", 500);
+  ASSERT_TRUE(conn->IsConnected());
+  xcli = conn->GetClient();
+  ASSERT_EQ((uint8_t)HCMessage::VERSION_2, xcli->GetProtocol());
+
+  //Check blocking and asynchronous transactions over version 2 headers
+  ASSERT_EQ(ERR_NONE, xcli->Get(HCServer::PID_NAME, sval));
+  ASSERT_EQ("Versioned", sval);
+  ASSERT_EQ(ERR_NONE, xcli->Get(HCServer::PID_VERSION, sval, &xact));
+  ASSERT_EQ(ERR_NONE, xact.Wait(1000));
+  ASSERT_EQ(__DATE__ " " __TIME__, sval);
+
+  //Check transaction numbers past 8 bits are new calls, not replies remembered for calls sent again
+  for(i=0; i<300; i++)
+    ASSERT_EQ(ERR_NONE, xcli->Call(4));
+  ASSERT_EQ((uint32_t)300, counter.GetCount());
+
+  //Check server still answers version 1 headers
+  xcli->SetProtocol(HCMessage::VERSION_1);
+  ASSERT_EQ((uint8_t)HCMessage::VERSION_1, xcli->GetProtocol());
+  ASSERT_EQ(ERR_NONE, xcli->Call(4));
+  ASSERT_EQ(ERR_NONE, xcli->Get(HCServer::PID_NAME, sval, &xact));
+  ASSERT_EQ(ERR_NONE, xact.Wait(1000));
+  ASSERT_EQ("Versioned", sval);
+  ASSERT_EQ((uint32_t)301, counter.GetCount());
+
+  //Cleanup
+  delete conn;
+  delete pcont;
+  delete xsrv;
+  delete xtopcont;
+  delete xdev;
+}
+
+class Board
+{
+public:
+  static const uint32_t LOG_SIZE = 64;
+  static const uint32_t HIST_SIZE = 4;
+
+public:
+  Board(Device* dev, const std::string& name, uint32_t val)
+  {
+    uint32_t i;
+
+    //Initialize state
+    _val = val;
+    _label = name;
+    _resets = 0;
+    memset(_log, 0, sizeof(_log));
+    for(i=0; i<HIST_SIZE; i++)
+      _hist[i] = val + i;
+
+    //Create server with one parameter of each kind (value, string, call, file and table)
+    _dev = dev;
+    _topcont = new HCContainer("");
+    _srv = new HCServer(_dev, _topcont, name, __DATE__ " " __TIME__);
+    HCAdd(new HCUns32<Board>("val", this, &Board::GetVal, &Board::SetVal), _topcont, _srv);
+    HCAdd(new HCStr<Board>("label", this, &Board::GetLabel, &Board::SetLabel), _topcont, _srv);
+    HCAdd(new HCCall<Board>("reset", this, &Board::Reset), _topcont, _srv);
+    HCAdd(new HCFile<Board>("log", this, &Board::ReadLog, &Board::WriteLog), _topcont, _srv);
+    HCAdd(new HCUns32Table<Board>("hist", this, &Board::GetHist, &Board::SetHist, HIST_SIZE), _topcont, _srv);
+    _srv->Start();
+  }
+
+  ~Board()
+  {
+    //Cleanup
+    delete _srv;
+    delete _topcont;
+    delete _dev;
+  }
+
+  HCServer* GetServer(void)
+  {
+    return _srv;
+  }
+
+  int GetVal(uint32_t& val)
+  {
+    val = _val;
+    return ERR_NONE;
+  }
+
+  int SetVal(const uint32_t val)
+  {
+    _val = val;
+    return ERR_NONE;
+  }
+
+  int GetLabel(string& val)
+  {
+    val = _label;
+    return ERR_NONE;
+  }
+
+  int SetLabel(const string& val)
+  {
+    _label = val;
+    return ERR_NONE;
+  }
+
+  int Reset(void)
+  {
+    _resets++;
+    return ERR_NONE;
+  }
+
+  uint32_t GetResets(void)
+  {
+    return _resets;
+  }
+
+  int ReadLog(uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len)
+  {
+    //Check offset
+    if(offset > LOG_SIZE)
+      return ERR_RANGE;
+
+    //Copy out as much as fits
+    len = (maxlen < (LOG_SIZE - offset)) ? maxlen : (LOG_SIZE - offset);
+    memcpy(val, &_log[offset], len);
+    return ERR_NONE;
+  }
+
+  int WriteLog(uint32_t offset, uint8_t* val, uint16_t len)
+  {
+    //Check offset and length
+    if((offset > LOG_SIZE) || (len > (LOG_SIZE - offset)))
+      return ERR_RANGE;
+
+    memcpy(&_log[offset], val, len);
+    return ERR_NONE;
+  }
+
+  int GetHist(uint32_t eid, uint32_t& val)
+  {
+    //Check eid
+    if(eid >= HIST_SIZE)
+      return ERR_EID;
+
+    val = _hist[eid];
+    return ERR_NONE;
+  }
+
+  int SetHist(uint32_t eid, const uint32_t val)
+  {
+    //Check eid
+    if(eid >= HIST_SIZE)
+      return ERR_EID;
+
+    _hist[eid] = val;
+    return ERR_NONE;
+  }
+
+private:
+  Device* _dev;
+  HCContainer* _topcont;
+  HCServer* _srv;
+  uint32_t _val;
+  string _label;
+  uint32_t _resets;
+  uint8_t _log[LOG_SIZE];
+  uint32_t _hist[HIST_SIZE];
+};
+
+static void AddParams(HCServer* srv, HCContainer* startcont)
+{
+  HCContainer* cont;
+  HCParameter* param;
+
+  //Add parameters of this container, then of all containers below it
+  for(param=startcont->GetFirstSubParam(); param!=0; param=param->GetNext())
+    srv->Add(param);
+  for(cont=startcont->GetFirstSubCont(); cont!=0; cont=cont->GetNext())
+    AddParams(srv, cont);
+}
+
+TEST(HC, ProxyForwarding)
+{
+  Board* board;
+  LoopDevice* bdev;
+  LoopDevice* ldev;
+  HCContainer* atopcont;
+  LoopDevice* adev;
+  HCServer* asrv;
+  HCConnection* conn;
+  HCContainer* ctopcont;
+  LoopDevice* cdev;
+  HCClient* acli;
+  uint8_t buf[Board::LOG_SIZE];
+  uint16_t len;
+  uint32_t u32val;
+  uint32_t xacts;
+  string sval;
+
+  //Create downstream board and aggregating server with connection to it
+  bdev = new LoopDevice();
+  board = new Board(bdev, "Down", 7);
+  adev = new LoopDevice();
+  atopcont = new HCContainer("");
+  asrv = new HCServer(adev, atopcont, "Up", __DATE__ " " __TIME__);
+  ldev = new LoopDevice(bdev);
+  conn = new HCConnection(ldev, atopcont, "down", 100);
+  ASSERT_TRUE(conn->IsConnected());
+  AddParams(asrv, conn->GetCont());
+  asrv->Start();
+
+  //Create client of aggregating server
+  cdev = new LoopDevice(adev);
+  ctopcont = new HCContainer("");
+  acli = new HCClient(cdev, ctopcont, 1000);
+
+  //Check connection parameters got first PIDs after special ones in order added to board
+  ASSERT_EQ("val", asrv->GetParam(4)->GetName());
+  ASSERT_EQ("log", asrv->GetParam(7)->GetName());
+
+  //Check get, set, read and write are forwarded to board under downstream PIDs
+  ASSERT_EQ(ERR_NONE, acli->Get(4, u32val));
+  ASSERT_EQ((uint32_t)7, u32val);
+  ASSERT_EQ(ERR_NONE, acli->Set(4, (uint32_t)9));
+  ASSERT_EQ(ERR_NONE, board->GetVal(u32val));
+  ASSERT_EQ((uint32_t)9, u32val);
+  ASSERT_EQ(ERR_NONE, acli->Set(5, string("relabelled")));
+  ASSERT_EQ(ERR_NONE, acli->Get(5, sval));
+  ASSERT_EQ("relabelled", sval);
+  ASSERT_EQ(ERR_NONE, acli->Write(7, 4, (uint8_t*)"abcd", 4));
+  ASSERT_EQ(ERR_NONE, acli->Read(7, 4, buf, 4, len));
+  ASSERT_EQ((uint16_t)4, len);
+  ASSERT_EQ(0, memcmp(buf, "abcd", 4));
+  ASSERT_EQ(ERR_NONE, acli->Call(6));
+  ASSERT_EQ((uint32_t)1, board->GetResets());
+
+  //Check cells are passed through undecoded (type checked by board, not aggregating server)
+  ASSERT_EQ(ERR_TYPE, acli->Get(4, sval));
+
+  //Check every transaction was forwarded (reads may be sent again if the reply is slow) without error
+  ASSERT_EQ(ERR_NONE, asrv->GetFwdXactCount(xacts));
+  ASSERT_GE(xacts, (uint32_t)8);
+  ASSERT_EQ(ERR_NONE, asrv->GetFwdErrCount(u32val));
+  ASSERT_EQ((uint32_t)0, u32val);
+
+  //Check write forwarded once more (writes are never sent again)
+  ASSERT_EQ(ERR_NONE, acli->Set(4, (uint32_t)10));
+  ASSERT_EQ(ERR_NONE, asrv->GetFwdXactCount(u32val));
+  ASSERT_EQ(xacts + 1, u32val);
+
+  //Check board timing out gets error reply from aggregating server
+  ldev->SetLoss(LoopDevice::RATE_SCALE);
+  ASSERT_EQ(ERR_TIMEOUT, acli->Set(4, (uint32_t)11));
+  ASSERT_EQ(ERR_NONE, asrv->GetFwdErrCount(u32val));
+  ASSERT_EQ((uint32_t)1, u32val);
+  ASSERT_EQ(ERR_TIMEOUT, acli->Write(7, 0, (uint8_t*)"wxyz", 4));
+  ASSERT_EQ(ERR_NONE, asrv->GetFwdErrCount(u32val));
+  ASSERT_EQ((uint32_t)2, u32val);
+  ASSERT_EQ(ERR_NONE, asrv->GetFwdXactCount(u32val));
+  ASSERT_EQ(xacts + 1, u32val);
+
+  //Check forwarding recovers once board answers again
+  ldev->SetLoss(0);
+  ASSERT_EQ(ERR_NONE, acli->Get(4, u32val));
+  ASSERT_EQ((uint32_t)11, u32val);
+
+  //Cleanup
+  delete acli;
+  delete ctopcont;
+  delete cdev;
+  delete asrv;
+  delete conn;
+  delete atopcont;
+  delete adev;
+  delete board;
+}
+
+static void WriteAggregatorConfig(const char* filename)
+{
+  FILE* fp;
+
+  //Write aggregator configuration (late connection listed between two live ones, fewer connect threads than connections)
+  fp = fopen(filename, "w");
+  fputs("<server>\n"
+        "  <name>Agg</name>\n"
+        "  <port>1520</port>\n"
+        "  <maxparallel>2</maxparallel>\n"
+        "  <retryperiod>200</retryperiod>\n"
+        "  <workers>1</workers>\n", fp);
+  fputs("  <conn>\n"
+        "    <name>d0</name>\n"
+        "    <timeout>100</timeout>\n"
+        "    <udpsocket><port>0</port><destipaddr>127.0.0.1</destipaddr><destport>1521</destport></udpsocket>\n"
+        "  </conn>\n", fp);
+  fputs("  <conn>\n"
+        "    <name>d1</name>\n"
+        "    <timeout>100</timeout>\n"
+        "    <udpsocket><port>0</port><destipaddr>127.0.0.1</destipaddr><destport>1522</destport></udpsocket>\n"
+        "  </conn>\n", fp);
+  fputs("  <conn>\n"
+        "    <name>d2</name>\n"
+        "    <timeout>100</timeout>\n"
+        "    <udpsocket><port>0</port><destipaddr>127.0.0.1</destipaddr><destport>1523</destport></udpsocket>\n"
+        "  </conn>\n"
+        "</server>\n", fp);
+  fclose(fp);
+}
+
+TEST(HC, AggregatorLateConnection)
+{
+  static const uint32_t MAX_RESULTS = 16;
+  Board* board0;
+  Board* board1;
+  Board* board2;
+  HCAggregator* agg;
+  UDPDevice* cdev;
+  HCContainer* ctopcont;
+  HCClient* acli;
+  uint32_t pids0[MAX_RESULTS];
+  uint32_t pids2[MAX_RESULTS];
+  uint32_t pids[MAX_RESULTS];
+  string vals[MAX_RESULTS];
+  int errs[MAX_RESULTS];
+  uint32_t count0;
+  uint32_t count2;
+  uint32_t count;
+  uint32_t pidtop;
+  uint32_t crc;
+  uint32_t u32val;
+  uint32_t i;
+
+  //Create two boards, leaving the one for the middle connection down
+  board0 = new Board(new UDPDevice(1521), "Board0", 10);
+  board2 = new Board(new UDPDevice(1523), "Board2", 30);
+
+  //Create aggregator and client of it
+  WriteAggregatorConfig(".aggregator-Agg.xml");
+  agg = new HCAggregator(".aggregator-Agg.xml");
+  cdev = new UDPDevice(0, 0, "127.0.0.1", 1520);
+  ctopcont = new HCContainer("");
+  acli = new HCClient(cdev, ctopcont, 1000);
+
+  //Check live connections were attached and the down one was not
+  ASSERT_EQ(ERR_NONE, acli->QueryGet("/d0/*", pids0, vals, errs, MAX_RESULTS, count0));
+  ASSERT_EQ((uint32_t)5, count0);
+  ASSERT_EQ(ERR_NONE, acli->QueryGet("/d2/*", pids2, vals, errs, MAX_RESULTS, count2));
+  ASSERT_EQ((uint32_t)5, count2);
+  ASSERT_EQ(ERR_NONE, acli->QueryGet("/d1/*", pids, vals, errs, MAX_RESULTS, count));
+  ASSERT_EQ((uint32_t)0, count);
+  ASSERT_EQ(ERR_NONE, acli->Get(HCServer::PID_INFOFILECRC, crc));
+
+  //Check connections were attached in configuration order whichever connected first
+  ASSERT_LT(pids0[count0 - 1], pids2[0]);
+  pidtop = pids2[count2 - 1];
+
+  //Bring late board up and wait for it to be retried and grafted in
+  board1 = new Board(new UDPDevice(1522), "Board1", 20);
+  for(i=0; i<50; i++)
+  {
+    ASSERT_EQ(ERR_NONE, acli->QueryGet("/d1/*", pids, vals, errs, MAX_RESULTS, count));
+    if(count != 0)
+      break;
+    ThreadSleep(100);
+  }
+  ASSERT_EQ((uint32_t)5, count);
+
+  //Check late parameters got new PIDs past existing ones and are reachable
+  for(i=0; i<count; i++)
+    ASSERT_GT(pids[i], pidtop);
+  ASSERT_EQ(ERR_NONE, acli->Get(pids[0], u32val));
+  ASSERT_EQ((uint32_t)20, u32val);
+
+  //Check PIDs of other connections did not move
+  ASSERT_EQ(ERR_NONE, acli->QueryGet("/d0/*", pids, vals, errs, MAX_RESULTS, count));
+  ASSERT_EQ(count0, count);
+  for(i=0; i<count; i++)
+    ASSERT_EQ(pids0[i], pids[i]);
+  ASSERT_EQ(ERR_NONE, acli->QueryGet("/d2/*", pids, vals, errs, MAX_RESULTS, count));
+  ASSERT_EQ(count2, count);
+  for(i=0; i<count; i++)
+    ASSERT_EQ(pids2[i], pids[i]);
+  ASSERT_EQ(ERR_NONE, acli->Get(pids2[0], u32val));
+  ASSERT_EQ((uint32_t)30, u32val);
+
+  //Check server information file was regenerated with grafted parameters
+  ASSERT_EQ(ERR_NONE, acli->Get(HCServer::PID_INFOFILECRC, u32val));
+  ASSERT_NE(crc, u32val);
+
+  //Cleanup
+  delete acli;
+  delete ctopcont;
+  delete cdev;
+  delete agg;
+  delete board0;
+  delete board1;
+  delete board2;
+}
+
+TEST(HC, WidePIDs)
+{
+  CallCounter padcounter;
+  CallCounter counter;
+  HCParameter* pad;
+  HCContainer* wtopcont;
+  LoopDevice* wdev;
+  HCServer* wsrv;
+  HCContainer* pcont;
+  HCConnection* conn;
+  HCClient* wcli;
+  LoopDevice* ndev;
+  HCContainer* ntopcont;
+  HCClient* ncli;
+  FILE* fp;
+  char line[256];
+  bool found;
+  uint32_t i;
+  string sval;
+
+  //Create server allowing wide PIDs and fill narrow PID range with one padding call outside the tree
+  wdev = new LoopDevice();
+  wtopcont = new HCContainer("");
+  wsrv = new HCServer(wdev, wtopcont, "Wide", __DATE__ " " __TIME__, HCServer::PID_MAX_WIDE);
+  pad = new HCCall<CallCounter>("pad", &padcounter, &CallCounter::Call);
+  for(i=0; i<=0xFFFF; i++)
+    wsrv->Add(pad);
+
+  //Add call beyond narrow PID range (after special parameters and padding) and start server
+  HCAdd(new HCCall<CallCounter>("call", &counter, &CallCounter::Call), wtopcont, wsrv);
+  wsrv->Start();
+
+  //Check server information file advertises wide PIDs
+  found = false;
+  ASSERT_NE((FILE*)0, (fp = fopen(".server-Wide.xml", "r")));
+  while(fgets(line, sizeof(line), fp) != 0)
+    if(strstr(line, "<pidwidth>32</pidwidth>") != 0)
+      found = true;
+  fclose(fp);
+  ASSERT_TRUE(found);
+
+  //Check connection negotiates wide PIDs and reaches parameter above 0xFFFF
+  pcont = new HCContainer("");
+  conn = new HCConnection(new LoopDevice(wdev), pcont, "wide", 500);
+  ASSERT_TRUE(conn->IsConnected());
+  wcli = conn->GetClient();
+  ASSERT_TRUE(wcli->GetWidePID());
+  ASSERT_EQ(ERR_NONE, wcli->Call(0x10004));
+  ASSERT_EQ((uint32_t)1, counter.GetCount());
+  ASSERT_EQ(ERR_NONE, wcli->Get(HCServer::PID_NAME, sval));
+  ASSERT_EQ("Wide", sval);
+
+  //Check narrow client still reaches narrow PIDs of wide server but cannot address wide ones
+  ndev = new LoopDevice(wdev);
+  ntopcont = new HCContainer("");
+  ncli = new HCClient(ndev, ntopcont, 200);
+  ASSERT_FALSE(ncli->GetWidePID());
+  ASSERT_EQ(ERR_NONE, ncli->Get(HCServer::PID_NAME, sval));
+  ASSERT_EQ("Wide", sval);
+  ASSERT_EQ(ERR_NONE, ncli->Call(0xFFFF));
+  ASSERT_EQ((uint32_t)1, padcounter.GetCount());
+  ASSERT_NE(ERR_NONE, ncli->Call(0x10004));
+  ASSERT_EQ((uint32_t)1, counter.GetCount());
+
+  //Cleanup
+  delete ncli;
+  delete ntopcont;
+  delete ndev;
+  delete conn;
+  delete pcont;
+  delete wsrv;
+  delete wtopcont;
+  delete wdev;
+  delete pad;
+}
+
+TEST(HC, QueryFanOut)
+{
+  static const uint32_t MAX_RESULTS = 16;
+  static const char* NAMES[] = {"val", "label", "reset", "log", "hist"};
+  Board* boards[2];
+  LoopDevice* bdevs[2];
+  HCConnection* conns[2];
+  HCContainer* atopcont;
+  LoopDevice* adev;
+  HCServer* asrv;
+  HCContainer* ctopcont;
+  LoopDevice* cdev;
+  HCClient* acli;
+  uint32_t pids[MAX_RESULTS];
+  string vals[MAX_RESULTS];
+  int errs[MAX_RESULTS];
+  uint32_t count;
+  uint32_t xacts;
+  uint32_t u32val;
+  uint32_t i;
+  uint32_t j;
+
+  //Create aggregating server with connections to two downstream boards, each with label too long for both to share a reply
+  atopcont = new HCContainer("");
+  adev = new LoopDevice();
+  asrv = new HCServer(adev, atopcont, "Query", __DATE__ " " __TIME__);
+  for(i=0; i<2; i++)
+  {
+    bdevs[i] = new LoopDevice();
+    boards[i] = new Board(bdevs[i], "Query" + to_string(i), 10 * (i + 1));
+    boards[i]->SetLabel(string(700, 'a' + i));
+    conns[i] = new HCConnection(new LoopDevice(bdevs[i]), atopcont, "d" + to_string(i), 500);
+    ASSERT_TRUE(conns[i]->IsConnected());
+    AddParams(asrv, conns[i]->GetCont());
+  }
+  asrv->Start();
+
+  //Create client of aggregating server
+  cdev = new LoopDevice(adev);
+  ctopcont = new HCContainer("");
+  acli = new HCClient(cdev, ctopcont, 1000);
+
+  //Query parameters of both boards at once (results continue over more than one reply)
+  ASSERT_EQ(ERR_NONE, conns[0]->GetClient()->GetGoodXactCount(xacts));
+  ASSERT_EQ(ERR_NONE, acli->QueryGet("/d*/*", pids, vals, errs, MAX_RESULTS, count));
+  ASSERT_EQ((uint32_t)10, count);
+
+  //Check matched parameters and their values (calls, files and tables have no single value)
+  for(i=0; i<2; i++)
+  {
+    for(j=0; j<5; j++)
+      ASSERT_EQ(NAMES[j], asrv->GetParam(pids[i * 5 + j])->GetName());
+    ASSERT_EQ(ERR_NONE, errs[i * 5]);
+    ASSERT_EQ(to_string(10 * (i + 1)), vals[i * 5]);
+    ASSERT_EQ(ERR_NONE, errs[i * 5 + 1]);
+    ASSERT_NE(string::npos, vals[i * 5 + 1].find(string(700, 'a' + i)));
+    ASSERT_EQ(ERR_TYPE, errs[i * 5 + 2]);
+    ASSERT_EQ(ERR_TYPE, errs[i * 5 + 3]);
+    ASSERT_EQ(ERR_TYPE, errs[i * 5 + 4]);
+  }
+
+  //Check continuation reused first result instead of getting values from boards again
+  ASSERT_EQ(ERR_NONE, conns[0]->GetClient()->GetGoodXactCount(u32val));
+  ASSERT_EQ(xacts + 1, u32val);
+
+  //Check query matching nothing
+  ASSERT_EQ(ERR_NONE, acli->QueryGet("/d9/*", pids, vals, errs, MAX_RESULTS, count));
+  ASSERT_EQ((uint32_t)0, count);
+
+  //Cleanup
+  delete acli;
+  delete ctopcont;
+  delete cdev;
+  delete asrv;
+  for(i=0; i<2; i++)
+    delete conns[i];
+  delete atopcont;
+  delete adev;
+  for(i=0; i<2; i++)
+    delete boards[i];
+}
+
+TEST(HC, ReplicaFailover)
+{
+  static const char* NAMES[] = {"Replica", "Replica", "Imposter"};
+  Board* boards[3];
+  LoopDevice* bdevs[3];
+  LoopDevice* rdevs[3];
+  HCContainer* pcont;
+  HCConnection* conn;
+  HCClient* rcli;
+  bool seen[3];
+  uint32_t u32val;
+  uint32_t i;
+
+  //Create two equivalent boards and one serving a different server information file, each with its own value
+  for(i=0; i<3; i++)
+  {
+    bdevs[i] = new LoopDevice();
+    boards[i] = new Board(bdevs[i], NAMES[i], i);
+    rdevs[i] = new LoopDevice(bdevs[i]);
+  }
+
+  //Connect to all three as replicas of one server
+  pcont = new HCContainer("");
+  conn = new HCConnection(rdevs[0], pcont, "replica", 300, "", false);
+  conn->AddReplica(rdevs[1]);
+  conn->AddReplica(rdevs[2]);
+  conn->SetHoldoff(200);
+  ASSERT_TRUE(conn->Connect());
+  rcli = conn->GetClient();
+  ASSERT_EQ((uint32_t)3, rcli->GetReplicaCount());
+
+  //Check reads are spread over equivalent replicas and never reach replica with different information file
+  seen[0] = seen[1] = seen[2] = false;
+  for(i=0; i<20; i++)
+  {
+    ASSERT_EQ(ERR_NONE, rcli->Get(4, u32val));
+    ASSERT_LT(u32val, (uint32_t)3);
+    seen[u32val] = true;
+  }
+  ASSERT_TRUE(seen[0]);
+  ASSERT_TRUE(seen[1]);
+  ASSERT_FALSE(seen[2]);
+
+  //Check writes go to primary only
+  ASSERT_EQ(ERR_NONE, rcli->Set(4, (uint32_t)0));
+  ASSERT_EQ(ERR_NONE, boards[1]->GetVal(u32val));
+  ASSERT_EQ((uint32_t)1, u32val);
+
+  //Drop every reply from second replica and check reads still succeed by failing over to primary
+  rdevs[1]->SetLoss(LoopDevice::RATE_SCALE);
+  for(i=0; i<10; i++)
+  {
+    ASSERT_EQ(ERR_NONE, rcli->Get(4, u32val));
+    ASSERT_EQ((uint32_t)0, u32val);
+  }
+  ASSERT_EQ(ERR_NONE, rcli->GetFailoverCount(u32val));
+  ASSERT_GE(u32val, (uint32_t)1);
+
+  //Check writes still go to primary while second replica is down
+  ASSERT_EQ(ERR_NONE, rcli->Set(4, (uint32_t)10));
+  ASSERT_EQ(ERR_NONE, boards[0]->GetVal(u32val));
+  ASSERT_EQ((uint32_t)10, u32val);
+  ASSERT_EQ(ERR_NONE, boards[1]->GetVal(u32val));
+  ASSERT_EQ((uint32_t)1, u32val);
+
+  //Restore second replica and check reads reach it again once holdoff expires
+  rdevs[1]->SetLoss(0);
+  ThreadSleep(300);
+  seen[0] = seen[1] = false;
+  for(i=0; i<20; i++)
+  {
+    ASSERT_EQ(ERR_NONE, rcli->Get(4, u32val));
+    seen[(u32val == 10) ? 0 : 1] = true;
+  }
+  ASSERT_TRUE(seen[0]);
+  ASSERT_TRUE(seen[1]);
+
+  //Cleanup
+  delete conn;
+  delete pcont;
+  for(i=0; i<3; i++)
+    delete boards[i];
+}
+
+TEST(HC, SPSCPipe)
+{
+  SPSCPipe* pipe;
+  LoopDevice* dev0;
+  SLIPFramer* framer;
+  const uint8_t* data;
+  uint8_t* space;
+  uint8_t frames[32];
+  uint8_t buf[8];
+  uint32_t len;
+
+  //Check empty pipe does not block when not waiting
+  pipe = new SPSCPipe(8);
+  ASSERT_EQ((uint32_t)0, pipe->Read(buf, sizeof(buf), WAIT_NONE));
+  ASSERT_EQ((uint32_t)0, pipe->Peek(data, WAIT_NONE));
+
+  //Check write wraps around the ring and reads back in order
+  ASSERT_EQ((uint32_t)6, pipe->Write("abcdef", 6, WAIT_NONE));
+  ASSERT_EQ((uint32_t)4, pipe->Read(buf, 4, WAIT_NONE));
+  ASSERT_EQ((uint32_t)5, pipe->Write("ghijk", 5, WAIT_NONE));
+  ASSERT_EQ((uint32_t)0, pipe->Write("lm", 2, 10));
+  ASSERT_EQ((uint32_t)7, pipe->Read(buf, sizeof(buf), WAIT_NONE));
+  ASSERT_EQ(0, memcmp(buf, "efghijk", 7));
+
+  //Check reserve and peek only hand out contiguous bytes up to end of ring
+  ASSERT_EQ((uint32_t)5, pipe->Reserve(space, WAIT_NONE));
+  memcpy(space, "mno", 3);
+  pipe->Commit(3);
+  ASSERT_EQ((uint32_t)3, pipe->GetCount());
+  ASSERT_EQ((uint32_t)3, pipe->Peek(data, WAIT_NONE));
+  ASSERT_EQ(0, memcmp(data, "mno", 3));
+  pipe->Consume(2);
+  ASSERT_EQ((uint32_t)1, pipe->Peek(data, WAIT_NONE));
+  ASSERT_EQ('o', data[0]);
+  pipe->Consume(1);
+  delete pipe;
+
+  //Check framer parses two frames delivered in one lower device read
+  dev0 = new LoopDevice();
+  framer = new SLIPFramer(new LoopDevice(dev0), sizeof(buf));
+  len = SLIPFramer::Encode("pq", 2, frames);
+  len += SLIPFramer::Encode("\xC0r", 2, &frames[len]);
+  ASSERT_EQ(len, dev0->Write(frames, len));
+  ASSERT_EQ(ERR_NONE, framer->WaitReadable(100));
+  ASSERT_EQ((uint32_t)2, framer->Read(buf, sizeof(buf)));
+  ASSERT_EQ(0, memcmp(buf, "pq", 2));
+  ASSERT_EQ(ERR_NONE, framer->WaitReadable(0));
+  ASSERT_EQ((uint32_t)2, framer->Read(buf, sizeof(buf)));
+  ASSERT_EQ(0, memcmp(buf, "\xC0r", 2));
+
+  //Cleanup
+  delete framer;
+  delete dev0;
+}
+
+template <class Q>
+class QueueProducer
+{
+public:
+  static const uint32_t ITEM_COUNT = 20000;
+
+public:
+  QueueProducer(Q* queue)
+  {
+    //Create thread writing numbered items to queue
+    _queue = queue;
+    _thread = new Thread<QueueProducer<Q> >(this, &QueueProducer<Q>::Run);
+  }
+
+  ~QueueProducer()
+  {
+    //Cleanup
+    delete _thread;
+  }
+
+  void Start(void)
+  {
+    _thread->Start();
+  }
+
+  void Join(void)
+  {
+    _thread->Join();
+  }
+
+private:
+  void Run(void)
+  {
+    uint32_t i;
+
+    //Write items in order, waiting for room as needed
+    for(i=0; i<ITEM_COUNT; i++)
+      _queue->Write(&i, sizeof(i), WAIT_INF);
+  }
+
+private:
+  Q* _queue;
+  Thread<QueueProducer<Q> >* _thread;
+};
+
+template <class Q>
+static void CheckQueue(Q* queue)
+{
+  QueueProducer<Q>* producer;
+  uint8_t big[16];
+  uint32_t item;
+  uint64_t start;
+  uint32_t i;
+
+  //Check empty queue does not block when not waiting and timed read gives up after about its timeout
+  ASSERT_EQ((uint32_t)0, queue->Read(&item, sizeof(item), WAIT_NONE));
+  start = ThreadTimeUS();
+  ASSERT_EQ((uint32_t)0, queue->Read(&item, sizeof(item), 50));
+  ASSERT_GE(ThreadTimeUS() - start, (uint64_t)45000);
+  ASSERT_LT(ThreadTimeUS() - start, (uint64_t)1000000);
+
+  //Check item larger than buffer size is dropped
+  memset(big, 0, sizeof(big));
+  ASSERT_EQ((uint32_t)0, queue->Write(big, sizeof(big), WAIT_NONE));
+
+  //Check full queue rejects write when not waiting and reads back what fit
+  for(i=0; i<4; i++)
+    ASSERT_EQ((uint32_t)sizeof(i), queue->Write(&i, sizeof(i), WAIT_NONE));
+  ASSERT_EQ((uint32_t)0, queue->Write(&i, sizeof(i), WAIT_NONE));
+  for(i=0; i<4; i++)
+  {
+    ASSERT_EQ((uint32_t)sizeof(item), queue->Read(&item, sizeof(item), WAIT_NONE));
+    ASSERT_EQ(i, item);
+  }
+  ASSERT_EQ((uint32_t)0, queue->Read(&item, sizeof(item), WAIT_NONE));
+
+  //Check items keep their order as the buffers wrap around with writer and reader on separate threads
+  producer = new QueueProducer<Q>(queue);
+  producer->Start();
+  for(i=0; i<QueueProducer<Q>::ITEM_COUNT; i++)
+  {
+    ASSERT_EQ((uint32_t)sizeof(item), queue->Read(&item, sizeof(item), 1000));
+    ASSERT_EQ(i, item);
+  }
+  producer->Join();
+  delete producer;
+}
+
+TEST(HC, Queues)
+{
+  Queue* queue;
+  SPSCQueue* spscqueue;
+
+  //Check locked and single producer single consumer queues of four 8 byte buffers
+  queue = new Queue(4, 8);
+  CheckQueue(queue);
+  delete queue;
+  spscqueue = new SPSCQueue(4, 8);
+  CheckQueue(spscqueue);
+  delete spscqueue;
+}
+
+TEST(HC, EventSemaphore)
+{
+  Event* evt;
+  Semaphore* sem;
+  uint64_t start;
+
+  //Check event signal is taken once and timeout is honored
+  evt = new Event();
+  ASSERT_EQ(ERR_UNSPEC, evt->Wait(WAIT_NONE));
+  ASSERT_EQ(ERR_NONE, evt->Signal());
+  ASSERT_EQ(ERR_NONE, evt->Signal());
+  ASSERT_EQ(ERR_NONE, evt->Wait(WAIT_NONE));
+  start = ThreadTimeUS();
+  ASSERT_EQ(ERR_TIMEOUT, evt->Wait(20));
+  ASSERT_GE(ThreadTimeUS() - start, (uint64_t)20000);
+  delete evt;
+
+  //Check initially signalled event comes back signalled on reset
+  evt = new Event(true);
+  ASSERT_EQ(ERR_NONE, evt->Wait(WAIT_NONE));
+  ASSERT_EQ(ERR_NONE, evt->Reset());
+  ASSERT_EQ(ERR_NONE, evt->Wait(WAIT_NONE));
+  delete evt;
+
+  //Check semaphore counts gives and times out when empty
+  sem = new Semaphore(1);
+  ASSERT_EQ(ERR_NONE, sem->Give());
+  ASSERT_EQ(ERR_NONE, sem->Wait(WAIT_NONE));
+  ASSERT_EQ(ERR_NONE, sem->Wait(10));
+  ASSERT_EQ(ERR_UNSPEC, sem->Wait(WAIT_NONE));
+  ASSERT_EQ(ERR_TIMEOUT, sem->Wait(10));
+  ASSERT_EQ(ERR_NONE, sem->Reset());
+  ASSERT_EQ(ERR_NONE, sem->Wait(WAIT_NONE));
+  delete sem;
+}
+
+static uint32_t ThreadCount(void)
+{
+  FILE* file;
+  char line[64];
+  uint32_t count;
+
+  //Get number of threads in this process from its status file
+  count = 0;
+  if((file = fopen("/proc/self/status", "r")) == NULL)
+    return 0;
+  while(fgets(line, sizeof(line), file) != NULL)
+    if(sscanf(line, "Threads: %u", &count) == 1)
+      break;
+  fclose(file);
+
+  return count;
+}
+
+class ExecutorProbe : public ExecutorTask
+{
+public:
+  ExecutorProbe(uint32_t* runs, uint32_t* peak)
+  {
+    //Remember where to count runs and most threads seen
+    _runs = runs;
+    _peak = peak;
+  }
+
+  virtual void Run(void)
+  {
+    uint32_t count;
+    uint32_t peak;
+
+    //Stand in for a blocking downstream transaction
+    ThreadSleep(10);
+
+    //Record most threads alive while work is in flight
+    count = ThreadCount();
+    peak = __atomic_load_n(_peak, __ATOMIC_RELAXED);
+    while((count > peak) && !__atomic_compare_exchange_n(_peak, &peak, count, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    __atomic_add_fetch(_runs, 1, __ATOMIC_RELAXED);
+  }
+
+private:
+  uint32_t* _runs;
+  uint32_t* _peak;
+};
+
+TEST(HC, ExecutorThreadCount)
+{
+  Executor* exec;
+  ExecutorProbe* probes[30];
+  uint32_t base;
+  uint32_t runs;
+  uint32_t peak;
+  uint32_t u32val;
+  uint32_t i;
+
+  //Create executor with one worker per core
+  base = ThreadCount();
+  exec = new Executor();
+  ASSERT_EQ(ThreadNumProcsOnline(), exec->GetWorkerCount());
+  ASSERT_EQ(base + exec->GetWorkerCount(), ThreadCount());
+
+  //Run work for thirty connections at once and check it never needs more than the workers
+  runs = 0;
+  peak = 0;
+  for(i=0; i<30; i++)
+  {
+    probes[i] = new ExecutorProbe(&runs, &peak);
+    ASSERT_EQ(ERR_NONE, exec->Submit(probes[i]));
+  }
+  for(i=0; i<30; i++)
+    ASSERT_EQ(ERR_NONE, probes[i]->Wait(5000));
+  ASSERT_EQ((uint32_t)30, runs);
+  ASSERT_EQ(base + exec->GetWorkerCount(), peak);
+
+  //Check shutdown finishes queued work then refuses more
+  for(i=0; i<30; i++)
+    ASSERT_EQ(ERR_NONE, exec->Submit(probes[i]));
+  exec->Shutdown();
+  ASSERT_EQ((uint32_t)60, runs);
+  ASSERT_EQ(ERR_NONE, exec->GetRunCount(u32val));
+  ASSERT_EQ((uint32_t)60, u32val);
+  ASSERT_EQ(ERR_INVALID, exec->Submit(probes[0]));
+  ASSERT_EQ(base, ThreadCount());
+
+  //Cleanup
+  for(i=0; i<30; i++)
+    delete probes[i];
+  delete exec;
+}
+
+class TimerProbe : public TimerTask
+{
+public:
+  TimerProbe()
+  {
+    //Not fired yet
+    _runs = 0;
+    _last = 0;
+  }
+
+  virtual void Run(void)
+  {
+    //Record expiry
+    __atomic_store_n(&_last, ThreadTimeUS(), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&_runs, 1, __ATOMIC_RELAXED);
+  }
+
+  uint32_t GetRuns(void)
+  {
+    return __atomic_load_n(&_runs, __ATOMIC_RELAXED);
+  }
+
+  uint64_t GetLast(void)
+  {
+    return __atomic_load_n(&_last, __ATOMIC_RELAXED);
+  }
+
+private:
+  uint32_t _runs;
+  uint64_t _last;
+};
+
+TEST(HC, TimerWheel)
+{
+  TimerWheel* wheel;
+  TimerProbe* oneshot;
+  TimerProbe* periodic;
+  TimerProbe* cancelled;
+  TimerProbe* distant;
+  uint64_t start;
+  uint32_t u32val;
+
+  //Schedule one-shot, periodic, soon to be cancelled and distant (upper level) timers on a one millisecond wheel
+  wheel = new TimerWheel(1000);
+  oneshot = new TimerProbe();
+  periodic = new TimerProbe();
+  cancelled = new TimerProbe();
+  distant = new TimerProbe();
+  start = ThreadTimeUS();
+  ASSERT_EQ(ERR_NONE, wheel->Schedule(oneshot, 20000));
+  ASSERT_EQ(ERR_NONE, wheel->Schedule(periodic, 10000, 10000));
+  ASSERT_EQ(ERR_NONE, wheel->Schedule(cancelled, 30000));
+  ASSERT_EQ(ERR_NONE, wheel->Schedule(distant, 100000000));
+  ASSERT_TRUE(distant->IsScheduled());
+  ASSERT_EQ(ERR_NONE, wheel->GetActiveCount(u32val));
+  ASSERT_EQ((uint32_t)4, u32val);
+
+  //Cancel one before it fires (second cancel finds nothing to do)
+  ASSERT_EQ(ERR_NONE, wheel->Cancel(cancelled));
+  ASSERT_EQ(ERR_INVALID, wheel->Cancel(cancelled));
+
+  //Let periodic timer run about ten times
+  ThreadSleep(105);
+  ASSERT_EQ(ERR_NONE, wheel->Cancel(periodic));
+  ASSERT_EQ(ERR_NONE, periodic->Wait(1000));
+
+  //Check one-shot fired once and not early, periodic kept going and cancelled never fired
+  ASSERT_EQ((uint32_t)1, oneshot->GetRuns());
+  ASSERT_GE(oneshot->GetLast() - start, (uint64_t)20000);
+  ASSERT_FALSE(oneshot->IsScheduled());
+  ASSERT_GE(periodic->GetRuns(), (uint32_t)5);
+  ASSERT_LE(periodic->GetRuns(), (uint32_t)11);
+  ASSERT_EQ((uint32_t)0, cancelled->GetRuns());
+  ASSERT_EQ((uint32_t)0, distant->GetRuns());
+
+  //Check counters
+  ASSERT_EQ(ERR_NONE, wheel->GetActiveCount(u32val));
+  ASSERT_EQ((uint32_t)1, u32val);
+  ASSERT_EQ(ERR_NONE, wheel->GetScheduleCount(u32val));
+  ASSERT_EQ((uint32_t)4, u32val);
+  ASSERT_EQ(ERR_NONE, wheel->GetCancelCount(u32val));
+  ASSERT_EQ((uint32_t)2, u32val);
+  ASSERT_EQ(ERR_NONE, wheel->GetExpireCount(u32val));
+  ASSERT_EQ(1 + periodic->GetRuns(), u32val);
+
+  //Cleanup
+  ASSERT_EQ(ERR_NONE, wheel->Cancel(distant));
+  delete wheel;
+  delete distant;
+  delete cancelled;
+  delete periodic;
+  delete oneshot;
+}
+
+class ConcurrentPeer
+{
+public:
+  ConcurrentPeer(Device* dev, const string& srvname)
+  {
+    //Create client over its own device (peer owns device)
+    _cont = new HCContainer("");
+    _dev = dev;
+    _srvname = srvname;
+    _cli = new HCClient(_dev, _cont, 1000);
+    _goodcount = 0;
+    _thread = new Thread<ConcurrentPeer>(this, &ConcurrentPeer::Run);
+  }
+
+  ~ConcurrentPeer()
+  {
+    //Cleanup
+    delete _thread;
+    delete _cli;
+    delete _dev;
+    delete _cont;
+  }
+
+  int Get(void)
+  {
+    string sval;
+    int err;
+
+    //Get server name and check for expected value
+    if((err = _cli->Get(HCServer::PID_NAME, sval)) == ERR_NONE)
+      if(sval != _srvname)
+        err = ERR_UNSPEC;
+
+    return err;
+  }
+
+  void Start(void)
+  {
+    _thread->Start();
+  }
+
+  void Join(void)
+  {
+    _thread->Join();
+  }
+
+  uint32_t GetGoodCount(void)
+  {
+    return _goodcount;
+  }
+
+private:
+  void Run(void)
+  {
+    uint32_t i;
+
+    //Perform transactions concurrently with all other peers
+    for(i=0; i<XACT_COUNT; i++)
+      if(Get() == ERR_NONE)
+        _goodcount++;
+  }
+
+public:
+  static const uint32_t XACT_COUNT = 20;
+
+private:
+  HCContainer* _cont;
+  Device* _dev;
+  string _srvname;
+  HCClient* _cli;
+  uint32_t _goodcount;
+  Thread<ConcurrentPeer>* _thread;
+};
+
+const uint32_t ConcurrentPeer::XACT_COUNT;
+
+TEST(HC, ReactorConcurrentClients)
+{
+  static const uint32_t PEER_COUNT = 500;
+  TCPReactor* rdev;
+  HCContainer* rtopcont;
+  HCServer* rsrv;
+  ConcurrentPeer* peers[PEER_COUNT];
+  uint32_t i;
+
+  //Create server on reactor device
+  rdev = new TCPReactor(1510, 2000 + 2);
+  rtopcont = new HCContainer("");
+  rsrv = new HCServer(rdev, rtopcont, "Reactor", __DATE__ " " __TIME__);
+  rsrv->Start();
+
+  //Connect all peers and leave their connections open
+  for(i=0; i<PEER_COUNT; i++)
+  {
+    peers[i] = new ConcurrentPeer(new SLIPFramer(new TCPClient(0, "127.0.0.1", 1510), 2000 + 2), "Reactor");
+    ASSERT_EQ(ERR_NONE, peers[i]->Get());
+  }
+
+  //Verify every connection is held concurrently
+  ASSERT_EQ(PEER_COUNT, rdev->GetConnCount());
+
+  //Run transactions from all peers at once and verify each reply reached its requester
+  for(i=0; i<PEER_COUNT; i++)
+    peers[i]->Start();
+
+  for(i=0; i<PEER_COUNT; i++)
+  {
+    peers[i]->Join();
+    ASSERT_EQ(ConcurrentPeer::XACT_COUNT, peers[i]->GetGoodCount());
+  }
+
+  //Cleanup
+  for(i=0; i<PEER_COUNT; i++)
+    delete peers[i];
+
+  delete rsrv;
+  delete rtopcont;
+  delete rdev;
+}
+
+TEST(HC, UDPConcurrentClients)
+{
+  static const uint32_t PEER_COUNT = 100;
+  UDPDevice* udev;
+  HCContainer* utopcont;
+  HCServer* usrv;
+  ConcurrentPeer* peers[PEER_COUNT];
+  uint32_t i;
+
+  //Create server on single UDP port
+  udev = new UDPDevice(1511);
+  utopcont = new HCContainer("");
+  usrv = new HCServer(udev, utopcont, "Shared", __DATE__ " " __TIME__);
+  usrv->Start();
+
+  //Create peers each on its own ephemeral port
+  for(i=0; i<PEER_COUNT; i++)
+    peers[i] = new ConcurrentPeer(new UDPDevice(0, 0, "127.0.0.1", 1511), "Shared");
+
+  //Run transactions from all peers at once and verify each reply reached its requester
+  for(i=0; i<PEER_COUNT; i++)
+    peers[i]->Start();
+
+  for(i=0; i<PEER_COUNT; i++)
+  {
+    peers[i]->Join();
+    ASSERT_EQ(ConcurrentPeer::XACT_COUNT, peers[i]->GetGoodCount());
+  }
+
+  //Cleanup
+  for(i=0; i<PEER_COUNT; i++)
+    delete peers[i];
+
+  delete usrv;
+  delete utopcont;
+  delete udev;
+}
+
+TEST(HC, ShardedUDPClients)
+{
+  static const uint32_t SHARD_COUNT = 3;
+  static const uint32_t PEER_COUNT = 32;
+  Board* board;
+  UDPDevice* sdevs[SHARD_COUNT];
+  ConcurrentPeer* peers[PEER_COUNT];
+  UDPDevice* cdev;
+  HCContainer* ctopcont;
+  HCClient* scli;
+  uint32_t u32val;
+  uint32_t i;
+
+  //Create server and shards all bound to same UDP port (kernel spreads peers over them)
+  board = new Board(new UDPDevice(1512, 0, 0, 0, true), "Sharded", 0);
+  for(i=0; i<SHARD_COUNT; i++)
+  {
+    sdevs[i] = new UDPDevice(1512, 0, 0, 0, true);
+    ASSERT_EQ(ERR_NONE, board->GetServer()->AddShard(sdevs[i]));
+  }
+  ASSERT_EQ(ERR_NONE, board->GetServer()->GetShardCount(u32val));
+  ASSERT_EQ(SHARD_COUNT + 1, u32val);
+
+  //Run transactions from peers each on its own ephemeral port and verify each reply reached its requester
+  for(i=0; i<PEER_COUNT; i++)
+    peers[i] = new ConcurrentPeer(new UDPDevice(0, 0, "127.0.0.1", 1512), "Sharded");
+
+  for(i=0; i<PEER_COUNT; i++)
+    peers[i]->Start();
+
+  for(i=0; i<PEER_COUNT; i++)
+  {
+    peers[i]->Join();
+    ASSERT_EQ(ConcurrentPeer::XACT_COUNT, peers[i]->GetGoodCount());
+  }
+
+  //Check set and get from clients on many ports (whichever shard answers) reach the one shared parameter
+  for(i=0; i<PEER_COUNT; i++)
+  {
+    cdev = new UDPDevice(0, 0, "127.0.0.1", 1512);
+    ctopcont = new HCContainer("");
+    scli = new HCClient(cdev, ctopcont, 1000);
+    ASSERT_EQ(ERR_NONE, scli->Set(4, i));
+    ASSERT_EQ(ERR_NONE, scli->Get(4, u32val));
+    ASSERT_EQ(i, u32val);
+    ASSERT_EQ(ERR_NONE, board->GetVal(u32val));
+    ASSERT_EQ(i, u32val);
+    delete scli;
+    delete ctopcont;
+    delete cdev;
+  }
+
+  //Cleanup
+  for(i=0; i<PEER_COUNT; i++)
+    delete peers[i];
+
+  delete board;
+  for(i=0; i<SHARD_COUNT; i++)
+    delete sdevs[i];
+}
+
+TEST(HC, URingUDPClients)
+{
+  static const uint32_t PEER_COUNT = 16;
+  URingUDPDevice* udev;
+  HCContainer* utopcont;
+  HCServer* usrv;
+  ConcurrentPeer* peers[PEER_COUNT];
+  uint32_t i;
+
+  //Check kernel can do io_uring
+  if(!URingUDPDevice::IsSupported())
+    GTEST_SKIP() << "io_uring unavailable";
+
+  //Create server on io_uring UDP port
+  udev = new URingUDPDevice(1514);
+  utopcont = new HCContainer("");
+  usrv = new HCServer(udev, utopcont, "Ring", __DATE__ " " __TIME__);
+  usrv->Start();
+
+  //Create peers each on its own ephemeral port (half over io_uring, half over plain sockets)
+  for(i=0; i<PEER_COUNT; i++)
+  {
+    if((i % 2) == 0)
+      peers[i] = new ConcurrentPeer(new URingUDPDevice(0, 0, "127.0.0.1", 1514), "Ring");
+    else
+      peers[i] = new ConcurrentPeer(new UDPDevice(0, 0, "127.0.0.1", 1514), "Ring");
+  }
+
+  //Run transactions from all peers at once and verify each reply reached its requester
+  for(i=0; i<PEER_COUNT; i++)
+    peers[i]->Start();
+
+  for(i=0; i<PEER_COUNT; i++)
+  {
+    peers[i]->Join();
+    ASSERT_EQ(ConcurrentPeer::XACT_COUNT, peers[i]->GetGoodCount());
+  }
+
+  //Cleanup
+  for(i=0; i<PEER_COUNT; i++)
+    delete peers[i];
+
+  delete usrv;
+  delete utopcont;
+  delete udev;
+}
+
+TEST(HC, SHMClient)
+{
+  Board* board;
+  HCContainer* pcont;
+  HCConnection* conn;
+  HCClient* shmcli;
+  uint8_t wbuf[Board::LOG_SIZE];
+  uint8_t rbuf[Board::LOG_SIZE];
+  uint16_t len;
+  uint32_t u32val;
+  uint32_t i;
+  string sval;
+
+  //Create server on shared memory segment with small rings and connect to it (information file download spans many messages)
+  board = new Board(new SHMDevice("hctest", true, 4096), "Shared", 5);
+  pcont = new HCContainer("");
+  conn = new HCConnection(new SHMDevice("hctest", false, 4096), pcont, "shared", 500);
+  ASSERT_TRUE(conn->IsConnected());
+  shmcli = conn->GetClient();
+
+  //Check get, set, write and read round trips
+  ASSERT_EQ(ERR_NONE, shmcli->Get(HCServer::PID_NAME, sval));
+  ASSERT_EQ("Shared", sval);
+  ASSERT_EQ(ERR_NONE, shmcli->Set(4, (uint32_t)6));
+  ASSERT_EQ(ERR_NONE, board->GetVal(u32val));
+  ASSERT_EQ((uint32_t)6, u32val);
+  for(i=0; i<Board::LOG_SIZE; i++)
+    wbuf[i] = (uint8_t)i;
+  ASSERT_EQ(ERR_NONE, shmcli->Write(7, 0, wbuf, Board::LOG_SIZE));
+  ASSERT_EQ(ERR_NONE, shmcli->Read(7, 0, rbuf, Board::LOG_SIZE, len));
+  ASSERT_EQ((uint16_t)Board::LOG_SIZE, len);
+  ASSERT_EQ(0, memcmp(wbuf, rbuf, Board::LOG_SIZE));
+
+  //Check transactions keep flowing as rings wrap many times
+  for(i=0; i<2000; i++)
+  {
+    ASSERT_EQ(ERR_NONE, shmcli->Set(4, i));
+    ASSERT_EQ(ERR_NONE, shmcli->Get(4, u32val));
+    ASSERT_EQ(i, u32val);
+  }
+
+  //Cleanup
+  delete conn;
+  delete pcont;
+  delete board;
+}
+
+TEST(HC, UnixConcurrentClients)
+{
+  static const uint32_t PEER_COUNT = 100;
+  UnixReactor* xdev;
+  HCContainer* xtopcont;
+  HCServer* xsrv;
+  ConcurrentPeer* peers[PEER_COUNT];
+  uint32_t i;
+
+  //Create server on Unix sequenced packet socket
+  xdev = new UnixReactor("/tmp/hctest.sock", HCMessage::OVERHEAD + HCMessage::PAYLOAD_MAX);
+  xtopcont = new HCContainer("");
+  xsrv = new HCServer(xdev, xtopcont, "Local", __DATE__ " " __TIME__);
+  xsrv->Start();
+
+  //Create peers each on its own connection
+  for(i=0; i<PEER_COUNT; i++)
+    peers[i] = new ConcurrentPeer(new UnixClient("/tmp/hctest.sock"), "Local");
+
+  //Run transactions from all peers at once and verify each reply reached its requester
+  for(i=0; i<PEER_COUNT; i++)
+    peers[i]->Start();
+
+  for(i=0; i<PEER_COUNT; i++)
+  {
+    peers[i]->Join();
+    ASSERT_EQ(ConcurrentPeer::XACT_COUNT, peers[i]->GetGoodCount());
+  }
+
+  //Every peer connection was accepted
+  ASSERT_EQ(PEER_COUNT, xdev->GetConnCount());
+
+  //Cleanup
+  for(i=0; i<PEER_COUNT; i++)
+    delete peers[i];
+
+  delete xsrv;
+  delete xtopcont;
+  delete xdev;
+}
+
 int main(int argc, char** argv)
 {
   int result;
@@ -163,7 +2074,7 @@ int main(int argc, char** argv)
   scratch = new Scratch();
 
   //Create server device
-  srvdev = new UDPSocket(1500);
+  srvdev = new LoopDevice();
 
   //Create server top container
   srvtopcont = new HCContainer("");
@@ -180,7 +2091,7 @@ int main(int argc, char** argv)
   srv->Start();
 
   //Create client device
-  clidev = new UDPSocket(0, "127.0.0.1", 1500);
+  clidev = new LoopDevice(srvdev);
 
   //Create client top container
   clitopcont = new HCContainer("");
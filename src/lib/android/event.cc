@@ -27,49 +27,27 @@
 #include "event.hh"
 #include "error.hh"
 #include <errno.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include <time.h>
+#include <unistd.h>
 
 Event::Event(bool signalled)
 {
   //Initialize member variables
   _initcount = signalled ? 1 : 0;
   _count = _initcount;
-
-  //Initialize mutex
-  pthread_mutex_init(&_mutex, NULL);
-
-  //Initialize cond lock attributes to use monotonic clock
-  pthread_condattr_init(&_condattr);
-  pthread_condattr_setclock(&_condattr, CLOCK_MONOTONIC);
-
-  //Initialize cond lock
-  pthread_cond_init(&_cond, &_condattr);
+  _waiters = 0;
 }
 
 Event::~Event()
 {
-  //Destroy cond lock
-  pthread_cond_destroy(&_cond);
-
-  //Destroy cond lock attributes
-  pthread_condattr_destroy(&_condattr);
-
-  //Destroy mutex
-  pthread_mutex_destroy(&_mutex);
 }
 
 int Event::Clear(void)
 {
-  //Lock mutex and check for error
-  if(pthread_mutex_lock(&_mutex) != 0)
-    return ERR_UNSPEC;
-
   //Clear count
-  _count = 0;
-
-  //Unlock mutex and check for error
-  if(pthread_mutex_unlock(&_mutex) != 0)
-    return ERR_UNSPEC;
+  __atomic_store_n(&_count, 0, __ATOMIC_RELEASE);
 
   return ERR_NONE;
 }
@@ -79,114 +57,66 @@ int Event::Wait(uint32_t msecs)
   struct timespec timeout;
   int result;
 
-  //Lock mutex and check for error
-  if(pthread_mutex_lock(&_mutex) != 0)
-    return ERR_UNSPEC;
+  //Take signal without blocking if already set
+  if(__atomic_exchange_n(&_count, 0, __ATOMIC_SEQ_CST) != 0)
+    return ERR_NONE;
 
-  //Check for timeout specified as none, finite or infinite
+  //Check for no waiting
   if(msecs == WAIT_NONE)
+    return ERR_UNSPEC;
+
+  //Calculate absolute time for futex wait timeout
+  if(msecs != WAIT_INF)
   {
-    //Check for count of 0
-    if(_count == 0)
+    clock_gettime(CLOCK_MONOTONIC, &timeout);
+    timeout.tv_sec += msecs / 1000;
+    timeout.tv_nsec += (msecs % 1000) * 1000000;
+    if(timeout.tv_nsec >= 1000000000)
     {
-      //Unlock mutex
-      pthread_mutex_unlock(&_mutex);
-
-      //Return error
-      return ERR_UNSPEC;
+      timeout.tv_sec += timeout.tv_nsec / 1000000000;
+      timeout.tv_nsec = timeout.tv_nsec % 1000000000;
     }
-
-    //Set count to 0
-    _count = 0;
   }
-  else if(msecs == WAIT_INF)
+
+  //Announce waiter so signallers know to make the system call
+  __atomic_add_fetch(&_waiters, 1, __ATOMIC_SEQ_CST);
+
+  //Keep sleeping until signal is taken (a wakeup can be stolen by a thread that never slept)
+  while(__atomic_exchange_n(&_count, 0, __ATOMIC_SEQ_CST) == 0)
   {
-    //Check for count of 0
-    if(_count == 0)
+    //Sleep while count is still zero
+    result = syscall(SYS_futex, &_count, FUTEX_WAIT_BITSET_PRIVATE, 0, (msecs == WAIT_INF) ? NULL : &timeout, NULL, FUTEX_BITSET_MATCH_ANY);
+
+    //Check for timeout or other error (interrupted or count changed first just go around again)
+    if((result != 0) && (errno == ETIMEDOUT))
     {
-      //Wait for cond lock and check for error
-      if(pthread_cond_wait(&_cond, &_mutex) != 0)
-      {
-        //Unlock mutex
-        pthread_mutex_unlock(&_mutex);
-
-        //Return error
-        return ERR_UNSPEC;
-      }
+      __atomic_sub_fetch(&_waiters, 1, __ATOMIC_SEQ_CST);
+      return ERR_TIMEOUT;
     }
-
-    //Set count to 0
-    _count = 0;
-  }
-  else
-  {
-    //Check for count of zero
-    if(_count == 0)
+    else if((result != 0) && (errno != EINTR) && (errno != EAGAIN))
     {
-      //Calculate absolute time for cond wait timeout
-      clock_gettime(CLOCK_MONOTONIC, &timeout);
-      timeout.tv_sec += msecs / 1000;
-      timeout.tv_nsec += (msecs % 1000) * 1000000;
-      if(timeout.tv_nsec >= 1000000000)
-      {
-        timeout.tv_sec += timeout.tv_nsec / 1000000000;
-        timeout.tv_nsec = timeout.tv_nsec % 1000000000;
-      }
-
-      //Wait for cond lock with timeout
-      result = pthread_cond_timedwait(&_cond, &_mutex, &timeout);
-
-      //Check for timeout or other error
-      if(result == ETIMEDOUT)
-      {
-        //Unlock mutex
-        pthread_mutex_unlock(&_mutex);
-
-        //Return timeout
-        return ERR_TIMEOUT;
-      }
-      else if(result != 0)
-      {
-        //Unlock mutex
-        pthread_mutex_unlock(&_mutex);
-
-        //Return timeout
-        return ERR_UNSPEC;
-      }
+      __atomic_sub_fetch(&_waiters, 1, __ATOMIC_SEQ_CST);
+      return ERR_UNSPEC;
     }
-
-    //Set count to 0
-    _count = 0;
   }
 
-  //Unlock mutex and check for error
-  if(pthread_mutex_unlock(&_mutex) != 0)
-    return ERR_UNSPEC;
+  //Withdraw waiter
+  __atomic_sub_fetch(&_waiters, 1, __ATOMIC_SEQ_CST);
 
   return ERR_NONE;
 }
 
 int Event::Signal(void)
 {
-  //Lock mutex and check for error
-  if(pthread_mutex_lock(&_mutex) != 0)
-    return ERR_UNSPEC;
-
   //Set count to 1
-  _count = 1;
+  __atomic_store_n(&_count, 1, __ATOMIC_SEQ_CST);
 
-  //Signal cond lock and check for error
-  if(pthread_cond_signal(&_cond) != 0)
-  {
-    //Unlock mutex
-    pthread_mutex_unlock(&_mutex);
+  //Only pay for a system call when someone is asleep
+  if(__atomic_load_n(&_waiters, __ATOMIC_SEQ_CST) == 0)
+    return ERR_NONE;
 
-    //Return timeout
-    return ERR_UNSPEC;
-  }
-
-  //Unlock mutex and check for error
-  if(pthread_mutex_unlock(&_mutex) != 0)
+  //Wake one waiter and check for error
+  if(syscall(SYS_futex, &_count, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0) < 0)
     return ERR_UNSPEC;
 
   return ERR_NONE;
@@ -194,16 +124,8 @@ int Event::Signal(void)
 
 int Event::Reset(void)
 {
-  //Lock mutex and check for error
-  if(pthread_mutex_lock(&_mutex) != 0)
-    return ERR_UNSPEC;
-
   //Set count to initial value
-  _count = _initcount;
-
-  //Unlock mutex and check for error
-  if(pthread_mutex_unlock(&_mutex) != 0)
-    return ERR_UNSPEC;
+  __atomic_store_n(&_count, _initcount, __ATOMIC_RELEASE);
 
   return ERR_NONE;
 }
@@ -0,0 +1,345 @@
+// Executor
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "executor.hh"
+#include "error.hh"
+#include <cassert>
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+//Executor and queue served by the calling thread (none unless it is a worker)
+static __thread Executor* curexec = 0;
+static __thread uint32_t curindex = 0;
+
+ExecutorTask::ExecutorTask()
+{
+  //Not submitted yet so nothing to wait for
+  _state = STATE_DONE;
+}
+
+ExecutorTask::~ExecutorTask()
+{
+}
+
+void ExecutorTask::Arm(void)
+{
+  //Mark pending before task is queued
+  __atomic_store_n(&_state, STATE_PENDING, __ATOMIC_RELEASE);
+}
+
+void ExecutorTask::Execute(void)
+{
+  //Do the work
+  Run();
+
+  //Mark done and wake any waiter (owner may delete task as soon as state changes so nothing is touched after)
+  if(__atomic_exchange_n(&_state, STATE_DONE, __ATOMIC_ACQ_REL) == STATE_WAITED)
+    syscall(SYS_futex, &_state, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+int ExecutorTask::Wait(uint32_t msecs)
+{
+  struct timespec timeout;
+  uint32_t state;
+
+  //Check for already done
+  if(__atomic_load_n(&_state, __ATOMIC_ACQUIRE) == STATE_DONE)
+    return ERR_NONE;
+
+  //Check for no waiting
+  if(msecs == WAIT_NONE)
+    return ERR_TIMEOUT;
+
+  //Calculate absolute time for futex wait timeout
+  if(msecs != WAIT_INF)
+  {
+    clock_gettime(CLOCK_MONOTONIC, &timeout);
+    timeout.tv_sec += msecs / 1000;
+    timeout.tv_nsec += (msecs % 1000) * 1000000;
+    if(timeout.tv_nsec >= 1000000000)
+    {
+      timeout.tv_sec += timeout.tv_nsec / 1000000000;
+      timeout.tv_nsec = timeout.tv_nsec % 1000000000;
+    }
+  }
+
+  while(true)
+  {
+    //Flag that a waiter needs waking unless task finished meanwhile
+    state = STATE_PENDING;
+    if(!__atomic_compare_exchange_n(&_state, &state, STATE_WAITED, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) && (state == STATE_DONE))
+      return ERR_NONE;
+
+    //Sleep while still waited on and check for timeout
+    if((syscall(SYS_futex, &_state, FUTEX_WAIT_BITSET_PRIVATE, STATE_WAITED, (msecs == WAIT_INF) ? NULL : &timeout, NULL, FUTEX_BITSET_MATCH_ANY) != 0) && (errno == ETIMEDOUT))
+      return ERR_TIMEOUT;
+  }
+}
+
+ExecutorWorker::ExecutorWorker(Executor* exec, uint32_t index, int core)
+{
+  //Assert valid arguments
+  assert(exec != 0);
+
+  //Initialize member variables
+  _exec = exec;
+  _index = index;
+
+  //Create worker thread (pinned if core given)
+  _thread = new Thread<ExecutorWorker>(this, &ExecutorWorker::WorkThread, core);
+}
+
+ExecutorWorker::~ExecutorWorker()
+{
+  //Cleanup
+  delete _thread;
+}
+
+void ExecutorWorker::Start(void)
+{
+  _thread->Start();
+}
+
+void ExecutorWorker::Join(void)
+{
+  _thread->Join();
+}
+
+void ExecutorWorker::WorkThread(void)
+{
+  //Serve own queue until executor shuts down
+  _exec->Work(_index);
+}
+
+Executor::Executor(uint32_t workers, bool pin, uint32_t depth)
+{
+  uint32_t cores;
+  uint32_t i;
+
+  //Assert valid arguments
+  assert(depth > 0);
+
+  //Default to one worker per core
+  if((cores = ThreadNumProcsOnline()) == 0)
+    cores = 1;
+
+  //Initialize member variables
+  _workercount = (workers == 0) ? cores : workers;
+  _queues = new Queue*[_workercount];
+  _workers = new ExecutorWorker*[_workercount];
+  _next = 0;
+  _pending = 0;
+  _stopping = false;
+  _joined = false;
+  _submitcount = 0;
+  _runcount = 0;
+  _stealcount = 0;
+  _overflowcount = 0;
+
+  //Create a task pointer queue and worker for each core (pinned round robin if requested)
+  for(i=0; i<_workercount; i++)
+  {
+    _queues[i] = new Queue(depth, sizeof(ExecutorTask*));
+    _workers[i] = new ExecutorWorker(this, i, pin ? (int)(i % cores) : -1);
+  }
+
+  //Start workers
+  for(i=0; i<_workercount; i++)
+    _workers[i]->Start();
+}
+
+Executor::~Executor()
+{
+  uint32_t i;
+
+  //Finish queued work and stop workers
+  Shutdown();
+
+  //Cleanup
+  for(i=0; i<_workercount; i++)
+  {
+    delete _workers[i];
+    delete _queues[i];
+  }
+
+  delete[] _workers;
+  delete[] _queues;
+}
+
+uint32_t Executor::GetWorkerCount(void)
+{
+  return _workercount;
+}
+
+int Executor::GetSubmitCount(uint32_t& val)
+{
+  val = __atomic_load_n(&_submitcount, __ATOMIC_RELAXED);
+  return ERR_NONE;
+}
+
+int Executor::GetRunCount(uint32_t& val)
+{
+  val = __atomic_load_n(&_runcount, __ATOMIC_RELAXED);
+  return ERR_NONE;
+}
+
+int Executor::GetStealCount(uint32_t& val)
+{
+  val = __atomic_load_n(&_stealcount, __ATOMIC_RELAXED);
+  return ERR_NONE;
+}
+
+int Executor::GetOverflowCount(uint32_t& val)
+{
+  val = __atomic_load_n(&_overflowcount, __ATOMIC_RELAXED);
+  return ERR_NONE;
+}
+
+int Executor::Submit(ExecutorTask* task)
+{
+  uint32_t first;
+  uint32_t i;
+
+  //Assert valid arguments
+  assert(task != 0);
+
+  //Refuse new work from outside once shutting down (running tasks may still queue follow-ups)
+  if(__atomic_load_n(&_stopping, __ATOMIC_ACQUIRE) && (curexec != this))
+    return ERR_INVALID;
+
+  //Mark task pending before any worker can run it
+  task->Arm();
+  __atomic_add_fetch(&_pending, 1, __ATOMIC_SEQ_CST);
+
+  //Keep work submitted by a worker on its own queue, otherwise spread submissions round robin
+  first = (curexec == this) ? curindex : (__atomic_fetch_add(&_next, 1, __ATOMIC_RELAXED) % _workercount);
+
+  //Try each queue in turn starting with first choice
+  for(i=0; i<_workercount; i++)
+    if(_queues[(first + i) % _workercount]->Write(&task, sizeof(task), WAIT_NONE) == sizeof(task))
+      break;
+
+  //Check for all queues full
+  if(i == _workercount)
+  {
+    __atomic_sub_fetch(&_pending, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&_overflowcount, 1, __ATOMIC_RELAXED);
+    _idle.Wake();
+    return ERR_OVERFLOW;
+  }
+
+  __atomic_add_fetch(&_submitcount, 1, __ATOMIC_RELAXED);
+
+  //Wake idle workers
+  _idle.Wake();
+
+  return ERR_NONE;
+}
+
+void Executor::Shutdown(void)
+{
+  uint32_t i;
+
+  //Check for already shut down
+  if(_joined)
+    return;
+
+  //Stop taking outside work and wake idle workers so they drain queues and exit
+  __atomic_store_n(&_stopping, true, __ATOMIC_SEQ_CST);
+  _idle.Wake();
+
+  //Wait for workers to finish
+  for(i=0; i<_workercount; i++)
+    _workers[i]->Join();
+
+  _joined = true;
+}
+
+void Executor::Work(uint32_t index)
+{
+  ExecutorTask* task;
+  uint32_t key;
+
+  //Remember executor and queue served by this thread so tasks it submits stay local
+  curexec = this;
+  curindex = index;
+
+  while(true)
+  {
+    //Take next task, arming idle waiter before looking again so a submission made meanwhile is not slept through
+    if((task = Take(index)) == 0)
+    {
+      key = _idle.Begin();
+      if((task = Take(index)) == 0)
+      {
+        //Check for shutdown with nothing left to run (wake others so they see it too)
+        if(__atomic_load_n(&_stopping, __ATOMIC_SEQ_CST) && (__atomic_load_n(&_pending, __ATOMIC_SEQ_CST) == 0))
+        {
+          _idle.Wake();
+          return;
+        }
+
+        //Sleep until work is submitted
+        _idle.Sleep(key, 0);
+        continue;
+      }
+    }
+
+    //Run task (owner may delete it once it is marked done)
+    task->Execute();
+    __atomic_add_fetch(&_runcount, 1, __ATOMIC_RELAXED);
+
+    //Count task finished and wake sleeping workers if it was the last one during shutdown
+    if((__atomic_sub_fetch(&_pending, 1, __ATOMIC_SEQ_CST) == 0) && __atomic_load_n(&_stopping, __ATOMIC_SEQ_CST))
+      _idle.Wake();
+  }
+}
+
+ExecutorTask* Executor::Take(uint32_t index)
+{
+  ExecutorTask* task;
+  uint32_t i;
+
+  //Check own queue first
+  if(_queues[index]->Read(&task, sizeof(task), WAIT_NONE) == sizeof(task))
+    return task;
+
+  //Steal from other workers starting with the next one along
+  for(i=1; i<_workercount; i++)
+  {
+    if(_queues[(index + i) % _workercount]->Read(&task, sizeof(task), WAIT_NONE) == sizeof(task))
+    {
+      __atomic_add_fetch(&_stealcount, 1, __ATOMIC_RELAXED);
+      return task;
+    }
+  }
+
+  return 0;
+}
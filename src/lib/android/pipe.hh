@@ -28,6 +28,7 @@
 
 #include "mutex.hh"
 #include "event.hh"
+#include "queue.hh"
 #include <inttypes.h>
 
 class Pipe
@@ -49,3 +50,36 @@ private:
   uint32_t _size;
   uint8_t* _buffer;
 };
+
+class SPSCPipe
+{
+public:
+  //Attempts made before sleeping on an empty or full pipe
+  static const uint32_t SPIN_COUNT = 256;
+
+public:
+  SPSCPipe(uint32_t size);
+  ~SPSCPipe();
+  void Reset(void);
+  uint32_t GetCount(void);
+  uint32_t Read(void* buf, uint32_t maxlen, uint32_t msecs);
+  uint32_t Write(const void* buf, uint32_t len, uint32_t msecs);
+  uint32_t Peek(const uint8_t*& buf, uint32_t msecs);
+  void Consume(uint32_t len);
+  uint32_t Reserve(uint8_t*& buf, uint32_t msecs);
+  void Commit(uint32_t len);
+
+private:
+  uint32_t WaitData(uint32_t msecs);
+  uint32_t WaitSpace(uint32_t need, uint32_t msecs);
+
+private:
+  uint64_t _wrpos;
+  uint8_t _pad0[56];
+  uint64_t _rdpos;
+  uint8_t _pad1[56];
+  QueueWaiter _notempty;
+  QueueWaiter _notfull;
+  uint32_t _size;
+  uint8_t* _buffer;
+};
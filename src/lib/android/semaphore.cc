@@ -27,7 +27,10 @@
 #include "semaphore.hh"
 #include "error.hh"
 #include <errno.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include <time.h>
+#include <unistd.h>
 #include <cassert>
 
 #define SEMAPHORE_CNT_MAX 1000000
@@ -40,42 +43,17 @@ Semaphore::Semaphore(uint32_t initcount)
   //Initialize member variables
   _initcount = initcount;
   _count = initcount;
-
-  //Initialize mutex
-  pthread_mutex_init(&_mutex, NULL);
-
-  //Initialize cond lock attributes to use monotonic clock
-  pthread_condattr_init(&_condattr);
-  pthread_condattr_setclock(&_condattr, CLOCK_MONOTONIC);
-
-  //Initialize cond lock
-  pthread_cond_init(&_cond, &_condattr);
+  _waiters = 0;
 }
 
 Semaphore::~Semaphore()
 {
-  //Destroy cond lock
-  pthread_cond_destroy(&_cond);
-
-  //Destroy cond lock attributes
-  pthread_condattr_destroy(&_condattr);
-
-  //Destroy mutex
-  pthread_mutex_destroy(&_mutex);
 }
 
 int Semaphore::Clear(void)
 {
-  //Lock mutex and check for error
-  if(pthread_mutex_lock(&_mutex) != 0)
-    return ERR_UNSPEC;
-
   //Clear count
-  _count = 0;
-
-  //Unlock mutex and check for error
-  if(pthread_mutex_unlock(&_mutex) != 0)
-    return ERR_UNSPEC;
+  __atomic_store_n(&_count, 0, __ATOMIC_RELEASE);
 
   return ERR_NONE;
 }
@@ -85,121 +63,69 @@ int Semaphore::Wait(uint32_t msecs)
   struct timespec timeout;
   int result;
 
-  //Lock mutex and check for error
-  if(pthread_mutex_lock(&_mutex) != 0)
-    return ERR_UNSPEC;
+  //Take count without blocking if available
+  if(TryTake())
+    return ERR_NONE;
 
-  //Check for timeout specified as none, finite or infinite
+  //Check for no waiting
   if(msecs == WAIT_NONE)
-  {
-    //Check for count of 0
-    if(_count == 0)
-    {
-      //Unlock mutex
-      pthread_mutex_unlock(&_mutex);
-
-      //Return error
-      return ERR_UNSPEC;
-    }
+    return ERR_UNSPEC;
 
-    //Decrement count
-    _count--;
-  }
-  else if(msecs == WAIT_INF)
+  //Calculate absolute time for futex wait timeout
+  if(msecs != WAIT_INF)
   {
-    //Check for count of 0
-    if(_count == 0)
+    clock_gettime(CLOCK_MONOTONIC, &timeout);
+    timeout.tv_sec += msecs / 1000;
+    timeout.tv_nsec += (msecs % 1000) * 1000000;
+    if(timeout.tv_nsec >= 1000000000)
     {
-      //Wait for cond lock and check for error
-      if(pthread_cond_wait(&_cond, &_mutex) != 0)
-      {
-        //Unlock mutex
-        pthread_mutex_unlock(&_mutex);
-
-        //Return error
-        return ERR_UNSPEC;
-      }
+      timeout.tv_sec += timeout.tv_nsec / 1000000000;
+      timeout.tv_nsec = timeout.tv_nsec % 1000000000;
     }
+  }
 
-    //The count should never be 0 here
-    assert(_count != 0);
+  //Announce waiter so givers know to make the system call
+  __atomic_add_fetch(&_waiters, 1, __ATOMIC_SEQ_CST);
 
-    //Decrement count
-    _count--;
-  }
-  else
+  //Keep sleeping until a count is taken (another waiter may take it first)
+  while(!TryTake())
   {
-    //Check count
-    if(_count == 0)
+    //Sleep while count is still zero
+    result = syscall(SYS_futex, &_count, FUTEX_WAIT_BITSET_PRIVATE, 0, (msecs == WAIT_INF) ? NULL : &timeout, NULL, FUTEX_BITSET_MATCH_ANY);
+
+    //Check for timeout or other error (interrupted or count changed first just go around again)
+    if((result != 0) && (errno == ETIMEDOUT))
     {
-      //Calculate absolute time for cond wait timeout
-      clock_gettime(CLOCK_MONOTONIC, &timeout);
-      timeout.tv_sec += msecs / 1000;
-      timeout.tv_nsec += (msecs % 1000) * 1000000;
-      if(timeout.tv_nsec >= 1000000000)
-      {
-        timeout.tv_sec += timeout.tv_nsec / 1000000000;
-        timeout.tv_nsec = timeout.tv_nsec % 1000000000;
-      }
-
-      //Wait for cond lock with timeout
-      result = pthread_cond_timedwait(&_cond, &_mutex, &timeout);
-
-      //Check for timeout or other error
-      if(result == ETIMEDOUT)
-      {
-        //Unlock mutex
-        pthread_mutex_unlock(&_mutex);
-
-        //Return timeout
-        return ERR_TIMEOUT;
-      }
-      else if(result != 0)
-      {
-        //Unlock mutex
-        pthread_mutex_unlock(&_mutex);
-
-        //Return timeout
-        return ERR_UNSPEC;
-      }
+      __atomic_sub_fetch(&_waiters, 1, __ATOMIC_SEQ_CST);
+      return ERR_TIMEOUT;
+    }
+    else if((result != 0) && (errno != EINTR) && (errno != EAGAIN))
+    {
+      __atomic_sub_fetch(&_waiters, 1, __ATOMIC_SEQ_CST);
+      return ERR_UNSPEC;
     }
-
-    //The count should never be 0 here
-    assert(_count != 0);
-
-    //Decrement count
-    _count--;
   }
 
-  //Unlock mutex and check for error
-  if(pthread_mutex_unlock(&_mutex) != 0)
-    return ERR_UNSPEC;
+  //Withdraw waiter
+  __atomic_sub_fetch(&_waiters, 1, __ATOMIC_SEQ_CST);
 
   return ERR_NONE;
 }
 
 int Semaphore::Give(void)
 {
-  //Lock mutex and check for error
-  if(pthread_mutex_lock(&_mutex) != 0)
-    return ERR_UNSPEC;
+  uint32_t count;
 
-  //Increment count
-  if(++_count > SEMAPHORE_CNT_MAX)
-    _count = SEMAPHORE_CNT_MAX;
+  //Increment count (saturating)
+  count = __atomic_load_n(&_count, __ATOMIC_RELAXED);
+  while(!__atomic_compare_exchange_n(&_count, &count, (count < SEMAPHORE_CNT_MAX) ? count + 1 : SEMAPHORE_CNT_MAX, true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
 
-  //Signal cond lock and check for error
-  if(pthread_cond_signal(&_cond) != 0)
-  {
-    //Unlock mutex
-    pthread_mutex_unlock(&_mutex);
-
-    //Return timeout
-    return ERR_UNSPEC;
-  }
+  //Only pay for a system call when someone is asleep
+  if(__atomic_load_n(&_waiters, __ATOMIC_SEQ_CST) == 0)
+    return ERR_NONE;
 
-  //Unlock mutex and check for error
-  if(pthread_mutex_unlock(&_mutex) != 0)
+  //Wake one waiter and check for error
+  if(syscall(SYS_futex, &_count, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0) < 0)
     return ERR_UNSPEC;
 
   return ERR_NONE;
@@ -207,16 +133,21 @@ int Semaphore::Give(void)
 
 int Semaphore::Reset(void)
 {
-  //Lock mutex and check for error
-  if(pthread_mutex_lock(&_mutex) != 0)
-    return ERR_UNSPEC;
-
   //Set count to initial value
-  _count = _initcount;
-
-  //Unlock mutex and check for error
-  if(pthread_mutex_unlock(&_mutex) != 0)
-    return ERR_UNSPEC;
+  __atomic_store_n(&_count, _initcount, __ATOMIC_RELEASE);
 
   return ERR_NONE;
 }
+
+bool Semaphore::TryTake(void)
+{
+  uint32_t count;
+
+  //Decrement count unless it is zero (failed exchange reloads count)
+  count = __atomic_load_n(&_count, __ATOMIC_RELAXED);
+  while(count != 0)
+    if(__atomic_compare_exchange_n(&_count, &count, count - 1, true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+      return true;
+
+  return false;
+}
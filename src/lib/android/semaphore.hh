@@ -28,7 +28,6 @@
 
 #include "const.hh"
 #include <inttypes.h>
-#include <pthread.h>
 
 class Semaphore
 {
@@ -41,9 +40,10 @@ public:
   int Reset(void);
 
 private:
-  pthread_mutex_t _mutex;
-  pthread_condattr_t _condattr;
-  pthread_cond_t _cond;
+  bool TryTake(void);
+
+private:
   uint32_t _initcount;
   uint32_t _count;
+  uint32_t _waiters;
 };
@@ -25,7 +25,9 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "serdev.hh"
+#include "const.hh"
 #include "error.hh"
+#include "thread.hh"
 #include <unistd.h>
 #include <errno.h>
 #include <iostream>
@@ -34,6 +36,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <cassert>
 
 using namespace std;
@@ -195,3 +198,29 @@ uint32_t SerDev::Write(const void* buf, uint32_t len)
 
   return (uint32_t)wlen;
 }
+
+int SerDev::WaitReadable(uint32_t msecs)
+{
+  struct pollfd pfd;
+  int retval;
+
+  //Wait for received bytes
+  pfd.fd = _fd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  if((retval = poll(&pfd, 1, (msecs == WAIT_INF) ? -1 : (int)msecs)) < 0)
+    return ERR_UNSPEC;
+
+  //Check for timeout
+  if(retval == 0)
+    return ERR_TIMEOUT;
+
+  //Port that hung up stays ready forever, so wait out the timeout rather than let caller spin
+  if(!(pfd.revents & POLLIN))
+  {
+    ThreadSleep(msecs);
+    return ERR_UNSPEC;
+  }
+
+  return ERR_NONE;
+}
@@ -37,6 +37,7 @@ public:
   virtual ~SerDev();
   virtual uint32_t Read(void* buf, uint32_t maxlen);
   virtual uint32_t Write(const void* buf, uint32_t len);
+  virtual int WaitReadable(uint32_t msecs);
 
 private:
   int _fd;
@@ -0,0 +1,566 @@
+// TCP reactor
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "const.hh"
+#include "tcpreactor.hh"
+#include <arpa/inet.h>
+#include <cassert>
+#include <errno.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std;
+
+TCPReactor::TCPReactor(uint16_t port, uint32_t maxpldsiz, uint32_t maxconns)
+: Device()
+{
+  struct sockaddr_in addr;
+  int listenfd;
+  int optval;
+
+  //Create the non-blocking listening socket
+  if((listenfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) < 0)
+    cout << __FILE__ << ":" << __LINE__ << " - Error creating listening socket" << "\n";
+
+  //Set listening socket to reuseable
+  optval = 1;
+  if(setsockopt(listenfd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) != 0)
+    cout << __FILE__ << ":" << __LINE__ << " - Error setting listening socket reuse" << "\n";
+
+  //Bind listening socket to specified port
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if(bind(listenfd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    cout << __FILE__ << ":" << __LINE__ << " - Error binding listening socket" << "\n";
+
+  //Listen
+  if(listen(listenfd, SOMAXCONN) != 0)
+    cout << __FILE__ << ":" << __LINE__ << " - Error listening" << "\n";
+
+  //Byte stream needs SLIP framing
+  Init(listenfd, maxpldsiz, maxconns, true);
+}
+
+TCPReactor::TCPReactor(int listenfd, uint32_t maxpldsiz, uint32_t maxconns, bool framed)
+: Device()
+{
+  //Take over listening socket made by derived class
+  Init(listenfd, maxpldsiz, maxconns, framed);
+}
+
+TCPReactor::~TCPReactor()
+{
+  uint32_t i;
+
+  //Stop reactor thread
+  Stop();
+
+  //Close all connections
+  for(i=0; i<_maxconns; i++)
+  {
+    if(_fds[i] >= 0)
+      close(_fds[i]);
+
+    delete _decoders[i];
+  }
+
+  //Close epoll instance and listening socket
+  if(_epollfd >= 0)
+    close(_epollfd);
+
+  if(_listenfd >= 0)
+    close(_listenfd);
+
+  //Cleanup
+  delete[] _txbuf;
+  delete[] _rdbuf;
+  delete[] _rxitem;
+  delete[] _pushitem;
+  delete _rxqueue;
+  delete[] _decoders;
+  delete[] _gens;
+  delete[] _fds;
+  delete _mutex;
+}
+
+uint32_t TCPReactor::Read(void* buf, uint32_t maxlen)
+{
+  //Read and remember source connection so a plain write replies to it
+  return ReadFrom(buf, maxlen, _rxpeer);
+}
+
+uint32_t TCPReactor::Write(const void* buf, uint32_t len)
+{
+  //Reply to connection of last plain read
+  return WriteTo(buf, len, _rxpeer);
+}
+
+uint32_t TCPReactor::ReadFrom(void* buf, uint32_t maxlen, uint64_t& peer)
+{
+  uint32_t handle;
+  uint32_t len;
+
+  //Assert valid arguments
+  assert((buf != 0) && (maxlen > 0));
+
+  //Start reactor thread if not already
+  _mutex->Wait();
+  if(!_started)
+  {
+    _started = true;
+    _reactorthread->Start();
+  }
+  _mutex->Give();
+
+  //Keep trying until a message that fits is received
+  while(true)
+  {
+    //Wait for inbound message
+    if((len = _rxqueue->Read(_rxitem, sizeof(uint32_t) + _maxpldsiz, WAIT_INF)) <= sizeof(uint32_t))
+      continue;
+
+    //Drop message that does not fit
+    len -= sizeof(uint32_t);
+    if(len > maxlen)
+      continue;
+
+    //Peer is handle of source connection
+    memcpy(&handle, _rxitem, sizeof(uint32_t));
+    peer = handle;
+
+    //Copy payload
+    memcpy(buf, &_rxitem[sizeof(uint32_t)], len);
+
+    return len;
+  }
+}
+
+uint32_t TCPReactor::WriteTo(const void* buf, uint32_t len, uint64_t peer)
+{
+  uint32_t slot;
+  const uint8_t* frame;
+  uint32_t framelen;
+  uint32_t offset;
+  uint64_t deadline;
+  struct pollfd pfd;
+  int retval;
+
+  //Assert valid arguments
+  assert((buf != 0) && (len > 0));
+
+  //Check for too large
+  if(len > _maxpldsiz)
+    return 0;
+
+  //Begin mutual exclusion
+  _mutex->Wait();
+
+  //Check that the peer's connection is still the one open in its slot
+  slot = (uint32_t)peer & HANDLE_SLOT_MASK;
+  if((peer > 0xFFFFFFFF) || (slot >= _maxconns) || (_fds[slot] < 0) || (_gens[slot] != (peer >> HANDLE_GEN_SHIFT)))
+  {
+    //End mutual exclusion
+    _mutex->Give();
+    return 0;
+  }
+
+  //Encode frame (message preserving sockets send payload as is)
+  if(_framed)
+  {
+    framelen = SLIPFramer::Encode(buf, len, _txbuf);
+    frame = _txbuf;
+  }
+  else
+  {
+    framelen = len;
+    frame = (const uint8_t*)buf;
+  }
+
+  //Send entire frame, waiting a limited time on a congested connection
+  offset = 0;
+  deadline = ThreadTimeUS() + (uint64_t)WRITE_TIMEOUT * 1000;
+  while(offset < framelen)
+  {
+    //Send what the connection will take
+    if((retval = SendConn(slot, &frame[offset], framelen - offset)) > 0)
+    {
+      offset += (uint32_t)retval;
+      continue;
+    }
+
+    //Wait for room unless connection failed or is stuck
+    if((retval == 0) && (ThreadTimeUS() < deadline))
+    {
+      pfd.fd = _fds[slot];
+      pfd.events = POLLOUT;
+      pfd.revents = 0;
+      poll(&pfd, 1, 10);
+      continue;
+    }
+
+    //Give up on connection
+    Close(slot);
+
+    //End mutual exclusion
+    _mutex->Give();
+    return 0;
+  }
+
+  //End mutual exclusion
+  _mutex->Give();
+
+  return len;
+}
+
+uint32_t TCPReactor::GetConnCount(void)
+{
+  uint32_t retval;
+
+  //Get count with mutual exclusion
+  _mutex->Wait();
+  retval = _conncount;
+  _mutex->Give();
+
+  return retval;
+}
+
+int TCPReactor::GetFD(uint32_t slot)
+{
+  //Assert valid arguments
+  assert(slot < _maxconns);
+
+  return _fds[slot];
+}
+
+uint32_t TCPReactor::GetMaxConns(void)
+{
+  return _maxconns;
+}
+
+void TCPReactor::Stop(void)
+{
+  //Delete reactor thread (derived classes call this before tearing down their connection state)
+  if(_reactorthread != 0)
+  {
+    delete _reactorthread;
+    _reactorthread = 0;
+  }
+}
+
+bool TCPReactor::OpenConn(uint32_t slot, int fd)
+{
+  //Plain TCP needs no per connection setup
+  return true;
+}
+
+int TCPReactor::RecvConn(uint32_t slot, void* buf, uint32_t maxlen)
+{
+  ssize_t retval;
+
+  //Read from socket
+  if((retval = read(_fds[slot], buf, maxlen)) > 0)
+    return (int)retval;
+
+  //Check for nothing available yet
+  if((retval < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)))
+    return 0;
+
+  //Peer closed or error
+  return -1;
+}
+
+int TCPReactor::SendConn(uint32_t slot, const void* buf, uint32_t len)
+{
+  ssize_t retval;
+
+  //Write to socket
+  if((retval = send(_fds[slot], buf, len, MSG_NOSIGNAL)) >= 0)
+    return (int)retval;
+
+  //Check for no room yet
+  if((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))
+    return 0;
+
+  return -1;
+}
+
+void TCPReactor::CloseConn(uint32_t slot)
+{
+  //Plain TCP needs no per connection teardown
+}
+
+void TCPReactor::Init(int listenfd, uint32_t maxpldsiz, uint32_t maxconns, bool framed)
+{
+  struct epoll_event ev;
+  uint32_t i;
+
+  //Assert valid arguments
+  assert((maxpldsiz > 0) && (maxconns > 0) && (maxconns <= CONNS_MAX));
+
+  //Initialize member variables
+  _mutex = new Mutex();
+  _listenfd = listenfd;
+  _maxpldsiz = maxpldsiz;
+  _maxconns = maxconns;
+  _framed = framed;
+  _conncount = 0;
+  _rxpeer = PEER_NONE;
+  _started = false;
+
+  //Create connection table (decoders are allocated on first use of a slot, generation zero is
+  //skipped so no handle equals PEER_NONE)
+  _fds = new int[_maxconns];
+  _gens = new uint16_t[_maxconns];
+  _decoders = new SLIPDecoder*[_maxconns];
+  for(i=0; i<_maxconns; i++)
+  {
+    _fds[i] = -1;
+    _gens[i] = 1;
+    _decoders[i] = 0;
+  }
+
+  //Create inbound message queue (each item is a connection handle followed by the payload)
+  _rxqueue = new SPSCQueue(QUEUE_DEPTH, sizeof(uint32_t) + _maxpldsiz);
+  _pushitem = new uint8_t[sizeof(uint32_t) + _maxpldsiz];
+  _rxitem = new uint8_t[sizeof(uint32_t) + _maxpldsiz];
+
+  //Create socket read buffer (whole message plus a byte to spot oversize ones when unframed) and
+  //worst case SLIP encoded transmit buffer
+  _rdbufsize = (_framed || (READ_SIZE > _maxpldsiz)) ? READ_SIZE : _maxpldsiz + 1;
+  _rdbuf = new uint8_t[_rdbufsize];
+  _txbuf = new uint8_t[2 * _maxpldsiz + 2];
+
+  //Create epoll instance and register listening socket
+  if((_epollfd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+    cout << __FILE__ << ":" << __LINE__ << " - Error creating epoll instance" << "\n";
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.u32 = SLOT_LISTEN;
+  if(epoll_ctl(_epollfd, EPOLL_CTL_ADD, _listenfd, &ev) != 0)
+    cout << __FILE__ << ":" << __LINE__ << " - Error registering listening socket" << "\n";
+
+  //Create reactor thread (started on first read so derived classes are fully constructed)
+  _reactorthread = new Thread<TCPReactor>(this, &TCPReactor::ReactorThread);
+}
+
+void TCPReactor::Accept(void)
+{
+  struct epoll_event ev;
+  int fd;
+  int optval;
+  uint32_t slot;
+
+  //Accept all pending connections
+  while(true)
+  {
+    //Accept
+    if((fd = accept4(_listenfd, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC)) < 0)
+    {
+      //Retry interrupted or aborted accepts
+      if((errno == EINTR) || (errno == ECONNABORTED))
+        continue;
+
+      //Report anything other than no more pending connections
+      if((errno != EAGAIN) && (errno != EWOULDBLOCK))
+        cout << __FILE__ << ":" << __LINE__ << " - Error accepting" << "\n";
+
+      return;
+    }
+
+    //Disable Nagle so small replies are not delayed
+    if(_framed)
+    {
+      optval = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
+    }
+
+    //Begin mutual exclusion
+    _mutex->Wait();
+
+    //Refuse connection if table is full
+    if(_conncount >= _maxconns)
+    {
+      _mutex->Give();
+      close(fd);
+      continue;
+    }
+
+    //Find free slot
+    for(slot=0; _fds[slot]>=0; slot++);
+
+    //Create or reset decoder (message preserving sockets need none)
+    if(_framed)
+    {
+      if(_decoders[slot] == 0)
+        _decoders[slot] = new SLIPDecoder(_maxpldsiz);
+      else
+        _decoders[slot]->Reset();
+    }
+
+    //Occupy slot and let derived class set up connection
+    _fds[slot] = fd;
+    if(!OpenConn(slot, fd))
+    {
+      _fds[slot] = -1;
+      _mutex->Give();
+      close(fd);
+      continue;
+    }
+
+    //Register connection with epoll (tagged with slot)
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = slot;
+    if(epoll_ctl(_epollfd, EPOLL_CTL_ADD, fd, &ev) != 0)
+    {
+      cout << __FILE__ << ":" << __LINE__ << " - Error registering connection" << "\n";
+      CloseConn(slot);
+      _fds[slot] = -1;
+      _mutex->Give();
+      close(fd);
+      continue;
+    }
+
+    //Count connection
+    _conncount++;
+
+    //End mutual exclusion
+    _mutex->Give();
+  }
+}
+
+void TCPReactor::Service(uint32_t slot)
+{
+  uint32_t handle;
+  uint32_t i;
+  uint32_t j;
+  int len;
+
+  //Read a limited number of times so one busy connection cannot starve the rest
+  for(i=0; i<READ_BURST; i++)
+  {
+    //Begin mutual exclusion
+    _mutex->Wait();
+
+    //Check for connection closed by earlier event
+    if(_fds[slot] < 0)
+    {
+      _mutex->Give();
+      break;
+    }
+
+    //Read available data and close connection on error or peer close
+    if((len = RecvConn(slot, _rdbuf, _rdbufsize)) < 0)
+      Close(slot);
+
+    //Form connection handle
+    handle = ((uint32_t)_gens[slot] << HANDLE_GEN_SHIFT) | slot;
+
+    //End mutual exclusion
+    _mutex->Give();
+
+    //Check for nothing more to read
+    if(len <= 0)
+      break;
+
+    //Queue whole message read from message preserving socket (dropping any that was truncated)
+    if(!_framed)
+    {
+      if((uint32_t)len <= _maxpldsiz)
+      {
+        memcpy(_pushitem, &handle, sizeof(uint32_t));
+        memcpy(&_pushitem[sizeof(uint32_t)], _rdbuf, len);
+        _rxqueue->Write(_pushitem, sizeof(uint32_t) + len, WAIT_INF);
+      }
+      continue;
+    }
+
+    //Decode received bytes and queue each completed frame (waits while reader is behind)
+    for(j=0; j<(uint32_t)len; j++)
+    {
+      if(_decoders[slot]->Decode(_rdbuf[j]))
+      {
+        memcpy(_pushitem, &handle, sizeof(uint32_t));
+        memcpy(&_pushitem[sizeof(uint32_t)], _decoders[slot]->GetFrame(), _decoders[slot]->GetLength());
+        _rxqueue->Write(_pushitem, sizeof(uint32_t) + _decoders[slot]->GetLength(), WAIT_INF);
+      }
+    }
+  }
+}
+
+void TCPReactor::Close(uint32_t slot)
+{
+  //Unregister from epoll and let derived class tear down connection
+  epoll_ctl(_epollfd, EPOLL_CTL_DEL, _fds[slot], 0);
+  CloseConn(slot);
+
+  //Close socket and free slot (new generation invalidates outstanding handles)
+  close(_fds[slot]);
+  _fds[slot] = -1;
+  if(++_gens[slot] == 0)
+    _gens[slot] = 1;
+  _conncount--;
+}
+
+void TCPReactor::ReactorThread(void)
+{
+  struct epoll_event events[EVENTS_MAX];
+  int count;
+  int i;
+
+  //Dispatch events forever
+  while(true)
+  {
+    //Wait for readiness
+    if((count = epoll_wait(_epollfd, events, EVENTS_MAX, -1)) < 0)
+    {
+      if(errno != EINTR)
+      {
+        cout << __FILE__ << ":" << __LINE__ << " - Error waiting for events" << "\n";
+        ThreadSleep(1000);
+      }
+      continue;
+    }
+
+    //Accept new connections or service existing ones
+    for(i=0; i<count; i++)
+    {
+      if(events[i].data.u32 == SLOT_LISTEN)
+        Accept();
+      else
+        Service(events[i].data.u32);
+    }
+  }
+}
@@ -35,6 +35,7 @@
 #include <stdio.h>
 
 int ThreadSleep(uint32_t msecs);
+uint64_t ThreadTimeUS(void);
 uint32_t ThreadNumProcsOnline(void);
 
 template <class T>
@@ -63,6 +64,9 @@ public:
 
     //Indicate not started
     _started = false;
+
+    //Indicate nothing to join
+    _joinable = false;
   }
 
   ~Thread()
@@ -73,6 +77,11 @@ public:
       pthread_cancel(_threadid);
       pthread_join(_threadid, NULL);
     }
+    else if(_joinable)
+    {
+      //Reap thread that has already returned
+      pthread_join(_threadid, NULL);
+    }
 
     //Destroy the mutex
     delete _mutex;
@@ -98,9 +107,17 @@ public:
     pthread_attr_init(&attr);
     pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
 
+    //Indicate started (before creating so a thread that returns immediately is not marked running)
+    _started = true;
+    _joinable = true;
+
     //Start the thread
     if((result = pthread_create(&_threadid, NULL, (void*(*)(void*))&Thread<T>::Wrapper, this)) != 0)
     {
+      //Indicate not started
+      _started = false;
+      _joinable = false;
+
       //End mutual exclusion
       _mutex->Give();
       return ERR_UNSPEC;
@@ -109,12 +126,35 @@ public:
     //Destroy thread attributes (no longer needed)
     pthread_attr_destroy(&attr);
 
-    //Indicate started
-    _started = true;
+    //End mutual exclusion
+    _mutex->Give();
+
+    return ERR_NONE;
+  }
+
+  int Join(void)
+  {
+    //Begin mutual exclusion
+    _mutex->Wait();
+
+    //Check for nothing to join
+    if(!_joinable)
+    {
+      //End mutual exclusion
+      _mutex->Give();
+      return ERR_INVALID;
+    }
+
+    //Indicate nothing to join
+    _joinable = false;
 
     //End mutual exclusion
     _mutex->Give();
 
+    //Wait for thread method to return
+    if(pthread_join(_threadid, NULL) != 0)
+      return ERR_UNSPEC;
+
     return ERR_NONE;
   }
 
@@ -162,5 +202,6 @@ private:
   int _core;
   Mutex* _mutex;
   bool _started;
+  bool _joinable;
   pthread_t _threadid;
 };
@@ -0,0 +1,493 @@
+// Timer wheel
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "timerwheel.hh"
+#include "error.hh"
+#include <cassert>
+#include <inttypes.h>
+
+TimerTask::TimerTask()
+{
+  //Initialize member variables
+  _next = 0;
+  _prev = 0;
+  _runnext = 0;
+  _runprev = 0;
+  _wheel = 0;
+  _expiry = 0;
+  _fired = 0;
+  _period = 0;
+  _slot = 0;
+  _queued = false;
+}
+
+TimerTask::~TimerTask()
+{
+}
+
+bool TimerTask::IsScheduled(void)
+{
+  return _wheel != 0;
+}
+
+TimerWheel::TimerWheel(uint32_t tickus, Executor* exec)
+{
+  uint32_t i;
+  uint32_t j;
+
+  //Assert valid arguments
+  assert(tickus > 0);
+
+  //Initialize member variables
+  _tickus = tickus;
+  _exec = exec;
+  _start = ThreadTimeUS();
+  _now = 0;
+  _wakeat = 0;
+  _runhead = 0;
+  _runtail = 0;
+  _mutex = new Mutex();
+  _stop = false;
+  _activecount = 0;
+  _schedcount = 0;
+  _expirecount = 0;
+  _cancelcount = 0;
+  _overruncount = 0;
+  _latecount = 0;
+  _latesum = 0;
+  _latemin = 0;
+  _latemax = 0;
+
+  //Empty all slots
+  for(i=0; i<LEVEL_COUNT; i++)
+    for(j=0; j<SLOT_COUNT; j++)
+      _slots[i][j] = 0;
+
+  //Create and start wheel thread
+  _thread = new Thread<TimerWheel>(this, &TimerWheel::WheelThread);
+  _thread->Start();
+}
+
+TimerWheel::~TimerWheel()
+{
+  //Stop wheel thread (timers still scheduled are simply dropped)
+  _mutex->Wait();
+  _stop = true;
+  _mutex->Give();
+  _waiter.Wake();
+  _thread->Join();
+
+  //Cleanup
+  delete _thread;
+  delete _mutex;
+}
+
+uint32_t TimerWheel::GetTick(void)
+{
+  return _tickus;
+}
+
+int TimerWheel::Schedule(TimerTask* task, uint32_t delayus, uint32_t periodus)
+{
+  uint64_t expiry;
+  bool wake;
+
+  //Assert valid arguments
+  assert((task != 0) && ((task->_wheel == 0) || (task->_wheel == this)));
+
+  _mutex->Wait();
+
+  //Take task out of wheel if already scheduled
+  if(task->_wheel != 0)
+  {
+    Unlink(task);
+    _activecount--;
+  }
+
+  //Round expiry up to a whole tick so timer never fires early (and never in a tick already processed)
+  expiry = (ThreadTimeUS() - _start + delayus + _tickus - 1) / _tickus;
+  if(expiry <= _now)
+    expiry = _now + 1;
+
+  //Period rounds to nearest whole tick (at least one)
+  task->_expiry = expiry;
+  task->_period = (periodus == 0) ? 0 : (periodus + _tickus / 2) / _tickus;
+  if((periodus != 0) && (task->_period == 0))
+    task->_period = 1;
+
+  //Add to wheel
+  task->_wheel = this;
+  Insert(task);
+  _activecount++;
+  _schedcount++;
+
+  //Wake wheel thread if it sleeps past new expiry
+  wake = (_wakeat == 0) || (expiry < _wakeat);
+  _mutex->Give();
+
+  if(wake)
+    _waiter.Wake();
+
+  return ERR_NONE;
+}
+
+int TimerWheel::Cancel(TimerTask* task)
+{
+  //Assert valid arguments
+  assert(task != 0);
+
+  _mutex->Wait();
+
+  //Check for neither in wheel nor waiting to run
+  if((task->_wheel == 0) && !task->_queued)
+  {
+    _mutex->Give();
+    return ERR_INVALID;
+  }
+
+  //Take task out of wheel
+  if(task->_wheel != 0)
+  {
+    Unlink(task);
+    task->_wheel = 0;
+    _activecount--;
+  }
+
+  //Take task off run list
+  if(task->_queued)
+    Dequeue(task);
+
+  _cancelcount++;
+
+  _mutex->Give();
+
+  return ERR_NONE;
+}
+
+int TimerWheel::GetActiveCount(uint32_t& val)
+{
+  _mutex->Wait();
+  val = _activecount;
+  _mutex->Give();
+
+  return ERR_NONE;
+}
+
+int TimerWheel::GetScheduleCount(uint32_t& val)
+{
+  _mutex->Wait();
+  val = _schedcount;
+  _mutex->Give();
+
+  return ERR_NONE;
+}
+
+int TimerWheel::GetExpireCount(uint32_t& val)
+{
+  _mutex->Wait();
+  val = _expirecount;
+  _mutex->Give();
+
+  return ERR_NONE;
+}
+
+int TimerWheel::GetCancelCount(uint32_t& val)
+{
+  _mutex->Wait();
+  val = _cancelcount;
+  _mutex->Give();
+
+  return ERR_NONE;
+}
+
+int TimerWheel::GetOverrunCount(uint32_t& val)
+{
+  _mutex->Wait();
+  val = _overruncount;
+  _mutex->Give();
+
+  return ERR_NONE;
+}
+
+int TimerWheel::GetDrift(uint32_t& val)
+{
+  //Average lateness of dispatch behind due time (microseconds)
+  _mutex->Wait();
+  val = (_latecount == 0) ? 0 : (uint32_t)(_latesum / _latecount);
+  _mutex->Give();
+
+  return ERR_NONE;
+}
+
+int TimerWheel::GetJitter(uint32_t& val)
+{
+  //Spread between earliest and latest dispatch relative to due time (microseconds)
+  _mutex->Wait();
+  val = (uint32_t)(_latemax - _latemin);
+  _mutex->Give();
+
+  return ERR_NONE;
+}
+
+void TimerWheel::Insert(TimerTask* task)
+{
+  uint64_t delta;
+  uint64_t when;
+  uint32_t level;
+  uint32_t slot;
+
+  //Pick lowest level whose span covers time to expiry
+  delta = task->_expiry - _now;
+  for(level=0; (level < (LEVEL_COUNT - 1)) && (delta >= (1ULL << (SLOT_BITS * (level + 1)))); level++);
+
+  //Park timers beyond top level span in its furthest slot (they cascade back in when it comes round)
+  when = task->_expiry;
+  if(delta >= (1ULL << (SLOT_BITS * LEVEL_COUNT)))
+    when = _now + (1ULL << (SLOT_BITS * LEVEL_COUNT)) - 1;
+
+  //Push on front of slot list
+  slot = (when >> (SLOT_BITS * level)) & (SLOT_COUNT - 1);
+  task->_prev = 0;
+  task->_next = _slots[level][slot];
+  if(task->_next != 0)
+    task->_next->_prev = task;
+  _slots[level][slot] = task;
+
+  //Remember slot for unlinking
+  task->_slot = (level << SLOT_BITS) | slot;
+}
+
+void TimerWheel::Unlink(TimerTask* task)
+{
+  uint32_t level;
+  uint32_t slot;
+
+  //Find slot task was inserted in
+  level = task->_slot >> SLOT_BITS;
+  slot = task->_slot & (SLOT_COUNT - 1);
+
+  //Splice task out of slot list
+  if(task->_prev != 0)
+    task->_prev->_next = task->_next;
+  else
+    _slots[level][slot] = task->_next;
+
+  if(task->_next != 0)
+    task->_next->_prev = task->_prev;
+
+  task->_next = 0;
+  task->_prev = 0;
+}
+
+void TimerWheel::Enqueue(TimerTask* task)
+{
+  //Append task to run list
+  task->_runnext = 0;
+  task->_runprev = _runtail;
+  if(_runtail != 0)
+    _runtail->_runnext = task;
+  else
+    _runhead = task;
+  _runtail = task;
+
+  task->_queued = true;
+}
+
+void TimerWheel::Dequeue(TimerTask* task)
+{
+  //Splice task out of run list
+  if(task->_runprev != 0)
+    task->_runprev->_runnext = task->_runnext;
+  else
+    _runhead = task->_runnext;
+
+  if(task->_runnext != 0)
+    task->_runnext->_runprev = task->_runprev;
+  else
+    _runtail = task->_runprev;
+
+  task->_runnext = 0;
+  task->_runprev = 0;
+  task->_queued = false;
+}
+
+void TimerWheel::Advance(void)
+{
+  TimerTask* task;
+  TimerTask* next;
+  uint32_t level;
+
+  //Move on one tick
+  _now++;
+
+  //Cascade higher level slots down as each level below wraps round
+  for(level=1; (level < LEVEL_COUNT) && ((_now & ((1ULL << (SLOT_BITS * level)) - 1)) == 0); level++)
+  {
+    //Take whole slot list and reinsert each timer closer to its expiry
+    task = _slots[level][(_now >> (SLOT_BITS * level)) & (SLOT_COUNT - 1)];
+    _slots[level][(_now >> (SLOT_BITS * level)) & (SLOT_COUNT - 1)] = 0;
+    for(; task != 0; task = next)
+    {
+      next = task->_next;
+      Insert(task);
+    }
+  }
+
+  //Take timers due this tick
+  task = _slots[0][_now & (SLOT_COUNT - 1)];
+  _slots[0][_now & (SLOT_COUNT - 1)] = 0;
+
+  for(; task != 0; task = next)
+  {
+    next = task->_next;
+    task->_next = 0;
+    task->_prev = 0;
+    task->_fired = task->_expiry;
+
+    //Reschedule periodic timer from when it was due rather than when it runs so it does not drift
+    if(task->_period != 0)
+    {
+      task->_expiry += task->_period;
+      Insert(task);
+    }
+    else
+    {
+      task->_wheel = 0;
+      _activecount--;
+    }
+
+    //Queue to run unless previous expiry has not run yet
+    if(!task->_queued)
+      Enqueue(task);
+    else
+      _overruncount++;
+  }
+}
+
+void TimerWheel::Dispatch(void)
+{
+  TimerTask* task;
+  uint64_t now;
+  uint64_t due;
+  uint64_t late;
+
+  while(true)
+  {
+    _mutex->Wait();
+
+    //Take next task off run list and check for done
+    if((task = _runhead) == 0)
+    {
+      _mutex->Give();
+      return;
+    }
+
+    Dequeue(task);
+
+    //Skip task if its previous run has not finished
+    if(task->Wait(WAIT_NONE) != ERR_NONE)
+    {
+      _overruncount++;
+      _mutex->Give();
+      continue;
+    }
+
+    //Count expiry only once it is dispatched (one cancelled while waiting to run never happened)
+    _expirecount++;
+
+    //Track how late task starts compared to when it was due
+    now = ThreadTimeUS();
+    due = _start + task->_fired * _tickus;
+    late = (now > due) ? now - due : 0;
+    if((_latecount == 0) || (late < _latemin))
+      _latemin = late;
+    if(late > _latemax)
+      _latemax = late;
+    _latesum += late;
+    _latecount++;
+
+    //Mark pending before releasing mutex so a cancel followed by a wait covers this run
+    task->Arm();
+
+    _mutex->Give();
+
+    //Run on executor if given (or if it refuses), otherwise on wheel thread
+    if((_exec == 0) || (_exec->Submit(task) != ERR_NONE))
+      task->Execute();
+  }
+}
+
+uint64_t TimerWheel::NextDue(void)
+{
+  uint64_t tick;
+
+  //Check for nothing to wake for
+  if(_activecount == 0)
+    return 0;
+
+  //Find next occupied level zero slot, or the wrap where higher levels cascade
+  for(tick=_now+1; (tick & (SLOT_COUNT - 1)) != 0; tick++)
+    if(_slots[0][tick & (SLOT_COUNT - 1)] != 0)
+      break;
+
+  return tick;
+}
+
+void TimerWheel::WheelThread(void)
+{
+  uint64_t target;
+  uint64_t wakeat;
+  uint32_t key;
+  bool stop;
+
+  while(true)
+  {
+    _mutex->Wait();
+
+    //Process every tick that has passed (jumping straight there when wheel is empty)
+    target = (ThreadTimeUS() - _start) / _tickus;
+    if(_activecount == 0)
+      _now = target;
+    while(_now < target)
+      Advance();
+
+    //Note when next timer is due, arming waiter first so a sooner timer scheduled meanwhile wakes thread
+    key = _waiter.Begin();
+    _wakeat = NextDue();
+    wakeat = _wakeat;
+    stop = _stop;
+
+    _mutex->Give();
+
+    //Run expired timers and check for stop
+    Dispatch();
+    if(stop)
+      return;
+
+    //Sleep until next timer is due (for ever when wheel is empty)
+    _waiter.Sleep(key, (wakeat == 0) ? 0 : _start + wakeat * _tickus);
+  }
+}
@@ -0,0 +1,151 @@
+// Timer wheel
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "executor.hh"
+#include "mutex.hh"
+#include "queue.hh"
+#include "thread.hh"
+#include <inttypes.h>
+
+class TimerWheel;
+
+//Callback run when a timer expires (cancel it and wait for it before deleting)
+class TimerTask : public ExecutorTask
+{
+public:
+  TimerTask();
+  virtual ~TimerTask();
+  bool IsScheduled(void);
+
+private:
+  //Wheel bookkeeping (only touched by the wheel with its mutex held)
+  friend class TimerWheel;
+  TimerTask* _next;
+  TimerTask* _prev;
+  TimerTask* _runnext;
+  TimerTask* _runprev;
+  TimerWheel* _wheel;
+  uint64_t _expiry;
+  uint64_t _fired;
+  uint32_t _period;
+  uint32_t _slot;
+  bool _queued;
+};
+
+//Timer that calls a method of an object
+template <class T>
+class TimerMethod : public TimerTask
+{
+public:
+  //Signature of method to call on expiry
+  typedef void (T::*TimerCallback)(void);
+
+public:
+  TimerMethod(T* object, TimerCallback method)
+  {
+    //Assert valid arguments
+    assert((object != 0) && (method != 0));
+
+    //Initialize object and method pointers
+    _object = object;
+    _method = method;
+  }
+
+  virtual ~TimerMethod()
+  {
+  }
+
+  virtual void Run(void)
+  {
+    //Call the timer method
+    (_object->*_method)();
+  }
+
+private:
+  T* _object;
+  TimerCallback _method;
+};
+
+class TimerWheel
+{
+public:
+  //Default tick (microseconds)
+  static const uint32_t TICK_DEFAULT = 1000;
+
+  //Wheel geometry (four levels of 256 slots span 2^32 ticks)
+  static const uint32_t LEVEL_COUNT = 4;
+  static const uint32_t SLOT_BITS = 8;
+  static const uint32_t SLOT_COUNT = 1 << SLOT_BITS;
+
+public:
+  TimerWheel(uint32_t tickus=TICK_DEFAULT, Executor* exec=0);
+  ~TimerWheel();
+  uint32_t GetTick(void);
+  int Schedule(TimerTask* task, uint32_t delayus, uint32_t periodus=0);
+  int Cancel(TimerTask* task);
+  int GetActiveCount(uint32_t& val);
+  int GetScheduleCount(uint32_t& val);
+  int GetExpireCount(uint32_t& val);
+  int GetCancelCount(uint32_t& val);
+  int GetOverrunCount(uint32_t& val);
+  int GetDrift(uint32_t& val);
+  int GetJitter(uint32_t& val);
+
+private:
+  void Insert(TimerTask* task);
+  void Unlink(TimerTask* task);
+  void Enqueue(TimerTask* task);
+  void Dequeue(TimerTask* task);
+  void Advance(void);
+  void Dispatch(void);
+  uint64_t NextDue(void);
+  void WheelThread(void);
+
+private:
+  uint32_t _tickus;
+  Executor* _exec;
+  uint64_t _start;
+  uint64_t _now;
+  uint64_t _wakeat;
+  TimerTask* _slots[LEVEL_COUNT][SLOT_COUNT];
+  TimerTask* _runhead;
+  TimerTask* _runtail;
+  Mutex* _mutex;
+  QueueWaiter _waiter;
+  bool _stop;
+  uint32_t _activecount;
+  uint32_t _schedcount;
+  uint32_t _expirecount;
+  uint32_t _cancelcount;
+  uint32_t _overruncount;
+  uint64_t _latecount;
+  uint64_t _latesum;
+  uint64_t _latemin;
+  uint64_t _latemax;
+  Thread<TimerWheel>* _thread;
+};
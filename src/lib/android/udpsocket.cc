@@ -24,6 +24,7 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include "const.hh"
 #include "error.hh"
 #include "udpsocket.hh"
 #include <arpa/inet.h>
@@ -31,6 +32,7 @@
 #include <iostream>
 #include <netdb.h>
 #include <net/if.h>
+#include <poll.h>
 #include <string.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
@@ -39,7 +41,7 @@
 
 using namespace std;
 
-UDPSocket::UDPSocket(uint16_t port, const char* bindif)
+UDPSocket::UDPSocket(uint16_t port, const char* bindif, bool reuseport)
 {
   struct sockaddr_in addr;
   struct ifreq bindreq;
@@ -49,6 +51,14 @@ UDPSocket::UDPSocket(uint16_t port, const char* bindif)
   if((_socketfd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
     cout << __FILE__ << ":" << __LINE__ << " - Error creating socket" << "\n";
 
+  //Let several sockets bind the same port with the kernel spreading datagrams across them
+  if(reuseport)
+  {
+    optval = 1;
+    if(setsockopt(_socketfd, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) != 0)
+      cout << __FILE__ << ":" << __LINE__ << " - Error setting socket port reuse" << "\n";
+  }
+
   //Bind socket to specified port
   memset(&addr, 0, sizeof(addr));
   addr.sin_family = AF_INET;
@@ -78,6 +88,12 @@ UDPSocket::UDPSocket(uint16_t port, const char* bindif)
   optval = 10;
   if(setsockopt(_socketfd, IPPROTO_IP, IP_MULTICAST_TTL, &optval, sizeof(optval)) < 0)
     cout << __FILE__ << ":" << __LINE__ << " - Error setting TTL" << "\n";
+
+  //Have kernel report its receive queue drop count with each datagram
+  _dropcount = 0;
+  optval = 1;
+  if(setsockopt(_socketfd, SOL_SOCKET, SO_RXQ_OVFL, &optval, sizeof(optval)) < 0)
+    cout << __FILE__ << ":" << __LINE__ << " - Error enabling drop count" << "\n";
 }
 
 UDPSocket::~UDPSocket()
@@ -89,26 +105,20 @@ UDPSocket::~UDPSocket()
 
 uint32_t UDPSocket::RecvFrom(void* buf, uint32_t maxlen, uint32_t& srcipaddr, uint16_t& srcport)
 {
-  struct sockaddr_in src;
-  socklen_t srclen;
-  ssize_t retval;
+  uint32_t len;
 
   //Assert valid arguments
   assert((buf != 0) && (maxlen > 0));
 
-  //Read from socket
-  srclen = sizeof(src);
-  if((retval = recvfrom(_socketfd, buf, maxlen, 0, (struct sockaddr*)&src, &srclen)) <= 0)
+  //Receive batch of one
+  if(RecvBatch((uint8_t*)buf, maxlen, 1, &len, &srcipaddr, &srcport) != 1)
   {
     srcipaddr = 0;
     srcport = 0;
     return 0;
   }
 
-  //Return source information and received UDP payload length
-  srcipaddr = ntohl(src.sin_addr.s_addr);
-  srcport = ntohs(src.sin_port);
-  return (uint32_t)retval;
+  return len;
 }
 
 uint32_t UDPSocket::SendTo(const void* buf, uint32_t len, uint32_t dstipaddr, uint16_t dstport)
@@ -130,3 +140,189 @@ uint32_t UDPSocket::SendTo(const void* buf, uint32_t len, uint32_t dstipaddr, ui
 
   return len;
 }
+
+uint32_t UDPSocket::RecvBatch(uint8_t* bufs, uint32_t bufsiz, uint32_t maxcount, uint32_t* lens, uint32_t* srcipaddrs, uint16_t* srcports)
+{
+  struct mmsghdr msgs[BATCH_MAX];
+  struct iovec iovs[BATCH_MAX];
+  struct sockaddr_in srcs[BATCH_MAX];
+  uint8_t ctls[BATCH_MAX][CMSG_SPACE(sizeof(uint32_t))];
+  struct cmsghdr* cmsg;
+  int count;
+  int i;
+
+  //Assert valid arguments
+  assert((bufs != 0) && (bufsiz > 0) && (maxcount > 0) && (lens != 0) && (srcipaddrs != 0) && (srcports != 0));
+
+  //Limit to batch size
+  if(maxcount > BATCH_MAX)
+    maxcount = BATCH_MAX;
+
+  //Describe each receive buffer
+  memset(msgs, 0, sizeof(msgs[0]) * maxcount);
+  for(i=0; i<(int)maxcount; i++)
+  {
+    iovs[i].iov_base = &bufs[i * bufsiz];
+    iovs[i].iov_len = bufsiz;
+    msgs[i].msg_hdr.msg_name = &srcs[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof(srcs[i]);
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_control = ctls[i];
+    msgs[i].msg_hdr.msg_controllen = sizeof(ctls[i]);
+  }
+
+  //Wait for at least one datagram then take whatever else is already queued
+  if((count = recvmmsg(_socketfd, msgs, maxcount, MSG_WAITFORONE, NULL)) <= 0)
+    return 0;
+
+  //Return source information and received UDP payload lengths
+  for(i=0; i<count; i++)
+  {
+    lens[i] = msgs[i].msg_len;
+    srcipaddrs[i] = ntohl(srcs[i].sin_addr.s_addr);
+    srcports[i] = ntohs(srcs[i].sin_port);
+
+    //Remember latest kernel drop count
+    for(cmsg=CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg!=NULL; cmsg=CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg))
+      if((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SO_RXQ_OVFL))
+        memcpy(&_dropcount, CMSG_DATA(cmsg), sizeof(uint32_t));
+  }
+
+  return (uint32_t)count;
+}
+
+uint32_t UDPSocket::SendBatch(const uint8_t* bufs, uint32_t bufsiz, const uint32_t* lens, const uint32_t* dstipaddrs, const uint16_t* dstports, uint32_t count)
+{
+  struct mmsghdr msgs[BATCH_MAX];
+  struct iovec iovs[BATCH_MAX];
+  struct sockaddr_in dsts[BATCH_MAX];
+  uint32_t sent;
+  uint32_t done;
+  uint32_t n;
+  uint32_t i;
+  int retval;
+
+  //Assert valid arguments
+  assert((bufs != 0) && (bufsiz > 0) && (lens != 0) && (dstipaddrs != 0) && (dstports != 0));
+
+  //Send in chunks of batch size
+  for(done=0, sent=0; done<count; done+=n)
+  {
+    //Determine chunk size
+    n = count - done;
+    if(n > BATCH_MAX)
+      n = BATCH_MAX;
+
+    //Describe each datagram of chunk
+    memset(msgs, 0, sizeof(msgs[0]) * n);
+    memset(dsts, 0, sizeof(dsts[0]) * n);
+    for(i=0; i<n; i++)
+    {
+      dsts[i].sin_family = AF_INET;
+      dsts[i].sin_addr.s_addr = htonl(dstipaddrs[done + i]);
+      dsts[i].sin_port = htons(dstports[done + i]);
+      iovs[i].iov_base = (void*)&bufs[(done + i) * bufsiz];
+      iovs[i].iov_len = lens[done + i];
+      msgs[i].msg_hdr.msg_name = &dsts[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(dsts[i]);
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    //Send chunk, skipping any datagram the kernel rejects
+    for(i=0; i<n; )
+    {
+      if((retval = sendmmsg(_socketfd, &msgs[i], n - i, 0)) <= 0)
+      {
+        i++;
+        continue;
+      }
+
+      i += (uint32_t)retval;
+      sent += (uint32_t)retval;
+    }
+  }
+
+  return sent;
+}
+
+int UDPSocket::GetRecvBufSize(uint32_t& val)
+{
+  return GetBufSize(SO_RCVBUF, val);
+}
+
+int UDPSocket::SetRecvBufSize(uint32_t val)
+{
+  return SetBufSize(SO_RCVBUF, val);
+}
+
+int UDPSocket::GetSendBufSize(uint32_t& val)
+{
+  return GetBufSize(SO_SNDBUF, val);
+}
+
+int UDPSocket::SetSendBufSize(uint32_t val)
+{
+  return SetBufSize(SO_SNDBUF, val);
+}
+
+uint32_t UDPSocket::GetDropCount(void)
+{
+  return _dropcount;
+}
+
+int UDPSocket::WaitReadable(uint32_t msecs)
+{
+  struct pollfd pfd;
+  int retval;
+
+  //Wait for a datagram (or pending error) to be readable
+  pfd.fd = _socketfd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  if((retval = poll(&pfd, 1, (msecs == WAIT_INF) ? -1 : (int)msecs)) < 0)
+    return ERR_UNSPEC;
+
+  //Check for timeout
+  if(retval == 0)
+    return ERR_TIMEOUT;
+
+  return ERR_NONE;
+}
+
+int UDPSocket::GetFD(void)
+{
+  return _socketfd;
+}
+
+int UDPSocket::GetBufSize(int optname, uint32_t& val)
+{
+  int optval;
+  socklen_t optlen;
+
+  //Get buffer size (kernel reports double the requested size to cover bookkeeping)
+  optlen = sizeof(optval);
+  if(getsockopt(_socketfd, SOL_SOCKET, optname, &optval, &optlen) != 0)
+    return ERR_UNSPEC;
+
+  val = (uint32_t)optval;
+
+  return ERR_NONE;
+}
+
+int UDPSocket::SetBufSize(int optname, uint32_t val)
+{
+  int optval;
+
+  //Check range
+  if(val > 0x7FFFFFFF)
+    return ERR_RANGE;
+
+  //Set buffer size (kernel caps it at the system maximum)
+  optval = (int)val;
+  if(setsockopt(_socketfd, SOL_SOCKET, optname, &optval, sizeof(optval)) != 0)
+    return ERR_UNSPEC;
+
+  return ERR_NONE;
+}
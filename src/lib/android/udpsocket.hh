@@ -31,11 +31,29 @@
 class UDPSocket
 {
 public:
-  UDPSocket(uint16_t port=0, const char* bindif=0);
+  //Maximum datagrams moved per batched system call
+  static const uint32_t BATCH_MAX = 64;
+
+public:
+  UDPSocket(uint16_t port=0, const char* bindif=0, bool reuseport=false);
   virtual ~UDPSocket();
   uint32_t RecvFrom(void* buf, uint32_t maxlen, uint32_t& srcipaddr, uint16_t& srcport);
   uint32_t SendTo(const void* buf, uint32_t len, uint32_t dstipaddr, uint16_t dstport);
+  uint32_t RecvBatch(uint8_t* bufs, uint32_t bufsiz, uint32_t maxcount, uint32_t* lens, uint32_t* srcipaddrs, uint16_t* srcports);
+  uint32_t SendBatch(const uint8_t* bufs, uint32_t bufsiz, const uint32_t* lens, const uint32_t* dstipaddrs, const uint16_t* dstports, uint32_t count);
+  int GetRecvBufSize(uint32_t& val);
+  int SetRecvBufSize(uint32_t val);
+  int GetSendBufSize(uint32_t& val);
+  int SetSendBufSize(uint32_t val);
+  uint32_t GetDropCount(void);
+  int WaitReadable(uint32_t msecs);
+  int GetFD(void);
+
+private:
+  int GetBufSize(int optname, uint32_t& val);
+  int SetBufSize(int optname, uint32_t val);
 
 private:
   int _socketfd;
+  uint32_t _dropcount;
 };
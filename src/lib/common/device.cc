@@ -25,6 +25,8 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "device.hh"
+#include "error.hh"
+#include "thread.hh"
 
 Device::Device()
 {
@@ -43,3 +45,72 @@ uint32_t Device::Write(const void*, uint32_t)
 {
   return 0;
 }
+
+uint32_t Device::ReadFrom(void* buf, uint32_t maxlen, uint64_t& peer)
+{
+  //Point to point devices have no peer to report
+  peer = PEER_NONE;
+
+  return Read(buf, maxlen);
+}
+
+uint32_t Device::WriteTo(const void* buf, uint32_t len, uint64_t)
+{
+  //Point to point devices only have one destination
+  return Write(buf, len);
+}
+
+uint32_t Device::ReadBatch(uint8_t* bufs, uint32_t bufsiz, uint32_t maxcount, uint32_t* lens, uint64_t* peers)
+{
+  //Devices without batch support read one message at a time
+  if((maxcount == 0) || ((lens[0] = ReadFrom(bufs, bufsiz, peers[0])) == 0))
+    return 0;
+
+  return 1;
+}
+
+uint32_t Device::WriteBatch(const uint8_t* bufs, uint32_t bufsiz, const uint32_t* lens, const uint64_t* peers, uint32_t count)
+{
+  uint32_t sent;
+  uint32_t i;
+
+  //Devices without batch support write one message at a time
+  for(i=0, sent=0; i<count; i++)
+    if(WriteTo(&bufs[i * bufsiz], lens[i], peers[i]) == lens[i])
+      sent++;
+
+  return sent;
+}
+
+int Device::GetRecvBufSize(uint32_t&)
+{
+  return ERR_NOIMP;
+}
+
+int Device::SetRecvBufSize(uint32_t)
+{
+  return ERR_NOIMP;
+}
+
+int Device::GetSendBufSize(uint32_t&)
+{
+  return ERR_NOIMP;
+}
+
+int Device::SetSendBufSize(uint32_t)
+{
+  return ERR_NOIMP;
+}
+
+int Device::GetDropCount(uint32_t&)
+{
+  return ERR_NOIMP;
+}
+
+int Device::WaitReadable(uint32_t msecs)
+{
+  //Devices that cannot report readiness just wait out the timeout
+  ThreadSleep(msecs);
+
+  return ERR_TIMEOUT;
+}
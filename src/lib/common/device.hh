@@ -30,9 +30,23 @@
 
 class Device
 {
+public:
+  //Peer handle meaning the device's default destination
+  static const uint64_t PEER_NONE = 0;
+
 public:
   Device();
   virtual ~Device();
   virtual uint32_t Read(void* buf, uint32_t maxlen);
   virtual uint32_t Write(const void* buf, uint32_t len);
+  virtual uint32_t ReadFrom(void* buf, uint32_t maxlen, uint64_t& peer);
+  virtual uint32_t WriteTo(const void* buf, uint32_t len, uint64_t peer);
+  virtual uint32_t ReadBatch(uint8_t* bufs, uint32_t bufsiz, uint32_t maxcount, uint32_t* lens, uint64_t* peers);
+  virtual uint32_t WriteBatch(const uint8_t* bufs, uint32_t bufsiz, const uint32_t* lens, const uint64_t* peers, uint32_t count);
+  virtual int GetRecvBufSize(uint32_t& val);
+  virtual int SetRecvBufSize(uint32_t val);
+  virtual int GetSendBufSize(uint32_t& val);
+  virtual int SetSendBufSize(uint32_t val);
+  virtual int GetDropCount(uint32_t& val);
+  virtual int WaitReadable(uint32_t msecs);
 };
@@ -24,139 +24,144 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include "const.hh"
 #include "error.hh"
 #include "slipframer.hh"
 #include <cassert>
+#include <string.h>
 
-SLIPFramer::SLIPFramer(Device* lowdev, uint32_t maxpldsiz)
-: Device()
+SLIPDecoder::SLIPDecoder(uint32_t maxpldsiz)
 {
   //Assert valid arguments
-  assert((lowdev != 0) && (maxpldsiz > 0));
+  assert(maxpldsiz > 0);
 
   //Initialize member variables
-  _lowdev = lowdev;
   _maxpldsiz = maxpldsiz;
-  _txbuf = new uint8_t[_maxpldsiz*2 + 2];
+  _rxbuf = new uint8_t[_maxpldsiz];
+  _rxind = 0;
+  _rxmode = RX_MODE_NORMAL;
+  _framelen = 0;
 }
 
-SLIPFramer::~SLIPFramer()
+SLIPDecoder::~SLIPDecoder()
 {
   //Cleanup
-  delete[] _txbuf;
-  delete _lowdev;
+  delete[] _rxbuf;
 }
 
-uint32_t SLIPFramer::Read(void* buf, uint32_t maxlen)
+void SLIPDecoder::Reset(void)
 {
-  uint8_t ch;
-  uint32_t rlen;
-  uint32_t rbufind;
-  int rxmode;
-
-  //Assert valid arguments
-  assert((buf != 0) && (maxlen > 0));
-
-  //Initialize state variables
-  rxmode = RX_MODE_NORMAL;
-  rbufind = 0;
+  //Reset state machine
+  _rxind = 0;
+  _rxmode = RX_MODE_NORMAL;
+  _framelen = 0;
+}
 
-  //Read a byte at a time
-  while((rlen = _lowdev->Read(&ch, 1)) == 1)
+bool SLIPDecoder::Decode(uint8_t ch)
+{
+  //Process depending on mode
+  switch(_rxmode)
   {
-    //Process depending on mode
-    switch(rxmode)
+  case RX_MODE_NORMAL:
+    //Check for END byte
+    if(ch == SLIPFramer::BYTE_END)
     {
-    case RX_MODE_NORMAL:
-      //Check for END byte
-      if(ch == BYTE_END)
+      //Check for any data received before END byte
+      if(_rxind != 0)
       {
-        //Check for any data received before END byte
-        if(rbufind != 0)
-          return rbufind;
-
-        //Just read more data
-        break;
+        //Frame complete
+        _framelen = _rxind;
+        _rxind = 0;
+        return true;
       }
 
-      //Check for escape byte
-      if(ch == BYTE_ESC)
-      {
-        //Go to escape mode
-        rxmode = RX_MODE_ESCAPE;
-        break;
-      }
-
-      //Check for not enough room
-      if(rbufind >= maxlen)
-      {
-        //Reset state machine
-        rbufind = 0;
-        rxmode = RX_MODE_NORMAL;
-        break;
-      }
+      //Just read more data
+      break;
+    }
 
-      //Buffer received byte
-      *((uint8_t*)buf + rbufind++) = ch;
+    //Check for escape byte
+    if(ch == SLIPFramer::BYTE_ESC)
+    {
+      //Go to escape mode
+      _rxmode = RX_MODE_ESCAPE;
+      break;
+    }
 
+    //Check for not enough room
+    if(_rxind >= _maxpldsiz)
+    {
+      //Reset state machine
+      Reset();
       break;
-    case RX_MODE_ESCAPE:
-      //Check for not enough room
-      if(rbufind >= maxlen)
-      {
-        //Reset state machine
-        rbufind = 0;
-        rxmode = RX_MODE_NORMAL;
-        break;
-      }
+    }
 
-      //Decode escaped byte
-      switch(ch)
-      {
-      case BYTE_ESC_END:
-        //Buffer decoded END byte and go back to normal mode
-        *((uint8_t*)buf + rbufind++) = BYTE_END;
-        rxmode = RX_MODE_NORMAL;
-        break;
-      case BYTE_ESC_ESC:
-        //Buffer decoded ESC byte and go back to normal mode
-        *((uint8_t*)buf + rbufind++) = BYTE_ESC;
-        rxmode = RX_MODE_NORMAL;
-        break;
-      default:
-        //Reset state machine on invalid escape sequence
-        rbufind = 0;
-        rxmode = RX_MODE_NORMAL;
-        break;
-      }
+    //Buffer received byte
+    _rxbuf[_rxind++] = ch;
+
+    break;
+  case RX_MODE_ESCAPE:
+    //Check for not enough room
+    if(_rxind >= _maxpldsiz)
+    {
+      //Reset state machine
+      Reset();
+      break;
+    }
 
+    //Decode escaped byte
+    switch(ch)
+    {
+    case SLIPFramer::BYTE_ESC_END:
+      //Buffer decoded END byte and go back to normal mode
+      _rxbuf[_rxind++] = SLIPFramer::BYTE_END;
+      _rxmode = RX_MODE_NORMAL;
+      break;
+    case SLIPFramer::BYTE_ESC_ESC:
+      //Buffer decoded ESC byte and go back to normal mode
+      _rxbuf[_rxind++] = SLIPFramer::BYTE_ESC;
+      _rxmode = RX_MODE_NORMAL;
       break;
     default:
-      //Reset state machine on invalid state
-      rbufind = 0;
-      rxmode = RX_MODE_NORMAL;
+      //Reset state machine on invalid escape sequence
+      Reset();
       break;
     }
+
+    break;
+  default:
+    //Reset state machine on invalid state
+    Reset();
+    break;
   }
 
-  //An error occurred in lower level device read
-  return rbufind;
+  //Frame not complete
+  return false;
 }
 
-uint32_t SLIPFramer::Write(const void* buf, uint32_t len)
+const uint8_t* SLIPDecoder::GetFrame(void)
+{
+  return _rxbuf;
+}
+
+uint32_t SLIPDecoder::GetLength(void)
+{
+  return _framelen;
+}
+
+uint32_t SLIPFramer::Encode(const void* buf, uint32_t len, uint8_t* frame)
 {
   uint32_t i;
   uint32_t byteind;
   uint8_t ch;
 
-  //Assert valid arguments
-  assert((buf != 0) && (len > 0) && (len <= _maxpldsiz));
+  //Assert valid arguments (frame must hold len*2 + 2 bytes)
+  assert((buf != 0) && (frame != 0));
 
   //Zero the byte index
   byteind = 0;
 
   //First byte is always END byte
-  _txbuf[byteind++] = BYTE_END;
+  frame[byteind++] = BYTE_END;
 
   //Loop through all bytes to be sent
   for(i=0; i<len; i++)
@@ -164,27 +169,121 @@ uint32_t SLIPFramer::Write(const void* buf, uint32_t len)
     //Get byte
     ch = *((uint8_t*)buf + i);
 
-    //Put data into transmit buffer
+    //Put data into frame
     switch(ch)
     {
     case BYTE_END:
       //Byte stuff END byte
-      _txbuf[byteind++] = BYTE_ESC;
-      _txbuf[byteind++] = BYTE_ESC_END;
+      frame[byteind++] = BYTE_ESC;
+      frame[byteind++] = BYTE_ESC_END;
       break;
     case BYTE_ESC:
       //Byte stuff ESC byte
-      _txbuf[byteind++] = BYTE_ESC;
-      _txbuf[byteind++] = BYTE_ESC_ESC;
+      frame[byteind++] = BYTE_ESC;
+      frame[byteind++] = BYTE_ESC_ESC;
       break;
     default:
       //No need for byte stuffing
-      _txbuf[byteind++] = ch;
+      frame[byteind++] = ch;
     }
   }
 
   //Last byte is always END
-  _txbuf[byteind++] = BYTE_END;
+  frame[byteind++] = BYTE_END;
+
+  return byteind;
+}
+
+SLIPFramer::SLIPFramer(Device* lowdev, uint32_t maxpldsiz)
+: Device()
+{
+  //Assert valid arguments
+  assert((lowdev != 0) && (maxpldsiz > 0));
+
+  //Initialize member variables
+  _lowdev = lowdev;
+  _maxpldsiz = maxpldsiz;
+  _decoder = new SLIPDecoder(_maxpldsiz);
+  _rxpipe = new SPSCPipe(_maxpldsiz*2 + 2);
+  _txbuf = new uint8_t[_maxpldsiz*2 + 2];
+}
+
+SLIPFramer::~SLIPFramer()
+{
+  //Cleanup
+  delete[] _txbuf;
+  delete _rxpipe;
+  delete _decoder;
+  delete _lowdev;
+}
+
+uint32_t SLIPFramer::Read(void* buf, uint32_t maxlen)
+{
+  const uint8_t* data;
+  uint8_t* space;
+  uint32_t avail;
+  uint32_t i;
+  uint32_t len;
+
+  //Assert valid arguments
+  assert((buf != 0) && (maxlen > 0));
+
+  //Go until a frame is decoded or lower level device fails
+  while(true)
+  {
+    //Decode buffered bytes straight out of the receive ring
+    while((avail = _rxpipe->Peek(data, WAIT_NONE)) != 0)
+    {
+      //Decode bytes until a frame completes
+      for(i=0; i<avail; i++)
+        if(_decoder->Decode(data[i]))
+          break;
+
+      //Check for frame not complete (all bytes used)
+      if(i == avail)
+      {
+        _rxpipe->Consume(avail);
+        continue;
+      }
+
+      //Release bytes up to and including END byte
+      _rxpipe->Consume(i + 1);
+
+      //Drop frames that don't fit in caller's buffer
+      if((len = _decoder->GetLength()) > maxlen)
+        continue;
+
+      //Copy frame to caller's buffer
+      memcpy(buf, _decoder->GetFrame(), len);
+
+      return len;
+    }
+
+    //Rewind empty ring (this thread is both writer and reader) so the whole ring is one contiguous space
+    _rxpipe->Reset();
+
+    //Read whatever the lower level device has directly into the ring
+    avail = _rxpipe->Reserve(space, WAIT_NONE);
+    if((len = _lowdev->Read(space, avail)) == 0)
+      break;
+
+    _rxpipe->Commit(len);
+  }
+
+  //An error occurred in lower level device read so discard partial frame
+  _decoder->Reset();
+  return 0;
+}
+
+uint32_t SLIPFramer::Write(const void* buf, uint32_t len)
+{
+  uint32_t byteind;
+
+  //Assert valid arguments
+  assert((buf != 0) && (len > 0) && (len <= _maxpldsiz));
+
+  //Encode message into transmit buffer
+  byteind = Encode(buf, len, _txbuf);
 
   //Write transmit message to the lower device and check for error
   if(_lowdev->Write(_txbuf, byteind) != byteind)
@@ -192,3 +291,13 @@ uint32_t SLIPFramer::Write(const void* buf, uint32_t len)
 
   return len;
 }
+
+int SLIPFramer::WaitReadable(uint32_t msecs)
+{
+  //Check for bytes already buffered from lower device
+  if(_rxpipe->GetCount() != 0)
+    return ERR_NONE;
+
+  //Frames arrive through lower device
+  return _lowdev->WaitReadable(msecs);
+}
@@ -27,29 +27,55 @@
 #pragma once
 
 #include "device.hh"
+#include "pipe.hh"
 #include <inttypes.h>
 
-class SLIPFramer : public Device
+class SLIPDecoder
 {
 public:
-  SLIPFramer(Device* lowdev, uint32_t maxpldsiz);
-  virtual ~SLIPFramer();
-  virtual uint32_t Read(void* buf, uint32_t maxlen);
-  virtual uint32_t Write(const void* buf, uint32_t len);
+  SLIPDecoder(uint32_t maxpldsiz);
+  ~SLIPDecoder();
+  void Reset(void);
+  bool Decode(uint8_t ch);
+  const uint8_t* GetFrame(void);
+  uint32_t GetLength(void);
 
 private:
   //Receive states
   static const uint32_t RX_MODE_NORMAL = 0;
   static const uint32_t RX_MODE_ESCAPE = 1;
 
+private:
+  uint32_t _maxpldsiz;
+  uint8_t* _rxbuf;
+  uint32_t _rxind;
+  uint32_t _rxmode;
+  uint32_t _framelen;
+};
+
+class SLIPFramer : public Device
+{
+public:
   //Special bytes
   static const uint8_t BYTE_END = 0xC0;
   static const uint8_t BYTE_ESC = 0xDB;
   static const uint8_t BYTE_ESC_END = 0xDC;
   static const uint8_t BYTE_ESC_ESC = 0xDD;
 
+public:
+  static uint32_t Encode(const void* buf, uint32_t len, uint8_t* frame);
+
+public:
+  SLIPFramer(Device* lowdev, uint32_t maxpldsiz);
+  virtual ~SLIPFramer();
+  virtual uint32_t Read(void* buf, uint32_t maxlen);
+  virtual uint32_t Write(const void* buf, uint32_t len);
+  virtual int WaitReadable(uint32_t msecs);
+
 private:
   Device* _lowdev;
   uint32_t _maxpldsiz;
+  SLIPDecoder* _decoder;
+  SPSCPipe* _rxpipe;
   uint8_t* _txbuf;
 };
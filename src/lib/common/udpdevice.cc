@@ -39,10 +39,10 @@
 
 using namespace std;
 
-UDPDevice::UDPDevice(uint16_t port, const char* bindif, const char* dstipaddr, uint16_t dstport)
+UDPDevice::UDPDevice(uint16_t port, const char* bindif, const char* dstipaddr, uint16_t dstport, bool reuseport)
 {
   //Create socket
-  _sock = new UDPSocket(port, bindif);
+  _sock = new UDPSocket(port, bindif, reuseport);
 
   //Create mutex
   _mutex = new Mutex();
@@ -78,15 +78,11 @@ UDPDevice::~UDPDevice()
 
 uint32_t UDPDevice::Read(void* buf, uint32_t maxlen)
 {
-  uint32_t srcipaddr;
-  uint16_t srcport;
+  uint64_t peer;
   uint32_t retval;
 
-  //Assert valid arguments
-  assert((buf != 0) && (maxlen > 0));
-
   //Read from socket
-  if((retval = _sock->RecvFrom(buf, maxlen, srcipaddr, srcport)) == 0)
+  if((retval = ReadFrom(buf, maxlen, peer)) == 0)
     return 0;
 
   //Begin mutual exclusion
@@ -96,8 +92,8 @@ uint32_t UDPDevice::Read(void* buf, uint32_t maxlen)
   if(_setdstonread)
   {
     //Set destination to source of incoming datagram
-    _dstipaddr = srcipaddr;
-    _dstport = srcport;
+    _dstipaddr = (uint32_t)(peer >> 16);
+    _dstport = (uint16_t)peer;
   }
 
   //End mutual exclusion
@@ -127,3 +123,131 @@ uint32_t UDPDevice::Write(const void* buf, uint32_t len)
   //Write to socket
   return _sock->SendTo(buf, len, dstipaddr, dstport);
 }
+
+uint32_t UDPDevice::ReadFrom(void* buf, uint32_t maxlen, uint64_t& peer)
+{
+  uint32_t srcipaddr;
+  uint16_t srcport;
+  uint32_t retval;
+
+  //Assert valid arguments
+  assert((buf != 0) && (maxlen > 0));
+
+  //Read from socket
+  if((retval = _sock->RecvFrom(buf, maxlen, srcipaddr, srcport)) == 0)
+    return 0;
+
+  //Peer is source IP address and port of incoming datagram
+  peer = ((uint64_t)srcipaddr << 16) | srcport;
+
+  return retval;
+}
+
+uint32_t UDPDevice::WriteTo(const void* buf, uint32_t len, uint64_t peer)
+{
+  //Assert valid arguments
+  assert((buf != 0) && (len > 0));
+
+  //Use default destination if no peer given
+  if(peer == PEER_NONE)
+    return Write(buf, len);
+
+  //Write to socket
+  return _sock->SendTo(buf, len, (uint32_t)(peer >> 16), (uint16_t)peer);
+}
+
+uint32_t UDPDevice::ReadBatch(uint8_t* bufs, uint32_t bufsiz, uint32_t maxcount, uint32_t* lens, uint64_t* peers)
+{
+  uint32_t count;
+  uint32_t i;
+
+  //Assert valid arguments
+  assert((bufs != 0) && (bufsiz > 0) && (lens != 0) && (peers != 0));
+
+  //Receive as many datagrams as are queued (up to limit) in one call
+  if((count = _sock->RecvBatch(bufs, bufsiz, maxcount, lens, _rxipaddrs, _rxports)) == 0)
+    return 0;
+
+  //Peers are source IP addresses and ports of incoming datagrams
+  for(i=0; i<count; i++)
+    peers[i] = ((uint64_t)_rxipaddrs[i] << 16) | _rxports[i];
+
+  return count;
+}
+
+uint32_t UDPDevice::WriteBatch(const uint8_t* bufs, uint32_t bufsiz, const uint32_t* lens, const uint64_t* peers, uint32_t count)
+{
+  uint32_t sent;
+  uint32_t done;
+  uint32_t n;
+  uint32_t i;
+
+  //Assert valid arguments
+  assert((bufs != 0) && (bufsiz > 0) && (lens != 0) && (peers != 0));
+
+  //Begin mutual exclusion
+  _mutex->Wait();
+
+  //Send in chunks of socket batch size
+  for(done=0, sent=0; done<count; done+=n)
+  {
+    //Determine chunk size
+    n = count - done;
+    if(n > UDPSocket::BATCH_MAX)
+      n = UDPSocket::BATCH_MAX;
+
+    //Convert peers to destinations (no peer means default destination)
+    for(i=0; i<n; i++)
+    {
+      if(peers[done + i] == PEER_NONE)
+      {
+        _txipaddrs[i] = _dstipaddr;
+        _txports[i] = _dstport;
+      }
+      else
+      {
+        _txipaddrs[i] = (uint32_t)(peers[done + i] >> 16);
+        _txports[i] = (uint16_t)peers[done + i];
+      }
+    }
+
+    //Send chunk in one call
+    sent += _sock->SendBatch(&bufs[done * bufsiz], bufsiz, &lens[done], _txipaddrs, _txports, n);
+  }
+
+  //End mutual exclusion
+  _mutex->Give();
+
+  return sent;
+}
+
+int UDPDevice::GetRecvBufSize(uint32_t& val)
+{
+  return _sock->GetRecvBufSize(val);
+}
+
+int UDPDevice::SetRecvBufSize(uint32_t val)
+{
+  return _sock->SetRecvBufSize(val);
+}
+
+int UDPDevice::GetSendBufSize(uint32_t& val)
+{
+  return _sock->GetSendBufSize(val);
+}
+
+int UDPDevice::SetSendBufSize(uint32_t val)
+{
+  return _sock->SetSendBufSize(val);
+}
+
+int UDPDevice::GetDropCount(uint32_t& val)
+{
+  val = _sock->GetDropCount();
+  return ERR_NONE;
+}
+
+int UDPDevice::WaitReadable(uint32_t msecs)
+{
+  return _sock->WaitReadable(msecs);
+}
@@ -35,10 +35,20 @@
 class UDPDevice : public Device
 {
 public:
-  UDPDevice(uint16_t port, const char* bindif=0, const char* destipaddr=0, uint16_t destport=0);
+  UDPDevice(uint16_t port, const char* bindif=0, const char* destipaddr=0, uint16_t destport=0, bool reuseport=false);
   virtual ~UDPDevice();
   uint32_t Read(void* buf, uint32_t maxlen);
   uint32_t Write(const void* buf, uint32_t len);
+  uint32_t ReadFrom(void* buf, uint32_t maxlen, uint64_t& peer);
+  uint32_t WriteTo(const void* buf, uint32_t len, uint64_t peer);
+  uint32_t ReadBatch(uint8_t* bufs, uint32_t bufsiz, uint32_t maxcount, uint32_t* lens, uint64_t* peers);
+  uint32_t WriteBatch(const uint8_t* bufs, uint32_t bufsiz, const uint32_t* lens, const uint64_t* peers, uint32_t count);
+  int GetRecvBufSize(uint32_t& val);
+  int SetRecvBufSize(uint32_t val);
+  int GetSendBufSize(uint32_t& val);
+  int SetSendBufSize(uint32_t val);
+  int GetDropCount(uint32_t& val);
+  int WaitReadable(uint32_t msecs);
 
 private:
   UDPSocket* _sock;
@@ -46,4 +56,8 @@ private:
   uint32_t _dstipaddr;
   uint16_t _dstport;
   bool _setdstonread;
+  uint32_t _rxipaddrs[UDPSocket::BATCH_MAX];
+  uint16_t _rxports[UDPSocket::BATCH_MAX];
+  uint32_t _txipaddrs[UDPSocket::BATCH_MAX];
+  uint16_t _txports[UDPSocket::BATCH_MAX];
 };
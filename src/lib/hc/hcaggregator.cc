@@ -44,6 +44,17 @@ HCAggregator::HCAggregator(const string& filename)
   _conn = 0;
   _conncount = 0;
 
+  //Initialize connection establishment information
+  _maxparallel = MAXPARALLEL_DEFAULT;
+  _retryperiod = RETRYPERIOD_DEFAULT;
+  _nextconn = 0;
+  _connmutex = new Mutex();
+  _retrythread = new Thread<HCAggregator>(this, &HCAggregator::RetryThread);
+
+  //Initialize shared executor information
+  _workers = WORKERS_DEFAULT;
+  _exec = 0;
+
   //Initialize query server information
   _qsrvdev = 0;
   _qsrv = 0;
@@ -66,11 +77,23 @@ HCAggregator::HCAggregator(const string& filename)
     return;
   }
 
+  //Run wildcard get batches for all connections on a shared pool of workers rather than a thread each
+  _exec = new Executor(_workers);
+  _srv->SetExecutor(_exec);
+  if(_qsrv != 0)
+    _qsrv->SetExecutor(_exec);
+
+  //Establish all connections
+  ConnectAll();
+
   //Add parameters to server starting at top container
   AddParamsToServer(_topcont);
 
   //Start server
   _srv->Start();
+
+  //Start retrying any connections that failed in the background
+  _retrythread->Start();
 }
 
 HCAggregator::~HCAggregator()
@@ -78,16 +101,19 @@ HCAggregator::~HCAggregator()
   uint32_t i;
 
   //Cleanup
+  delete _retrythread;
   delete _srv;
   delete _srvdev;
   delete _qsrv;
   delete _qsrvdev;
+  delete _exec;
 
   for(i=0; i<_conncount; i++)
-    if(_conn[i] == 0)
+    if(_conn[i] != 0)
       delete _conn[i];
 
   delete[] _conn;
+  delete _connmutex;
   delete _topcont;
 }
 
@@ -121,6 +147,8 @@ HCServer* HCAggregator::ParseServer(XMLElement* pelt)
   string name;
   uint16_t port;
   uint16_t qport;
+  uint32_t pidwidth;
+  string transport;
 
   //Check for null parent element
   if(pelt == 0)
@@ -150,6 +178,28 @@ HCServer* HCAggregator::ParseServer(XMLElement* pelt)
   if(!ParseValue(pelt, "port", port))
     return 0;
 
+  //Parse optional PID width (wide PIDs lift the limit on aggregated parameters)
+  pidwidth = 16;
+  if((pelt->FirstChildElement("pidwidth") != 0) && (!ParseValue(pelt, "pidwidth", pidwidth) || ((pidwidth != 16) && (pidwidth != 32))))
+    return 0;
+
+  //Parse optional maximum number of connections to establish concurrently
+  if((pelt->FirstChildElement("maxparallel") != 0) && (!ParseValue(pelt, "maxparallel", _maxparallel) || (_maxparallel == 0)))
+    return 0;
+
+  //Parse optional period between reconnect attempts
+  if((pelt->FirstChildElement("retryperiod") != 0) && !ParseValue(pelt, "retryperiod", _retryperiod))
+    return 0;
+
+  //Parse optional number of shared executor workers
+  if((pelt->FirstChildElement("workers") != 0) && !ParseValue(pelt, "workers", _workers))
+    return 0;
+
+  //Parse optional server transport (io_uring falls back to plain sockets where unavailable)
+  transport = "udp";
+  if((pelt->FirstChildElement("transport") != 0) && (!ParseValue(pelt, "transport", transport) || ((transport != "udp") && (transport != "uring"))))
+    return 0;
+
   //Check for optional query server
   if(ParseValue(pelt, "qport", qport))
   {
@@ -161,18 +211,21 @@ HCServer* HCAggregator::ParseServer(XMLElement* pelt)
   }
 
   //Create server device
-  _srvdev = new UDPDevice(port);
+  _srvdev = NewUDPDevice(port, 0, 0, transport == "uring");
 
   //Create server
-  return new HCServer(_srvdev, _topcont, name, __DATE__ " " __TIME__);
+  return new HCServer(_srvdev, _topcont, name, __DATE__ " " __TIME__, (pidwidth == 32) ? HCServer::PID_MAX_WIDE : HCServer::PID_MAX);
 }
 
 HCConnection* HCAggregator::ParseConn(XMLElement* pelt)
 {
   string name;
   uint32_t timeout;
+  uint32_t primary;
+  uint32_t holdoff;
   Device* dev;
   XMLElement* elt;
+  HCConnection* conn;
 
   //Check for null parent element
   if(pelt == 0)
@@ -186,24 +239,211 @@ HCConnection* HCAggregator::ParseConn(XMLElement* pelt)
   if(!ParseValue(pelt, "timeout", timeout))
     return 0;
 
-  //Initialize device pointer to invalid
-  dev = 0;
+  //Check for replicated server (equivalent endpoints listed as replicas)
+  if((elt = pelt->FirstChildElement("replica")) == 0)
+  {
+    //Parse device and check for error
+    if((dev = ParseDevice(pelt)) == 0)
+      return 0;
+
+    //Create connection (connected later so connections can be established concurrently)
+    return new HCConnection(dev, _topcont, name, timeout, "", false);
+  }
+
+  //Parse device of first replica and check for error
+  if((dev = ParseDevice(elt)) == 0)
+    return 0;
+
+  //Create connection
+  conn = new HCConnection(dev, _topcont, name, timeout, "", false);
+
+  //Parse devices of remaining replicas and add to connection
+  for(elt = elt->NextSiblingElement("replica"); elt != 0; elt = elt->NextSiblingElement("replica"))
+  {
+    //Parse device and check for error
+    if((dev = ParseDevice(elt)) == 0)
+    {
+      delete conn;
+      return 0;
+    }
+
+    //Add replica
+    conn->AddReplica(dev);
+  }
+
+  //Parse optional index of replica writes go to (defaults to first)
+  if(pelt->FirstChildElement("primary") != 0)
+  {
+    //Parse primary element and check for error
+    if(!ParseValue(pelt, "primary", primary))
+    {
+      delete conn;
+      return 0;
+    }
+
+    //Set primary replica
+    conn->SetPrimary(primary);
+  }
+
+  //Parse optional time (ms) a failed replica is avoided
+  if(pelt->FirstChildElement("holdoff") != 0)
+  {
+    //Parse holdoff element and check for error
+    if(!ParseValue(pelt, "holdoff", holdoff))
+    {
+      delete conn;
+      return 0;
+    }
+
+    //Set holdoff
+    conn->SetHoldoff(holdoff);
+  }
+
+  return conn;
+}
+
+Device* HCAggregator::ParseDevice(XMLElement* pelt)
+{
+  XMLElement* elt;
+
+  //Check for null parent element
+  if(pelt == 0)
+    return 0;
 
   //Look for various devices
   if((elt = pelt->FirstChildElement("udpsocket")) != 0)
-    dev = ParseUDPSocket(elt);
+    return ParseUDPSocket(elt);
+  else if((elt = pelt->FirstChildElement("uringsocket")) != 0)
+    return ParseUDPSocket(elt, true);
   else if((elt = pelt->FirstChildElement("slipframer")) != 0)
-    dev = ParseSLIPFramer(elt);
+    return ParseSLIPFramer(elt);
+  else if((elt = pelt->FirstChildElement("shm")) != 0)
+    return ParseSHM(elt);
+  else if((elt = pelt->FirstChildElement("unixclient")) != 0)
+    return ParseUnixClient(elt);
+
+  //Device not found
+  return 0;
+}
 
-  //Check for device not found
-  if(dev == 0)
-    return 0;
+void HCAggregator::ConnectAll(void)
+{
+  uint32_t i;
+  uint32_t threadcount;
+  Thread<HCAggregator>** threads;
 
-  //Create connection
-  return new HCConnection(dev, _topcont, name, timeout);
+  //Limit number of connect threads to number of connections
+  threadcount = (_maxparallel < _conncount) ? _maxparallel : _conncount;
+
+  //Check for nothing to connect
+  if(threadcount == 0)
+    return;
+
+  //Create and start connect threads (each pulls connections until none remain)
+  _nextconn = 0;
+  threads = new Thread<HCAggregator>*[threadcount];
+  for(i=0; i<threadcount; i++)
+  {
+    threads[i] = new Thread<HCAggregator>(this, &HCAggregator::ConnectThread);
+    threads[i]->Start();
+  }
+
+  //Wait for all connect threads to finish
+  for(i=0; i<threadcount; i++)
+  {
+    threads[i]->Join();
+    delete threads[i];
+  }
+  delete[] threads;
+
+  //Attach connected containers in configuration order so PID assignment is stable
+  for(i=0; i<_conncount; i++)
+    if((_conn[i] != 0) && _conn[i]->IsConnected())
+      _conn[i]->Attach();
+}
+
+void HCAggregator::ConnectThread(void)
+{
+  uint32_t i;
+
+  while(true)
+  {
+    //Claim next connection
+    _connmutex->Wait();
+    i = _nextconn++;
+    _connmutex->Give();
+
+    //Check for no connections remaining
+    if(i >= _conncount)
+      return;
+
+    //Connect (failures are retried in the background after server starts)
+    if(_conn[i] != 0)
+      _conn[i]->Connect();
+  }
+}
+
+void HCAggregator::RetryThread(void)
+{
+  uint32_t i;
+  uint32_t remaining;
+
+  while(true)
+  {
+    //Count connections still to be established
+    remaining = 0;
+    for(i=0; i<_conncount; i++)
+      if((_conn[i] != 0) && !_conn[i]->IsConnected())
+        remaining++;
+
+    //Check for all connections established
+    if(remaining == 0)
+      return;
+
+    //Wait before retrying
+    ThreadSleep(_retryperiod);
+
+    //Retry each failed connection
+    for(i=0; i<_conncount; i++)
+    {
+      //Check for invalid or already connected
+      if((_conn[i] == 0) || _conn[i]->IsConnected())
+        continue;
+
+      //Connect and check for failure
+      if(!_conn[i]->Connect())
+        continue;
+
+      //Graft connection container into tree (linked in whole, so server threads walking the tree never see it half built) and running server
+      _connmutex->Wait();
+      _conn[i]->Attach();
+      if(_srv != 0)
+        _srv->Graft(_conn[i]->GetCont());
+      _connmutex->Give();
+
+      //Print info
+      cout << "Grafted connection \"" << _conn[i]->GetCont()->GetName() << "\"" << "\n";
+    }
+  }
+}
+
+Device* HCAggregator::NewUDPDevice(uint16_t port, const char* destipaddr, uint16_t destport, bool uring)
+{
+  //Check for plain socket wanted
+  if(!uring)
+    return new UDPDevice(port, 0, destipaddr, destport);
+
+  //Fall back to plain socket if kernel cannot do io_uring
+  if(!URingUDPDevice::IsSupported())
+  {
+    cout << "io_uring unavailable, using plain UDP socket for port " << port << "\n";
+    return new UDPDevice(port, 0, destipaddr, destport);
+  }
+
+  return new URingUDPDevice(port, 0, destipaddr, destport);
 }
 
-UDPDevice* HCAggregator::ParseUDPSocket(XMLElement* pelt)
+Device* HCAggregator::ParseUDPSocket(XMLElement* pelt, bool uring)
 {
   uint16_t port;
   string destipaddr;
@@ -226,7 +466,7 @@ UDPDevice* HCAggregator::ParseUDPSocket(XMLElement* pelt)
     return 0;
 
   //Create UDP socket
-  return new UDPDevice(port, 0, destipaddr.c_str(), destport);
+  return NewUDPDevice(port, destipaddr.c_str(), destport, uring);
 }
 
 SLIPFramer* HCAggregator::ParseSLIPFramer(XMLElement* pelt)
@@ -260,6 +500,38 @@ SLIPFramer* HCAggregator::ParseSLIPFramer(XMLElement* pelt)
   return new SLIPFramer(dev, maxpldsiz);
 }
 
+SHMDevice* HCAggregator::ParseSHM(XMLElement* pelt)
+{
+  string name;
+
+  //Check for null parent element
+  if(pelt == 0)
+    return 0;
+
+  //Parse name element and check for error
+  if(!ParseValue(pelt, "name", name))
+    return 0;
+
+  //Attach to segment created by server of same name
+  return new SHMDevice(name.c_str(), false);
+}
+
+UnixClient* HCAggregator::ParseUnixClient(XMLElement* pelt)
+{
+  string path;
+
+  //Check for null parent element
+  if(pelt == 0)
+    return 0;
+
+  //Parse path element and check for error
+  if(!ParseValue(pelt, "path", path))
+    return 0;
+
+  //Create Unix client (message boundaries are kept so no SLIP framer needed)
+  return new UnixClient(path.c_str());
+}
+
 TCPClient* HCAggregator::ParseTCPClient(XMLElement* pelt)
 {
   uint16_t port;
@@ -319,6 +591,7 @@ TLSClient* HCAggregator::ParseTLSClient(XMLElement* pelt)
 
 bool HCAggregator::ParseValue(XMLElement* pelt, const char* name, string& val)
 {
+  XMLElement* elt;
   const char* text;
 
   //Check for null parent element
@@ -326,7 +599,7 @@ bool HCAggregator::ParseValue(XMLElement* pelt, const char* name, string& val)
     return false;
 
   //Find element with matching name and check for error
-  if((text = pelt->FirstChildElement(name)->GetText()) == 0)
+  if(((elt = pelt->FirstChildElement(name)) == 0) || ((text = elt->GetText()) == 0))
   {
     cout << __FILE__ << ' ' << __LINE__ << " - Could not find element \"" << name << "\"\n";
     return false;
@@ -339,6 +612,7 @@ bool HCAggregator::ParseValue(XMLElement* pelt, const char* name, string& val)
 
 bool HCAggregator::ParseValue(XMLElement* pelt, const char* name, uint16_t& val)
 {
+  XMLElement* elt;
   const char* text;
 
   //Check for null parent element
@@ -346,7 +620,7 @@ bool HCAggregator::ParseValue(XMLElement* pelt, const char* name, uint16_t& val)
     return false;
 
   //Find element with matching name and check for error
-  if((text = pelt->FirstChildElement(name)->GetText()) == 0)
+  if(((elt = pelt->FirstChildElement(name)) == 0) || ((text = elt->GetText()) == 0))
   {
     cout << __FILE__ << ' ' << __LINE__ << " - Could not find element \"" << name << "\"\n";
     return false;
@@ -358,6 +632,7 @@ bool HCAggregator::ParseValue(XMLElement* pelt, const char* name, uint16_t& val)
 
 bool HCAggregator::ParseValue(XMLElement* pelt, const char* name, uint32_t& val)
 {
+  XMLElement* elt;
   const char* text;
 
   //Check for null parent element
@@ -365,7 +640,7 @@ bool HCAggregator::ParseValue(XMLElement* pelt, const char* name, uint32_t& val)
     return false;
 
   //Find element with matching name and check for error
-  if((text = pelt->FirstChildElement(name)->GetText()) == 0)
+  if(((elt = pelt->FirstChildElement(name)) == 0) || ((text = elt->GetText()) == 0))
   {
     cout << __FILE__ << ' ' << __LINE__ << " - Could not find element \"" << name << "\"\n";
     return false;
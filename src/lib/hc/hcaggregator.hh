@@ -26,19 +26,35 @@
 
 #pragma once
 
+#include "executor.hh"
 #include "hcconnection.hh"
 #include "hccontainer.hh"
 #include "hcserver.hh"
 #include "hcqserver.hh"
+#include "mutex.hh"
+#include "shmdevice.hh"
 #include "slipframer.hh"
 #include "tlsclient.hh"
 #include "tcpclient.hh"
+#include "thread.hh"
 #include "tinyxml2.hh"
 #include "udpdevice.hh"
+#include "unixclient.hh"
+#include "uringudpdevice.hh"
 #include <string>
 
 class HCAggregator
 {
+public:
+  //Default number of connections established concurrently
+  static const uint32_t MAXPARALLEL_DEFAULT = 8;
+
+  //Default period between reconnect attempts for failed connections
+  static const uint32_t RETRYPERIOD_DEFAULT = 5000;
+
+  //Default number of shared executor workers (zero means one per core)
+  static const uint32_t WORKERS_DEFAULT = 0;
+
 public:
   HCAggregator(const std::string& filename);
   virtual ~HCAggregator();
@@ -46,20 +62,36 @@ public:
   void AddParamsToServer(HCContainer* startcont);
   HCServer* ParseServer(tinyxml2::XMLElement* pelt);
   HCConnection* ParseConn(tinyxml2::XMLElement* pelt);
-  UDPDevice* ParseUDPSocket(tinyxml2::XMLElement* pelt);
+  Device* ParseDevice(tinyxml2::XMLElement* pelt);
+  Device* ParseUDPSocket(tinyxml2::XMLElement* pelt, bool uring=false);
   SLIPFramer* ParseSLIPFramer(tinyxml2::XMLElement* pelt);
+  SHMDevice* ParseSHM(tinyxml2::XMLElement* pelt);
+  UnixClient* ParseUnixClient(tinyxml2::XMLElement* pelt);
   TCPClient* ParseTCPClient(tinyxml2::XMLElement* pelt);
   TLSClient* ParseTLSClient(tinyxml2::XMLElement* pelt);
   bool ParseValue(tinyxml2::XMLElement* pelt, const char* name, std::string& val);
   bool ParseValue(tinyxml2::XMLElement* pelt, const char* name, uint16_t& val);
   bool ParseValue(tinyxml2::XMLElement* pelt, const char* name, uint32_t& val);
 
+private:
+  void ConnectAll(void);
+  void ConnectThread(void);
+  void RetryThread(void);
+  Device* NewUDPDevice(uint16_t port, const char* destipaddr, uint16_t destport, bool uring);
+
 private:
   HCContainer* _topcont;
   HCConnection** _conn;
   uint32_t _conncount;
+  uint32_t _maxparallel;
+  uint32_t _retryperiod;
+  uint32_t _nextconn;
+  Mutex* _connmutex;
+  Thread<HCAggregator>* _retrythread;
+  uint32_t _workers;
+  Executor* _exec;
   Device* _qsrvdev;
   HCQServer* _qsrv;
-  UDPDevice* _srvdev;
+  Device* _srvdev;
   HCServer* _srv;
 };
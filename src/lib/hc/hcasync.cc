@@ -0,0 +1,89 @@
+// HC asynchronous transaction
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "hcasync.hh"
+#include "error.hh"
+#include <cassert>
+
+HCAsync::HCAsync()
+{
+  //Initialize member variables
+  _next = 0;
+  _msg = new HCMessage();
+  _cell = new HCCell();
+  _replica = 0;
+  _start = 0;
+  _deadline = 0;
+  _resend = 0;
+  _sends = 0;
+  _read = false;
+  _pid = 0;
+  _eid = 0;
+  _offset = 0;
+  _expopcode = 0xFFFF;
+  _maxlen = 0;
+  _len = 0;
+  _transaction = 0;
+  _type = 0;
+  _checkeid = false;
+  _checkoffset = false;
+  _val = 0;
+  _decoder = 0;
+  _err = ERR_NONE;
+}
+
+HCAsync::~HCAsync()
+{
+  //Cleanup
+  delete _cell;
+  delete _msg;
+}
+
+void HCAsync::Run(void)
+{
+  //Nothing to do on completion unless overridden
+}
+
+bool HCAsync::IsDone(void)
+{
+  return ExecutorTask::Wait(WAIT_NONE) == ERR_NONE;
+}
+
+int HCAsync::Wait(uint32_t msecs)
+{
+  int ierr;
+
+  //Wait for completion and check for time up
+  if((ierr = ExecutorTask::Wait(msecs)) != ERR_NONE)
+    return ierr;
+
+  return _err;
+}
+
+int HCAsync::GetError(void)
+{
+  return _err;
+}
@@ -0,0 +1,112 @@
+// HC asynchronous transaction
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "executor.hh"
+#include "hccell.hh"
+#include "hcmessage.hh"
+#include "hcreplica.hh"
+#include <cassert>
+#include <inttypes.h>
+
+class HCClient;
+
+//Transaction started without blocking (owned by the caller, which must not delete or restart it from its own completion)
+class HCAsync : public ExecutorTask
+{
+public:
+  HCAsync();
+  virtual ~HCAsync();
+  virtual void Run(void);
+  bool IsDone(void);
+  int Wait(uint32_t msecs=WAIT_INF);
+  int GetError(void);
+
+private:
+  //Reply decoder (reads value and error code into caller's storage or sets default value on error)
+  typedef int (*Decoder)(HCCell* cell, void* val, int err);
+
+private:
+  //Transaction state (only touched by the client)
+  friend class HCClient;
+  HCAsync* _next;
+  HCMessage* _msg;
+  HCCell* _cell;
+  HCReplica* _replica;
+  uint64_t _start;
+  uint64_t _deadline;
+  uint64_t _resend;
+  uint32_t _sends;
+  bool _read;
+  uint32_t _pid;
+  uint32_t _eid;
+  uint32_t _offset;
+  uint16_t _expopcode;
+  uint16_t _maxlen;
+  uint16_t* _len;
+  uint32_t _transaction;
+  uint8_t _type;
+  bool _checkeid;
+  bool _checkoffset;
+  void* _val;
+  Decoder _decoder;
+  int _err;
+};
+
+//Asynchronous transaction that calls a method of an object on completion
+template <class T>
+class HCAsyncMethod : public HCAsync
+{
+public:
+  //Signature of method to call on completion
+  typedef void (T::*CompleteMethod)(HCAsync* xact);
+
+public:
+  HCAsyncMethod(T* object, CompleteMethod method)
+  {
+    //Assert valid arguments
+    assert((object != 0) && (method != 0));
+
+    //Initialize object and method pointers
+    _object = object;
+    _method = method;
+  }
+
+  virtual ~HCAsyncMethod()
+  {
+  }
+
+  virtual void Run(void)
+  {
+    //Call the completion method
+    (_object->*_method)(this);
+  }
+
+private:
+  T* _object;
+  CompleteMethod _method;
+};
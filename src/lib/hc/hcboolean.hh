@@ -66,7 +66,7 @@ struct HCBooleanEnum
 class HCBooleanCli
 {
 public:
-  HCBooleanCli(HCClient* cli, uint16_t pid)
+  HCBooleanCli(HCClient* cli, uint32_t pid)
   {
     //Assert valid arguments
     assert(cli != 0);
@@ -104,9 +104,33 @@ public:
     return _cli->ISet(_pid, eid, val);
   }
 
+  int Get(bool& val, HCAsync* xact)
+  {
+    //Delegate to client (value stored when transaction completes)
+    return _cli->Get(_pid, val, xact);
+  }
+
+  int Set(const bool val, HCAsync* xact)
+  {
+    //Delegate to client
+    return _cli->Set(_pid, val, xact);
+  }
+
+  int IGet(uint32_t eid, bool& val, HCAsync* xact)
+  {
+    //Delegate to client (value stored when transaction completes)
+    return _cli->IGet(_pid, eid, val, xact);
+  }
+
+  int ISet(uint32_t eid, const bool val, HCAsync* xact)
+  {
+    //Delegate to client
+    return _cli->ISet(_pid, eid, val, xact);
+  }
+
 private:
   HCClient* _cli;
-  uint16_t _pid;
+  uint32_t _pid;
 };
 
 //-----------------------------------------------------------------------------
@@ -299,7 +323,7 @@ public:
     }
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     uint32_t i;
 
@@ -996,7 +1020,7 @@ public:
     }
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     uint32_t i;
 
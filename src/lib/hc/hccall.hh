@@ -42,7 +42,7 @@
 class HCCallCli
 {
 public:
-  HCCallCli(HCClient* cli, uint16_t pid)
+  HCCallCli(HCClient* cli, uint32_t pid)
   {
     //Assert valid arguments
     assert(cli != 0);
@@ -68,9 +68,21 @@ public:
     return _cli->ICall(_pid, eid);
   }
 
+  int Call(HCAsync* xact)
+  {
+    //Delegate to client
+    return _cli->Call(_pid, xact);
+  }
+
+  int ICall(uint32_t eid, HCAsync* xact)
+  {
+    //Delegate to client
+    return _cli->ICall(_pid, eid, xact);
+  }
+
 private:
   HCClient* _cli;
-  uint16_t _pid;
+  uint32_t _pid;
 };
 
 //-----------------------------------------------------------------------------
@@ -128,7 +140,7 @@ public:
     st << "\n  Type: " << TypeString();
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     //Generate XML information
     file << std::string(indent, ' ') << "<" << TypeString() << ">\n";
@@ -265,7 +277,7 @@ public:
     }
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     uint32_t i;
 
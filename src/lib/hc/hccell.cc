@@ -34,6 +34,39 @@
 
 using namespace std;
 
+bool HCCell::IsReadOpCode(uint8_t opcode)
+{
+  //Check for command that doesn't change server state (safe to send to any replica or send again)
+  switch(opcode & ~OPCODE_WIDE)
+  {
+  case OPCODE_GET_CMD:
+  case OPCODE_IGET_CMD:
+  case OPCODE_READ_CMD:
+  case OPCODE_QGET_CMD:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool HCCell::IsWriteOpCode(uint8_t opcode)
+{
+  //Check for command that changes server state (not safe to carry out twice)
+  switch(opcode & ~OPCODE_WIDE)
+  {
+  case OPCODE_CALL_CMD:
+  case OPCODE_SET_CMD:
+  case OPCODE_ICALL_CMD:
+  case OPCODE_ISET_CMD:
+  case OPCODE_ADD_CMD:
+  case OPCODE_SUB_CMD:
+  case OPCODE_WRITE_CMD:
+    return true;
+  default:
+    return false;
+  }
+}
+
 HCCell::HCCell()
 {
   //Allocate memory for cell buffer
@@ -67,6 +100,130 @@ uint8_t HCCell::GetOpCode(void)
   return _opcode;
 }
 
+void HCCell::Rewind(void)
+{
+  //Reset read index so payload can be read again from the start
+  _readindex = 0;
+}
+
+void HCCell::Copy(HCCell* cell)
+{
+  //Assert valid arguments
+  assert(cell != 0);
+
+  //Copy op code and raw payload (read index starts over)
+  _readindex = 0;
+  _opcode = cell->_opcode;
+  _payloadlength = cell->_payloadlength;
+  memcpy(_payload, cell->_payload, _payloadlength);
+}
+
+bool HCCell::Append(HCCell* cell)
+{
+  //Assert valid arguments
+  assert(cell != 0);
+
+  //Check for overflow
+  if((PAYLOAD_MAX - _payloadlength) < cell->_payloadlength)
+    return false;
+
+  //Append raw payload of other cell
+  memcpy(_payload + _payloadlength, cell->_payload, cell->_payloadlength);
+  _payloadlength += cell->_payloadlength;
+  return true;
+}
+
+uint32_t HCCell::GetLength(void)
+{
+  return _payloadlength;
+}
+
+uint32_t HCCell::GetUnread(void)
+{
+  return _payloadlength - _readindex;
+}
+
+bool HCCell::IsWide(void)
+{
+  return (_opcode & OPCODE_WIDE) != 0;
+}
+
+bool HCCell::ReadPID(uint32_t& pid)
+{
+  uint16_t npid;
+
+  //Check for wide PID
+  if(IsWide())
+    return Read(pid);
+
+  //Read narrow PID and check for error
+  if(!Read(npid))
+    return false;
+
+  //Widen PID
+  pid = npid;
+  return true;
+}
+
+bool HCCell::WritePID(uint32_t pid)
+{
+  //Check for wide PID
+  if(IsWide())
+    return Write(pid);
+
+  //Check for PID not representable in narrow cell
+  if(pid > 0xFFFF)
+    return false;
+
+  //Write narrow PID
+  return Write((uint16_t)pid);
+}
+
+bool HCCell::ReplacePID(uint32_t pid, bool wide)
+{
+  uint32_t oldsize;
+  uint32_t newsize;
+
+  //Determine size of existing and replacement PID
+  oldsize = IsWide() ? sizeof(uint32_t) : sizeof(uint16_t);
+  newsize = wide ? sizeof(uint32_t) : sizeof(uint16_t);
+
+  //Check for no existing PID, overflow or PID not representable in narrow cell
+  if((_payloadlength < oldsize) || ((_payloadlength - oldsize + newsize) > PAYLOAD_MAX) || (!wide && (pid > 0xFFFF)))
+    return false;
+
+  //Shift rest of payload if PID size changes
+  if(newsize != oldsize)
+  {
+    memmove(_payload + newsize, _payload + oldsize, _payloadlength - oldsize);
+    _payloadlength = _payloadlength - oldsize + newsize;
+  }
+
+  //Set or clear wide flag on op code
+  if(wide)
+    _opcode |= OPCODE_WIDE;
+  else
+    _opcode &= ~OPCODE_WIDE;
+
+  //Serialize PID over start of payload
+  if(wide)
+  {
+    _payload[0] = (uint8_t)(pid >> 24);
+    _payload[1] = (uint8_t)(pid >> 16);
+    _payload[2] = (uint8_t)(pid >> 8);
+    _payload[3] = (uint8_t)pid;
+  }
+  else
+  {
+    _payload[0] = (uint8_t)(pid >> 8);
+    _payload[1] = (uint8_t)pid;
+  }
+
+  //Read index starts over
+  _readindex = 0;
+  return true;
+}
+
 uint32_t HCCell::Serialize(uint8_t* serbuf, uint32_t maxlen)
 {
   uint32_t i;
@@ -666,8 +823,8 @@ void HCCell::Print(const string& extra)
   //Print common info
   cout << extra << "Cell: OpCode=" << (uint16_t)_opcode << "=";
 
-  //Print info dependent on cell opcode
-  switch(_opcode)
+  //Print info dependent on cell opcode (ignoring wide PID flag)
+  switch(_opcode & ~OPCODE_WIDE)
   {
   case OPCODE_CALL_CMD:
     cout << "Call Cmd";
@@ -729,11 +886,21 @@ void HCCell::Print(const string& extra)
   case OPCODE_WRITE_STS:
     cout << "Write Sts";
     break;
+  case OPCODE_QGET_CMD:
+    cout << "QGet Cmd";
+    break;
+  case OPCODE_QGET_STS:
+    cout << "QGet Sts";
+    break;
   default:
     cout << "Unknown";
     break;
   }
 
+  //Print wide PID flag
+  if(IsWide())
+    cout << " (Wide)";
+
   //Print payload
   cout << ", Payload=";
   for(i=0; i<_payloadlength; i++)
@@ -53,6 +53,11 @@ public:
   static const uint8_t OPCODE_READ_STS = 0x11;
   static const uint8_t OPCODE_WRITE_CMD = 0x12;
   static const uint8_t OPCODE_WRITE_STS = 0x13;
+  static const uint8_t OPCODE_QGET_CMD = 0x14;
+  static const uint8_t OPCODE_QGET_STS = 0x15;
+
+  //Opcode flag indicating PID is 32 bits wide instead of 16
+  static const uint8_t OPCODE_WIDE = 0x80;
 
   //Cell overhead
   static const uint32_t OVERHEAD = 3;
@@ -60,11 +65,24 @@ public:
   //Maximum payload size (see message payload max)
   static const uint32_t PAYLOAD_MAX = 1397;
 
+public:
+  static bool IsReadOpCode(uint8_t opcode);
+  static bool IsWriteOpCode(uint8_t opcode);
+
 public:
   HCCell();
   ~HCCell();
   void Reset(uint8_t opcode);
   uint8_t GetOpCode(void);
+  void Rewind(void);
+  void Copy(HCCell* cell);
+  bool Append(HCCell* cell);
+  uint32_t GetLength(void);
+  uint32_t GetUnread(void);
+  bool IsWide(void);
+  bool ReadPID(uint32_t& pid);
+  bool WritePID(uint32_t pid);
+  bool ReplacePID(uint32_t pid, bool wide);
   uint32_t Serialize(uint8_t* serbuf, uint32_t maxlen);
   uint32_t Deserialize(uint8_t* serbuf, uint32_t len);
   bool Read(bool& val);
@@ -28,6 +28,8 @@
 #include "hcclient.hh"
 #include "hcboolean.hh"
 #include "hcinteger.hh"
+#include "hcparameter.hh"
+#include "hcserver.hh"
 #include <cassert>
 #include <iostream>
 
@@ -40,72 +42,214 @@ static const HCBooleanEnum Offon[] =
   HCBooleanEnum()
 };
 
-HCClient::HCClient(Device* lowdev, HCContainer* parent, uint32_t timeout)
+static int DirectGet(HCParameter* param, bool& val)
 {
-  HCContainer* cont;
+  return param->GetBool(val);
+}
+
+static int DirectGet(HCParameter* param, string& val)
+{
+  return param->GetStr(val);
+}
+
+static int DirectGet(HCParameter* param, float& val)
+{
+  return param->GetFlt(val);
+}
+
+static int DirectGet(HCParameter* param, double& val)
+{
+  return param->GetFlt(val);
+}
+
+template <typename T> static int DirectGet(HCParameter* param, T& val)
+{
+  return param->GetInt(val);
+}
+
+static int DirectSet(HCParameter* param, const bool val)
+{
+  return param->SetBool(val);
+}
+
+static int DirectSet(HCParameter* param, const string val)
+{
+  return param->SetStr(val);
+}
+
+static int DirectSet(HCParameter* param, const float val)
+{
+  return param->SetFlt(val);
+}
+
+static int DirectSet(HCParameter* param, const double val)
+{
+  return param->SetFlt(val);
+}
+
+template <typename T> static int DirectSet(HCParameter* param, const T val)
+{
+  return param->SetInt(val);
+}
+
+static int DirectIGet(HCParameter* param, uint32_t eid, bool& val)
+{
+  return param->GetBoolTbl(eid, val);
+}
+
+static int DirectIGet(HCParameter* param, uint32_t eid, string& val)
+{
+  return param->GetStrTbl(eid, val);
+}
+
+static int DirectIGet(HCParameter* param, uint32_t eid, float& val)
+{
+  return param->GetFltTbl(eid, val);
+}
+
+static int DirectIGet(HCParameter* param, uint32_t eid, double& val)
+{
+  return param->GetFltTbl(eid, val);
+}
+
+template <typename T> static int DirectIGet(HCParameter* param, uint32_t eid, T& val)
+{
+  return param->GetIntTbl(eid, val);
+}
+
+static int DirectISet(HCParameter* param, uint32_t eid, const bool val)
+{
+  return param->SetBoolTbl(eid, val);
+}
+
+static int DirectISet(HCParameter* param, uint32_t eid, const string val)
+{
+  return param->SetStrTbl(eid, val);
+}
+
+static int DirectISet(HCParameter* param, uint32_t eid, const float val)
+{
+  return param->SetFltTbl(eid, val);
+}
+
+static int DirectISet(HCParameter* param, uint32_t eid, const double val)
+{
+  return param->SetFltTbl(eid, val);
+}
+
+template <typename T> static int DirectISet(HCParameter* param, uint32_t eid, const T val)
+{
+  return param->SetIntTbl(eid, val);
+}
+
+static int DirectAdd(HCParameter*, const bool)
+{
+  return ERR_TYPE;
+}
+
+static int DirectAdd(HCParameter*, const float)
+{
+  return ERR_TYPE;
+}
+
+static int DirectAdd(HCParameter*, const double)
+{
+  return ERR_TYPE;
+}
+
+static int DirectAdd(HCParameter* param, const string val)
+{
+  return param->AddStr(val);
+}
+
+template <typename T> static int DirectAdd(HCParameter* param, const T val)
+{
+  return param->AddInt(val);
+}
+
+static int DirectSub(HCParameter*, const bool)
+{
+  return ERR_TYPE;
+}
+
+static int DirectSub(HCParameter*, const float)
+{
+  return ERR_TYPE;
+}
+
+static int DirectSub(HCParameter*, const double)
+{
+  return ERR_TYPE;
+}
+
+static int DirectSub(HCParameter* param, const string val)
+{
+  return param->SubStr(val);
+}
+
+template <typename T> static int DirectSub(HCParameter* param, const T val)
+{
+  return param->SubInt(val);
+}
 
+HCClient::HCClient(Device* lowdev, HCContainer* parent, uint32_t timeout)
+{
   //Assert valid arguments
   assert((lowdev != 0) && (parent != 0) && (timeout > 1));
 
-  //Initialize member variables
-  _pidmax = 0;
-  _lowdev = lowdev;
-  _parent = parent;
-  _imsg = new HCMessage();
-  _icell = new HCCell();
-  _omsg = new HCMessage();
-  _ocell = new HCCell();
-  _debug = false;
-  _senderrcount = 0;
-  _recverrcount = 0;
-  _transactionerrcount = 0;
-  _cellerrcount = 0;
-  _opcodeerrcount = 0;
-  _timeouterrcount = 0;
-  _piderrcount = 0;
-  _typeerrcount = 0;
-  _eiderrcount = 0;
-  _offseterrcount = 0;
-  _goodxactcount = 0;
-  _transaction = 0;
-  _xactmutex = new Mutex();
-  _exptransaction = 0xFFFF;
-  _expopcode = 0xFFFF;
-  _timeout = timeout;
-  _replyevent = new Event();
+  //Initialize member variables and add parameters
+  Init(0, parent, timeout);
 
-  //Create file buffer (only used for downloading SIF)
-  _filebuffer = new uint8_t[HCCell::PAYLOAD_MAX - 9];
+  //Add device as first replica (starts receiving replies)
+  AddReplica(lowdev);
+}
 
-  //Add parameters to the parent container
-  cont = new HCContainer(".client");
-  parent->Add(cont);
-  cont->Add(new HCBoolean<HCClient>("debug", this, &HCClient::GetDebug, &HCClient::SetDebug, Offon));
-  cont->Add(new HCUns32<HCClient>("senderrcount", this, &HCClient::GetSendErrCount, 0));
-  cont->Add(new HCUns32<HCClient>("recverrcount", this, &HCClient::GetRecvErrCount, 0));
-  cont->Add(new HCUns32<HCClient>("transactionerrcount", this, &HCClient::GetTransactionErrCount, 0));
-  cont->Add(new HCUns32<HCClient>("cellerrcount", this, &HCClient::GetCellErrCount, 0));
-  cont->Add(new HCUns32<HCClient>("opcodeerrcount", this, &HCClient::GetOpCodeErrCount, 0));
-  cont->Add(new HCUns32<HCClient>("timeouterrcount", this, &HCClient::GetTimeoutErrCount, 0));
-  cont->Add(new HCUns32<HCClient>("piderrcount", this, &HCClient::GetPIDErrCount, 0));
-  cont->Add(new HCUns32<HCClient>("typeerrcount", this, &HCClient::GetTypeErrCount, 0));
-  cont->Add(new HCUns32<HCClient>("eiderrcount", this, &HCClient::GetEIDErrCount, 0));
-  cont->Add(new HCUns32<HCClient>("offseterrcount", this, &HCClient::GetOffsetErrCount, 0));
-  cont->Add(new HCUns32<HCClient>("goodxactcount", this, &HCClient::GetGoodXactCount, 0));
-
-  //Create and start the read thread
-  _readthread = new Thread<HCClient>(this, &HCClient::ReadThread);
-  _readthread->Start();
+HCClient::HCClient(HCServer* server, HCContainer* parent)
+{
+  //Assert valid arguments
+  assert((server != 0) && (parent != 0));
+
+  //Initialize member variables and add parameters (no replicas, transactions call server parameters directly)
+  Init(server, parent, 0);
 }
 
 HCClient::~HCClient()
 {
+  HCAsync* xact;
+  uint32_t i;
+
   //Cleanup member variables
-  delete _readthread;
+  for(i=0; i<_replicacount; i++)
+    delete _replicas[i];
+
+  //Stop timeout sweeps
+  if(_sweeping)
+  {
+    _wheel->Cancel(_sweeper);
+    _sweeper->Wait();
+  }
+
+  delete _sweeper;
+
+  if(_ownwheel)
+    delete _wheel;
+
+  //Fail asynchronous transactions still in flight
+  for(i=0; i<ASYNC_SLOTS; i++)
+  {
+    if((xact = _pending[i]) != 0)
+    {
+      _pending[i] = 0;
+      FinishAsync(xact, ERR_UNSPEC);
+    }
+  }
+
   delete[] _filebuffer;
   delete _replyevent;
   delete _xactmutex;
-  delete _imsg;
+  delete _rxmutex;
+  delete _vmsg;
+  delete _vcell;
   delete _icell;
   delete _omsg;
   delete _ocell;
@@ -207,164 +351,755 @@ int HCClient::GetOffsetErrCount(uint32_t& val)
   return ERR_NONE;
 }
 
-int HCClient::GetGoodXactCount(uint32_t& val)
+int HCClient::GetFailoverCount(uint32_t& val)
 {
   //Get the value
-  val = _goodxactcount;
+  val = _failovercount;
 
   return ERR_NONE;
 }
 
-int HCClient::Call(uint16_t pid)
+int HCClient::GetAsyncCount(uint32_t& val)
 {
-  int ierr;
+  //Get the value
+  val = _pendingcount;
 
-  //Begin mutual exclusion of transaction
-  _xactmutex->Wait();
+  return ERR_NONE;
+}
 
-  //Format outbound message
-  _omsg->Reset(_transaction);
-  _ocell->Reset(HCCell::OPCODE_CALL_CMD);
-  _ocell->Write(pid);
-  _omsg->Write(_ocell);
+int HCClient::GetSRTT(uint32_t& val)
+{
+  //Check for direct client
+  if(_replicacount == 0)
+  {
+    val = 0;
+    return ERR_NONE;
+  }
 
-  //Perform call transaction
-  ierr = CallXact(pid);
+  //Get the value from primary replica
+  return _replicas[_primary]->GetSRTT(val);
+}
 
-  //End mutual exclusion of transaction
-  _xactmutex->Give();
+int HCClient::GetRTO(uint32_t& val)
+{
+  //Check for direct client
+  if(_replicacount == 0)
+  {
+    val = 0;
+    return ERR_NONE;
+  }
 
-  return ierr;
+  //Get the value from primary replica
+  return _replicas[_primary]->GetRTO(val);
 }
 
-int HCClient::ICall(uint16_t pid, uint32_t eid)
+int HCClient::GetRetransmitCount(uint32_t& val)
 {
-  int ierr;
+  //Get the value
+  val = _retransmitcount;
 
-  //Begin mutual exclusion of transaction
-  _xactmutex->Wait();
+  return ERR_NONE;
+}
 
-  //Format outbound message
-  _omsg->Reset(_transaction);
-  _ocell->Reset(HCCell::OPCODE_ICALL_CMD);
-  _ocell->Write(pid);
-  _ocell->Write(eid);
-  _omsg->Write(_ocell);
+int HCClient::GetDupReplyCount(uint32_t& val)
+{
+  //Get the value
+  val = _dupreplycount;
 
-  //Perform set transaction
-  ierr = ICallXact(pid, eid);
+  return ERR_NONE;
+}
 
-  //End mutual exclusion of transaction
-  _xactmutex->Give();
+int HCClient::GetTimeoutHist(uint32_t eid, uint32_t& val)
+{
+  //Check for EID out of range
+  if(eid >= TIMEOUT_BINS)
+  {
+    val = 0;
+    return ERR_EID;
+  }
 
-  return ierr;
+  //Get the value
+  val = _timeouthist[eid];
+
+  return ERR_NONE;
 }
 
-int HCClient::Read(uint16_t pid, uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len)
+void HCClient::AddReplica(Device* lowdev)
 {
-  int8_t merr;
-  int ierr;
+  HCReplica* rep;
 
-  //Take the transaction mutex
-  _xactmutex->Wait();
+  //Assert valid arguments
+  assert(lowdev != 0);
 
-  //Perform get transaction
-  ierr = ReadXact(pid, offset, maxlen);
+  //Check for in-process server (parameters are called directly, not through devices)
+  if(_server != 0)
+  {
+    cout << __FILE__ << ' ' << __LINE__ << " - In-process client can't have replicas" << "\n";
+    return;
+  }
 
-  //Check for no internal error
-  if(ierr == ERR_NONE)
+  //Check for too many replicas
+  if(_replicacount >= REPLICA_MAX)
   {
-    //Read value and error from inbound cell (already skipped past PID, and offset)
-    _icell->Read(val, maxlen, len);
-    _icell->Read(merr);
-    ierr = (int)merr;
+    cout << __FILE__ << ' ' << __LINE__ << " - Replica count is at max (" << REPLICA_MAX << ')' << "\n";
+    return;
   }
-  else
+
+  //Create replica
+  rep = new HCReplica(this, lowdev, _replicacount);
+  _replicas[_replicacount++] = rep;
+
+  //Add failover count and health parameters of first replica once there is more than one
+  if(_replicacount == 2)
   {
-    //Indicate no bytes read
-    len = 0;
+    _cont->Add(new HCUns32<HCClient>("failovercount", this, &HCClient::GetFailoverCount, 0));
+    AddReplicaCont(_replicas[0]);
   }
 
-  //Give the transaction mutex
-  _xactmutex->Give();
+  //Add health parameters of replica
+  if(_replicacount >= 2)
+    AddReplicaCont(rep);
 
-  return ierr;
+  //Start receiving replies from replica
+  rep->Start();
 }
 
-int HCClient::Write(uint16_t pid, uint32_t offset, uint8_t* val, uint16_t len)
+uint32_t HCClient::GetReplicaCount(void)
 {
-  int ierr;
-
-  //Begin mutual exclusion of transaction
-  _xactmutex->Wait();
-
-  //Format outbound message
-  _omsg->Reset(_transaction);
-  _ocell->Reset(HCCell::OPCODE_WRITE_CMD);
-  _ocell->Write(pid);
-  _ocell->Write(offset);
-  _ocell->Write(val, len);
-  _omsg->Write(_ocell);
+  return _replicacount;
+}
 
-  //Perform write transaction
-  ierr = WriteXact(pid, offset);
+bool HCClient::IsDirect(void)
+{
+  return _server != 0;
+}
 
-  //End mutual exclusion of transaction
-  _xactmutex->Give();
+void HCClient::SetPrimary(uint32_t index)
+{
+  //Check for invalid index
+  if(index >= _replicacount)
+    return;
 
-  return ierr;
+  //Set replica writes go to
+  _primary = index;
 }
 
-int HCClient::DownloadSIF(uint16_t pid, const char* filename)
+void HCClient::SetHoldoff(uint32_t holdoff)
 {
-  FILE* file;
-  uint16_t len;
-  int ierr;
+  //Set time (ms) a failed replica is avoided
+  _holdoff = holdoff;
+}
 
+void HCClient::SetTimerWheel(TimerWheel* wheel)
+{
   //Assert valid arguments
-  assert(filename != 0);
-
-  //Open local file and check for error
-  if((file = fopen(filename, "w")) == NULL)
-    return ERR_UNSPEC;
+  assert(wheel != 0);
 
-  //Transfer file piece by piece
-  while(true)
+  //Check for asynchronous transactions already timed by another wheel
+  if(_sweeping || (_wheel != 0))
   {
-    //Read part of remote file
-    ierr = Read(pid, (uint32_t)ftell(file), _filebuffer, HCCell::PAYLOAD_MAX - 9, len);
+    cout << __FILE__ << ' ' << __LINE__ << " - Timer wheel must be set before first asynchronous transaction" << "\n";
+    return;
+  }
 
-    //If timeout, retry read part of remote file
-    if(ierr == ERR_TIMEOUT)
-      ierr = Read(pid, (uint32_t)ftell(file), _filebuffer, HCCell::PAYLOAD_MAX - 9, len);
+  //Use shared wheel to time out asynchronous transactions
+  _wheel = wheel;
+}
 
-    //If timeout, retry read part of remote file
-    if(ierr == ERR_TIMEOUT)
-      ierr = Read(pid, (uint32_t)ftell(file), _filebuffer, HCCell::PAYLOAD_MAX - 9, len);
+int HCClient::CheckReplicas(uint32_t crc)
+{
+  uint32_t i;
 
-    //Check for error
-    if(ierr != ERR_NONE)
-    {
-      //Close info file
-      fclose(file);
-      return ierr;
-    }
+  //Check for single replica (nothing to compare against)
+  if(_replicacount < 2)
+    return ERR_NONE;
 
-    //Write to local file
-    fwrite(_filebuffer, 1, len, file);
+  //Begin mutual exclusion of transaction
+  _xactmutex->Wait();
 
-    //Check for done
-    if(len < HCCell::PAYLOAD_MAX - 9)
-      break;
-  }
+  //Remember server information file CRC all replicas must share
+  _sifcrc = crc;
+  _crcset = true;
 
-  //Close info file
-  fclose(file);
-  return ERR_NONE;
+  //Check all replicas (unreachable replicas are checked again before first use)
+  for(i=0; i<_replicacount; i++)
+    if(_replicas[i]->IsEnabled() && !_replicas[i]->IsVerified())
+      VerifyReplica(_replicas[i]);
+
+  //Set expected reply parameters to invalid
+  _rxmutex->Wait();
+  _exptransaction = TRANSACTION_NONE;
+  _expopcode = 0xFFFF;
+  _xactreplica = 0;
+  _rxmutex->Give();
+
+  //End mutual exclusion of transaction
+  _xactmutex->Give();
+
+  return ERR_NONE;
+}
+
+bool HCClient::GetWidePID(void)
+{
+  return _wideflag != 0;
+}
+
+void HCClient::SetWidePID(bool val)
+{
+  //Set opcode flag used for all outbound cells
+  _wideflag = val ? HCCell::OPCODE_WIDE : 0;
+}
+
+uint8_t HCClient::GetProtocol(void)
+{
+  return _protocol;
+}
+
+void HCClient::SetProtocol(uint8_t val)
+{
+  //Limit to versions this end speaks
+  if(val < HCMessage::VERSION_1)
+    val = HCMessage::VERSION_1;
+  else if(val > HCMessage::VERSION_MAX)
+    val = HCMessage::VERSION_MAX;
+
+  //Switch message header version between transactions
+  _xactmutex->Wait();
+  _rxmutex->Wait();
+  _protocol = val;
+  _omsg->SetVersion(val);
+  _vmsg->SetVersion(val);
+  if(val == HCMessage::VERSION_1)
+    _transaction %= ASYNC_BASE;
+  _rxmutex->Give();
+  _xactmutex->Give();
+}
+
+int HCClient::GetGoodXactCount(uint32_t& val)
+{
+  //Get the value
+  val = _goodxactcount;
+
+  return ERR_NONE;
+}
+
+int HCClient::Call(uint32_t pid)
+{
+  HCParameter* param;
+  int ierr;
+
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, HCParameter::TypeCode(), param)) == ERR_NONE)
+      ierr = param->Call();
+
+    return ierr;
+  }
+
+  //Begin mutual exclusion of transaction
+  _xactmutex->Wait();
+
+  //Format outbound message
+  _omsg->Reset(_transaction);
+  _ocell->Reset(HCCell::OPCODE_CALL_CMD | _wideflag);
+  _ocell->WritePID(pid);
+  _omsg->Write(_ocell);
+
+  //Perform call transaction
+  ierr = CallXact(pid);
+
+  //End mutual exclusion of transaction
+  _xactmutex->Give();
+
+  return ierr;
+}
+
+int HCClient::ICall(uint32_t pid, uint32_t eid)
+{
+  HCParameter* param;
+  int ierr;
+
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, HCParameter::TypeCode(), param)) == ERR_NONE)
+      ierr = param->CallTbl(eid);
+
+    return ierr;
+  }
+
+  //Begin mutual exclusion of transaction
+  _xactmutex->Wait();
+
+  //Format outbound message
+  _omsg->Reset(_transaction);
+  _ocell->Reset(HCCell::OPCODE_ICALL_CMD | _wideflag);
+  _ocell->WritePID(pid);
+  _ocell->Write(eid);
+  _omsg->Write(_ocell);
+
+  //Perform set transaction
+  ierr = ICallXact(pid, eid);
+
+  //End mutual exclusion of transaction
+  _xactmutex->Give();
+
+  return ierr;
+}
+
+int HCClient::Read(uint32_t pid, uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len)
+{
+  HCParameter* param;
+  int8_t merr;
+  int ierr;
+
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, HCParameter::T_FILE, param)) == ERR_NONE)
+      ierr = param->Read(offset, val, maxlen, len);
+    else
+      len = 0;
+
+    return ierr;
+  }
+
+  //Take the transaction mutex
+  _xactmutex->Wait();
+
+  //Perform get transaction
+  ierr = ReadXact(pid, offset, maxlen);
+
+  //Check for no internal error
+  if(ierr == ERR_NONE)
+  {
+    //Read value and error from inbound cell (already skipped past PID, and offset)
+    _icell->Read(val, maxlen, len);
+    _icell->Read(merr);
+    ierr = (int)merr;
+  }
+  else
+  {
+    //Indicate no bytes read
+    len = 0;
+  }
+
+  //Give the transaction mutex
+  _xactmutex->Give();
+
+  return ierr;
+}
+
+int HCClient::Write(uint32_t pid, uint32_t offset, uint8_t* val, uint16_t len)
+{
+  HCParameter* param;
+  int ierr;
+
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, HCParameter::T_FILE, param)) == ERR_NONE)
+      ierr = param->Write(offset, val, len);
+
+    return ierr;
+  }
+
+  //Begin mutual exclusion of transaction
+  _xactmutex->Wait();
+
+  //Format outbound message
+  _omsg->Reset(_transaction);
+  _ocell->Reset(HCCell::OPCODE_WRITE_CMD | _wideflag);
+  _ocell->WritePID(pid);
+  _ocell->Write(offset);
+  _ocell->Write(val, len);
+  _omsg->Write(_ocell);
+
+  //Perform write transaction
+  ierr = WriteXact(pid, offset);
+
+  //End mutual exclusion of transaction
+  _xactmutex->Give();
+
+  return ierr;
+}
+
+int HCClient::Call(uint32_t pid, HCAsync* xact)
+{
+  //Assert valid arguments
+  assert(xact != 0);
+
+  //Check for transaction already in flight
+  if(!xact->IsDone())
+    return ERR_INVALID;
+
+  //Call server parameter directly if in-process
+  if(_server != 0)
+    return CompleteAsync(xact, Call(pid));
+
+  //Format outbound cell
+  PrepareAsync(xact, pid, HCCell::OPCODE_CALL_STS | _wideflag);
+  xact->_cell->Reset(HCCell::OPCODE_CALL_CMD | _wideflag);
+  xact->_cell->WritePID(pid);
+
+  //Start call transaction
+  return StartAsync(xact, false);
+}
+
+int HCClient::ICall(uint32_t pid, uint32_t eid, HCAsync* xact)
+{
+  //Assert valid arguments
+  assert(xact != 0);
+
+  //Check for transaction already in flight
+  if(!xact->IsDone())
+    return ERR_INVALID;
+
+  //Call server parameter directly if in-process
+  if(_server != 0)
+    return CompleteAsync(xact, ICall(pid, eid));
+
+  //Format outbound cell
+  PrepareAsync(xact, pid, HCCell::OPCODE_ICALL_STS | _wideflag);
+  xact->_cell->Reset(HCCell::OPCODE_ICALL_CMD | _wideflag);
+  xact->_cell->WritePID(pid);
+  xact->_cell->Write(eid);
+  xact->_eid = eid;
+  xact->_checkeid = true;
+
+  //Start call transaction
+  return StartAsync(xact, false);
+}
+
+int HCClient::Read(uint32_t pid, uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len, HCAsync* xact)
+{
+  //Assert valid arguments
+  assert(xact != 0);
+
+  //Check for transaction already in flight
+  if(!xact->IsDone())
+    return ERR_INVALID;
+
+  //Read server parameter directly if in-process
+  if(_server != 0)
+    return CompleteAsync(xact, Read(pid, offset, val, maxlen, len));
+
+  //Format outbound cell and note where data goes
+  PrepareAsync(xact, pid, HCCell::OPCODE_READ_STS | _wideflag);
+  xact->_cell->Reset(HCCell::OPCODE_READ_CMD | _wideflag);
+  xact->_cell->WritePID(pid);
+  xact->_cell->Write(offset);
+  xact->_cell->Write(maxlen);
+  xact->_offset = offset;
+  xact->_checkoffset = true;
+  xact->_val = val;
+  xact->_maxlen = maxlen;
+  xact->_len = &len;
+
+  //Start read transaction
+  return StartAsync(xact, true);
+}
+
+int HCClient::Write(uint32_t pid, uint32_t offset, uint8_t* val, uint16_t len, HCAsync* xact)
+{
+  //Assert valid arguments
+  assert(xact != 0);
+
+  //Check for transaction already in flight
+  if(!xact->IsDone())
+    return ERR_INVALID;
+
+  //Write server parameter directly if in-process
+  if(_server != 0)
+    return CompleteAsync(xact, Write(pid, offset, val, len));
+
+  //Format outbound cell
+  PrepareAsync(xact, pid, HCCell::OPCODE_WRITE_STS | _wideflag);
+  xact->_cell->Reset(HCCell::OPCODE_WRITE_CMD | _wideflag);
+  xact->_cell->WritePID(pid);
+  xact->_cell->Write(offset);
+  xact->_cell->Write(val, len);
+  xact->_offset = offset;
+  xact->_checkoffset = true;
+
+  //Start write transaction
+  return StartAsync(xact, false);
+}
+
+int HCClient::DownloadSIF(uint32_t pid, const char* filename)
+{
+  FILE* file;
+  uint16_t maxlen;
+  uint16_t len;
+  int ierr;
+
+  //Assert valid arguments
+  assert(filename != 0);
+
+  //Determine largest piece that fits in reply (wide PIDs take two extra bytes)
+  maxlen = HCCell::PAYLOAD_MAX - 9 - ((_wideflag != 0) ? 2 : 0);
+
+  //Open local file and check for error
+  if((file = fopen(filename, "w")) == NULL)
+    return ERR_UNSPEC;
+
+  //Transfer file piece by piece
+  while(true)
+  {
+    //Read part of remote file (sent again as needed when replies are slow)
+    ierr = Read(pid, (uint32_t)ftell(file), _filebuffer, maxlen, len);
+
+    //Check for error
+    if(ierr != ERR_NONE)
+    {
+      //Close info file
+      fclose(file);
+      return ierr;
+    }
+
+    //Write to local file
+    fwrite(_filebuffer, 1, len, file);
+
+    //Check for done
+    if(len < maxlen)
+      break;
+  }
+
+  //Close info file
+  fclose(file);
+  return ERR_NONE;
+}
+
+int HCClient::Forward(HCCell* icell, HCCell* ocell)
+{
+  int ierr;
+
+  //Assert valid arguments
+  assert((icell != 0) && (ocell != 0));
+
+  //Check for in-process server (raw cells are only exchanged with remote servers)
+  if(_server != 0)
+    return ERR_UNSPEC;
+
+  //Begin mutual exclusion of transaction
+  _xactmutex->Wait();
+
+  //Reset reply event
+  _replyevent->Reset();
+
+  //Set expected reply parameters (status opcode always follows command opcode)
+  _exptransaction = _transaction;
+  _expopcode = icell->GetOpCode() + 1;
+
+  //Format outbound message with raw inbound cell
+  _omsg->Reset(NextTransaction());
+  _omsg->Write(icell);
+
+  //Print outbound message if requested
+  if(_debug)
+    _omsg->Print("Tx");
+
+  //Exchange messages with server (reads may go to any replica) and check for error
+  if((ierr = Exchange(HCCell::IsReadOpCode(icell->GetOpCode()))) != ERR_NONE)
+  {
+    //End mutual exclusion of transaction
+    _xactmutex->Give();
+
+    return ierr;
+  }
+
+  //Relay raw inbound cell to caller without decoding it
+  ocell->Copy(_icell);
+
+  //Increment good transaction count
+  _goodxactcount++;
+
+  //End mutual exclusion of transaction
+  _xactmutex->Give();
+
+  return ERR_NONE;
 }
 
-template <typename T> int HCClient::Get(uint16_t pid, T& val)
+int HCClient::Batch(HCCell** icells, HCCell** ocells, int* errs, uint32_t count)
 {
+  uint32_t i;
+  uint32_t n;
+  uint32_t k;
+  uint32_t ipid;
+  uint32_t opid;
+  bool read;
+  int xerr;
+  int ierr;
+
+  //Assert valid arguments
+  assert((icells != 0) && (ocells != 0) && (errs != 0));
+
+  //Check for in-process server (raw cells are only exchanged with remote servers)
+  if(_server != 0)
+  {
+    for(i=0; i<count; i++)
+      errs[i] = ERR_UNSPEC;
+
+    return ERR_UNSPEC;
+  }
+
+  //Check for batch of reads only (may be spread across replicas)
+  for(i=0; (i < count) && HCCell::IsReadOpCode(icells[i]->GetOpCode()); i++);
+  read = (i == count);
+
+  //Begin mutual exclusion of transaction
+  _xactmutex->Wait();
+
+  //Send cells packed into as few messages as possible (cells must be idempotent since
+  //cells whose replies didn't fit in the reply message are sent again)
+  ierr = ERR_NONE;
+  i = 0;
+  while(i < count)
+  {
+    //Format outbound message with as many raw cells as fit
+    _omsg->Reset(_transaction);
+    for(n=0; ((i + n) < count) && _omsg->Write(icells[i + n]); n++);
+
+    //Check for cell that can't fit in a message by itself
+    if(n == 0)
+    {
+      errs[i++] = ERR_OVERFLOW;
+      ierr = ERR_OVERFLOW;
+      continue;
+    }
+
+    //Reset reply event
+    _replyevent->Reset();
+
+    //Set expected reply parameters (reply cells go straight to caller's cells)
+    _batchcells = ocells + i;
+    _batchmax = n;
+    _batchcount = 0;
+    _exptransaction = NextTransaction();
+    _expopcode = EXPOPCODE_BATCH;
+
+    //Print outbound message if requested
+    if(_debug)
+      _omsg->Print("Tx");
+
+    //Exchange messages with server and check for error
+    if((xerr = Exchange(read)) != ERR_NONE)
+    {
+      //Fail all cells in message
+      for(k=0; k<n; k++)
+        errs[i + k] = xerr;
+      ierr = xerr;
+    }
+    else
+    {
+      //Check each reply against its command
+      for(k=0; k<_batchcount; k++)
+      {
+        //Check for status opcode not following command opcode
+        if(ocells[i + k]->GetOpCode() != (icells[i + k]->GetOpCode() + 1))
+        {
+          _opcodeerrcount++;
+          break;
+        }
+
+        //Check for mismatched PIDs
+        if(!icells[i + k]->ReadPID(ipid) || !ocells[i + k]->ReadPID(opid) || (ipid != opid))
+        {
+          icells[i + k]->Rewind();
+          ocells[i + k]->Rewind();
+          _piderrcount++;
+          break;
+        }
+
+        //Leave cells ready to be read from the start
+        icells[i + k]->Rewind();
+        ocells[i + k]->Rewind();
+        errs[i + k] = ERR_NONE;
+      }
+
+      //Check for no usable replies (avoid resending forever)
+      if(k == 0)
+      {
+        errs[i] = ERR_UNSPEC;
+        ierr = ERR_UNSPEC;
+        n = 1;
+      }
+      else
+      {
+        //Increment good transaction count
+        _goodxactcount++;
+
+        //Resend cells without replies in next message
+        n = k;
+      }
+    }
+
+    //Clear batch reply storage
+    _batchcells = 0;
+    _batchmax = 0;
+
+    //Move to next unsent cell
+    i += n;
+  }
+
+  //End mutual exclusion of transaction
+  _xactmutex->Give();
+
+  return ierr;
+}
+
+int HCClient::QueryGet(const string& name, uint32_t* pids, string* vals, int* errs, uint32_t maxcount, uint32_t& count)
+{
+  HCCell qcell;
+  HCCell rcell;
+  uint32_t total;
+  uint32_t start;
+  uint32_t next;
+  uint8_t type;
+  int8_t berr;
+  int ierr;
+
+  //Assert valid arguments
+  assert((pids != 0) && (vals != 0) && (errs != 0));
+
+  //Fetch pages of results until all are returned or caller storage is full
+  count = 0;
+  next = 0;
+  do
+  {
+    //Format query cell starting at next result
+    start = next;
+    qcell.Reset(HCCell::OPCODE_QGET_CMD | _wideflag);
+    if(!qcell.Write(name) || !qcell.Write(start))
+      return ERR_OVERFLOW;
+
+    //Perform transaction and check for error
+    if((ierr = Forward(&qcell, &rcell)) != ERR_NONE)
+      return ierr;
+
+    //Read result count and index of next result and check for error
+    if(!rcell.Read(total) || !rcell.Read(next) || (next < start))
+      return ERR_DESER;
+
+    //Read results until end of cell or caller storage is full
+    while((rcell.GetUnread() > 0) && (count < maxcount))
+    {
+      //Read PID, type, value and error code and check for error
+      if(!rcell.ReadPID(pids[count]) || !rcell.Read(type) || !HCParameter::ValueString(&rcell, type, vals[count]) || !rcell.Read(berr))
+        return ERR_DESER;
+
+      errs[count++] = berr;
+    }
+  }
+  while((next > start) && (next < total) && (count < maxcount));
+
+  return ERR_NONE;
+}
+
+template <typename T> int HCClient::Get(uint32_t pid, T& val)
+{
+  HCParameter* param;
   uint8_t type;
   int8_t merr;
   int ierr;
@@ -372,6 +1107,17 @@ template <typename T> int HCClient::Get(uint16_t pid, T& val)
   //Determine type code
   type = HCParameter::TypeCode(val);
 
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, type, param)) == ERR_NONE)
+      ierr = DirectGet(param, val);
+    else
+      HCParameter::DefaultVal(val);
+
+    return ierr;
+  }
+
   //Take the transaction mutex
   _xactmutex->Wait();
 
@@ -398,21 +1144,31 @@ template <typename T> int HCClient::Get(uint16_t pid, T& val)
   return ierr;
 }
 
-template <typename T> int HCClient::Set(uint16_t pid, const T val)
+template <typename T> int HCClient::Set(uint32_t pid, const T val)
 {
+  HCParameter* param;
   uint8_t type;
   int ierr;
 
   //Determine type code
   type = HCParameter::TypeCode(val);
 
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, type, param)) == ERR_NONE)
+      ierr = DirectSet(param, val);
+
+    return ierr;
+  }
+
   //Begin mutual exclusion of transaction
   _xactmutex->Wait();
 
   //Format outbound message
   _omsg->Reset(_transaction);
-  _ocell->Reset(HCCell::OPCODE_SET_CMD);
-  _ocell->Write(pid);
+  _ocell->Reset(HCCell::OPCODE_SET_CMD | _wideflag);
+  _ocell->WritePID(pid);
   _ocell->Write(type);
   _ocell->Write(val);
   _omsg->Write(_ocell);
@@ -426,8 +1182,9 @@ template <typename T> int HCClient::Set(uint16_t pid, const T val)
   return ierr;
 }
 
-template <typename T> int HCClient::IGet(uint16_t pid, uint32_t eid, T& val)
+template <typename T> int HCClient::IGet(uint32_t pid, uint32_t eid, T& val)
 {
+  HCParameter* param;
   uint8_t type;
   int8_t merr;
   int ierr;
@@ -435,6 +1192,17 @@ template <typename T> int HCClient::IGet(uint16_t pid, uint32_t eid, T& val)
   //Determine type code
   type = HCParameter::TypeCode(val);
 
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, type, param)) == ERR_NONE)
+      ierr = DirectIGet(param, eid, val);
+    else
+      HCParameter::DefaultVal(val);
+
+    return ierr;
+  }
+
   //Take the transaction mutex
   _xactmutex->Wait();
 
@@ -461,21 +1229,31 @@ template <typename T> int HCClient::IGet(uint16_t pid, uint32_t eid, T& val)
   return ierr;
 }
 
-template <typename T> int HCClient::ISet(uint16_t pid, uint32_t eid, const T val)
+template <typename T> int HCClient::ISet(uint32_t pid, uint32_t eid, const T val)
 {
+  HCParameter* param;
   uint8_t type;
   int ierr;
 
   //Determine type code
   type = HCParameter::TypeCode(val);
 
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, type, param)) == ERR_NONE)
+      ierr = DirectISet(param, eid, val);
+
+    return ierr;
+  }
+
   //Begin mutual exclusion of transaction
   _xactmutex->Wait();
 
   //Format outbound message
   _omsg->Reset(_transaction);
-  _ocell->Reset(HCCell::OPCODE_ISET_CMD);
-  _ocell->Write(pid);
+  _ocell->Reset(HCCell::OPCODE_ISET_CMD | _wideflag);
+  _ocell->WritePID(pid);
   _ocell->Write(eid);
   _ocell->Write(type);
   _ocell->Write(val);
@@ -490,21 +1268,31 @@ template <typename T> int HCClient::ISet(uint16_t pid, uint32_t eid, const T val
   return ierr;
 }
 
-template <typename T> int HCClient::Add(uint16_t pid, const T val)
+template <typename T> int HCClient::Add(uint32_t pid, const T val)
 {
+  HCParameter* param;
   uint8_t type;
   int ierr;
 
   //Determine type code
   type = HCParameter::TypeCode(val);
 
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, type, param)) == ERR_NONE)
+      ierr = DirectAdd(param, val);
+
+    return ierr;
+  }
+
   //Begin mutual exclusion of transaction
   _xactmutex->Wait();
 
   //Format outbound message
   _omsg->Reset(_transaction);
-  _ocell->Reset(HCCell::OPCODE_ADD_CMD);
-  _ocell->Write(pid);
+  _ocell->Reset(HCCell::OPCODE_ADD_CMD | _wideflag);
+  _ocell->WritePID(pid);
   _ocell->Write(type);
   _ocell->Write(val);
   _omsg->Write(_ocell);
@@ -518,120 +1306,324 @@ template <typename T> int HCClient::Add(uint16_t pid, const T val)
   return ierr;
 }
 
-template <typename T> int HCClient::Sub(uint16_t pid, const T val)
+template <typename T> int HCClient::Sub(uint32_t pid, const T val)
 {
+  HCParameter* param;
   uint8_t type;
   int ierr;
 
   //Determine type code
   type = HCParameter::TypeCode(val);
 
-  //Begin mutual exclusion of transaction
-  _xactmutex->Wait();
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, type, param)) == ERR_NONE)
+      ierr = DirectSub(param, val);
+
+    return ierr;
+  }
+
+  //Begin mutual exclusion of transaction
+  _xactmutex->Wait();
+
+  //Format outbound message
+  _omsg->Reset(_transaction);
+  _ocell->Reset(HCCell::OPCODE_SUB_CMD | _wideflag);
+  _ocell->WritePID(pid);
+  _ocell->Write(type);
+  _ocell->Write(val);
+  _omsg->Write(_ocell);
+
+  //Perform sub transaction
+  ierr = SubXact(pid);
+
+  //End mutual exclusion of transaction
+  _xactmutex->Give();
+
+  return ierr;
+}
+
+template int HCClient::Get<bool>(uint32_t pid, bool& val);
+template int HCClient::Set<bool>(uint32_t pid, const bool val);
+template int HCClient::IGet<bool>(uint32_t pid, uint32_t eid, bool& val);
+template int HCClient::ISet<bool>(uint32_t pid, uint32_t eid, const bool val);
+template int HCClient::Add<bool>(uint32_t pid, const bool val);
+template int HCClient::Sub<bool>(uint32_t pid, const bool val);
+
+template int HCClient::Get<string>(uint32_t pid, string& val);
+template int HCClient::Set<string>(uint32_t pid, const string val);
+template int HCClient::IGet<string>(uint32_t pid, uint32_t eid, string& val);
+template int HCClient::ISet<string>(uint32_t pid, uint32_t eid, const string val);
+template int HCClient::Add<string>(uint32_t pid, const string val);
+template int HCClient::Sub<string>(uint32_t pid, const string val);
+
+template int HCClient::Get<int8_t>(uint32_t pid, int8_t& val);
+template int HCClient::Set<int8_t>(uint32_t pid, const int8_t val);
+template int HCClient::IGet<int8_t>(uint32_t pid, uint32_t eid, int8_t& val);
+template int HCClient::ISet<int8_t>(uint32_t pid, uint32_t eid, const int8_t val);
+template int HCClient::Add<int8_t>(uint32_t pid, const int8_t val);
+template int HCClient::Sub<int8_t>(uint32_t pid, const int8_t val);
+
+template int HCClient::Get<int16_t>(uint32_t pid, int16_t& val);
+template int HCClient::Set<int16_t>(uint32_t pid, const int16_t val);
+template int HCClient::IGet<int16_t>(uint32_t pid, uint32_t eid, int16_t& val);
+template int HCClient::ISet<int16_t>(uint32_t pid, uint32_t eid, const int16_t val);
+template int HCClient::Add<int16_t>(uint32_t pid, const int16_t val);
+template int HCClient::Sub<int16_t>(uint32_t pid, const int16_t val);
+
+template int HCClient::Get<int32_t>(uint32_t pid, int32_t& val);
+template int HCClient::Set<int32_t>(uint32_t pid, const int32_t val);
+template int HCClient::IGet<int32_t>(uint32_t pid, uint32_t eid, int32_t& val);
+template int HCClient::ISet<int32_t>(uint32_t pid, uint32_t eid, const int32_t val);
+template int HCClient::Add<int32_t>(uint32_t pid, const int32_t val);
+template int HCClient::Sub<int32_t>(uint32_t pid, const int32_t val);
+
+template int HCClient::Get<int64_t>(uint32_t pid, int64_t& val);
+template int HCClient::Set<int64_t>(uint32_t pid, const int64_t val);
+template int HCClient::IGet<int64_t>(uint32_t pid, uint32_t eid, int64_t& val);
+template int HCClient::ISet<int64_t>(uint32_t pid, uint32_t eid, const int64_t val);
+template int HCClient::Add<int64_t>(uint32_t pid, const int64_t val);
+template int HCClient::Sub<int64_t>(uint32_t pid, const int64_t val);
+
+template int HCClient::Get<uint8_t>(uint32_t pid, uint8_t& val);
+template int HCClient::Set<uint8_t>(uint32_t pid, const uint8_t val);
+template int HCClient::IGet<uint8_t>(uint32_t pid, uint32_t eid, uint8_t& val);
+template int HCClient::ISet<uint8_t>(uint32_t pid, uint32_t eid, const uint8_t val);
+template int HCClient::Add<uint8_t>(uint32_t pid, const uint8_t val);
+template int HCClient::Sub<uint8_t>(uint32_t pid, const uint8_t val);
+
+template int HCClient::Get<uint16_t>(uint32_t pid, uint16_t& val);
+template int HCClient::Set<uint16_t>(uint32_t pid, const uint16_t val);
+template int HCClient::IGet<uint16_t>(uint32_t pid, uint32_t eid, uint16_t& val);
+template int HCClient::ISet<uint16_t>(uint32_t pid, uint32_t eid, const uint16_t val);
+template int HCClient::Add<uint16_t>(uint32_t pid, const uint16_t val);
+template int HCClient::Sub<uint16_t>(uint32_t pid, const uint16_t val);
+
+template int HCClient::Get<uint32_t>(uint32_t pid, uint32_t& val);
+template int HCClient::Set<uint32_t>(uint32_t pid, const uint32_t val);
+template int HCClient::IGet<uint32_t>(uint32_t pid, uint32_t eid, uint32_t& val);
+template int HCClient::ISet<uint32_t>(uint32_t pid, uint32_t eid, const uint32_t val);
+template int HCClient::Add<uint32_t>(uint32_t pid, const uint32_t val);
+template int HCClient::Sub<uint32_t>(uint32_t pid, const uint32_t val);
+
+template int HCClient::Get<uint64_t>(uint32_t pid, uint64_t& val);
+template int HCClient::Set<uint64_t>(uint32_t pid, const uint64_t val);
+template int HCClient::IGet<uint64_t>(uint32_t pid, uint32_t eid, uint64_t& val);
+template int HCClient::ISet<uint64_t>(uint32_t pid, uint32_t eid, const uint64_t val);
+template int HCClient::Add<uint64_t>(uint32_t pid, const uint64_t val);
+template int HCClient::Sub<uint64_t>(uint32_t pid, const uint64_t val);
+
+template int HCClient::Get<float>(uint32_t pid, float& val);
+template int HCClient::Set<float>(uint32_t pid, const float val);
+template int HCClient::IGet<float>(uint32_t pid, uint32_t eid, float& val);
+template int HCClient::ISet<float>(uint32_t pid, uint32_t eid, const float val);
+template int HCClient::Add<float>(uint32_t pid, const float val);
+template int HCClient::Sub<float>(uint32_t pid, const float val);
+
+template int HCClient::Get<double>(uint32_t pid, double& val);
+template int HCClient::Set<double>(uint32_t pid, const double val);
+template int HCClient::IGet<double>(uint32_t pid, uint32_t eid, double& val);
+template int HCClient::ISet<double>(uint32_t pid, uint32_t eid, const double val);
+template int HCClient::Add<double>(uint32_t pid, const double val);
+template int HCClient::Sub<double>(uint32_t pid, const double val);
+
+template <typename T> static int DecodeVal(HCCell* cell, void* val, int err)
+{
+  int8_t merr;
+
+  //Check for transaction error
+  if(err != ERR_NONE)
+  {
+    //Set to default value
+    HCParameter::DefaultVal(*(T*)val);
+    return err;
+  }
+
+  //Read value and error from inbound cell (already skipped past PID, EID and type)
+  cell->Read(*(T*)val);
+  cell->Read(merr);
+
+  return (int)merr;
+}
+
+template <typename T> int HCClient::Get(uint32_t pid, T& val, HCAsync* xact)
+{
+  //Assert valid arguments
+  assert(xact != 0);
+
+  //Check for transaction already in flight
+  if(!xact->IsDone())
+    return ERR_INVALID;
+
+  //Get server parameter directly if in-process
+  if(_server != 0)
+    return CompleteAsync(xact, Get(pid, val));
+
+  //Format outbound cell and note where value goes
+  PrepareAsync(xact, pid, HCCell::OPCODE_GET_STS | _wideflag);
+  xact->_cell->Reset(HCCell::OPCODE_GET_CMD | _wideflag);
+  xact->_cell->WritePID(pid);
+  xact->_type = HCParameter::TypeCode(val);
+  xact->_val = &val;
+  xact->_decoder = DecodeVal<T>;
+
+  //Start get transaction
+  return StartAsync(xact, true);
+}
+
+template <typename T> int HCClient::Set(uint32_t pid, const T val, HCAsync* xact)
+{
+  uint8_t type;
+
+  //Assert valid arguments
+  assert(xact != 0);
+
+  //Check for transaction already in flight
+  if(!xact->IsDone())
+    return ERR_INVALID;
+
+  //Set server parameter directly if in-process
+  if(_server != 0)
+    return CompleteAsync(xact, Set(pid, val));
+
+  //Determine type code
+  type = HCParameter::TypeCode(val);
+
+  //Format outbound cell
+  PrepareAsync(xact, pid, HCCell::OPCODE_SET_STS | _wideflag);
+  xact->_cell->Reset(HCCell::OPCODE_SET_CMD | _wideflag);
+  xact->_cell->WritePID(pid);
+  xact->_cell->Write(type);
+  xact->_cell->Write(val);
+
+  //Start set transaction
+  return StartAsync(xact, false);
+}
+
+template <typename T> int HCClient::IGet(uint32_t pid, uint32_t eid, T& val, HCAsync* xact)
+{
+  //Assert valid arguments
+  assert(xact != 0);
+
+  //Check for transaction already in flight
+  if(!xact->IsDone())
+    return ERR_INVALID;
+
+  //Get server parameter directly if in-process
+  if(_server != 0)
+    return CompleteAsync(xact, IGet(pid, eid, val));
+
+  //Format outbound cell and note where value goes
+  PrepareAsync(xact, pid, HCCell::OPCODE_IGET_STS | _wideflag);
+  xact->_cell->Reset(HCCell::OPCODE_IGET_CMD | _wideflag);
+  xact->_cell->WritePID(pid);
+  xact->_cell->Write(eid);
+  xact->_eid = eid;
+  xact->_checkeid = true;
+  xact->_type = HCParameter::TypeCode(val);
+  xact->_val = &val;
+  xact->_decoder = DecodeVal<T>;
+
+  //Start get transaction
+  return StartAsync(xact, true);
+}
+
+template <typename T> int HCClient::ISet(uint32_t pid, uint32_t eid, const T val, HCAsync* xact)
+{
+  uint8_t type;
 
-  //Format outbound message
-  _omsg->Reset(_transaction);
-  _ocell->Reset(HCCell::OPCODE_SUB_CMD);
-  _ocell->Write(pid);
-  _ocell->Write(type);
-  _ocell->Write(val);
-  _omsg->Write(_ocell);
+  //Assert valid arguments
+  assert(xact != 0);
 
-  //Perform sub transaction
-  ierr = SubXact(pid);
+  //Check for transaction already in flight
+  if(!xact->IsDone())
+    return ERR_INVALID;
 
-  //End mutual exclusion of transaction
-  _xactmutex->Give();
+  //Set server parameter directly if in-process
+  if(_server != 0)
+    return CompleteAsync(xact, ISet(pid, eid, val));
 
-  return ierr;
+  //Determine type code
+  type = HCParameter::TypeCode(val);
+
+  //Format outbound cell
+  PrepareAsync(xact, pid, HCCell::OPCODE_ISET_STS | _wideflag);
+  xact->_cell->Reset(HCCell::OPCODE_ISET_CMD | _wideflag);
+  xact->_cell->WritePID(pid);
+  xact->_cell->Write(eid);
+  xact->_cell->Write(type);
+  xact->_cell->Write(val);
+  xact->_eid = eid;
+  xact->_checkeid = true;
+
+  //Start set transaction
+  return StartAsync(xact, false);
 }
 
-template int HCClient::Get<bool>(uint16_t pid, bool& val);
-template int HCClient::Set<bool>(uint16_t pid, const bool val);
-template int HCClient::IGet<bool>(uint16_t pid, uint32_t eid, bool& val);
-template int HCClient::ISet<bool>(uint16_t pid, uint32_t eid, const bool val);
-template int HCClient::Add<bool>(uint16_t pid, const bool val);
-template int HCClient::Sub<bool>(uint16_t pid, const bool val);
-
-template int HCClient::Get<string>(uint16_t pid, string& val);
-template int HCClient::Set<string>(uint16_t pid, const string val);
-template int HCClient::IGet<string>(uint16_t pid, uint32_t eid, string& val);
-template int HCClient::ISet<string>(uint16_t pid, uint32_t eid, const string val);
-template int HCClient::Add<string>(uint16_t pid, const string val);
-template int HCClient::Sub<string>(uint16_t pid, const string val);
-
-template int HCClient::Get<int8_t>(uint16_t pid, int8_t& val);
-template int HCClient::Set<int8_t>(uint16_t pid, const int8_t val);
-template int HCClient::IGet<int8_t>(uint16_t pid, uint32_t eid, int8_t& val);
-template int HCClient::ISet<int8_t>(uint16_t pid, uint32_t eid, const int8_t val);
-template int HCClient::Add<int8_t>(uint16_t pid, const int8_t val);
-template int HCClient::Sub<int8_t>(uint16_t pid, const int8_t val);
-
-template int HCClient::Get<int16_t>(uint16_t pid, int16_t& val);
-template int HCClient::Set<int16_t>(uint16_t pid, const int16_t val);
-template int HCClient::IGet<int16_t>(uint16_t pid, uint32_t eid, int16_t& val);
-template int HCClient::ISet<int16_t>(uint16_t pid, uint32_t eid, const int16_t val);
-template int HCClient::Add<int16_t>(uint16_t pid, const int16_t val);
-template int HCClient::Sub<int16_t>(uint16_t pid, const int16_t val);
-
-template int HCClient::Get<int32_t>(uint16_t pid, int32_t& val);
-template int HCClient::Set<int32_t>(uint16_t pid, const int32_t val);
-template int HCClient::IGet<int32_t>(uint16_t pid, uint32_t eid, int32_t& val);
-template int HCClient::ISet<int32_t>(uint16_t pid, uint32_t eid, const int32_t val);
-template int HCClient::Add<int32_t>(uint16_t pid, const int32_t val);
-template int HCClient::Sub<int32_t>(uint16_t pid, const int32_t val);
-
-template int HCClient::Get<int64_t>(uint16_t pid, int64_t& val);
-template int HCClient::Set<int64_t>(uint16_t pid, const int64_t val);
-template int HCClient::IGet<int64_t>(uint16_t pid, uint32_t eid, int64_t& val);
-template int HCClient::ISet<int64_t>(uint16_t pid, uint32_t eid, const int64_t val);
-template int HCClient::Add<int64_t>(uint16_t pid, const int64_t val);
-template int HCClient::Sub<int64_t>(uint16_t pid, const int64_t val);
-
-template int HCClient::Get<uint8_t>(uint16_t pid, uint8_t& val);
-template int HCClient::Set<uint8_t>(uint16_t pid, const uint8_t val);
-template int HCClient::IGet<uint8_t>(uint16_t pid, uint32_t eid, uint8_t& val);
-template int HCClient::ISet<uint8_t>(uint16_t pid, uint32_t eid, const uint8_t val);
-template int HCClient::Add<uint8_t>(uint16_t pid, const uint8_t val);
-template int HCClient::Sub<uint8_t>(uint16_t pid, const uint8_t val);
-
-template int HCClient::Get<uint16_t>(uint16_t pid, uint16_t& val);
-template int HCClient::Set<uint16_t>(uint16_t pid, const uint16_t val);
-template int HCClient::IGet<uint16_t>(uint16_t pid, uint32_t eid, uint16_t& val);
-template int HCClient::ISet<uint16_t>(uint16_t pid, uint32_t eid, const uint16_t val);
-template int HCClient::Add<uint16_t>(uint16_t pid, const uint16_t val);
-template int HCClient::Sub<uint16_t>(uint16_t pid, const uint16_t val);
-
-template int HCClient::Get<uint32_t>(uint16_t pid, uint32_t& val);
-template int HCClient::Set<uint32_t>(uint16_t pid, const uint32_t val);
-template int HCClient::IGet<uint32_t>(uint16_t pid, uint32_t eid, uint32_t& val);
-template int HCClient::ISet<uint32_t>(uint16_t pid, uint32_t eid, const uint32_t val);
-template int HCClient::Add<uint32_t>(uint16_t pid, const uint32_t val);
-template int HCClient::Sub<uint32_t>(uint16_t pid, const uint32_t val);
-
-template int HCClient::Get<uint64_t>(uint16_t pid, uint64_t& val);
-template int HCClient::Set<uint64_t>(uint16_t pid, const uint64_t val);
-template int HCClient::IGet<uint64_t>(uint16_t pid, uint32_t eid, uint64_t& val);
-template int HCClient::ISet<uint64_t>(uint16_t pid, uint32_t eid, const uint64_t val);
-template int HCClient::Add<uint64_t>(uint16_t pid, const uint64_t val);
-template int HCClient::Sub<uint64_t>(uint16_t pid, const uint64_t val);
-
-template int HCClient::Get<float>(uint16_t pid, float& val);
-template int HCClient::Set<float>(uint16_t pid, const float val);
-template int HCClient::IGet<float>(uint16_t pid, uint32_t eid, float& val);
-template int HCClient::ISet<float>(uint16_t pid, uint32_t eid, const float val);
-template int HCClient::Add<float>(uint16_t pid, const float val);
-template int HCClient::Sub<float>(uint16_t pid, const float val);
-
-template int HCClient::Get<double>(uint16_t pid, double& val);
-template int HCClient::Set<double>(uint16_t pid, const double val);
-template int HCClient::IGet<double>(uint16_t pid, uint32_t eid, double& val);
-template int HCClient::ISet<double>(uint16_t pid, uint32_t eid, const double val);
-template int HCClient::Add<double>(uint16_t pid, const double val);
-template int HCClient::Sub<double>(uint16_t pid, const double val);
-
-template <typename T> int HCClient::Get(uint16_t pid, T& val0, T& val1)
+template int HCClient::Get<bool>(uint32_t pid, bool& val, HCAsync* xact);
+template int HCClient::Set<bool>(uint32_t pid, const bool val, HCAsync* xact);
+template int HCClient::IGet<bool>(uint32_t pid, uint32_t eid, bool& val, HCAsync* xact);
+template int HCClient::ISet<bool>(uint32_t pid, uint32_t eid, const bool val, HCAsync* xact);
+
+template int HCClient::Get<string>(uint32_t pid, string& val, HCAsync* xact);
+template int HCClient::Set<string>(uint32_t pid, const string val, HCAsync* xact);
+template int HCClient::IGet<string>(uint32_t pid, uint32_t eid, string& val, HCAsync* xact);
+template int HCClient::ISet<string>(uint32_t pid, uint32_t eid, const string val, HCAsync* xact);
+
+template int HCClient::Get<int8_t>(uint32_t pid, int8_t& val, HCAsync* xact);
+template int HCClient::Set<int8_t>(uint32_t pid, const int8_t val, HCAsync* xact);
+template int HCClient::IGet<int8_t>(uint32_t pid, uint32_t eid, int8_t& val, HCAsync* xact);
+template int HCClient::ISet<int8_t>(uint32_t pid, uint32_t eid, const int8_t val, HCAsync* xact);
+
+template int HCClient::Get<int16_t>(uint32_t pid, int16_t& val, HCAsync* xact);
+template int HCClient::Set<int16_t>(uint32_t pid, const int16_t val, HCAsync* xact);
+template int HCClient::IGet<int16_t>(uint32_t pid, uint32_t eid, int16_t& val, HCAsync* xact);
+template int HCClient::ISet<int16_t>(uint32_t pid, uint32_t eid, const int16_t val, HCAsync* xact);
+
+template int HCClient::Get<int32_t>(uint32_t pid, int32_t& val, HCAsync* xact);
+template int HCClient::Set<int32_t>(uint32_t pid, const int32_t val, HCAsync* xact);
+template int HCClient::IGet<int32_t>(uint32_t pid, uint32_t eid, int32_t& val, HCAsync* xact);
+template int HCClient::ISet<int32_t>(uint32_t pid, uint32_t eid, const int32_t val, HCAsync* xact);
+
+template int HCClient::Get<int64_t>(uint32_t pid, int64_t& val, HCAsync* xact);
+template int HCClient::Set<int64_t>(uint32_t pid, const int64_t val, HCAsync* xact);
+template int HCClient::IGet<int64_t>(uint32_t pid, uint32_t eid, int64_t& val, HCAsync* xact);
+template int HCClient::ISet<int64_t>(uint32_t pid, uint32_t eid, const int64_t val, HCAsync* xact);
+
+template int HCClient::Get<uint8_t>(uint32_t pid, uint8_t& val, HCAsync* xact);
+template int HCClient::Set<uint8_t>(uint32_t pid, const uint8_t val, HCAsync* xact);
+template int HCClient::IGet<uint8_t>(uint32_t pid, uint32_t eid, uint8_t& val, HCAsync* xact);
+template int HCClient::ISet<uint8_t>(uint32_t pid, uint32_t eid, const uint8_t val, HCAsync* xact);
+
+template int HCClient::Get<uint16_t>(uint32_t pid, uint16_t& val, HCAsync* xact);
+template int HCClient::Set<uint16_t>(uint32_t pid, const uint16_t val, HCAsync* xact);
+template int HCClient::IGet<uint16_t>(uint32_t pid, uint32_t eid, uint16_t& val, HCAsync* xact);
+template int HCClient::ISet<uint16_t>(uint32_t pid, uint32_t eid, const uint16_t val, HCAsync* xact);
+
+template int HCClient::Get<uint32_t>(uint32_t pid, uint32_t& val, HCAsync* xact);
+template int HCClient::Set<uint32_t>(uint32_t pid, const uint32_t val, HCAsync* xact);
+template int HCClient::IGet<uint32_t>(uint32_t pid, uint32_t eid, uint32_t& val, HCAsync* xact);
+template int HCClient::ISet<uint32_t>(uint32_t pid, uint32_t eid, const uint32_t val, HCAsync* xact);
+
+template int HCClient::Get<uint64_t>(uint32_t pid, uint64_t& val, HCAsync* xact);
+template int HCClient::Set<uint64_t>(uint32_t pid, const uint64_t val, HCAsync* xact);
+template int HCClient::IGet<uint64_t>(uint32_t pid, uint32_t eid, uint64_t& val, HCAsync* xact);
+template int HCClient::ISet<uint64_t>(uint32_t pid, uint32_t eid, const uint64_t val, HCAsync* xact);
+
+template int HCClient::Get<float>(uint32_t pid, float& val, HCAsync* xact);
+template int HCClient::Set<float>(uint32_t pid, const float val, HCAsync* xact);
+template int HCClient::IGet<float>(uint32_t pid, uint32_t eid, float& val, HCAsync* xact);
+template int HCClient::ISet<float>(uint32_t pid, uint32_t eid, const float val, HCAsync* xact);
+
+template int HCClient::Get<double>(uint32_t pid, double& val, HCAsync* xact);
+template int HCClient::Set<double>(uint32_t pid, const double val, HCAsync* xact);
+template int HCClient::IGet<double>(uint32_t pid, uint32_t eid, double& val, HCAsync* xact);
+template int HCClient::ISet<double>(uint32_t pid, uint32_t eid, const double val, HCAsync* xact);
+
+template <typename T> int HCClient::Get(uint32_t pid, T& val0, T& val1)
 {
+  HCParameter* param;
   uint8_t type;
   int8_t merr;
   int ierr;
@@ -639,6 +1631,17 @@ template <typename T> int HCClient::Get(uint16_t pid, T& val0, T& val1)
   //Determine type code
   type = HCParameter::TypeCode(val0, val1);
 
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, type, param)) == ERR_NONE)
+      ierr = param->GetVec(val0, val1);
+    else
+      HCParameter::DefaultVal(val0, val1);
+
+    return ierr;
+  }
+
   //Take the transaction mutex
   _xactmutex->Wait();
 
@@ -666,21 +1669,31 @@ template <typename T> int HCClient::Get(uint16_t pid, T& val0, T& val1)
   return ierr;
 }
 
-template <typename T> int HCClient::Set(uint16_t pid, const T val0, const T val1)
+template <typename T> int HCClient::Set(uint32_t pid, const T val0, const T val1)
 {
+  HCParameter* param;
   uint8_t type;
   int ierr;
 
   //Determine type code
   type = HCParameter::TypeCode(val0, val1);
 
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, type, param)) == ERR_NONE)
+      ierr = param->SetVec(val0, val1);
+
+    return ierr;
+  }
+
   //Begin mutual exclusion of transaction
   _xactmutex->Wait();
 
   //Format outbound message
   _omsg->Reset(_transaction);
-  _ocell->Reset(HCCell::OPCODE_SET_CMD);
-  _ocell->Write(pid);
+  _ocell->Reset(HCCell::OPCODE_SET_CMD | _wideflag);
+  _ocell->WritePID(pid);
   _ocell->Write(type);
   _ocell->Write(val0);
   _ocell->Write(val1);
@@ -695,8 +1708,9 @@ template <typename T> int HCClient::Set(uint16_t pid, const T val0, const T val1
   return ierr;
 }
 
-template <typename T> int HCClient::IGet(uint16_t pid, uint32_t eid, T& val0, T& val1)
+template <typename T> int HCClient::IGet(uint32_t pid, uint32_t eid, T& val0, T& val1)
 {
+  HCParameter* param;
   uint8_t type;
   int8_t merr;
   int ierr;
@@ -704,6 +1718,17 @@ template <typename T> int HCClient::IGet(uint16_t pid, uint32_t eid, T& val0, T&
   //Determine type code
   type = HCParameter::TypeCode(val0, val1);
 
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, type, param)) == ERR_NONE)
+      ierr = param->GetVecTbl(eid, val0, val1);
+    else
+      HCParameter::DefaultVal(val0, val1);
+
+    return ierr;
+  }
+
   //Take the transaction mutex
   _xactmutex->Wait();
 
@@ -731,21 +1756,31 @@ template <typename T> int HCClient::IGet(uint16_t pid, uint32_t eid, T& val0, T&
   return ierr;
 }
 
-template <typename T> int HCClient::ISet(uint16_t pid, uint32_t eid, const T val0, const T val1)
+template <typename T> int HCClient::ISet(uint32_t pid, uint32_t eid, const T val0, const T val1)
 {
+  HCParameter* param;
   uint8_t type;
   int ierr;
 
   //Determine type code
   type = HCParameter::TypeCode(val0, val1);
 
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, type, param)) == ERR_NONE)
+      ierr = param->SetVecTbl(eid, val0, val1);
+
+    return ierr;
+  }
+
   //Begin mutual exclusion of transaction
   _xactmutex->Wait();
 
   //Format outbound message
   _omsg->Reset(_transaction);
-  _ocell->Reset(HCCell::OPCODE_ISET_CMD);
-  _ocell->Write(pid);
+  _ocell->Reset(HCCell::OPCODE_ISET_CMD | _wideflag);
+  _ocell->WritePID(pid);
   _ocell->Write(eid);
   _ocell->Write(type);
   _ocell->Write(val0);
@@ -761,18 +1796,19 @@ template <typename T> int HCClient::ISet(uint16_t pid, uint32_t eid, const T val
   return ierr;
 }
 
-template int HCClient::Get<float>(uint16_t pid, float& val0, float& val1);
-template int HCClient::Set<float>(uint16_t pid, const float val0, const float val1);
-template int HCClient::IGet<float>(uint16_t pid, uint32_t eid, float& val0, float& val1);
-template int HCClient::ISet<float>(uint16_t pid, uint32_t eid, const float val0, const float val1);
+template int HCClient::Get<float>(uint32_t pid, float& val0, float& val1);
+template int HCClient::Set<float>(uint32_t pid, const float val0, const float val1);
+template int HCClient::IGet<float>(uint32_t pid, uint32_t eid, float& val0, float& val1);
+template int HCClient::ISet<float>(uint32_t pid, uint32_t eid, const float val0, const float val1);
 
-template int HCClient::Get<double>(uint16_t pid, double& val0, double& val1);
-template int HCClient::Set<double>(uint16_t pid, const double val0, const double val1);
-template int HCClient::IGet<double>(uint16_t pid, uint32_t eid, double& val0, double& val1);
-template int HCClient::ISet<double>(uint16_t pid, uint32_t eid, const double val0, const double val1);
+template int HCClient::Get<double>(uint32_t pid, double& val0, double& val1);
+template int HCClient::Set<double>(uint32_t pid, const double val0, const double val1);
+template int HCClient::IGet<double>(uint32_t pid, uint32_t eid, double& val0, double& val1);
+template int HCClient::ISet<double>(uint32_t pid, uint32_t eid, const double val0, const double val1);
 
-template <typename T> int HCClient::Get(uint16_t pid, T& val0, T& val1, T& val2)
+template <typename T> int HCClient::Get(uint32_t pid, T& val0, T& val1, T& val2)
 {
+  HCParameter* param;
   uint8_t type;
   int8_t merr;
   int ierr;
@@ -780,6 +1816,17 @@ template <typename T> int HCClient::Get(uint16_t pid, T& val0, T& val1, T& val2)
   //Determine type code
   type = HCParameter::TypeCode(val0, val1, val2);
 
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, type, param)) == ERR_NONE)
+      ierr = param->GetVec(val0, val1, val2);
+    else
+      HCParameter::DefaultVal(val0, val1, val2);
+
+    return ierr;
+  }
+
   //Take the transaction mutex
   _xactmutex->Wait();
 
@@ -808,21 +1855,31 @@ template <typename T> int HCClient::Get(uint16_t pid, T& val0, T& val1, T& val2)
   return ierr;
 }
 
-template <typename T> int HCClient::Set(uint16_t pid, const T val0, const T val1, const T val2)
+template <typename T> int HCClient::Set(uint32_t pid, const T val0, const T val1, const T val2)
 {
+  HCParameter* param;
   uint8_t type;
   int ierr;
 
   //Determine type code
   type = HCParameter::TypeCode(val0, val1, val2);
 
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, type, param)) == ERR_NONE)
+      ierr = param->SetVec(val0, val1, val2);
+
+    return ierr;
+  }
+
   //Begin mutual exclusion of transaction
   _xactmutex->Wait();
 
   //Format outbound message
   _omsg->Reset(_transaction);
-  _ocell->Reset(HCCell::OPCODE_SET_CMD);
-  _ocell->Write(pid);
+  _ocell->Reset(HCCell::OPCODE_SET_CMD | _wideflag);
+  _ocell->WritePID(pid);
   _ocell->Write(type);
   _ocell->Write(val0);
   _ocell->Write(val1);
@@ -838,8 +1895,9 @@ template <typename T> int HCClient::Set(uint16_t pid, const T val0, const T val1
   return ierr;
 }
 
-template <typename T> int HCClient::IGet(uint16_t pid, uint32_t eid, T& val0, T& val1, T& val2)
+template <typename T> int HCClient::IGet(uint32_t pid, uint32_t eid, T& val0, T& val1, T& val2)
 {
+  HCParameter* param;
   uint8_t type;
   int8_t merr;
   int ierr;
@@ -847,6 +1905,17 @@ template <typename T> int HCClient::IGet(uint16_t pid, uint32_t eid, T& val0, T&
   //Determine type code
   type = HCParameter::TypeCode(val0, val1, val2);
 
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, type, param)) == ERR_NONE)
+      ierr = param->GetVecTbl(eid, val0, val1, val2);
+    else
+      HCParameter::DefaultVal(val0, val1, val2);
+
+    return ierr;
+  }
+
   //Take the transaction mutex
   _xactmutex->Wait();
 
@@ -875,21 +1944,31 @@ template <typename T> int HCClient::IGet(uint16_t pid, uint32_t eid, T& val0, T&
   return ierr;
 }
 
-template <typename T> int HCClient::ISet(uint16_t pid, uint32_t eid, const T val0, const T val1, const T val2)
+template <typename T> int HCClient::ISet(uint32_t pid, uint32_t eid, const T val0, const T val1, const T val2)
 {
+  HCParameter* param;
   uint8_t type;
   int ierr;
 
   //Determine type code
   type = HCParameter::TypeCode(val0, val1, val2);
 
+  //Call server parameter directly if in-process
+  if(_server != 0)
+  {
+    if((ierr = DirectParam(pid, type, param)) == ERR_NONE)
+      ierr = param->SetVecTbl(eid, val0, val1, val2);
+
+    return ierr;
+  }
+
   //Begin mutual exclusion of transaction
   _xactmutex->Wait();
 
   //Format outbound message
   _omsg->Reset(_transaction);
-  _ocell->Reset(HCCell::OPCODE_ISET_CMD);
-  _ocell->Write(pid);
+  _ocell->Reset(HCCell::OPCODE_ISET_CMD | _wideflag);
+  _ocell->WritePID(pid);
   _ocell->Write(eid);
   _ocell->Write(type);
   _ocell->Write(val0);
@@ -906,17 +1985,17 @@ template <typename T> int HCClient::ISet(uint16_t pid, uint32_t eid, const T val
   return ierr;
 }
 
-template int HCClient::Get<float>(uint16_t pid, float& val0, float& val1, float& val2);
-template int HCClient::Set<float>(uint16_t pid, const float val0, const float val1, const float val2);
-template int HCClient::IGet<float>(uint16_t pid, uint32_t eid, float& val0, float& val1, float& val2);
-template int HCClient::ISet<float>(uint16_t pid, uint32_t eid, const float val0, const float val1, const float val2);
+template int HCClient::Get<float>(uint32_t pid, float& val0, float& val1, float& val2);
+template int HCClient::Set<float>(uint32_t pid, const float val0, const float val1, const float val2);
+template int HCClient::IGet<float>(uint32_t pid, uint32_t eid, float& val0, float& val1, float& val2);
+template int HCClient::ISet<float>(uint32_t pid, uint32_t eid, const float val0, const float val1, const float val2);
 
-template int HCClient::Get<double>(uint16_t pid, double& val0, double& val1, double& val2);
-template int HCClient::Set<double>(uint16_t pid, const double val0, const double val1, const double val2);
-template int HCClient::IGet<double>(uint16_t pid, uint32_t eid, double& val0, double& val1, double& val2);
-template int HCClient::ISet<double>(uint16_t pid, uint32_t eid, const double val0, const double val1, const double val2);
+template int HCClient::Get<double>(uint32_t pid, double& val0, double& val1, double& val2);
+template int HCClient::Set<double>(uint32_t pid, const double val0, const double val1, const double val2);
+template int HCClient::IGet<double>(uint32_t pid, uint32_t eid, double& val0, double& val1, double& val2);
+template int HCClient::ISet<double>(uint32_t pid, uint32_t eid, const double val0, const double val1, const double val2);
 
-template <typename T> int HCClient::Get(uint16_t pid, T* val, uint16_t maxlen, uint16_t& len)
+template <typename T> int HCClient::Get(uint32_t pid, T* val, uint16_t maxlen, uint16_t& len)
 {
   uint8_t type;
   int8_t merr;
@@ -925,6 +2004,14 @@ template <typename T> int HCClient::Get(uint16_t pid, T* val, uint16_t maxlen, u
   //Determine type code
   type = HCParameter::TypeCode(val);
 
+  //Check for in-process server (array parameters are only served remotely)
+  if(_server != 0)
+  {
+    HCParameter::DefaultVal(val, maxlen, len);
+    _typeerrcount++;
+    return ERR_TYPE;
+  }
+
   //Take the transaction mutex
   _xactmutex->Wait();
 
@@ -951,7 +2038,7 @@ template <typename T> int HCClient::Get(uint16_t pid, T* val, uint16_t maxlen, u
   return ierr;
 }
 
-template <typename T> int HCClient::Set(uint16_t pid, const T* val, uint16_t len)
+template <typename T> int HCClient::Set(uint32_t pid, const T* val, uint16_t len)
 {
   uint8_t type;
   int ierr;
@@ -959,13 +2046,20 @@ template <typename T> int HCClient::Set(uint16_t pid, const T* val, uint16_t len
   //Determine type code
   type = HCParameter::TypeCode(val);
 
+  //Check for in-process server (array parameters are only served remotely)
+  if(_server != 0)
+  {
+    _typeerrcount++;
+    return ERR_TYPE;
+  }
+
   //Begin mutual exclusion of transaction
   _xactmutex->Wait();
 
   //Format outbound message
   _omsg->Reset(_transaction);
-  _ocell->Reset(HCCell::OPCODE_SET_CMD);
-  _ocell->Write(pid);
+  _ocell->Reset(HCCell::OPCODE_SET_CMD | _wideflag);
+  _ocell->WritePID(pid);
   _ocell->Write(type);
   _ocell->Write(val, len);
   _omsg->Write(_ocell);
@@ -979,75 +2073,164 @@ template <typename T> int HCClient::Set(uint16_t pid, const T* val, uint16_t len
   return ierr;
 }
 
-template int HCClient::Get<int8_t>(uint16_t pid, int8_t* val, uint16_t maxlen, uint16_t& len);
-template int HCClient::Set<int8_t>(uint16_t pid, const int8_t* val, uint16_t len);
-template int HCClient::Get<int16_t>(uint16_t pid, int16_t* val, uint16_t maxlen, uint16_t& len);
-template int HCClient::Set<int16_t>(uint16_t pid, const int16_t* val, uint16_t len);
-template int HCClient::Get<int32_t>(uint16_t pid, int32_t* val, uint16_t maxlen, uint16_t& len);
-template int HCClient::Set<int32_t>(uint16_t pid, const int32_t* val, uint16_t len);
-template int HCClient::Get<int64_t>(uint16_t pid, int64_t* val, uint16_t maxlen, uint16_t& len);
-template int HCClient::Set<int64_t>(uint16_t pid, const int64_t* val, uint16_t len);
+template int HCClient::Get<int8_t>(uint32_t pid, int8_t* val, uint16_t maxlen, uint16_t& len);
+template int HCClient::Set<int8_t>(uint32_t pid, const int8_t* val, uint16_t len);
+template int HCClient::Get<int16_t>(uint32_t pid, int16_t* val, uint16_t maxlen, uint16_t& len);
+template int HCClient::Set<int16_t>(uint32_t pid, const int16_t* val, uint16_t len);
+template int HCClient::Get<int32_t>(uint32_t pid, int32_t* val, uint16_t maxlen, uint16_t& len);
+template int HCClient::Set<int32_t>(uint32_t pid, const int32_t* val, uint16_t len);
+template int HCClient::Get<int64_t>(uint32_t pid, int64_t* val, uint16_t maxlen, uint16_t& len);
+template int HCClient::Set<int64_t>(uint32_t pid, const int64_t* val, uint16_t len);
+
+template int HCClient::Get<uint8_t>(uint32_t pid, uint8_t* val, uint16_t maxlen, uint16_t& len);
+template int HCClient::Set<uint8_t>(uint32_t pid, const uint8_t* val, uint16_t len);
+template int HCClient::Get<uint16_t>(uint32_t pid, uint16_t* val, uint16_t maxlen, uint16_t& len);
+template int HCClient::Set<uint16_t>(uint32_t pid, const uint16_t* val, uint16_t len);
+template int HCClient::Get<uint32_t>(uint32_t pid, uint32_t* val, uint16_t maxlen, uint16_t& len);
+template int HCClient::Set<uint32_t>(uint32_t pid, const uint32_t* val, uint16_t len);
+template int HCClient::Get<uint64_t>(uint32_t pid, uint64_t* val, uint16_t maxlen, uint16_t& len);
+template int HCClient::Set<uint64_t>(uint32_t pid, const uint64_t* val, uint16_t len);
+
+void HCClient::Init(HCServer* server, HCContainer* parent, uint32_t timeout)
+{
+  uint32_t i;
+
+  //Initialize member variables
+  _server = server;
+  _pidmax = 0;
+  _wideflag = 0;
+  _parent = parent;
+  _replicacount = 0;
+  _primary = 0;
+  _nextreader = 0;
+  _holdoff = HOLDOFF_DEFAULT;
+  _xactreplica = 0;
+  _rxmutex = new Mutex();
+  _crcset = false;
+  _sifcrc = 0;
+  _vmsg = new HCMessage();
+  _vcell = new HCCell();
+  _icell = new HCCell();
+  _omsg = new HCMessage();
+  _ocell = new HCCell();
+  _debug = false;
+  _senderrcount = 0;
+  _recverrcount = 0;
+  _transactionerrcount = 0;
+  _cellerrcount = 0;
+  _opcodeerrcount = 0;
+  _timeouterrcount = 0;
+  _piderrcount = 0;
+  _typeerrcount = 0;
+  _eiderrcount = 0;
+  _offseterrcount = 0;
+  _goodxactcount = 0;
+  _failovercount = 0;
+  _retransmitcount = 0;
+  _dupreplycount = 0;
+  for(i=0; i<TIMEOUT_BINS; i++)
+    _timeouthist[i] = 0;
+  _transaction = 0;
+  _protocol = HCMessage::VERSION_1;
+  _xactmutex = new Mutex();
+  _exptransaction = TRANSACTION_NONE;
+  _resenttransaction = TRANSACTION_NONE;
+  _expopcode = 0xFFFF;
+  _timeout = timeout;
+  _replyevent = new Event();
+  _batchcells = 0;
+  _batchmax = 0;
+  _batchcount = 0;
+
+  //Create file buffer (only used for downloading SIF)
+  _filebuffer = new uint8_t[HCCell::PAYLOAD_MAX - 9];
+
+  //Initialize asynchronous transaction table (timer wheel created on first use unless one is given)
+  for(i=0; i<ASYNC_SLOTS; i++)
+  {
+    _pending[i] = 0;
+    _resent[i] = TRANSACTION_NONE;
+  }
+  _pendingcount = 0;
+  _asynctransaction = 0;
+  _wheel = 0;
+  _ownwheel = false;
+  _sweeper = new TimerMethod<HCClient>(this, &HCClient::Sweep);
+  _sweeping = false;
+
+  //Add parameters to the parent container
+  _cont = new HCContainer(".client");
+  parent->Add(_cont);
+  _cont->Add(new HCBoolean<HCClient>("debug", this, &HCClient::GetDebug, &HCClient::SetDebug, Offon));
+  _cont->Add(new HCUns32<HCClient>("senderrcount", this, &HCClient::GetSendErrCount, 0));
+  _cont->Add(new HCUns32<HCClient>("recverrcount", this, &HCClient::GetRecvErrCount, 0));
+  _cont->Add(new HCUns32<HCClient>("transactionerrcount", this, &HCClient::GetTransactionErrCount, 0));
+  _cont->Add(new HCUns32<HCClient>("cellerrcount", this, &HCClient::GetCellErrCount, 0));
+  _cont->Add(new HCUns32<HCClient>("opcodeerrcount", this, &HCClient::GetOpCodeErrCount, 0));
+  _cont->Add(new HCUns32<HCClient>("timeouterrcount", this, &HCClient::GetTimeoutErrCount, 0));
+  _cont->Add(new HCUns32<HCClient>("piderrcount", this, &HCClient::GetPIDErrCount, 0));
+  _cont->Add(new HCUns32<HCClient>("typeerrcount", this, &HCClient::GetTypeErrCount, 0));
+  _cont->Add(new HCUns32<HCClient>("eiderrcount", this, &HCClient::GetEIDErrCount, 0));
+  _cont->Add(new HCUns32<HCClient>("offseterrcount", this, &HCClient::GetOffsetErrCount, 0));
+  _cont->Add(new HCUns32<HCClient>("goodxactcount", this, &HCClient::GetGoodXactCount, 0));
+  _cont->Add(new HCUns32<HCClient>("asynccount", this, &HCClient::GetAsyncCount, 0));
+  _cont->Add(new HCUns32<HCClient>("srtt", this, &HCClient::GetSRTT, 0));
+  _cont->Add(new HCUns32<HCClient>("rto", this, &HCClient::GetRTO, 0));
+  _cont->Add(new HCUns32<HCClient>("retransmitcount", this, &HCClient::GetRetransmitCount, 0));
+  _cont->Add(new HCUns32<HCClient>("dupreplycount", this, &HCClient::GetDupReplyCount, 0));
+  _cont->Add(new HCUns32Table<HCClient>("timeouthist", this, &HCClient::GetTimeoutHist, 0, TIMEOUT_BINS));
+}
+
+int HCClient::DirectParam(uint32_t pid, uint8_t type, HCParameter*& param)
+{
+  //Get server parameter and check for error
+  if((param = _server->GetParam(pid)) == 0)
+  {
+    //Increment PID error count
+    _piderrcount++;
+    return ERR_PID;
+  }
+
+  //Check for type mismatch
+  if(param->GetType() != type)
+  {
+    //Increment type error count
+    _typeerrcount++;
+    return ERR_TYPE;
+  }
+
+  //Increment good transaction count
+  _goodxactcount++;
 
-template int HCClient::Get<uint8_t>(uint16_t pid, uint8_t* val, uint16_t maxlen, uint16_t& len);
-template int HCClient::Set<uint8_t>(uint16_t pid, const uint8_t* val, uint16_t len);
-template int HCClient::Get<uint16_t>(uint16_t pid, uint16_t* val, uint16_t maxlen, uint16_t& len);
-template int HCClient::Set<uint16_t>(uint16_t pid, const uint16_t* val, uint16_t len);
-template int HCClient::Get<uint32_t>(uint16_t pid, uint32_t* val, uint16_t maxlen, uint16_t& len);
-template int HCClient::Set<uint32_t>(uint16_t pid, const uint32_t* val, uint16_t len);
-template int HCClient::Get<uint64_t>(uint16_t pid, uint64_t* val, uint16_t maxlen, uint16_t& len);
-template int HCClient::Set<uint64_t>(uint16_t pid, const uint64_t* val, uint16_t len);
+  return ERR_NONE;
+}
 
-int HCClient::CallXact(uint16_t pid)
+int HCClient::CallXact(uint32_t pid)
 {
-  uint16_t ipid;
+  uint32_t ipid;
   int8_t berr;
+  int ierr;
 
   //Reset reply event
   _replyevent->Reset();
 
   //Set expected reply parameters
   _exptransaction = _transaction;
-  _expopcode = HCCell::OPCODE_CALL_STS;
+  _expopcode = HCCell::OPCODE_CALL_STS | _wideflag;
 
   //Increment transaction number
-  _transaction++;
+  NextTransaction();
 
   //Print outbound message if requested
   if(_debug)
     _omsg->Print("Tx");
 
-  //Send outbound message and check for error
-  if(_omsg->Send(_lowdev) != ERR_NONE)
-  {
-    //Increment send error count
-    _senderrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_UNSPEC;
-  }
-
-  //Wait for response
-  if(_replyevent->Wait(_timeout) != 0)
-  {
-    //Increment timeout error count
-    _timeouterrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_TIMEOUT;
-  }
-
-  //Set expected reply parameters to invalid
-  _exptransaction = 0xFFFF;
-  _expopcode = 0xFFFF;
+  //Exchange messages with server and check for error
+  if((ierr = Exchange(false)) != ERR_NONE)
+    return ierr;
 
   //Read PID from inbound cell
-  _icell->Read(ipid);
+  _icell->ReadPID(ipid);
 
   //Check for inbound PID doesn't match outbound PID
   if(ipid != pid)
@@ -1067,60 +2250,35 @@ int HCClient::CallXact(uint16_t pid)
   return (int)berr;
 }
 
-int HCClient::GetXact(uint16_t pid, uint8_t type)
+int HCClient::GetXact(uint32_t pid, uint8_t type)
 {
-  uint16_t ipid;
+  uint32_t ipid;
   uint8_t itype;
+  int ierr;
 
   //Reset reply event
   _replyevent->Reset();
 
   //Set expected reply parameters
   _exptransaction = _transaction;
-  _expopcode = HCCell::OPCODE_GET_STS;
+  _expopcode = HCCell::OPCODE_GET_STS | _wideflag;
 
   //Format outbound message
-  _omsg->Reset(_transaction++);
-  _ocell->Reset(HCCell::OPCODE_GET_CMD);
-  _ocell->Write(pid);
+  _omsg->Reset(NextTransaction());
+  _ocell->Reset(HCCell::OPCODE_GET_CMD | _wideflag);
+  _ocell->WritePID(pid);
   _omsg->Write(_ocell);
 
   //Print outbound message if requested
   if(_debug)
     _omsg->Print("Tx");
 
-  //Send outbound message and check for error
-  if(_omsg->Send(_lowdev) != ERR_NONE)
-  {
-    //Increment send error count
-    _senderrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_UNSPEC;
-  }
-
-  //Wait for response
-  if(_replyevent->Wait(_timeout) != 0)
-  {
-    //Increment timeout error count
-    _timeouterrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_TIMEOUT;
-  }
-
-  //Set expected reply parameters to invalid
-  _exptransaction = 0xFFFF;
-  _expopcode = 0xFFFF;
+  //Exchange messages with server and check for error
+  if((ierr = Exchange(true)) != ERR_NONE)
+    return ierr;
 
   //Read PID from inbound cell
-  _icell->Read(ipid);
+  _icell->ReadPID(ipid);
 
   //Check for inbound PID doesn't match outbound PID
   if(ipid != pid)
@@ -1149,57 +2307,32 @@ int HCClient::GetXact(uint16_t pid, uint8_t type)
   return ERR_NONE;
 }
 
-int HCClient::SetXact(uint16_t pid)
+int HCClient::SetXact(uint32_t pid)
 {
-  uint16_t ipid;
+  uint32_t ipid;
   int8_t berr;
+  int ierr;
 
   //Reset reply event
   _replyevent->Reset();
 
   //Set expected reply parameters
   _exptransaction = _transaction;
-  _expopcode = HCCell::OPCODE_SET_STS;
+  _expopcode = HCCell::OPCODE_SET_STS | _wideflag;
 
   //Increment transaction number
-  _transaction++;
+  NextTransaction();
 
   //Print outbound message if requested
   if(_debug)
     _omsg->Print("Tx");
 
-  //Send outbound message and check for error
-  if(_omsg->Send(_lowdev) != ERR_NONE)
-  {
-    //Increment send error count
-    _senderrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_UNSPEC;
-  }
-
-  //Wait for response
-  if(_replyevent->Wait(_timeout) != 0)
-  {
-    //Increment timeout error count
-    _timeouterrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_TIMEOUT;
-  }
-
-  //Set expected reply parameters to invalid
-  _exptransaction = 0xFFFF;
-  _expopcode = 0xFFFF;
+  //Exchange messages with server and check for error
+  if((ierr = Exchange(false)) != ERR_NONE)
+    return ierr;
 
   //Read PID from inbound cell
-  _icell->Read(ipid);
+  _icell->ReadPID(ipid);
 
   //Check for inbound PID doesn't match outbound PID
   if(ipid != pid)
@@ -1219,58 +2352,33 @@ int HCClient::SetXact(uint16_t pid)
   return (int)berr;
 }
 
-int HCClient::ICallXact(uint16_t pid, uint32_t eid)
+int HCClient::ICallXact(uint32_t pid, uint32_t eid)
 {
-  uint16_t ipid;
+  uint32_t ipid;
   uint32_t ieid;
   int8_t berr;
+  int ierr;
 
   //Reset reply event
   _replyevent->Reset();
 
   //Set expected reply parameters
   _exptransaction = _transaction;
-  _expopcode = HCCell::OPCODE_ICALL_STS;
+  _expopcode = HCCell::OPCODE_ICALL_STS | _wideflag;
 
   //Increment transaction number
-  _transaction++;
+  NextTransaction();
 
   //Print outbound message if requested
   if(_debug)
     _omsg->Print("Tx");
 
-  //Send outbound message and check for error
-  if(_omsg->Send(_lowdev) != ERR_NONE)
-  {
-    //Increment send error count
-    _senderrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_UNSPEC;
-  }
-
-  //Wait for response
-  if(_replyevent->Wait(_timeout) != 0)
-  {
-    //Increment timeout error count
-    _timeouterrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_TIMEOUT;
-  }
-
-  //Set expected reply parameters to invalid
-  _exptransaction = 0xFFFF;
-  _expopcode = 0xFFFF;
+  //Exchange messages with server and check for error
+  if((ierr = Exchange(false)) != ERR_NONE)
+    return ierr;
 
   //Read PID from inbound cell
-  _icell->Read(ipid);
+  _icell->ReadPID(ipid);
 
   //Check for inbound PID doesn't match outbound PID
   if(ipid != pid)
@@ -1302,23 +2410,24 @@ int HCClient::ICallXact(uint16_t pid, uint32_t eid)
   return (int)berr;
 }
 
-int HCClient::IGetXact(uint16_t pid, uint32_t eid, uint8_t type)
+int HCClient::IGetXact(uint32_t pid, uint32_t eid, uint8_t type)
 {
-  uint16_t ipid;
+  uint32_t ipid;
   uint32_t ieid;
   uint8_t itype;
+  int ierr;
 
   //Reset reply event
   _replyevent->Reset();
 
   //Set expected reply parameters
   _exptransaction = _transaction;
-  _expopcode = HCCell::OPCODE_IGET_STS;
+  _expopcode = HCCell::OPCODE_IGET_STS | _wideflag;
 
   //Format outbound message
-  _omsg->Reset(_transaction++);
-  _ocell->Reset(HCCell::OPCODE_IGET_CMD);
-  _ocell->Write(pid);
+  _omsg->Reset(NextTransaction());
+  _ocell->Reset(HCCell::OPCODE_IGET_CMD | _wideflag);
+  _ocell->WritePID(pid);
   _ocell->Write(eid);
   _omsg->Write(_ocell);
 
@@ -1326,38 +2435,12 @@ int HCClient::IGetXact(uint16_t pid, uint32_t eid, uint8_t type)
   if(_debug)
     _omsg->Print("Tx");
 
-  //Send outbound message and check for error
-  if(_omsg->Send(_lowdev) != ERR_NONE)
-  {
-    //Increment send error count
-    _senderrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_UNSPEC;
-  }
-
-  //Wait for response
-  if(_replyevent->Wait(_timeout) != 0)
-  {
-    //Increment timeout error count
-    _timeouterrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_TIMEOUT;
-  }
-
-  //Set expected reply parameters to invalid
-  _exptransaction = 0xFFFF;
-  _expopcode = 0xFFFF;
+  //Exchange messages with server and check for error
+  if((ierr = Exchange(true)) != ERR_NONE)
+    return ierr;
 
   //Read PID from inbound cell
-  _icell->Read(ipid);
+  _icell->ReadPID(ipid);
 
   //Check for inbound PID doesn't match outbound PID
   if(ipid != pid)
@@ -1398,58 +2481,33 @@ int HCClient::IGetXact(uint16_t pid, uint32_t eid, uint8_t type)
   return ERR_NONE;
 }
 
-int HCClient::ISetXact(uint16_t pid, uint32_t eid)
+int HCClient::ISetXact(uint32_t pid, uint32_t eid)
 {
-  uint16_t ipid;
+  uint32_t ipid;
   uint32_t ieid;
   int8_t berr;
+  int ierr;
 
   //Reset reply event
   _replyevent->Reset();
 
   //Set expected reply parameters
   _exptransaction = _transaction;
-  _expopcode = HCCell::OPCODE_ISET_STS;
+  _expopcode = HCCell::OPCODE_ISET_STS | _wideflag;
 
   //Increment transaction number
-  _transaction++;
+  NextTransaction();
 
   //Print outbound message if requested
   if(_debug)
     _omsg->Print("Tx");
 
-  //Send outbound message and check for error
-  if(_omsg->Send(_lowdev) != ERR_NONE)
-  {
-    //Increment send error count
-    _senderrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_UNSPEC;
-  }
-
-  //Wait for response
-  if(_replyevent->Wait(_timeout) != 0)
-  {
-    //Increment timeout error count
-    _timeouterrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_TIMEOUT;
-  }
-
-  //Set expected reply parameters to invalid
-  _exptransaction = 0xFFFF;
-  _expopcode = 0xFFFF;
+  //Exchange messages with server and check for error
+  if((ierr = Exchange(false)) != ERR_NONE)
+    return ierr;
 
   //Read PID from inbound cell
-  _icell->Read(ipid);
+  _icell->ReadPID(ipid);
 
   //Check for inbound PID doesn't match outbound PID
   if(ipid != pid)
@@ -1481,57 +2539,32 @@ int HCClient::ISetXact(uint16_t pid, uint32_t eid)
   return (int)berr;
 }
 
-int HCClient::AddXact(uint16_t pid)
+int HCClient::AddXact(uint32_t pid)
 {
-  uint16_t ipid;
+  uint32_t ipid;
   int8_t berr;
+  int ierr;
 
   //Reset reply event
   _replyevent->Reset();
 
   //Set expected reply parameters
   _exptransaction = _transaction;
-  _expopcode = HCCell::OPCODE_ADD_STS;
+  _expopcode = HCCell::OPCODE_ADD_STS | _wideflag;
 
   //Increment transaction number
-  _transaction++;
+  NextTransaction();
 
   //Print outbound message if requested
   if(_debug)
     _omsg->Print("Tx");
 
-  //Send outbound message and check for error
-  if(_omsg->Send(_lowdev) != ERR_NONE)
-  {
-    //Increment send error count
-    _senderrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_UNSPEC;
-  }
-
-  //Wait for response
-  if(_replyevent->Wait(_timeout) != 0)
-  {
-    //Increment timeout error count
-    _timeouterrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_TIMEOUT;
-  }
-
-  //Set expected reply parameters to invalid
-  _exptransaction = 0xFFFF;
-  _expopcode = 0xFFFF;
+  //Exchange messages with server and check for error
+  if((ierr = Exchange(false)) != ERR_NONE)
+    return ierr;
 
   //Read PID from inbound cell
-  _icell->Read(ipid);
+  _icell->ReadPID(ipid);
 
   //Check for inbound PID doesn't match outbound PID
   if(ipid != pid)
@@ -1551,57 +2584,32 @@ int HCClient::AddXact(uint16_t pid)
   return (int)berr;
 }
 
-int HCClient::SubXact(uint16_t pid)
+int HCClient::SubXact(uint32_t pid)
 {
-  uint16_t ipid;
+  uint32_t ipid;
   int8_t berr;
+  int ierr;
 
   //Reset reply event
   _replyevent->Reset();
 
   //Set expected reply parameters
   _exptransaction = _transaction;
-  _expopcode = HCCell::OPCODE_SUB_STS;
+  _expopcode = HCCell::OPCODE_SUB_STS | _wideflag;
 
   //Increment transaction number
-  _transaction++;
+  NextTransaction();
 
   //Print outbound message if requested
-  if(_debug)
-    _omsg->Print("Tx");
-
-  //Send outbound message and check for error
-  if(_omsg->Send(_lowdev) != ERR_NONE)
-  {
-    //Increment send error count
-    _senderrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_UNSPEC;
-  }
-
-  //Wait for response
-  if(_replyevent->Wait(_timeout) != 0)
-  {
-    //Increment timeout error count
-    _timeouterrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_TIMEOUT;
-  }
+  if(_debug)
+    _omsg->Print("Tx");
 
-  //Set expected reply parameters to invalid
-  _exptransaction = 0xFFFF;
-  _expopcode = 0xFFFF;
+  //Exchange messages with server and check for error
+  if((ierr = Exchange(false)) != ERR_NONE)
+    return ierr;
 
   //Read PID from inbound cell
-  _icell->Read(ipid);
+  _icell->ReadPID(ipid);
 
   //Check for inbound PID doesn't match outbound PID
   if(ipid != pid)
@@ -1621,22 +2629,23 @@ int HCClient::SubXact(uint16_t pid)
   return (int)berr;
 }
 
-int HCClient::ReadXact(uint16_t pid, uint32_t offset, uint16_t maxlen)
+int HCClient::ReadXact(uint32_t pid, uint32_t offset, uint16_t maxlen)
 {
-  uint16_t ipid;
+  uint32_t ipid;
   uint32_t ioffset;
+  int ierr;
 
   //Reset reply event
   _replyevent->Reset();
 
   //Set expected reply parameters
   _exptransaction = _transaction;
-  _expopcode = HCCell::OPCODE_READ_STS;
+  _expopcode = HCCell::OPCODE_READ_STS | _wideflag;
 
   //Format outbound message
-  _omsg->Reset(_transaction++);
-  _ocell->Reset(HCCell::OPCODE_READ_CMD);
-  _ocell->Write(pid);
+  _omsg->Reset(NextTransaction());
+  _ocell->Reset(HCCell::OPCODE_READ_CMD | _wideflag);
+  _ocell->WritePID(pid);
   _ocell->Write(offset);
   _ocell->Write(maxlen);
   _omsg->Write(_ocell);
@@ -1645,38 +2654,12 @@ int HCClient::ReadXact(uint16_t pid, uint32_t offset, uint16_t maxlen)
   if(_debug)
     _omsg->Print("Tx");
 
-  //Send outbound message and check for error
-  if(_omsg->Send(_lowdev) != ERR_NONE)
-  {
-    //Increment send error count
-    _senderrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_UNSPEC;
-  }
-
-  //Wait for response
-  if(_replyevent->Wait(_timeout) != 0)
-  {
-    //Increment timeout error count
-    _timeouterrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_TIMEOUT;
-  }
-
-  //Set expected reply parameters to invalid
-  _exptransaction = 0xFFFF;
-  _expopcode = 0xFFFF;
+  //Exchange messages with server and check for error
+  if((ierr = Exchange(true)) != ERR_NONE)
+    return ierr;
 
   //Read PID from inbound cell
-  _icell->Read(ipid);
+  _icell->ReadPID(ipid);
 
   //Check for inbound PID doesn't match outbound PID
   if(ipid != pid)
@@ -1705,58 +2688,33 @@ int HCClient::ReadXact(uint16_t pid, uint32_t offset, uint16_t maxlen)
   return ERR_NONE;
 }
 
-int HCClient::WriteXact(uint16_t pid, uint32_t offset)
+int HCClient::WriteXact(uint32_t pid, uint32_t offset)
 {
-  uint16_t ipid;
+  uint32_t ipid;
   uint32_t ioffset;
   int8_t berr;
+  int ierr;
 
   //Reset reply event
   _replyevent->Reset();
 
   //Set expected reply parameters
   _exptransaction = _transaction;
-  _expopcode = HCCell::OPCODE_WRITE_STS;
+  _expopcode = HCCell::OPCODE_WRITE_STS | _wideflag;
 
   //Increment transaction number
-  _transaction++;
+  NextTransaction();
 
   //Print outbound message if requested
   if(_debug)
     _omsg->Print("Tx");
 
-  //Send outbound message and check for error
-  if(_omsg->Send(_lowdev) != ERR_NONE)
-  {
-    //Increment send error count
-    _senderrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_UNSPEC;
-  }
-
-  //Wait for response
-  if(_replyevent->Wait(_timeout) != 0)
-  {
-    //Increment timeout error count
-    _timeouterrcount++;
-
-    //Set expected reply parameters to invalid
-    _exptransaction = 0xFFFF;
-    _expopcode = 0xFFFF;
-
-    return ERR_TIMEOUT;
-  }
-
-  //Set expected reply parameters to invalid
-  _exptransaction = 0xFFFF;
-  _expopcode = 0xFFFF;
+  //Exchange messages with server and check for error
+  if((ierr = Exchange(false)) != ERR_NONE)
+    return ierr;
 
   //Read PID from inbound cell
-  _icell->Read(ipid);
+  _icell->ReadPID(ipid);
 
   //Check for inbound PID doesn't match outbound PID
   if(ipid != pid)
@@ -1788,56 +2746,716 @@ int HCClient::WriteXact(uint16_t pid, uint32_t offset)
   return (int)berr;
 }
 
-void HCClient::ReadThread(void)
+void HCClient::AddReplicaCont(HCReplica* rep)
 {
-  //Go forever
-  while(true)
+  HCContainer* cont;
+  string name;
+
+  //Create replica container under client container
+  name = "replica";
+  name += to_string(rep->GetIndex());
+  cont = new HCContainer(name);
+  _cont->Add(cont);
+
+  //Add replica health parameters
+  cont->Add(new HCBoolean<HCReplica>("up", rep, &HCReplica::GetUp, 0, Offon));
+  cont->Add(new HCUns32<HCReplica>("srtt", rep, &HCReplica::GetSRTT, 0));
+  cont->Add(new HCUns32<HCReplica>("rttvar", rep, &HCReplica::GetRTTVar, 0));
+  cont->Add(new HCUns32<HCReplica>("rto", rep, &HCReplica::GetRTO, 0));
+  cont->Add(new HCUns32<HCReplica>("failcount", rep, &HCReplica::GetFailCount, 0));
+}
+
+HCReplica* HCClient::SelectReader(void)
+{
+  uint64_t now;
+  uint32_t i;
+  uint32_t srtt;
+  uint32_t bestsrtt;
+  bool found;
+  HCReplica* rep;
+
+  //Check for single replica or replicas not yet checked against each other (use primary)
+  if((_replicacount == 1) || !_crcset)
+    return SelectWriter();
+
+  //Find fastest available replica (replicas without samples count as fastest so they get measured)
+  now = ThreadTimeUS();
+  found = false;
+  bestsrtt = 0;
+  for(i=0; i<_replicacount; i++)
   {
-    //Receive inbound message and check for error
-    if(_imsg->Recv(_lowdev) != ERR_NONE)
+    if(_replicas[i]->IsAvailable(now, _holdoff))
     {
-      //Increment receive error count
-      _recverrcount++;
+      _replicas[i]->GetSRTT(srtt);
+      if(!found || (srtt < bestsrtt))
+        bestsrtt = srtt;
+      found = true;
+    }
+  }
 
-      //Ignore the rest of this loop
-      continue;
+  //Check for no available replicas
+  if(!found)
+    return SelectWriter();
+
+  //Begin mutual exclusion of round robin position (callers select replicas without holding transaction mutex)
+  _rxmutex->Wait();
+
+  //Spread reads round robin over available replicas not much slower than the fastest
+  for(i=0; i<_replicacount; i++)
+  {
+    rep = _replicas[(_nextreader + i) % _replicacount];
+    rep->GetSRTT(srtt);
+    if(rep->IsAvailable(now, _holdoff) && (srtt <= ((bestsrtt * 2) + SPREAD_SLACK)))
+    {
+      _nextreader = (rep->GetIndex() + 1) % _replicacount;
+      _rxmutex->Give();
+      return rep;
     }
+  }
 
-    //Print inbound message if requested
-    if(_debug)
-      _imsg->Print("Rx");
+  //End mutual exclusion of round robin position
+  _rxmutex->Give();
+
+  return SelectWriter();
+}
+
+HCReplica* HCClient::SelectWriter(void)
+{
+  uint64_t now;
+  uint32_t i;
+  HCReplica* rep;
+
+  //Use first available replica starting with primary
+  now = ThreadTimeUS();
+  for(i=0; i<_replicacount; i++)
+  {
+    rep = _replicas[(_primary + i) % _replicacount];
+    if(rep->IsAvailable(now, _holdoff))
+      return rep;
+  }
+
+  //Nothing available so use first enabled replica starting with primary
+  for(i=0; i<_replicacount; i++)
+  {
+    rep = _replicas[(_primary + i) % _replicacount];
+    if(rep->IsEnabled())
+      return rep;
+  }
 
-    //Check for invalid transaction number
-    if(_imsg->GetTransaction() != _exptransaction)
+  return _replicas[_primary];
+}
+
+bool HCClient::VerifyReplica(HCReplica* rep)
+{
+  uint32_t exptransaction;
+  uint16_t expopcode;
+  uint64_t start;
+  uint32_t ipid;
+  uint8_t itype;
+  uint32_t crc;
+  int8_t berr;
+  bool ok;
+
+  //Save expected reply parameters of transaction in progress
+  exptransaction = _exptransaction;
+  expopcode = _expopcode;
+
+  //Direct replies from replica to information file CRC request
+  _rxmutex->Wait();
+  _xactreplica = rep;
+  _exptransaction = _transaction;
+  _expopcode = HCCell::OPCODE_GET_STS | _wideflag;
+  _replyevent->Reset();
+  _rxmutex->Give();
+
+  //Format information file CRC request
+  _vmsg->Reset(NextTransaction());
+  _vcell->Reset(HCCell::OPCODE_GET_CMD | _wideflag);
+  _vcell->WritePID(HCServer::PID_INFOFILECRC);
+  _vmsg->Write(_vcell);
+
+  //Send request and wait for reply
+  start = ThreadTimeUS();
+  ok = (_vmsg->Send(rep->GetDevice()) == ERR_NONE) && (_replyevent->Wait(_timeout) == 0);
+
+  //Restore expected reply parameters of transaction in progress
+  _rxmutex->Wait();
+  _exptransaction = exptransaction;
+  _expopcode = expopcode;
+  _rxmutex->Give();
+
+  //Check for no reply
+  if(!ok)
+  {
+    rep->Failure(ThreadTimeUS());
+    return false;
+  }
+
+  //Read CRC from reply and check for error
+  if(!_icell->ReadPID(ipid) || (ipid != HCServer::PID_INFOFILECRC) || !_icell->Read(itype) || (itype != HCParameter::T_U32) || !_icell->Read(crc) || !_icell->Read(berr) || (berr != ERR_NONE))
+  {
+    rep->Failure(ThreadTimeUS());
+    return false;
+  }
+
+  //Check for replica serving a different server information file
+  if(crc != _sifcrc)
+  {
+    cout << "Replica " << rep->GetIndex() << " information file CRC mismatch (" << crc << " != " << _sifcrc << "), disabling" << "\n";
+    rep->Disable();
+    return false;
+  }
+
+  //Indicate replica verified
+  rep->Verify();
+  rep->Success();
+  rep->Sample(ThreadTimeUS() - start);
+  return true;
+}
+
+uint64_t HCClient::ArmTimeout(HCReplica* rep, uint64_t remaining)
+{
+  uint64_t timeout;
+  uint32_t bin;
+
+  //Take replica's adaptive timeout (split whole timeout over sends until replica has samples) within time remaining
+  timeout = rep->GetTimeout(((uint64_t)_timeout * 1000) / (RETRANSMIT_MAX + 1));
+  if(timeout > remaining)
+    timeout = remaining;
+
+  //Count timeout in bin of doubling milliseconds
+  for(bin=0; (bin < (TIMEOUT_BINS - 1)) && ((timeout / 1000) >= ((uint64_t)1 << bin)); bin++);
+  _timeouthist[bin]++;
+
+  return timeout;
+}
+
+int HCClient::Exchange(bool read)
+{
+  uint32_t attempt;
+  uint32_t sends;
+  HCReplica* rep;
+  uint64_t start;
+  uint64_t deadline;
+  uint64_t timeout;
+  uint64_t now;
+  int ierr;
+
+  //Try replicas in turn (only reads are safe to send again, so writes fail over on next transaction)
+  ierr = ERR_UNSPEC;
+  for(attempt=0; attempt<_replicacount; attempt++)
+  {
+    //Check for another attempt
+    if(attempt > 0)
     {
-      //Increment transaction error count
-      _transactionerrcount++;
+      //Check for write
+      if(!read)
+        break;
+
+      //Increment failover count
+      _failovercount++;
+    }
+
+    //Select replica (reads spread over fast replicas, writes go to primary)
+    rep = read ? SelectReader() : SelectWriter();
 
-      //Ignore the rest of this loop
+    //Check for replica not yet verified against server information file CRC
+    if(_crcset && !rep->IsVerified() && !VerifyReplica(rep))
+    {
+      ierr = ERR_TIMEOUT;
       continue;
     }
 
-    //Read inbound cell from message and check for error
-    if(!_imsg->Read(_icell))
+    //Direct replies from selected replica to this transaction
+    _rxmutex->Wait();
+    _xactreplica = rep;
+    _replyevent->Reset();
+    _rxmutex->Give();
+
+    //Send and wait for reply (reads are sent again when adaptive timeout expires, writes wait whole timeout)
+    start = ThreadTimeUS();
+    deadline = start + (uint64_t)_timeout * 1000;
+    for(sends=1; ; sends++)
     {
-      //Increment cell error count
-      _cellerrcount++;
+      //Remember transaction sent more than once so late replies to earlier sends are recognized
+      if((attempt > 0) || (sends > 1))
+      {
+        _rxmutex->Wait();
+        _resenttransaction = _omsg->GetTransaction();
+        _rxmutex->Give();
+      }
+
+      //Send outbound message and check for error
+      if(_omsg->Send(rep->GetDevice()) != ERR_NONE)
+      {
+        //Increment send error count
+        _senderrcount++;
+        ierr = ERR_UNSPEC;
+        break;
+      }
+
+      //Determine how long to wait for reply (last send waits out whole timeout)
+      now = ThreadTimeUS();
+      timeout = (now < deadline) ? deadline - now : 0;
+      if(read && (sends <= RETRANSMIT_MAX))
+        timeout = ArmTimeout(rep, timeout);
+
+      //Wait for response
+      if(_replyevent->Wait((uint32_t)((timeout + 999) / 1000)) == 0)
+      {
+        ierr = ERR_NONE;
+        break;
+      }
+
+      //Check for whole timeout expired
+      if(!read || (sends > RETRANSMIT_MAX) || (ThreadTimeUS() >= deadline))
+      {
+        //Increment timeout error count
+        _timeouterrcount++;
+        ierr = ERR_TIMEOUT;
+        break;
+      }
+
+      //Back off replica's adaptive timeout and increment retransmit count
+      rep->Backoff();
+      _retransmitcount++;
+    }
 
-      //Ignore the rest of this loop
+    //Check for error
+    if(ierr != ERR_NONE)
+    {
+      //Mark replica as failed
+      rep->Failure(ThreadTimeUS());
       continue;
     }
 
-    //Check for invalid opcode
-    if(_icell->GetOpCode() != _expopcode)
+    //Update replica round trip time (a reply to a message sent more than once could be to any of them)
+    rep->Success();
+    if(sends == 1)
+      rep->Sample(ThreadTimeUS() - start);
+    break;
+  }
+
+  //Set expected reply parameters to invalid
+  _rxmutex->Wait();
+  _exptransaction = TRANSACTION_NONE;
+  _expopcode = 0xFFFF;
+  _xactreplica = 0;
+  _rxmutex->Give();
+
+  return ierr;
+}
+
+uint32_t HCClient::NextTransaction(void)
+{
+  uint32_t transaction;
+
+  //Take transaction number for blocking transaction (wraps within lower half, upper half is asynchronous)
+  transaction = _transaction;
+  _transaction = (_transaction + 1) % ((_protocol == HCMessage::VERSION_1) ? ASYNC_BASE : ASYNC_BASE_WIDE);
+
+  return transaction;
+}
+
+void HCClient::PrepareAsync(HCAsync* xact, uint32_t pid, uint16_t expopcode)
+{
+  //Set expected reply and clear checks and destinations of any earlier transaction
+  xact->_pid = pid;
+  xact->_eid = 0;
+  xact->_offset = 0;
+  xact->_expopcode = expopcode;
+  xact->_maxlen = 0;
+  xact->_len = 0;
+  xact->_type = 0;
+  xact->_checkeid = false;
+  xact->_checkoffset = false;
+  xact->_val = 0;
+  xact->_decoder = 0;
+}
+
+int HCClient::StartAsync(HCAsync* xact, bool read)
+{
+  HCReplica* rep;
+  uint32_t slot;
+  bool ok;
+
+  //Select replica (reads spread over fast replicas, writes go to primary)
+  rep = read ? SelectReader() : SelectWriter();
+
+  //Check for replica not yet verified against server information file CRC (blocks like a normal transaction)
+  if(_crcset && !rep->IsVerified())
+  {
+    _xactmutex->Wait();
+    ok = rep->IsVerified() || VerifyReplica(rep);
+    _xactmutex->Give();
+
+    if(!ok)
+      return FinishAsync(xact, ERR_TIMEOUT);
+  }
+
+  //Begin mutual exclusion of reply handling
+  _rxmutex->Wait();
+
+  //Start sweeping for timeouts on first use (creating wheel if none was given)
+  if(!_sweeping)
+  {
+    if(_wheel == 0)
+    {
+      _wheel = new TimerWheel();
+      _ownwheel = true;
+    }
+
+    _wheel->Schedule(_sweeper, SWEEP_PERIOD, SWEEP_PERIOD);
+    _sweeping = true;
+  }
+
+  //Check for too many transactions in flight
+  if(_pendingcount >= ASYNC_MAX)
+  {
+    _rxmutex->Give();
+    return FinishAsync(xact, ERR_OVERFLOW);
+  }
+
+  //Take next transaction number whose slot is not still in flight (version 1 numbers are just the slot)
+  while(_pending[_asynctransaction % ASYNC_SLOTS] != 0)
+    _asynctransaction++;
+  slot = _asynctransaction % ASYNC_SLOTS;
+  if(_protocol == HCMessage::VERSION_1)
+    xact->_transaction = ASYNC_BASE + slot;
+  else
+    xact->_transaction = ASYNC_BASE_WIDE | (_asynctransaction & ~ASYNC_BASE_WIDE);
+  _asynctransaction++;
+
+  //Format outbound message
+  xact->_msg->SetVersion(_protocol);
+  xact->_msg->Reset(xact->_transaction);
+  xact->_msg->Write(xact->_cell);
+
+  //Put transaction in flight so reader thread can match reply to it
+  xact->_replica = rep;
+  xact->_start = ThreadTimeUS();
+  xact->_deadline = xact->_start + (uint64_t)_timeout * 1000;
+  xact->_resend = read ? xact->_start + ArmTimeout(rep, (uint64_t)_timeout * 1000) : xact->_deadline;
+  xact->_sends = 1;
+  xact->_read = read;
+  xact->_err = ERR_NONE;
+  xact->Arm();
+  _pending[slot] = xact;
+  _pendingcount++;
+
+  //Print outbound message if requested
+  if(_debug)
+    xact->_msg->Print("Tx");
+
+  //Send outbound message (before releasing mutex so a sweep can't finish transaction first) and check for error
+  if(xact->_msg->Send(rep->GetDevice()) != ERR_NONE)
+  {
+    //Take transaction back out of flight
+    _pending[slot] = 0;
+    _pendingcount--;
+
+    //End mutual exclusion of reply handling
+    _rxmutex->Give();
+
+    //Increment send error count
+    _senderrcount++;
+
+    //Mark replica as failed
+    rep->Failure(ThreadTimeUS());
+
+    return FinishAsync(xact, ERR_UNSPEC);
+  }
+
+  //End mutual exclusion of reply handling
+  _rxmutex->Give();
+
+  return ERR_NONE;
+}
+
+int HCClient::FinishAsync(HCAsync* xact, int err)
+{
+  uint32_t ipid;
+  uint32_t ieid;
+  uint32_t ioffset;
+  uint8_t itype;
+  int8_t berr;
+
+  //Check reply against command
+  if(err == ERR_NONE)
+  {
+    if(!xact->_cell->ReadPID(ipid) || (ipid != xact->_pid))
+    {
+      //Increment PID error count
+      _piderrcount++;
+      err = ERR_UNSPEC;
+    }
+    else if(xact->_checkeid && (!xact->_cell->Read(ieid) || (ieid != xact->_eid)))
+    {
+      //Increment EID error count
+      _eiderrcount++;
+      err = ERR_UNSPEC;
+    }
+    else if(xact->_checkoffset && (!xact->_cell->Read(ioffset) || (ioffset != xact->_offset)))
+    {
+      //Increment offset error count
+      _offseterrcount++;
+      err = ERR_UNSPEC;
+    }
+    else if((xact->_decoder != 0) && (!xact->_cell->Read(itype) || (itype != xact->_type)))
+    {
+      //Increment type error count
+      _typeerrcount++;
+      err = ERR_TYPE;
+    }
+    else
+    {
+      //Increment good transaction count
+      _goodxactcount++;
+    }
+  }
+
+  //Read result from inbound cell (value set to default or no bytes read on error)
+  if(xact->_decoder != 0)
+  {
+    err = xact->_decoder(xact->_cell, xact->_val, err);
+  }
+  else if(xact->_len != 0)
+  {
+    if(err == ERR_NONE)
+    {
+      xact->_cell->Read((uint8_t*)xact->_val, xact->_maxlen, *xact->_len);
+      xact->_cell->Read(berr);
+      err = (int)berr;
+    }
+    else
     {
-      //Increment opcode error count
-      _opcodeerrcount++;
+      *xact->_len = 0;
+    }
+  }
+  else if(err == ERR_NONE)
+  {
+    xact->_cell->Read(berr);
+    err = (int)berr;
+  }
+
+  return CompleteAsync(xact, err);
+}
+
+int HCClient::CompleteAsync(HCAsync* xact, int err)
+{
+  //Record result and complete transaction (caller may reuse or delete it from here on)
+  xact->_err = err;
+  xact->Execute();
+
+  return err;
+}
+
+void HCClient::ReceiveAsync(HCReplica* rep, HCMessage* imsg)
+{
+  HCAsync* xact;
+  uint32_t slot;
+
+  //Begin mutual exclusion of reply handling
+  _rxmutex->Wait();
+
+  //Check for no transaction in flight with number or reply from replica transaction wasn't sent to
+  slot = imsg->GetTransaction() % ASYNC_SLOTS;
+  if(((xact = _pending[slot]) == 0) || (xact->_transaction != imsg->GetTransaction()) || (rep != xact->_replica))
+  {
+    //Increment duplicate reply count for late reply to a transaction sent more than once, otherwise transaction error count
+    if(imsg->GetTransaction() == _resent[slot])
+      _dupreplycount++;
+    else
+      _transactionerrcount++;
+
+    //End mutual exclusion of reply handling
+    _rxmutex->Give();
+    return;
+  }
+
+  //Read inbound cell from message and check for error
+  if(!imsg->Read(xact->_cell))
+  {
+    //Increment cell error count
+    _cellerrcount++;
+
+    //End mutual exclusion of reply handling
+    _rxmutex->Give();
+    return;
+  }
+
+  //Check for invalid opcode
+  if(xact->_cell->GetOpCode() != xact->_expopcode)
+  {
+    //Increment opcode error count
+    _opcodeerrcount++;
+
+    //End mutual exclusion of reply handling
+    _rxmutex->Give();
+    return;
+  }
+
+  //Take transaction out of flight
+  _pending[slot] = 0;
+  _pendingcount--;
 
-      //Ignore the rest of this loop
+  //End mutual exclusion of reply handling
+  _rxmutex->Give();
+
+  //Update replica round trip time (only sampled if sent once) and complete transaction
+  rep->Success();
+  if(xact->_sends == 1)
+    rep->Sample(ThreadTimeUS() - xact->_start);
+  FinishAsync(xact, ERR_NONE);
+}
+
+void HCClient::Sweep(void)
+{
+  HCAsync* expired;
+  HCAsync* xact;
+  HCReplica* rep;
+  uint64_t now;
+  uint32_t i;
+
+  //Begin mutual exclusion of reply handling
+  _rxmutex->Wait();
+
+  //Take transactions past their deadline out of flight and send reads past their adaptive timeout again
+  expired = 0;
+  now = ThreadTimeUS();
+  for(i=0; (i < ASYNC_SLOTS) && (_pendingcount > 0); i++)
+  {
+    if((xact = _pending[i]) == 0)
       continue;
+
+    if(now >= xact->_deadline)
+    {
+      _pending[i] = 0;
+      _pendingcount--;
+      xact->_next = expired;
+      expired = xact;
+    }
+    else if(now >= xact->_resend)
+    {
+      //Back off replica's adaptive timeout and increment retransmit count
+      rep = xact->_replica;
+      rep->Backoff();
+      _retransmitcount++;
+
+      //Remember transaction sent more than once so late replies to earlier sends are recognized
+      _resent[i] = xact->_transaction;
+
+      //Send outbound message again and check for error (left to time out)
+      if(xact->_msg->Send(rep->GetDevice()) != ERR_NONE)
+        _senderrcount++;
+
+      //Set when to send again (last send waits out whole timeout)
+      xact->_sends++;
+      if(xact->_sends <= RETRANSMIT_MAX)
+        xact->_resend = now + ArmTimeout(rep, xact->_deadline - now);
+      else
+        xact->_resend = xact->_deadline;
     }
+  }
+
+  //End mutual exclusion of reply handling
+  _rxmutex->Give();
+
+  //Fail expired transactions
+  while((xact = expired) != 0)
+  {
+    expired = xact->_next;
+
+    //Increment timeout error count
+    _timeouterrcount++;
 
-    //Signal valid reply
+    //Mark replica as failed
+    rep = xact->_replica;
+    rep->Failure(now);
+
+    FinishAsync(xact, ERR_TIMEOUT);
+  }
+}
+
+void HCClient::Receive(HCReplica* rep, HCMessage* imsg, int err)
+{
+  //Check for receive error
+  if(err != ERR_NONE)
+  {
+    //Increment receive error count
+    _recverrcount++;
+    return;
+  }
+
+  //Print inbound message if requested
+  if(_debug)
+    imsg->Print("Rx");
+
+  //Check for reply to asynchronous transaction
+  if((imsg->GetVersion() == HCMessage::VERSION_1) ? (imsg->GetTransaction() >= ASYNC_BASE) : ((imsg->GetTransaction() & ASYNC_BASE_WIDE) != 0))
+  {
+    ReceiveAsync(rep, imsg);
+    return;
+  }
+
+  //Begin mutual exclusion of reply handling
+  _rxmutex->Wait();
+
+  //Check for invalid transaction number or reply from replica transaction isn't waiting on
+  if((imsg->GetTransaction() != _exptransaction) || (rep != _xactreplica))
+  {
+    //Increment duplicate reply count for late reply to a transaction sent more than once, otherwise transaction error count
+    if(imsg->GetTransaction() == _resenttransaction)
+      _dupreplycount++;
+    else
+      _transactionerrcount++;
+
+    //End mutual exclusion of reply handling
+    _rxmutex->Give();
+    return;
+  }
+
+  //Check for batch reply
+  if(_expopcode == EXPOPCODE_BATCH)
+  {
+    //Hand all cells to caller (checked against commands by caller)
+    for(_batchcount=0; (_batchcount < _batchmax) && imsg->Read(_batchcells[_batchcount]); _batchcount++);
+
+    //Signal valid reply and stop accepting replies
+    _exptransaction = TRANSACTION_NONE;
     _replyevent->Signal();
+
+    //End mutual exclusion of reply handling
+    _rxmutex->Give();
+    return;
+  }
+
+  //Read inbound cell from message and check for error
+  if(!imsg->Read(_icell))
+  {
+    //Increment cell error count
+    _cellerrcount++;
+
+    //End mutual exclusion of reply handling
+    _rxmutex->Give();
+    return;
+  }
+
+  //Check for invalid opcode
+  if(_icell->GetOpCode() != _expopcode)
+  {
+    //Increment opcode error count
+    _opcodeerrcount++;
+
+    //End mutual exclusion of reply handling
+    _rxmutex->Give();
+    return;
   }
+
+  //Signal valid reply and stop accepting replies (cell now belongs to waiting transaction)
+  _exptransaction = TRANSACTION_NONE;
+  _replyevent->Signal();
+
+  //End mutual exclusion of reply handling
+  _rxmutex->Give();
 }
@@ -26,20 +26,53 @@
 
 #pragma once
 
+#include "hcasync.hh"
 #include "hccell.hh"
 #include "hccontainer.hh"
 #include "hcmessage.hh"
+#include "hcreplica.hh"
 #include "device.hh"
 #include "event.hh"
 #include "mutex.hh"
 #include "thread.hh"
+#include "timerwheel.hh"
 #include <inttypes.h>
 #include <stdio.h>
 
+class HCServer;
+
 class HCClient
 {
+public:
+  //Expected opcode indicating reply to a batch (all cells handed to caller)
+  static const uint16_t EXPOPCODE_BATCH = 0x100;
+
+  //Maximum number of replicas of a server, default time (ms) a failed replica is avoided and
+  //slack (us) added to the fastest round trip time when choosing replicas to spread reads over
+  static const uint32_t REPLICA_MAX = 8;
+  static const uint32_t HOLDOFF_DEFAULT = 5000;
+  static const uint32_t SPREAD_SLACK = 500;
+
+  //Asynchronous transactions use the upper half of the transaction numbers, at most this many
+  //are in flight at once and they are checked for timeout this often (us)
+  static const uint8_t ASYNC_BASE = 0x80;
+  static const uint32_t ASYNC_SLOTS = 0x100 - ASYNC_BASE;
+  static const uint32_t ASYNC_MAX = 64;
+  static const uint32_t SWEEP_PERIOD = 10000;
+
+  //Asynchronous transactions use the upper half of version 2 (32 bit) transaction numbers, and no
+  //blocking transaction is ever given this number
+  static const uint32_t ASYNC_BASE_WIDE = 0x80000000;
+  static const uint32_t TRANSACTION_NONE = 0xFFFFFFFF;
+
+  //Idempotent reads are sent at most this many more times within the timeout when replies are slower
+  //than the adaptive timeout, which is counted in bins of doubling width (bin 0 under 1 ms, last open)
+  static const uint32_t RETRANSMIT_MAX = 2;
+  static const uint32_t TIMEOUT_BINS = 12;
+
 public:
   HCClient(Device* lowdev, HCContainer* parent, uint32_t timeout);
+  HCClient(HCServer* server, HCContainer* parent);
   virtual ~HCClient();
   int GetDebug(bool& val);
   int SetDebug(const bool val);
@@ -54,46 +87,102 @@ public:
   int GetEIDErrCount(uint32_t& val);
   int GetOffsetErrCount(uint32_t& val);
   int GetGoodXactCount(uint32_t& val);
-  int Call(uint16_t pid);
-  int ICall(uint16_t pid, uint32_t eid);
-  int Read(uint16_t pid, uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len);
-  int Write(uint16_t pid, uint32_t offset, uint8_t* val, uint16_t len);
-  int DownloadSIF(uint16_t pid, const char* filename);
-  template <typename T> int Get(uint16_t pid, T& val);
-  template <typename T> int Set(uint16_t pid, const T val);
-  template <typename T> int IGet(uint16_t pid, uint32_t eid, T& val);
-  template <typename T> int ISet(uint16_t pid, uint32_t eid, const T val);
-  template <typename T> int Add(uint16_t pid, const T val);
-  template <typename T> int Sub(uint16_t pid, const T val);
-  template <typename T> int Get(uint16_t pid, T& val0, T& val1);
-  template <typename T> int Set(uint16_t pid, const T val0, const T val1);
-  template <typename T> int IGet(uint16_t pid, uint32_t eid, T& val0, T& val1);
-  template <typename T> int ISet(uint16_t pid, uint32_t eid, const T val0, const T val1);
-  template <typename T> int Get(uint16_t pid, T& val0, T& val1, T& val2);
-  template <typename T> int Set(uint16_t pid, const T val0, const T val1, const T val2);
-  template <typename T> int IGet(uint16_t pid, uint32_t eid, T& val0, T& val1, T& val2);
-  template <typename T> int ISet(uint16_t pid, uint32_t eid, const T val0, const T val1, const T val2);
-  template <typename T> int Get(uint16_t pid, T* val, uint16_t maxlen, uint16_t& len);
-  template <typename T> int Set(uint16_t pid, const T* val, uint16_t len);
+  int GetFailoverCount(uint32_t& val);
+  int GetAsyncCount(uint32_t& val);
+  int GetSRTT(uint32_t& val);
+  int GetRTO(uint32_t& val);
+  int GetRetransmitCount(uint32_t& val);
+  int GetDupReplyCount(uint32_t& val);
+  int GetTimeoutHist(uint32_t eid, uint32_t& val);
+  bool GetWidePID(void);
+  void SetWidePID(bool val);
+  uint8_t GetProtocol(void);
+  void SetProtocol(uint8_t val);
+  void AddReplica(Device* lowdev);
+  uint32_t GetReplicaCount(void);
+  bool IsDirect(void);
+  void SetPrimary(uint32_t index);
+  void SetHoldoff(uint32_t holdoff);
+  void SetTimerWheel(TimerWheel* wheel);
+  int CheckReplicas(uint32_t crc);
+  void Receive(HCReplica* rep, HCMessage* imsg, int err);
+  int Call(uint32_t pid);
+  int ICall(uint32_t pid, uint32_t eid);
+  int Read(uint32_t pid, uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len);
+  int Write(uint32_t pid, uint32_t offset, uint8_t* val, uint16_t len);
+  int Call(uint32_t pid, HCAsync* xact);
+  int ICall(uint32_t pid, uint32_t eid, HCAsync* xact);
+  int Read(uint32_t pid, uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len, HCAsync* xact);
+  int Write(uint32_t pid, uint32_t offset, uint8_t* val, uint16_t len, HCAsync* xact);
+  int DownloadSIF(uint32_t pid, const char* filename);
+  int Forward(HCCell* icell, HCCell* ocell);
+  int Batch(HCCell** icells, HCCell** ocells, int* errs, uint32_t count);
+  int QueryGet(const std::string& name, uint32_t* pids, std::string* vals, int* errs, uint32_t maxcount, uint32_t& count);
+  template <typename T> int Get(uint32_t pid, T& val);
+  template <typename T> int Set(uint32_t pid, const T val);
+  template <typename T> int IGet(uint32_t pid, uint32_t eid, T& val);
+  template <typename T> int ISet(uint32_t pid, uint32_t eid, const T val);
+  template <typename T> int Add(uint32_t pid, const T val);
+  template <typename T> int Sub(uint32_t pid, const T val);
+  template <typename T> int Get(uint32_t pid, T& val, HCAsync* xact);
+  template <typename T> int Set(uint32_t pid, const T val, HCAsync* xact);
+  template <typename T> int IGet(uint32_t pid, uint32_t eid, T& val, HCAsync* xact);
+  template <typename T> int ISet(uint32_t pid, uint32_t eid, const T val, HCAsync* xact);
+  template <typename T> int Get(uint32_t pid, T& val0, T& val1);
+  template <typename T> int Set(uint32_t pid, const T val0, const T val1);
+  template <typename T> int IGet(uint32_t pid, uint32_t eid, T& val0, T& val1);
+  template <typename T> int ISet(uint32_t pid, uint32_t eid, const T val0, const T val1);
+  template <typename T> int Get(uint32_t pid, T& val0, T& val1, T& val2);
+  template <typename T> int Set(uint32_t pid, const T val0, const T val1, const T val2);
+  template <typename T> int IGet(uint32_t pid, uint32_t eid, T& val0, T& val1, T& val2);
+  template <typename T> int ISet(uint32_t pid, uint32_t eid, const T val0, const T val1, const T val2);
+  template <typename T> int Get(uint32_t pid, T* val, uint16_t maxlen, uint16_t& len);
+  template <typename T> int Set(uint32_t pid, const T* val, uint16_t len);
 
 private:
-  int CallXact(uint16_t pid);
-  int GetXact(uint16_t pid, uint8_t type);
-  int SetXact(uint16_t pid);
-  int ICallXact(uint16_t pid, uint32_t eid);
-  int IGetXact(uint16_t pid, uint32_t eid, uint8_t type);
-  int ISetXact(uint16_t pid, uint32_t eid);
-  int AddXact(uint16_t pid);
-  int SubXact(uint16_t pid);
-  int ReadXact(uint16_t pid, uint32_t offset, uint16_t maxlen);
-  int WriteXact(uint16_t pid, uint32_t offset);
-  void ReadThread(void);
+  void Init(HCServer* server, HCContainer* parent, uint32_t timeout);
+  int DirectParam(uint32_t pid, uint8_t type, HCParameter*& param);
+  int CallXact(uint32_t pid);
+  int GetXact(uint32_t pid, uint8_t type);
+  int SetXact(uint32_t pid);
+  int ICallXact(uint32_t pid, uint32_t eid);
+  int IGetXact(uint32_t pid, uint32_t eid, uint8_t type);
+  int ISetXact(uint32_t pid, uint32_t eid);
+  int AddXact(uint32_t pid);
+  int SubXact(uint32_t pid);
+  int ReadXact(uint32_t pid, uint32_t offset, uint16_t maxlen);
+  int WriteXact(uint32_t pid, uint32_t offset);
+  void AddReplicaCont(HCReplica* rep);
+  HCReplica* SelectReader(void);
+  HCReplica* SelectWriter(void);
+  bool VerifyReplica(HCReplica* rep);
+  uint64_t ArmTimeout(HCReplica* rep, uint64_t remaining);
+  int Exchange(bool read);
+  uint32_t NextTransaction(void);
+  void PrepareAsync(HCAsync* xact, uint32_t pid, uint16_t expopcode);
+  int StartAsync(HCAsync* xact, bool read);
+  int FinishAsync(HCAsync* xact, int err);
+  int CompleteAsync(HCAsync* xact, int err);
+  void ReceiveAsync(HCReplica* rep, HCMessage* imsg);
+  void Sweep(void);
 
 private:
+  HCServer* _server;
   uint32_t _pidmax;
-  Device* _lowdev;
+  uint8_t _wideflag;
   HCContainer* _parent;
-  HCMessage* _imsg;
+  HCContainer* _cont;
+  HCReplica* _replicas[REPLICA_MAX];
+  uint32_t _replicacount;
+  uint32_t _primary;
+  uint32_t _nextreader;
+  uint32_t _holdoff;
+  HCReplica* _xactreplica;
+  Mutex* _rxmutex;
+  bool _crcset;
+  uint32_t _sifcrc;
+  HCMessage* _vmsg;
+  HCCell* _vcell;
   HCCell* _icell;
   HCMessage* _omsg;
   HCCell* _ocell;
@@ -109,12 +198,28 @@ private:
   uint32_t _eiderrcount;
   uint32_t _offseterrcount;
   uint32_t _goodxactcount;
-  uint8_t _transaction;
+  uint32_t _failovercount;
+  uint32_t _retransmitcount;
+  uint32_t _dupreplycount;
+  uint32_t _timeouthist[TIMEOUT_BINS];
+  uint32_t _transaction;
+  uint8_t _protocol;
   Mutex* _xactmutex;
-  uint16_t _exptransaction;
+  uint32_t _exptransaction;
+  uint32_t _resenttransaction;
   uint16_t _expopcode;
   uint32_t _timeout;
   Event* _replyevent;
+  HCCell** _batchcells;
+  uint32_t _batchmax;
+  uint32_t _batchcount;
   uint8_t* _filebuffer;
-  Thread<HCClient>* _readthread;
+  HCAsync* _pending[ASYNC_SLOTS];
+  uint32_t _resent[ASYNC_SLOTS];
+  uint32_t _pendingcount;
+  uint32_t _asynctransaction;
+  TimerWheel* _wheel;
+  bool _ownwheel;
+  TimerMethod<HCClient>* _sweeper;
+  bool _sweeping;
 };
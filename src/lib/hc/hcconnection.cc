@@ -41,34 +41,105 @@
 using namespace std;
 using namespace tinyxml2;
 
-HCConnection::HCConnection(Device* dev, HCContainer* pcont, const string& contname, uint32_t timeout, const string& sifname)
-{
-  XMLDocument doc;
-  string srvname;
-  string srvvers;
-  uint32_t srvinfocrc;
-  string lsifname;
-  uint32_t lsifcrc;
-  int ierr;
+Mutex HCConnection::_sifmapmutex;
+map<string, Mutex*> HCConnection::_sifmutexes;
 
+HCConnection::HCConnection(Device* dev, HCContainer* pcont, const string& contname, uint32_t timeout, const string& sifname, bool connect)
+{
   //Assert valid arguments
   assert((dev != 0) && (pcont != 0));
 
-  //Remember device
-  _dev = dev;
+  //Remember device, parent container and server information file name
+  _devs[0] = dev;
+  _devcount = 1;
+  _pcont = pcont;
+  _sifname = sifname;
 
-  //Create container and add to parent container
+  //Indicate not connected or attached
+  _connected = false;
+  _attached = false;
+
+  //Create container (attached to parent on successful connect)
   _cont = new HCContainer(contname);
-  pcont->Add(_cont);
 
   //Create client
-  _cli = new HCClient(_dev, _cont, timeout);
+  _cli = new HCClient(dev, _cont, timeout);
+
+  //Check for deferred connect (caller connects and attaches container itself)
+  if(!connect)
+    return;
+
+  //Connect to server
+  Connect();
+
+  //Attach container to parent container
+  Attach();
+}
+
+HCConnection::HCConnection(HCServer* server, HCContainer* pcont, const string& contname, const string& sifname, bool connect)
+{
+  //Assert valid arguments
+  assert((server != 0) && (pcont != 0));
+
+  //No devices, client calls parameters of the server in this process directly
+  _devcount = 0;
+  _pcont = pcont;
+  _sifname = sifname;
+
+  //Indicate not connected or attached
+  _connected = false;
+  _attached = false;
+
+  //Create container (attached to parent on successful connect)
+  _cont = new HCContainer(contname);
+
+  //Create in-process client
+  _cli = new HCClient(server, _cont);
+
+  //Check for deferred connect (caller connects and attaches container itself)
+  if(!connect)
+    return;
+
+  //Connect to server
+  Connect();
+
+  //Attach container to parent container
+  Attach();
+}
+
+HCConnection::~HCConnection()
+{
+  uint32_t i;
+
+  //Cleanup
+  delete _cli;
+
+  for(i=0; i<_devcount; i++)
+    delete _devs[i];
+
+  //Container is owned by parent once attached
+  if(!_attached)
+    delete _cont;
+}
+
+bool HCConnection::Connect(void)
+{
+  XMLDocument doc;
+  string srvname;
+  string srvvers;
+  uint32_t srvinfocrc;
+  string lsifname;
+  int ierr;
+
+  //Check for already connected
+  if(_connected)
+    return true;
 
   //Get server name and check for error
   if((ierr = _cli->Get(HCServer::PID_NAME, srvname)) != ERR_NONE)
   {
     cout << "Error getting server name (" << ErrToString(ierr) << ')' << "\n";
-    return;
+    return false;
   }
 
   //Print info
@@ -78,7 +149,7 @@ HCConnection::HCConnection(Device* dev, HCContainer* pcont, const string& contna
   if((ierr = _cli->Get(HCServer::PID_VERSION, srvvers)) != ERR_NONE)
   {
     cout << "Error getting server version (" << ErrToString(ierr) << ')' << "\n";
-    return;
+    return false;
   }
 
   //Print info
@@ -88,14 +159,17 @@ HCConnection::HCConnection(Device* dev, HCContainer* pcont, const string& contna
   if((ierr = _cli->Get(HCServer::PID_INFOFILECRC, srvinfocrc)) != ERR_NONE)
   {
     cout << "Error getting server information file CRC (" << ErrToString(ierr) << ')' << "\n";
-    return;
+    return false;
   }
 
   //Print info
   cout << "Server information file CRC: " << srvinfocrc << "\n";
 
+  //Check that any replicas serve the same server information file
+  _cli->CheckReplicas(srvinfocrc);
+
   //Check for no server information file name specified
-  if(sifname == "")
+  if(_sifname == "")
   {
     //Create server information file name
     lsifname = ".client-";
@@ -104,12 +178,111 @@ HCConnection::HCConnection(Device* dev, HCContainer* pcont, const string& contna
   }
   else
   {
-    //Just copy passed server information file name to local variable
-    lsifname = sifname;
+    //Just copy server information file name to local variable
+    lsifname = _sifname;
   }
 
+  //Load server information file (downloaded first if out of date) and check for error
+  if(!LoadSIF(lsifname, srvinfocrc, doc))
+    return false;
+
+  //Parse server from DOM
+  ParseServer(doc.FirstChildElement("server"), _cont);
+
+  //Indicate connected
+  _connected = true;
+
+  return true;
+}
+
+bool HCConnection::IsConnected(void)
+{
+  return _connected;
+}
+
+void HCConnection::Attach(void)
+{
+  //Check for already attached
+  if(_attached)
+    return;
+
+  //Add container to parent container
+  _pcont->Add(_cont);
+  _attached = true;
+}
+
+HCContainer* HCConnection::GetCont(void)
+{
+  return _cont;
+}
+
+HCClient* HCConnection::GetClient(void)
+{
+  return _cli;
+}
+
+void HCConnection::AddReplica(Device* dev)
+{
+  //Assert valid arguments
+  assert(dev != 0);
+
+  //Check for too many replicas
+  if(_devcount >= HCClient::REPLICA_MAX)
+  {
+    cout << __FILE__ << ' ' << __LINE__ << " - Replica count is at max (" << HCClient::REPLICA_MAX << ')' << "\n";
+    delete dev;
+    return;
+  }
+
+  //Remember device and add replica to client
+  _devs[_devcount++] = dev;
+  _cli->AddReplica(dev);
+}
+
+void HCConnection::SetPrimary(uint32_t index)
+{
+  //Set replica writes go to
+  _cli->SetPrimary(index);
+}
+
+void HCConnection::SetHoldoff(uint32_t holdoff)
+{
+  //Set time (ms) a failed replica is avoided
+  _cli->SetHoldoff(holdoff);
+}
+
+Mutex* HCConnection::GetSIFMutex(const string& sifname)
+{
+  Mutex* mutex;
+
+  //Begin mutual exclusion
+  _sifmapmutex.Wait();
+
+  //Find mutex for file name, creating it on first use (kept for life of process)
+  if((mutex = _sifmutexes[sifname]) == 0)
+  {
+    mutex = new Mutex();
+    _sifmutexes[sifname] = mutex;
+  }
+
+  //End mutual exclusion
+  _sifmapmutex.Give();
+
+  return mutex;
+}
+
+bool HCConnection::LoadSIF(const string& sifname, uint32_t srvinfocrc, XMLDocument& doc)
+{
+  Mutex* mutex;
+  uint32_t lsifcrc;
+  int ierr;
+
+  //Begin mutual exclusion (connections made in parallel to servers of the same name share a file)
+  mutex = GetSIFMutex(sifname);
+  mutex->Wait();
+
   //Calculate CRC of local server information file
-  lsifcrc = CRC32File(lsifname.c_str());
+  lsifcrc = CRC32File(sifname.c_str());
 
   //Print info
   cout << "Local server information file CRC: " << lsifcrc << "\n";
@@ -121,39 +294,46 @@ HCConnection::HCConnection(Device* dev, HCContainer* pcont, const string& contna
     cout << "Downloading server information file" << "\n";
 
     //Get server information file from server and check for error
-    if((ierr = _cli->DownloadSIF(HCServer::PID_INFOFILE, lsifname.c_str())) != ERR_NONE)
+    if((ierr = _cli->DownloadSIF(HCServer::PID_INFOFILE, sifname.c_str())) != ERR_NONE)
     {
+      mutex->Give();
       cout << "Error getting server information file (" << ErrToString(ierr) << ')' << "\n";
-      return;
+      return false;
     }
   }
 
   //Parse file and check for error
-  if((doc.LoadFile(lsifname.c_str())) != 0)
+  if((doc.LoadFile(sifname.c_str())) != 0)
   {
-    cout << "Error parsing file (" << lsifname << ')' << "\n";
-    return;
+    mutex->Give();
+    cout << "Error parsing file (" << sifname << ')' << "\n";
+    return false;
   }
 
-  //Parse server from DOM
-  ParseServer(doc.FirstChildElement("server"), _cont);
-}
+  //End mutual exclusion
+  mutex->Give();
 
-HCConnection::~HCConnection()
-{
-  //Cleanup
-  delete _cli;
-  delete _dev;
+  return true;
 }
 
 void HCConnection::ParseServer(XMLElement* pelt, HCContainer* pcont)
 {
   XMLElement* elt;
+  uint32_t pidwidth;
+  uint32_t protocol;
 
   //Check for null parent objects
   if((pelt == 0) || (pcont == 0))
     return;
 
+  //Use wide PIDs if server advertises them
+  if(ParseValue(pelt, "pidwidth", pidwidth) && (pidwidth == 32))
+    _cli->SetWidePID(true);
+
+  //Use newest message header version both ends understand (servers that don't advertise one only speak version 1)
+  if(ParseValue(pelt, "protocol", protocol) && (protocol > HCMessage::VERSION_1) && !_cli->IsDirect())
+    _cli->SetProtocol((protocol > HCMessage::VERSION_MAX) ? HCMessage::VERSION_MAX : (uint8_t)protocol);
+
   //Loop through all children
   for(elt = pelt->FirstChildElement(); elt != 0; elt = elt->NextSiblingElement())
   {
@@ -400,7 +580,7 @@ void HCConnection::ParseCont(XMLElement* pelt, HCContainer* pcont)
 
 void HCConnection::ParseCall(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   HCCallCli* stub;
   HCParameter* param;
@@ -423,13 +603,17 @@ void HCConnection::ParseCall(XMLElement* pelt, HCContainer* pcont)
   //Create parameter
   param = new HCCall<HCCallCli>(name, stub, &HCCallCli::Call);
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 void HCConnection::ParseCallT(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   uint32_t size;
   XMLElement* elt;
@@ -468,13 +652,17 @@ void HCConnection::ParseCallT(XMLElement* pelt, HCContainer* pcont)
   //Create parameter
   param = new HCCallTable<HCCallCli>(name, stub, &HCCallCli::ICall, size, eidenums);
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 void HCConnection::ParseBool(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -539,13 +727,17 @@ void HCConnection::ParseBool(XMLElement* pelt, HCContainer* pcont)
       param = new HCBoolean<HCBooleanCli>(name, stub, 0, 0, valenums);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 void HCConnection::ParseBoolT(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -619,6 +811,10 @@ void HCConnection::ParseBoolT(XMLElement* pelt, HCContainer* pcont)
       param = new HCBooleanTable<HCBooleanCli>(name, stub, 0, 0, size, eidenums, valenums);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
@@ -686,7 +882,7 @@ HCBooleanEnum* HCConnection::ParseBoolEnum(XMLElement* pelt)
 
 void HCConnection::ParseStr(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -740,13 +936,17 @@ void HCConnection::ParseStr(XMLElement* pelt, HCContainer* pcont)
       param = new HCString<HCStringCli>(name, stub, 0, 0);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 void HCConnection::ParseStrT(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -816,13 +1016,17 @@ void HCConnection::ParseStrT(XMLElement* pelt, HCContainer* pcont)
       param = new HCStringTable<HCStringCli>(name, stub, 0, 0, size, eidenums);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 void HCConnection::ParseStrL(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -881,13 +1085,17 @@ void HCConnection::ParseStrL(XMLElement* pelt, HCContainer* pcont)
       param = new HCStringList<HCStringCli>(name, stub, 0, 0, 0, maxsize);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 void HCConnection::ParseFile(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   HCFileCli* stub;
@@ -922,13 +1130,17 @@ void HCConnection::ParseFile(XMLElement* pelt, HCContainer* pcont)
   else
     param = new HCFile<HCFileCli>(name, stub, 0, 0);
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 template <typename T> void HCConnection::ParseInt(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -993,13 +1205,17 @@ template <typename T> void HCConnection::ParseInt(XMLElement* pelt, HCContainer*
       param = new HCInteger<HCIntegerCli<T>, T>(name, stub, 0, 0, valenums);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 template <typename T> void HCConnection::ParseIntT(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -1073,13 +1289,17 @@ template <typename T> void HCConnection::ParseIntT(XMLElement* pelt, HCContainer
       param = new HCIntegerTable<HCIntegerCli<T>, T>(name, stub, 0, 0, size, eidenums, valenums);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 template <typename T> void HCConnection::ParseIntL(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -1149,13 +1369,17 @@ template <typename T> void HCConnection::ParseIntL(XMLElement* pelt, HCContainer
       param = new HCIntegerList<HCIntegerCli<T>, T>(name, stub, 0, 0, 0, maxsize, valenums);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 template <typename T> void HCConnection::ParseIntA(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -1209,6 +1433,10 @@ template <typename T> void HCConnection::ParseIntA(XMLElement* pelt, HCContainer
       param = new HCIntegerArray<HCIntegerCli<T>, T>(name, stub, 0, 0);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
@@ -1337,7 +1565,7 @@ HCEIDEnum* HCConnection::ParseEIDEnum(XMLElement* pelt)
 
 template <typename T> void HCConnection::ParseFloat(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -1396,13 +1624,17 @@ template <typename T> void HCConnection::ParseFloat(XMLElement* pelt, HCContaine
       param = new HCFloat<HCFloatCli<T>, T>(name, stub, 0, 0, scl);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 template <typename T> void HCConnection::ParseFloatTable(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -1477,13 +1709,17 @@ template <typename T> void HCConnection::ParseFloatTable(XMLElement* pelt, HCCon
       param = new HCFloatTable<HCFloatCli<T>, T>(name, stub, 0, 0, size, eidenums, scl);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 template <typename T> void HCConnection::ParseVec2(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -1547,13 +1783,17 @@ template <typename T> void HCConnection::ParseVec2(XMLElement* pelt, HCContainer
       param = new HCVec2<HCVec2Cli<T>, T>(name, stub, 0, 0, scl0, scl1);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 template <typename T> void HCConnection::ParseVec2T(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -1633,13 +1873,17 @@ template <typename T> void HCConnection::ParseVec2T(XMLElement* pelt, HCContaine
       param = new HCVec2Table<HCVec2Cli<T>, T>(name, stub, 0, 0, size, eidenums, scl0, scl1);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 template <typename T> void HCConnection::ParseVec3(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -1708,13 +1952,17 @@ template <typename T> void HCConnection::ParseVec3(XMLElement* pelt, HCContainer
       param = new HCVec3<HCVec3Cli<T>, T>(name, stub, 0, 0, scl0, scl1, scl2);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
 
 template <typename T> void HCConnection::ParseVec3T(XMLElement* pelt, HCContainer* pcont)
 {
-  uint16_t pid;
+  uint32_t pid;
   string name;
   string acc;
   string sav;
@@ -1799,6 +2047,10 @@ template <typename T> void HCConnection::ParseVec3T(XMLElement* pelt, HCContaine
       param = new HCVec3Table<HCVec3Cli<T>, T>(name, stub, 0, 0, size, eidenums, scl0, scl1, scl2);
   }
 
+  //Bind parameter to downstream PID for cut-through forwarding (in-process parameters are called directly)
+  if(!_cli->IsDirect())
+    param->SetProxy(_cli, pid);
+
   //Add to parent
   pcont->Add(param);
 }
@@ -32,16 +32,29 @@
 #include "hccontainer.hh"
 #include "hcserver.hh"
 #include "hcinteger.hh"
+#include "mutex.hh"
 #include "tinyxml2.hh"
+#include <map>
 #include <string>
 
 class HCConnection
 {
 public:
-  HCConnection(Device* dev, HCContainer* pcont, const std::string& contname, uint32_t timeout, const std::string& sifname="");
+  HCConnection(Device* dev, HCContainer* pcont, const std::string& contname, uint32_t timeout, const std::string& sifname="", bool connect=true);
+  HCConnection(HCServer* server, HCContainer* pcont, const std::string& contname, const std::string& sifname="", bool connect=true);
   virtual ~HCConnection();
+  bool Connect(void);
+  bool IsConnected(void);
+  void Attach(void);
+  HCContainer* GetCont(void);
+  HCClient* GetClient(void);
+  void AddReplica(Device* dev);
+  void SetPrimary(uint32_t index);
+  void SetHoldoff(uint32_t holdoff);
 
 private:
+  static Mutex* GetSIFMutex(const std::string& sifname);
+  bool LoadSIF(const std::string& sifname, uint32_t srvinfocrc, tinyxml2::XMLDocument& doc);
   void ParseServer(tinyxml2::XMLElement* pelt, HCContainer* pcont);
   void ParseCont(tinyxml2::XMLElement* pelt, HCContainer* pcont);
   void ParseCall(tinyxml2::XMLElement* pelt, HCContainer* pcont);
@@ -68,7 +81,14 @@ private:
   template <typename T> bool ParseValue(tinyxml2::XMLElement* pelt, const char* name, T& val);
 
 private:
-  Device* _dev;
+  Device* _devs[HCClient::REPLICA_MAX];
+  uint32_t _devcount;
   HCClient* _cli;
+  HCContainer* _pcont;
   HCContainer* _cont;
+  std::string _sifname;
+  bool _connected;
+  bool _attached;
+  static Mutex _sifmapmutex;
+  static std::map<std::string, Mutex*> _sifmutexes;
 };
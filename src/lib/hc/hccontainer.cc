@@ -173,12 +173,13 @@ void HCContainer::SetParent(HCContainer* parent)
 
 HCContainer* HCContainer::GetNext(void)
 {
-  return _next;
+  return __atomic_load_n(&_next, __ATOMIC_ACQUIRE);
 }
 
 void HCContainer::SetNext(HCContainer* next)
 {
-  _next = next;
+  //Publish fully built container to tree walkers
+  __atomic_store_n(&_next, next, __ATOMIC_RELEASE);
 }
 
 void HCContainer::Add(HCContainer* cont)
@@ -188,10 +189,14 @@ void HCContainer::Add(HCContainer* cont)
   //Assert valid arguments
   assert(cont != 0);
 
+  //This container becomes parent to added container (before walkers of a live tree can reach it)
+  cont->SetParent(this);
+
   //Check for first container added
   if(_firstsubcont == 0)
   {
-    _firstsubcont = cont;
+    //Publish fully built container to tree walkers
+    __atomic_store_n(&_firstsubcont, cont, __ATOMIC_RELEASE);
   }
   else
   {
@@ -203,9 +208,6 @@ void HCContainer::Add(HCContainer* cont)
     //Add new container at end of list
     last->SetNext(cont);
   }
-
-  //This container becomes parent to added container
-  cont->SetParent(this);
 }
 
 void HCContainer::Add(HCParameter* param)
@@ -218,7 +220,8 @@ void HCContainer::Add(HCParameter* param)
   //Check for first parameter added
   if(_firstsubparam == 0)
   {
-    _firstsubparam = param;
+    //Publish fully built parameter to tree walkers
+    __atomic_store_n(&_firstsubparam, param, __ATOMIC_RELEASE);
   }
   else
   {
@@ -234,10 +237,10 @@ void HCContainer::Add(HCParameter* param)
 
 HCContainer* HCContainer::GetFirstSubCont(void)
 {
-  return _firstsubcont;
+  return __atomic_load_n(&_firstsubcont, __ATOMIC_ACQUIRE);
 }
 
 HCParameter* HCContainer::GetFirstSubParam(void)
 {
-  return _firstsubparam;
+  return __atomic_load_n(&_firstsubparam, __ATOMIC_ACQUIRE);
 }
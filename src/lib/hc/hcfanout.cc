@@ -0,0 +1,325 @@
+// HC fan-out query
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "hcfanout.hh"
+#include "hcutility.hh"
+#include <cassert>
+
+using namespace std;
+
+HCFanOutBatch::HCFanOutBatch(HCClient* cli, uint32_t maxcount)
+{
+  //Assert valid arguments
+  assert((cli != 0) && (maxcount > 0));
+
+  //Initialize member variables
+  _cli = cli;
+  _count = 0;
+  _indices = new uint32_t[maxcount];
+  _icells = new HCCell*[maxcount];
+  _ocells = new HCCell*[maxcount];
+  _errs = new int[maxcount];
+  _submitted = false;
+
+  //Create thread (started only if batch runs alongside others without an executor)
+  _thread = new Thread<HCFanOutBatch>(this, &HCFanOutBatch::Run);
+}
+
+HCFanOutBatch::~HCFanOutBatch()
+{
+  //Cleanup
+  delete _thread;
+  delete[] _errs;
+  delete[] _ocells;
+  delete[] _icells;
+  delete[] _indices;
+}
+
+HCClient* HCFanOutBatch::GetClient(void)
+{
+  return _cli;
+}
+
+void HCFanOutBatch::Add(uint32_t index, HCCell* icell, HCCell* ocell)
+{
+  //Assert valid arguments
+  assert((icell != 0) && (ocell != 0));
+
+  //Add cells to batch (caller sizes batch for all matched parameters)
+  _indices[_count] = index;
+  _icells[_count] = icell;
+  _ocells[_count] = ocell;
+  _errs[_count] = ERR_UNSPEC;
+  _count++;
+}
+
+uint32_t HCFanOutBatch::GetCount(void)
+{
+  return _count;
+}
+
+uint32_t HCFanOutBatch::GetIndex(uint32_t i)
+{
+  //Assert valid arguments
+  assert(i < _count);
+
+  return _indices[i];
+}
+
+int HCFanOutBatch::GetErr(uint32_t i)
+{
+  //Assert valid arguments
+  assert(i < _count);
+
+  return _errs[i];
+}
+
+void HCFanOutBatch::Start(Executor* exec)
+{
+  //Run batch on executor if given and it has room
+  if((exec != 0) && (exec->Submit(this) == ERR_NONE))
+  {
+    _submitted = true;
+    return;
+  }
+
+  //Run batch in its own thread
+  _thread->Start();
+}
+
+void HCFanOutBatch::Join(void)
+{
+  //Wait for batch to finish on executor
+  if(_submitted)
+  {
+    Wait();
+    return;
+  }
+
+  //Wait for batch thread to finish
+  _thread->Join();
+}
+
+void HCFanOutBatch::Run(void)
+{
+  //Send all cells to downstream server in as few transactions as possible
+  _cli->Batch(_icells, _ocells, _errs, _count);
+}
+
+HCFanOut::HCFanOut(HCContainer* top, uint32_t maxcount)
+{
+  uint32_t i;
+
+  //Assert valid arguments
+  assert((top != 0) && (maxcount > 0));
+
+  //Initialize member variables
+  _top = top;
+  _maxcount = maxcount;
+  _count = 0;
+  _params = new HCParameter*[_maxcount];
+  _paths = new string[_maxcount];
+  _icells = new HCCell*[_maxcount];
+  _ocells = new HCCell*[_maxcount];
+  _errs = new int[_maxcount];
+  _batches = new HCFanOutBatch*[_maxcount];
+  _exec = 0;
+
+  //Create cells
+  for(i=0; i<_maxcount; i++)
+  {
+    _icells[i] = new HCCell();
+    _ocells[i] = new HCCell();
+  }
+}
+
+HCFanOut::~HCFanOut()
+{
+  uint32_t i;
+
+  //Cleanup
+  for(i=0; i<_maxcount; i++)
+  {
+    delete _icells[i];
+    delete _ocells[i];
+  }
+
+  delete[] _batches;
+  delete[] _errs;
+  delete[] _ocells;
+  delete[] _icells;
+  delete[] _paths;
+  delete[] _params;
+}
+
+void HCFanOut::SetExecutor(Executor* exec)
+{
+  //Run batches as executor tasks instead of a thread each
+  _exec = exec;
+}
+
+uint32_t HCFanOut::Get(const string& name)
+{
+  uint32_t i;
+  uint32_t j;
+  uint32_t k;
+  uint32_t batchcount;
+  HCClient* cli;
+  uint32_t dpid;
+
+  //Resolve expression against tree
+  _count = HCUtility::FindParams(name, _top, _params, _paths, _maxcount);
+
+  //Group matched parameters by downstream connection
+  batchcount = 0;
+  for(i=0; i<_count; i++)
+  {
+    //Check for parameter without a plain value (calls, files, tables and lists are not fetched)
+    if((_params[i]->GetType() == HCParameter::T_CALL) || (_params[i]->GetType() == HCParameter::T_FILE) || _params[i]->IsATable() || _params[i]->IsAList())
+    {
+      _errs[i] = ERR_TYPE;
+    }
+    else if(_params[i]->GetProxy(cli, dpid))
+    {
+      //Format get command cell using downstream PID
+      _icells[i]->Reset(HCCell::OPCODE_GET_CMD | (cli->GetWidePID() ? HCCell::OPCODE_WIDE : 0));
+      _icells[i]->WritePID(dpid);
+
+      //Find batch for downstream connection or create one
+      for(j=0; (j<batchcount) && (_batches[j]->GetClient() != cli); j++);
+      if(j == batchcount)
+        _batches[batchcount++] = new HCFanOutBatch(cli, _count);
+
+      //Add cells to batch
+      _batches[j]->Add(i, _icells[i], _ocells[i]);
+    }
+    else
+    {
+      //Get local parameter directly into status cell (PID is filled in by caller)
+      _icells[i]->Reset(HCCell::OPCODE_GET_CMD);
+      _ocells[i]->Reset(HCCell::OPCODE_GET_STS);
+      _ocells[i]->WritePID(0);
+      _errs[i] = _params[i]->GetCell(_icells[i], _ocells[i]) ? ERR_NONE : ERR_UNSPEC;
+    }
+  }
+
+  //Issue batches to all downstream servers in parallel (last one runs in this thread)
+  for(j=0; (j+1)<batchcount; j++)
+    _batches[j]->Start(_exec);
+  if(batchcount > 0)
+    _batches[batchcount-1]->Run();
+
+  //Wait for batches and collect errors
+  for(j=0; j<batchcount; j++)
+  {
+    //Wait for batch if it ran alongside this thread
+    if((j+1) < batchcount)
+      _batches[j]->Join();
+
+    //Copy errors to matching results
+    for(k=0; k<_batches[j]->GetCount(); k++)
+      _errs[_batches[j]->GetIndex(k)] = _batches[j]->GetErr(k);
+
+    //Cleanup
+    delete _batches[j];
+  }
+
+  return _count;
+}
+
+uint32_t HCFanOut::GetCount(void)
+{
+  return _count;
+}
+
+HCParameter* HCFanOut::GetParam(uint32_t i)
+{
+  //Assert valid arguments
+  assert(i < _count);
+
+  return _params[i];
+}
+
+const string& HCFanOut::GetPath(uint32_t i)
+{
+  //Assert valid arguments
+  assert(i < _count);
+
+  return _paths[i];
+}
+
+HCCell* HCFanOut::GetReply(uint32_t i)
+{
+  //Assert valid arguments
+  assert(i < _count);
+
+  //Check for no reply
+  if(_errs[i] != ERR_NONE)
+    return 0;
+
+  //Return get status cell ready to be read from the start
+  _ocells[i]->Rewind();
+  return _ocells[i];
+}
+
+int HCFanOut::GetErr(uint32_t i)
+{
+  //Assert valid arguments
+  assert(i < _count);
+
+  return _errs[i];
+}
+
+int HCFanOut::GetStr(uint32_t i, string& val)
+{
+  HCCell* cell;
+  uint32_t pid;
+  uint8_t type;
+  int8_t err;
+
+  //Assert valid arguments
+  assert(i < _count);
+
+  //Clear value
+  val.clear();
+
+  //Get reply and check for error
+  if((cell = GetReply(i)) == 0)
+    return _errs[i];
+
+  //Read PID and type and check for error
+  if(!cell->ReadPID(pid) || !cell->Read(type))
+    return ERR_DESER;
+
+  //Read value and error code and check for error
+  if(!HCParameter::ValueString(cell, type, val) || !cell->Read(err))
+  {
+    val.clear();
+    return ERR_DESER;
+  }
+
+  return err;
+}
@@ -0,0 +1,92 @@
+// HC fan-out query
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "hccell.hh"
+#include "hcclient.hh"
+#include "hccontainer.hh"
+#include "executor.hh"
+#include "hcparameter.hh"
+#include "thread.hh"
+#include <inttypes.h>
+#include <string>
+
+class HCFanOutBatch : public ExecutorTask
+{
+public:
+  HCFanOutBatch(HCClient* cli, uint32_t maxcount);
+  ~HCFanOutBatch();
+  HCClient* GetClient(void);
+  void Add(uint32_t index, HCCell* icell, HCCell* ocell);
+  uint32_t GetCount(void);
+  uint32_t GetIndex(uint32_t i);
+  int GetErr(uint32_t i);
+  void Start(Executor* exec=0);
+  void Join(void);
+  virtual void Run(void);
+
+private:
+  HCClient* _cli;
+  uint32_t _count;
+  uint32_t* _indices;
+  HCCell** _icells;
+  HCCell** _ocells;
+  int* _errs;
+  bool _submitted;
+  Thread<HCFanOutBatch>* _thread;
+};
+
+class HCFanOut
+{
+public:
+  //Default maximum number of parameters matched by a query
+  static const uint32_t MAXCOUNT_DEFAULT = 256;
+
+public:
+  HCFanOut(HCContainer* top, uint32_t maxcount=MAXCOUNT_DEFAULT);
+  ~HCFanOut();
+  void SetExecutor(Executor* exec);
+  uint32_t Get(const std::string& name);
+  uint32_t GetCount(void);
+  HCParameter* GetParam(uint32_t i);
+  const std::string& GetPath(uint32_t i);
+  HCCell* GetReply(uint32_t i);
+  int GetErr(uint32_t i);
+  int GetStr(uint32_t i, std::string& val);
+
+private:
+  HCContainer* _top;
+  uint32_t _maxcount;
+  uint32_t _count;
+  HCParameter** _params;
+  std::string* _paths;
+  HCCell** _icells;
+  HCCell** _ocells;
+  int* _errs;
+  HCFanOutBatch** _batches;
+  Executor* _exec;
+};
@@ -40,7 +40,7 @@
 class HCFileCli
 {
 public:
-  HCFileCli(HCClient* cli, uint16_t pid)
+  HCFileCli(HCClient* cli, uint32_t pid)
   {
     //Assert valid arguments
     assert(cli != 0);
@@ -67,9 +67,21 @@ public:
     return _cli->Write(_pid, offset, val, len);
   }
 
+  int Read(uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len, HCAsync* xact)
+  {
+    //Delegate to client (data and length stored when transaction completes)
+    return _cli->Read(_pid, offset, val, maxlen, len, xact);
+  }
+
+  int Write(uint32_t offset, uint8_t* val, uint16_t len, HCAsync* xact)
+  {
+    //Delegate to client
+    return _cli->Write(_pid, offset, val, len, xact);
+  }
+
 private:
   HCClient* _cli;
-  uint16_t _pid;
+  uint32_t _pid;
 };
 
 //File
@@ -146,7 +158,7 @@ public:
     st << "\n  Access: " << (_readmethod == 0 ? "" : "R") << (_writemethod == 0 ? "" : "W");
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     //Generate XML information
     file << std::string(indent, ' ') << "<file>" << "\n";
@@ -260,6 +272,29 @@ public:
     return ERR_NONE;
   }
 
+  virtual int Read(uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len)
+  {
+    //Check for null method
+    if(_readmethod == 0)
+    {
+      len = 0;
+      return ERR_ACCESS;
+    }
+
+    //Call read method
+    return (_object->*_readmethod)(offset, val, maxlen, len);
+  }
+
+  virtual int Write(uint32_t offset, uint8_t* val, uint16_t len)
+  {
+    //Check for null method
+    if(_writemethod == 0)
+      return ERR_ACCESS;
+
+    //Call write method
+    return (_object->*_writemethod)(offset, val, len);
+  }
+
   virtual bool ReadCell(uint32_t offset, uint16_t maxlen, HCCell* icell, HCCell* ocell)
   {
     uint16_t len;
@@ -272,6 +307,10 @@ public:
     if(maxlen > BUFFSER_SIZE)
       maxlen = BUFFSER_SIZE;
 
+    //Leave room for wide PID
+    if(icell->IsWide() && (maxlen > (BUFFSER_SIZE - 2)))
+      maxlen = BUFFSER_SIZE - 2;
+
     //Check for valid method
     if(_readmethod != 0)
     {
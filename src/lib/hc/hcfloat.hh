@@ -44,7 +44,7 @@ template <class T>
 class HCFloatCli
 {
 public:
-  HCFloatCli(HCClient* cli, uint16_t pid)
+  HCFloatCli(HCClient* cli, uint32_t pid)
   {
     //Assert valid arguments
     assert(cli != 0);
@@ -83,9 +83,33 @@ public:
     return _cli->ISet(_pid, eid, val);
   }
 
+  int Get(T& val, HCAsync* xact)
+  {
+    //Delegate to client (value stored when transaction completes)
+    return _cli->Get(_pid, val, xact);
+  }
+
+  int Set(const T val, HCAsync* xact)
+  {
+    //Delegate to client
+    return _cli->Set(_pid, val, xact);
+  }
+
+  int IGet(uint32_t eid, T& val, HCAsync* xact)
+  {
+    //Delegate to client (value stored when transaction completes)
+    return _cli->IGet(_pid, eid, val, xact);
+  }
+
+  int ISet(uint32_t eid, const T val, HCAsync* xact)
+  {
+    //Delegate to client
+    return _cli->ISet(_pid, eid, val, xact);
+  }
+
 private:
   HCClient* _cli;
-  uint16_t _pid;
+  uint32_t _pid;
 };
 
 //-----------------------------------------------------------------------------
@@ -205,7 +229,7 @@ public:
     st << "\n  Scale: " << _scale;
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     T dummy;
 
@@ -658,7 +682,7 @@ public:
     }
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     T dummy;
     uint32_t i;
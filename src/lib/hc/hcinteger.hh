@@ -126,7 +126,7 @@ template <class T>
 class HCIntegerCli
 {
 public:
-  HCIntegerCli(HCClient* cli, uint16_t pid)
+  HCIntegerCli(HCClient* cli, uint32_t pid)
   {
     //Assert valid arguments
     assert(cli != 0);
@@ -188,9 +188,33 @@ public:
     return _cli->Set(_pid, val, len);
   }
 
+  int Get(T& val, HCAsync* xact)
+  {
+    //Delegate to client (value stored when transaction completes)
+    return _cli->Get(_pid, val, xact);
+  }
+
+  int Set(const T val, HCAsync* xact)
+  {
+    //Delegate to client
+    return _cli->Set(_pid, val, xact);
+  }
+
+  int IGet(uint32_t eid, T& val, HCAsync* xact)
+  {
+    //Delegate to client (value stored when transaction completes)
+    return _cli->IGet(_pid, eid, val, xact);
+  }
+
+  int ISet(uint32_t eid, const T val, HCAsync* xact)
+  {
+    //Delegate to client
+    return _cli->ISet(_pid, eid, val, xact);
+  }
+
 private:
   HCClient* _cli;
-  uint16_t _pid;
+  uint32_t _pid;
 };
 
 //-----------------------------------------------------------------------------
@@ -402,7 +426,7 @@ public:
     }
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     T dummy;
     uint32_t i;
@@ -1346,7 +1370,7 @@ public:
     }
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     T dummy;
     uint32_t i;
@@ -2397,7 +2421,7 @@ public:
     }
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     T dummy;
     uint32_t i;
@@ -3189,7 +3213,7 @@ public:
     st << "\n  Savable: " << (IsSavable() ? "Yes" : "No");
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     T* dummy = 0;
 
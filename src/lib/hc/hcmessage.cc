@@ -26,10 +26,10 @@
 
 #include "hcmessage.hh"
 #include "error.hh"
-#include "thread.hh"
 #include <cassert>
 #include <iomanip>
 #include <iostream>
+#include <string.h>
 
 using namespace std;
 
@@ -38,13 +38,15 @@ HCMessage::HCMessage()
   //Allocate memory for message buffer
   _buffer = new uint8_t[OVERHEAD + PAYLOAD_MAX];
 
-  //Remember payload pointer (offset within message buffer)
+  //Remember payload pointer (offset within message buffer leaves room for largest header)
   _payload = _buffer + OVERHEAD;
 
-  //Initialize read index, payload length and transaction number
+  //Initialize read index, payload length, transaction number, version and flags
   _readindex = 0;
   _payloadlength = 0;
   _transaction = 0;
+  _version = VERSION_1;
+  _flags = 0;
 }
 
 HCMessage::~HCMessage()
@@ -53,37 +55,62 @@ HCMessage::~HCMessage()
   delete[] _buffer;
 }
 
-void HCMessage::Reset(uint8_t transaction)
+void HCMessage::Reset(uint32_t transaction)
 {
-  //Initialize read index, payload length and transaction number
+  //Initialize payload pointer, read index, payload length and transaction number (version and flags kept)
+  _payload = _buffer + OVERHEAD;
   _readindex = 0;
   _payloadlength = 0;
   _transaction = transaction;
 }
 
-uint8_t HCMessage::GetTransaction(void)
+uint32_t HCMessage::GetTransaction(void)
 {
   return _transaction;
 }
 
-int HCMessage::Send(Device* dev)
+uint8_t HCMessage::GetVersion(void)
 {
-  uint32_t i;
+  return _version;
+}
 
+void HCMessage::SetVersion(uint8_t version)
+{
   //Assert valid arguments
-  assert(dev != 0);
+  assert((version >= VERSION_1) && (version <= VERSION_MAX));
 
-  //Zero index
-  i=0;
+  _version = version;
+}
 
-  //Serialize transaction number
-  _buffer[i++] = _transaction;
+uint8_t HCMessage::GetFlags(void)
+{
+  return _flags;
+}
+
+void HCMessage::SetFlags(uint8_t flags)
+{
+  _flags = flags;
+}
+
+int HCMessage::Send(Device* dev)
+{
+  //Send to device's default destination
+  return Send(dev, Device::PEER_NONE);
+}
+
+int HCMessage::Send(Device* dev, uint64_t peer)
+{
+  uint8_t* start;
+  uint32_t len;
+
+  //Assert valid arguments
+  assert(dev != 0);
 
-  //Payload is already serialized in buffer so skip
-  i += _payloadlength;
+  //Serialize header in front of payload (payload is already serialized in buffer)
+  start = SerializeHeader(len);
 
-  //Write serialized message to device and check for error
-  if(dev->Write(_buffer, i) != i)
+  //Write serialized message to device peer and check for error
+  if(dev->WriteTo(start, len, peer) != len)
     return ERR_UNSPEC;
 
   //Success
@@ -91,39 +118,67 @@ int HCMessage::Send(Device* dev)
 }
 
 int HCMessage::Recv(Device* dev)
+{
+  uint64_t peer;
+
+  //Receive ignoring source peer
+  return Recv(dev, peer);
+}
+
+int HCMessage::Recv(Device* dev, uint64_t& peer)
 {
   uint32_t rlen;
-  uint32_t i;
 
   //Assert valid arguments
   assert(dev != 0);
 
-  //Read serialized message from device and check for error
-  if((rlen = dev->Read(_buffer, OVERHEAD + PAYLOAD_MAX)) == 0)
+  //Read serialized message and source peer from device and check for error
+  if((rlen = dev->ReadFrom(_buffer, OVERHEAD + PAYLOAD_MAX, peer)) == 0)
   {
-    //Sleep a while to prevent starving other threads
-    ThreadSleep(1000);
+    //Block until device is readable again (at most a while) rather than spin and starve other threads
+    dev->WaitReadable(1000);
     return ERR_UNSPEC;
   }
 
-  //Check for overflow
-  if((rlen < OVERHEAD) || (rlen > (OVERHEAD + PAYLOAD_MAX)))
-    return ERR_UNSPEC;
+  //Deserialize header (whichever version sender used)
+  return DeserializeHeader(rlen);
+}
 
-  //Zero index
-  i=0;
+uint32_t HCMessage::Store(uint8_t* buf, uint32_t maxlen)
+{
+  uint8_t* start;
+  uint32_t len;
 
-  //Deserialize transaction number
-  _transaction = _buffer[i++];
+  //Assert valid arguments
+  assert(buf != 0);
 
-  //Reset read index
-  _readindex = 0;
+  //Check for room
+  if((len = GetHeaderLength() + _payloadlength) > maxlen)
+    return 0;
 
-  //Set payload length
-  _payloadlength = rlen - OVERHEAD;
+  //Serialize header in front of payload
+  start = SerializeHeader(len);
 
-  //Success
-  return ERR_NONE;
+  //Copy serialized message (payload is already serialized in buffer)
+  memcpy(buf, start, len);
+
+  return len;
+}
+
+int HCMessage::Load(const uint8_t* buf, uint32_t len)
+{
+  //Assert valid arguments
+  assert(buf != 0);
+
+  //Check for overflow
+  if(len > (OVERHEAD + PAYLOAD_MAX))
+    return ERR_UNSPEC;
+
+  //Copy serialized message
+  memcpy(_buffer, buf, len);
+
+  //Deserialize header (whichever version sender used)
+  return DeserializeHeader(len);
 }
 
 bool HCMessage::Read(HCCell* cell)
@@ -159,7 +214,11 @@ void HCMessage::Print(const string& extra)
   uint32_t i;
 
   //Print common info
-  cout << extra << "Msg: Xact=" << (uint16_t)_transaction;
+  cout << extra << "Msg: Ver=" << (uint16_t)_version << ", Xact=" << _transaction;
+
+  //Print flags of version 2 header
+  if(_version != VERSION_1)
+    cout << ", Flags=" << hex << setw(2) << setfill('0') << (uint16_t)_flags << dec;
 
   //Print payload
   cout << ", Payload=";
@@ -167,3 +226,128 @@ void HCMessage::Print(const string& extra)
     cout << hex << setw(2) << setfill('0') << (uint16_t)_payload[i] << dec << " ";
   cout << "\n";
 }
+
+uint32_t HCMessage::GetHeaderLength(void)
+{
+  //Version 1 header is transaction number only
+  if(_version == VERSION_1)
+    return OVERHEAD_V1;
+
+  //Version 2 header may carry total length
+  return OVERHEAD_V2 + (((_flags & FLAG_LENGTH) != 0) ? LENGTH_SIZE : 0);
+}
+
+uint8_t* HCMessage::SerializeHeader(uint32_t& len)
+{
+  uint32_t hlen;
+  uint8_t* start;
+  uint32_t i;
+
+  //Header goes immediately before payload
+  hlen = GetHeaderLength();
+  start = _payload - hlen;
+  len = hlen + _payloadlength;
+
+  //Zero index
+  i=0;
+
+  //Check for version 1
+  if(_version == VERSION_1)
+  {
+    //Serialize transaction number (low 8 bits)
+    start[i++] = (uint8_t)_transaction;
+    return start;
+  }
+
+  //Serialize version, marker and flags
+  start[i++] = _version;
+  start[i++] = MARKER;
+  start[i++] = _flags;
+
+  //Serialize transaction number
+  start[i++] = (uint8_t)(_transaction >> 24);
+  start[i++] = (uint8_t)(_transaction >> 16);
+  start[i++] = (uint8_t)(_transaction >> 8);
+  start[i++] = (uint8_t)_transaction;
+
+  //Serialize total length if flagged
+  if((_flags & FLAG_LENGTH) != 0)
+  {
+    start[i++] = (uint8_t)(len >> 8);
+    start[i++] = (uint8_t)len;
+  }
+
+  return start;
+}
+
+int HCMessage::DeserializeHeader(uint32_t len)
+{
+  uint32_t hlen;
+  uint32_t total;
+  uint32_t i;
+
+  //Check for version 2 marker where version 1 has its first opcode
+  if((len >= 2) && (_buffer[1] == MARKER) && (_buffer[0] >= VERSION_2))
+  {
+    //Check for version this end doesn't speak or header cut short
+    if((_buffer[0] > VERSION_MAX) || (len < OVERHEAD_V2))
+      return ERR_UNSPEC;
+
+    //Zero index
+    i=0;
+
+    //Deserialize version and flags (skipping marker)
+    _version = _buffer[i++];
+    i++;
+    _flags = _buffer[i++];
+
+    //Deserialize transaction number
+    _transaction = (uint32_t)_buffer[i++] << 24;
+    _transaction |= (uint32_t)_buffer[i++] << 16;
+    _transaction |= (uint32_t)_buffer[i++] << 8;
+    _transaction |= (uint32_t)_buffer[i++];
+
+    //Deserialize and check total length if flagged
+    if((_flags & FLAG_LENGTH) != 0)
+    {
+      if(len < (OVERHEAD_V2 + LENGTH_SIZE))
+        return ERR_UNSPEC;
+
+      total = (uint32_t)_buffer[i++] << 8;
+      total |= (uint32_t)_buffer[i++];
+
+      if(total != len)
+        return ERR_UNSPEC;
+    }
+
+    hlen = i;
+  }
+  else
+  {
+    //Check for empty message
+    if(len < OVERHEAD_V1)
+      return ERR_UNSPEC;
+
+    //Deserialize version 1 transaction number
+    _version = VERSION_1;
+    _flags = 0;
+    _transaction = _buffer[0];
+    hlen = OVERHEAD_V1;
+  }
+
+  //Check for payload overflow
+  if((len - hlen) > PAYLOAD_MAX)
+    return ERR_UNSPEC;
+
+  //Payload follows header
+  _payload = _buffer + hlen;
+
+  //Reset read index
+  _readindex = 0;
+
+  //Set payload length
+  _payloadlength = len - hlen;
+
+  //Success
+  return ERR_NONE;
+}
@@ -34,8 +34,21 @@
 class HCMessage
 {
 public:
-  //Message overhead
-  static const uint32_t OVERHEAD = 1;
+  //Protocol versions (version 1 header is just an 8 bit transaction number)
+  static const uint8_t VERSION_1 = 1;
+  static const uint8_t VERSION_2 = 2;
+  static const uint8_t VERSION_MAX = VERSION_2;
+
+  //Version 2 header is version, marker, flags, 32 bit transaction number and total length (if flagged), with
+  //the marker where version 1 has its first opcode (never a valid opcode so versions can't be confused)
+  static const uint8_t MARKER = 0x48;
+  static const uint8_t FLAG_LENGTH = 0x01;
+
+  //Header sizes (overhead is the largest so buffers sized with it hold any version)
+  static const uint32_t OVERHEAD_V1 = 1;
+  static const uint32_t OVERHEAD_V2 = 7;
+  static const uint32_t LENGTH_SIZE = 2;
+  static const uint32_t OVERHEAD = OVERHEAD_V2 + LENGTH_SIZE;
 
   //Maximum payload size (see cell payload max)
   static const uint32_t PAYLOAD_MAX = 1400;
@@ -43,18 +56,33 @@ public:
 public:
   HCMessage();
   ~HCMessage();
-  void Reset(uint8_t transaction);
-  uint8_t GetTransaction(void);
+  void Reset(uint32_t transaction);
+  uint32_t GetTransaction(void);
+  uint8_t GetVersion(void);
+  void SetVersion(uint8_t version);
+  uint8_t GetFlags(void);
+  void SetFlags(uint8_t flags);
   int Send(Device* dev);
+  int Send(Device* dev, uint64_t peer);
   int Recv(Device* dev);
+  int Recv(Device* dev, uint64_t& peer);
+  uint32_t Store(uint8_t* buf, uint32_t maxlen);
+  int Load(const uint8_t* buf, uint32_t len);
   bool Read(HCCell* val);
   bool Write(HCCell* val);
   void Print(const std::string& extra);
 
+private:
+  uint32_t GetHeaderLength(void);
+  uint8_t* SerializeHeader(uint32_t& len);
+  int DeserializeHeader(uint32_t len);
+
 private:
   uint8_t* _buffer;
   uint8_t* _payload;
   uint32_t _readindex;
   uint32_t _payloadlength;
-  uint8_t _transaction;
+  uint32_t _transaction;
+  uint8_t _version;
+  uint8_t _flags;
 };
@@ -27,6 +27,7 @@
 #include "const.hh"
 #include "hcparameter.hh"
 #include "error.hh"
+#include "str.hh"
 #include <cassert>
 
 using namespace std;
@@ -36,6 +37,8 @@ HCParameter::HCParameter(const string& name)
 {
   //Initialize member variables
   _next = 0;
+  _proxycli = 0;
+  _proxypid = 0;
 }
 
 HCParameter::~HCParameter()
@@ -99,6 +102,139 @@ bool HCParameter::SkipValue(HCCell* cell, uint8_t type)
   return false;
 }
 
+template <typename T> static bool ArrayValueString(HCCell* cell, std::string& val)
+{
+  T aval[HCCell::PAYLOAD_MAX / sizeof(T)];
+  uint16_t len;
+
+  //Read array from cell and check for error
+  if(!cell->Read(aval, HCCell::PAYLOAD_MAX / sizeof(T), len))
+    return false;
+
+  //Convert to string
+  StringPrint(aval, len, val);
+  return true;
+}
+
+bool HCParameter::ValueString(HCCell* cell, uint8_t type, string& val)
+{
+  bool boolval;
+  int8_t i8val;
+  int16_t i16val;
+  int32_t i32val;
+  int64_t i64val;
+  uint8_t u8val;
+  uint16_t u16val;
+  uint32_t u32val;
+  uint64_t u64val;
+  float f32val[3];
+  double f64val[3];
+
+  //Assert valid arguments
+  assert(cell != 0);
+
+  //Read value depending on type and convert to string
+  switch(type)
+  {
+  case T_BOOL:
+    if(!cell->Read(boolval))
+      return false;
+    StringPrint(boolval, val);
+    return true;
+  case T_STR:
+    return cell->Read(val);
+  case T_I8:
+    if(!cell->Read(i8val))
+      return false;
+    StringPrint(i8val, val);
+    return true;
+  case T_I16:
+    if(!cell->Read(i16val))
+      return false;
+    StringPrint(i16val, val);
+    return true;
+  case T_I32:
+    if(!cell->Read(i32val))
+      return false;
+    StringPrint(i32val, val);
+    return true;
+  case T_I64:
+    if(!cell->Read(i64val))
+      return false;
+    StringPrint(i64val, val);
+    return true;
+  case T_U8:
+    if(!cell->Read(u8val))
+      return false;
+    StringPrint(u8val, val);
+    return true;
+  case T_U16:
+    if(!cell->Read(u16val))
+      return false;
+    StringPrint(u16val, val);
+    return true;
+  case T_U32:
+    if(!cell->Read(u32val))
+      return false;
+    StringPrint(u32val, val);
+    return true;
+  case T_U64:
+    if(!cell->Read(u64val))
+      return false;
+    StringPrint(u64val, val);
+    return true;
+  case T_F32:
+    if(!cell->Read(f32val[0]))
+      return false;
+    StringPrint(f32val[0], val);
+    return true;
+  case T_F64:
+    if(!cell->Read(f64val[0]))
+      return false;
+    StringPrint(f64val[0], val);
+    return true;
+  case T_I8A:
+    return ArrayValueString<int8_t>(cell, val);
+  case T_I16A:
+    return ArrayValueString<int16_t>(cell, val);
+  case T_I32A:
+    return ArrayValueString<int32_t>(cell, val);
+  case T_I64A:
+    return ArrayValueString<int64_t>(cell, val);
+  case T_U8A:
+    return ArrayValueString<uint8_t>(cell, val);
+  case T_U16A:
+    return ArrayValueString<uint16_t>(cell, val);
+  case T_U32A:
+    return ArrayValueString<uint32_t>(cell, val);
+  case T_U64A:
+    return ArrayValueString<uint64_t>(cell, val);
+  case T_V2F32:
+    if(!cell->Read(f32val[0], f32val[1]))
+      return false;
+    StringPrint(f32val[0], f32val[1], val);
+    return true;
+  case T_V2F64:
+    if(!cell->Read(f64val[0], f64val[1]))
+      return false;
+    StringPrint(f64val[0], f64val[1], val);
+    return true;
+  case T_V3F32:
+    if(!cell->Read(f32val[0], f32val[1], f32val[2]))
+      return false;
+    StringPrint(f32val[0], f32val[1], f32val[2], val);
+    return true;
+  case T_V3F64:
+    if(!cell->Read(f64val[0], f64val[1], f64val[2]))
+      return false;
+    StringPrint(f64val[0], f64val[1], f64val[2], val);
+    return true;
+  }
+
+  //Error
+  return false;
+}
+
 uint8_t HCParameter::TypeCode(void)
 {
   return HCParameter::T_CALL;
@@ -516,6 +652,18 @@ void HCParameter::DefaultVal(double& val0, double& val1, double& val2)
 }
 
 int HCParameter::HandleGetPIDError(HCCell* icell, HCCell* ocell)
+{
+  //Delegate to generic get error handler
+  return HandleGetError(icell, ocell, ERR_PID);
+}
+
+int HCParameter::HandleSetPIDError(HCCell* icell, HCCell* ocell)
+{
+  //Delegate to generic set error handler
+  return HandleSetError(icell, ocell, ERR_PID);
+}
+
+int HCParameter::HandleGetError(HCCell* icell, HCCell* ocell, int err)
 {
   int8_t i8val;
 
@@ -531,14 +679,14 @@ int HCParameter::HandleGetPIDError(HCCell* icell, HCCell* ocell)
   if(!ocell->Write(i8val))
     return false;
 
-  //Write PID error code to outbound cell and check for error
-  if(!ocell->Write((int8_t)ERR_PID))
+  //Write error code to outbound cell and check for error
+  if(!ocell->Write((int8_t)err))
     return false;
 
   return true;
 }
 
-int HCParameter::HandleSetPIDError(HCCell* icell, HCCell* ocell)
+int HCParameter::HandleSetError(HCCell* icell, HCCell* ocell, int err)
 {
   uint8_t type;
 
@@ -557,8 +705,8 @@ int HCParameter::HandleSetPIDError(HCCell* icell, HCCell* ocell)
   if(!SkipValue(icell, type))
     return false;
 
-  //Write PID error code to outbound cell and check for error
-  if(!ocell->Write((int8_t)ERR_PID))
+  //Write error code to outbound cell and check for error
+  if(!ocell->Write((int8_t)err))
     return false;
 
   return true;
@@ -596,12 +744,32 @@ bool HCParameter::GetNextCharInName(const string& name, char& nextchar)
 
 HCParameter* HCParameter::GetNext(void)
 {
-  return _next;
+  return __atomic_load_n(&_next, __ATOMIC_ACQUIRE);
 }
 
 void HCParameter::SetNext(HCParameter* next)
 {
-  _next = next;
+  //Publish fully built parameter to tree walkers
+  __atomic_store_n(&_next, next, __ATOMIC_RELEASE);
+}
+
+bool HCParameter::GetProxy(HCClient*& cli, uint32_t& pid)
+{
+  //Check for parameter not bound to a downstream server
+  if(_proxycli == 0)
+    return false;
+
+  //Return downstream client and PID
+  cli = _proxycli;
+  pid = _proxypid;
+  return true;
+}
+
+void HCParameter::SetProxy(HCClient* cli, uint32_t pid)
+{
+  //Bind parameter to downstream client and PID
+  _proxycli = cli;
+  _proxypid = pid;
 }
 
 void HCParameter::PrintNotReadable(void)
@@ -663,7 +831,7 @@ void HCParameter::PrintInfo(ostream& st)
   st << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET;
 }
 
-void HCParameter::SaveInfo(ofstream&, uint32_t, uint16_t)
+void HCParameter::SaveInfo(ofstream&, uint32_t, uint32_t)
 {
   cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
 }
@@ -1104,6 +1272,114 @@ int HCParameter::SetFltTbl(uint32_t eid, const double val)
   return ERR_TYPE;
 }
 
+int HCParameter::GetVec(float& val0, float& val1)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::GetVec(double& val0, double& val1)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::SetVec(const float val0, const float val1)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::SetVec(const double val0, const double val1)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::GetVecTbl(uint32_t eid, float& val0, float& val1)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::GetVecTbl(uint32_t eid, double& val0, double& val1)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::SetVecTbl(uint32_t eid, const float val0, const float val1)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::SetVecTbl(uint32_t eid, const double val0, const double val1)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::GetVec(float& val0, float& val1, float& val2)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::GetVec(double& val0, double& val1, double& val2)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::SetVec(const float val0, const float val1, const float val2)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::SetVec(const double val0, const double val1, const double val2)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::GetVecTbl(uint32_t eid, float& val0, float& val1, float& val2)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::GetVecTbl(uint32_t eid, double& val0, double& val1, double& val2)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::SetVecTbl(uint32_t eid, const float val0, const float val1, const float val2)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::SetVecTbl(uint32_t eid, const double val0, const double val1, const double val2)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::Read(uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
+int HCParameter::Write(uint32_t offset, uint8_t* val, uint16_t len)
+{
+  cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
+  return ERR_TYPE;
+}
+
 int HCParameter::Upload(const string&)
 {
   cout << TC_RED << _name << " does not override method '" << __PRETTY_FUNCTION__ << "'" << TC_RESET << "\n";
@@ -33,6 +33,8 @@
 #include <inttypes.h>
 #include <iostream>
 
+class HCClient;
+
 class HCParameter : public HCNode
 {
 public:
@@ -66,6 +68,7 @@ public:
 
 public:
   static bool SkipValue(HCCell* cell, uint8_t type);
+  static bool ValueString(HCCell* cell, uint8_t type, std::string& val);
   static uint8_t TypeCode(void);
   static const std::string TypeString(void);
   static uint8_t TypeCode(const bool& type);
@@ -150,6 +153,8 @@ public:
   static void DefaultVal(double& val0, double& val1, double& val2);
   static int HandleGetPIDError(HCCell* icell, HCCell* ocell);
   static int HandleSetPIDError(HCCell* icell, HCCell* ocell);
+  static int HandleGetError(HCCell* icell, HCCell* ocell, int err);
+  static int HandleSetError(HCCell* icell, HCCell* ocell, int err);
 
 public:
   HCParameter(const std::string& name);
@@ -157,6 +162,8 @@ public:
   bool GetNextCharInName(const std::string& name, char& nextchar);
   HCParameter* GetNext(void);
   void SetNext(HCParameter* node);
+  bool GetProxy(HCClient*& cli, uint32_t& pid);
+  void SetProxy(HCClient* cli, uint32_t pid);
   void PrintNotReadable(void);
   virtual uint8_t GetType(void);
   virtual bool IsReadable(void);
@@ -168,7 +175,7 @@ public:
   virtual void PrintVal(void);
   virtual void PrintConfig(const std::string& path, std::ostream& st=std::cout);
   virtual void PrintInfo(std::ostream& st=std::cout);
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid);
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid);
   virtual int Call(void);
   virtual int CallTbl(uint32_t eid);
   virtual int GetBool(bool& val);
@@ -241,6 +248,24 @@ public:
   virtual int GetFltTbl(uint32_t eid, double& val);
   virtual int SetFltTbl(uint32_t eid, const float val);
   virtual int SetFltTbl(uint32_t eid, const double val);
+  virtual int GetVec(float& val0, float& val1);
+  virtual int GetVec(double& val0, double& val1);
+  virtual int SetVec(const float val0, const float val1);
+  virtual int SetVec(const double val0, const double val1);
+  virtual int GetVecTbl(uint32_t eid, float& val0, float& val1);
+  virtual int GetVecTbl(uint32_t eid, double& val0, double& val1);
+  virtual int SetVecTbl(uint32_t eid, const float val0, const float val1);
+  virtual int SetVecTbl(uint32_t eid, const double val0, const double val1);
+  virtual int GetVec(float& val0, float& val1, float& val2);
+  virtual int GetVec(double& val0, double& val1, double& val2);
+  virtual int SetVec(const float val0, const float val1, const float val2);
+  virtual int SetVec(const double val0, const double val1, const double val2);
+  virtual int GetVecTbl(uint32_t eid, float& val0, float& val1, float& val2);
+  virtual int GetVecTbl(uint32_t eid, double& val0, double& val1, double& val2);
+  virtual int SetVecTbl(uint32_t eid, const float val0, const float val1, const float val2);
+  virtual int SetVecTbl(uint32_t eid, const double val0, const double val1, const double val2);
+  virtual int Read(uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len);
+  virtual int Write(uint32_t offset, uint8_t* val, uint16_t len);
   virtual int Upload(const std::string& val);
   virtual int Download(const std::string& val);
   virtual bool CallCell(HCCell* icell, HCCell* ocell);
@@ -261,6 +286,8 @@ public:
 
 private:
   HCParameter* _next;
+  HCClient* _proxycli;
+  uint32_t _proxypid;
 };
 
 struct HCEIDEnum
@@ -44,6 +44,7 @@ HCQServer::HCQServer(Device* lowdev, HCContainer* top)
   //Initialize member variables
   _lowdev = lowdev;
   _top = top;
+  _fanout = new HCFanOut(top);
   _readcount = 0;
   memset(_readbuf, 0, sizeof(_readbuf));
   _readind = 0;
@@ -59,6 +60,13 @@ HCQServer::~HCQServer()
 {
   //Cleanup
   delete _ctlthread;
+  delete _fanout;
+}
+
+void HCQServer::SetExecutor(Executor* exec)
+{
+  //Run wildcard get batches on executor
+  _fanout->SetExecutor(exec);
 }
 
 bool HCQServer::NextReadCharEquals(char ch)
@@ -704,6 +712,54 @@ bool HCQServer::ProcessSubCell(void)
   return true;
 }
 
+bool HCQServer::ProcessQGetCell(void)
+{
+  char pname[100];
+  uint32_t count;
+  uint32_t i;
+  string pval;
+  int err;
+
+  //Check for next character not name expression opening quote
+  if(!NextReadCharEquals('"'))
+    return false;
+
+  //Read name expression
+  if(!ReadField('"', pname, sizeof(pname)))
+    return false;
+
+  //Write name expression to outbound message
+  if(!WriteStringQuote(pname) || !WriteString(",["))
+    return false;
+
+  //Check for next character not cell closing bracket
+  if(!NextReadCharEquals(']'))
+    return false;
+
+  //Get all matching parameters (downstream servers queried in parallel)
+  count = _fanout->Get(pname);
+
+  //Write path, value string and error of each match to outbound message
+  for(i=0; i<count; i++)
+  {
+    //Get value string (formatted from raw value)
+    err = _fanout->GetStr(i, pval);
+
+    //Write to outbound message
+    if(((i > 0) && !WriteChar(',')) || !WriteChar('[') || !WriteStringQuote(_fanout->GetPath(i).c_str()) || !WriteChar(','))
+      return false;
+    if(!WriteStringQuote(pval.c_str()) || !WriteChar(',') || !WriteStringQuote(ErrToString(err).c_str()) || !WriteChar(']'))
+      return false;
+  }
+
+  //Write to outbound message
+  if(!WriteString("]]"))
+    return false;
+
+  //Success
+  return true;
+}
+
 bool HCQServer::ProcessSaveCell(void)
 {
   ofstream file;
@@ -780,6 +836,8 @@ bool HCQServer::ProcessCell(void)
     return ProcessAddCell();
   else if(strcmp(opcode, "su") == 0)
     return ProcessSubCell();
+  else if(strcmp(opcode, "qg") == 0)
+    return ProcessQGetCell();
 
   //Unrecognized opcode
   return false;
@@ -860,14 +918,16 @@ bool HCQServer::ProcessMessage(void)
 
 void HCQServer::CtlThread(void)
 {
+  uint64_t peer;
+
   //Go forever
   while(true)
   {
-    //Read inbound message from device (leave room for null terminator)
-    if((_readcount = _lowdev->Read(_readbuf, sizeof(_readbuf)-1)) == 0)
+    //Read inbound message and its source peer from device (leave room for null terminator)
+    if((_readcount = _lowdev->ReadFrom(_readbuf, sizeof(_readbuf)-1, peer)) == 0)
     {
-      //Sleep a while to prevent starving other threads
-      ThreadSleep(1000);
+      //Block until device is readable again (at most a while) rather than spin and starve other threads
+      _lowdev->WaitReadable(1000);
 
       //Ignore rest of loop
       continue;
@@ -887,7 +947,7 @@ void HCQServer::CtlThread(void)
       continue;
     }
 
-    //Write outbound message to device
-    _lowdev->Write(_writebuf, _writeind);
+    //Write outbound message back to source peer
+    _lowdev->WriteTo(_writebuf, _writeind, peer);
   }
 }
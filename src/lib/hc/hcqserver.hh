@@ -28,6 +28,7 @@
 
 #include "device.hh"
 #include "hccontainer.hh"
+#include "hcfanout.hh"
 #include "thread.hh"
 
 class HCQServer
@@ -35,6 +36,7 @@ class HCQServer
 public:
   HCQServer(Device* lowdev, HCContainer* top);
   ~HCQServer();
+  void SetExecutor(Executor* exec);
 
 private:
   bool NextReadCharEquals(char ch);
@@ -50,6 +52,7 @@ private:
   bool ProcessISetCell(void);
   bool ProcessAddCell(void);
   bool ProcessSubCell(void);
+  bool ProcessQGetCell(void);
   bool ProcessSaveCell(void);
   bool ProcessCell(void);
   bool ProcessMessage(void);
@@ -58,6 +61,7 @@ private:
 private:
   Device* _lowdev;
   HCContainer* _top;
+  HCFanOut* _fanout;
   uint32_t _readcount;
   char _readbuf[65536];
   uint32_t _readind;
@@ -0,0 +1,285 @@
+// HC replica
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "error.hh"
+#include "hcclient.hh"
+#include "hcreplica.hh"
+#include <cassert>
+
+HCReplica::HCReplica(HCClient* cli, Device* dev, uint32_t index)
+{
+  //Assert valid arguments
+  assert((cli != 0) && (dev != 0));
+
+  //Initialize member variables
+  _cli = cli;
+  _dev = dev;
+  _index = index;
+  _imsg = new HCMessage();
+  _mutex = new Mutex();
+  _enabled = true;
+  _verified = false;
+  _up = true;
+  _srtt = 0;
+  _rttvar = 0;
+  _backoff = 0;
+  _failtime = 0;
+  _failcount = 0;
+
+  //Create read thread (started by client once replica is registered)
+  _readthread = new Thread<HCReplica>(this, &HCReplica::ReadThread);
+}
+
+HCReplica::~HCReplica()
+{
+  //Cleanup
+  delete _readthread;
+  delete _mutex;
+  delete _imsg;
+}
+
+Device* HCReplica::GetDevice(void)
+{
+  return _dev;
+}
+
+uint32_t HCReplica::GetIndex(void)
+{
+  return _index;
+}
+
+void HCReplica::Start(void)
+{
+  //Start receiving replies from server
+  _readthread->Start();
+}
+
+bool HCReplica::IsEnabled(void)
+{
+  return _enabled;
+}
+
+void HCReplica::Disable(void)
+{
+  //Never use replica again
+  _enabled = false;
+}
+
+bool HCReplica::IsVerified(void)
+{
+  return _verified;
+}
+
+void HCReplica::Verify(void)
+{
+  //Indicate replica serves the expected server information file
+  _verified = true;
+}
+
+bool HCReplica::IsAvailable(uint64_t now, uint32_t holdoff)
+{
+  bool available;
+
+  //Check for disabled
+  if(!_enabled)
+    return false;
+
+  //Failed replicas become available again for probing once holdoff (ms) expires
+  _mutex->Wait();
+  available = _up || ((now - _failtime) >= ((uint64_t)holdoff * 1000));
+  _mutex->Give();
+
+  return available;
+}
+
+void HCReplica::Success(void)
+{
+  //Indicate up
+  _mutex->Wait();
+  _up = true;
+  _mutex->Give();
+}
+
+void HCReplica::Failure(uint64_t now)
+{
+  //Indicate down until holdoff expires and remember when
+  _mutex->Wait();
+  _up = false;
+  _failtime = now;
+  _failcount++;
+  _mutex->Give();
+}
+
+void HCReplica::Sample(uint64_t rtt)
+{
+  uint32_t err;
+
+  //Clamp sample to something the estimators can hold
+  if(rtt == 0)
+    rtt = 1;
+  else if(rtt > 0x7FFFFFFF)
+    rtt = 0x7FFFFFFF;
+
+  //Begin mutual exclusion (reader threads, sweeper and callers all sample)
+  _mutex->Wait();
+
+  //Reply to a single send is a valid sample so stop backing off
+  _backoff = 0;
+
+  //Check for first sample
+  if(_srtt == 0)
+  {
+    //Seed smoothed round trip time and variation
+    _srtt = (uint32_t)rtt;
+    _rttvar = (uint32_t)rtt / 2;
+    _mutex->Give();
+    return;
+  }
+
+  //Update round trip time variation with distance of sample from smoothed round trip time
+  err = (rtt > _srtt) ? (uint32_t)rtt - _srtt : _srtt - (uint32_t)rtt;
+  if(err > _rttvar)
+    _rttvar += (err - _rttvar) >> RTTVAR_SHIFT;
+  else
+    _rttvar -= (_rttvar - err) >> RTTVAR_SHIFT;
+
+  //Update smoothed round trip time
+  if(rtt > _srtt)
+    _srtt += (uint32_t)((rtt - _srtt) >> SRTT_SHIFT);
+  else
+    _srtt -= (uint32_t)((_srtt - rtt) >> SRTT_SHIFT);
+
+  //End mutual exclusion
+  _mutex->Give();
+}
+
+void HCReplica::Backoff(void)
+{
+  //Double retransmission timeout until a send is answered without being sent again
+  _mutex->Wait();
+  if(_backoff < BACKOFF_MAX)
+    _backoff++;
+  _mutex->Give();
+}
+
+uint64_t HCReplica::GetTimeout(uint64_t initial)
+{
+  uint64_t rto;
+
+  //Calculate timeout from consistent estimator state
+  _mutex->Wait();
+  rto = CalcTimeout(initial);
+  _mutex->Give();
+
+  return rto;
+}
+
+int HCReplica::GetUp(bool& val)
+{
+  //Get the value
+  _mutex->Wait();
+  val = _up;
+  _mutex->Give();
+
+  return ERR_NONE;
+}
+
+int HCReplica::GetSRTT(uint32_t& val)
+{
+  //Get the value
+  _mutex->Wait();
+  val = _srtt;
+  _mutex->Give();
+
+  return ERR_NONE;
+}
+
+int HCReplica::GetRTTVar(uint32_t& val)
+{
+  //Get the value
+  _mutex->Wait();
+  val = _rttvar;
+  _mutex->Give();
+
+  return ERR_NONE;
+}
+
+int HCReplica::GetRTO(uint32_t& val)
+{
+  uint64_t rto;
+
+  //Get the value (zero until there are samples)
+  _mutex->Wait();
+  rto = (_srtt == 0) ? 0 : CalcTimeout(0);
+  _mutex->Give();
+  val = (rto > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)rto;
+
+  return ERR_NONE;
+}
+
+int HCReplica::GetFailCount(uint32_t& val)
+{
+  //Get the value
+  _mutex->Wait();
+  val = _failcount;
+  _mutex->Give();
+
+  return ERR_NONE;
+}
+
+uint64_t HCReplica::CalcTimeout(uint64_t initial)
+{
+  uint64_t rto;
+
+  //Use initial timeout until there are samples, otherwise smoothed round trip time plus four variations
+  if(_srtt == 0)
+  {
+    rto = initial;
+  }
+  else
+  {
+    rto = (uint64_t)_srtt + ((uint64_t)_rttvar << 2);
+    if(rto < RTO_MIN)
+      rto = RTO_MIN;
+  }
+
+  return rto << _backoff;
+}
+
+void HCReplica::ReadThread(void)
+{
+  int ierr;
+
+  //Go forever
+  while(true)
+  {
+    //Receive inbound message
+    ierr = _imsg->Recv(_dev);
+
+    //Hand message to client
+    _cli->Receive(this, _imsg, ierr);
+  }
+}
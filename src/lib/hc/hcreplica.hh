@@ -0,0 +1,88 @@
+// HC replica
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "device.hh"
+#include "hcmessage.hh"
+#include "mutex.hh"
+#include "thread.hh"
+#include <inttypes.h>
+
+class HCClient;
+
+class HCReplica
+{
+public:
+  //Smoothed round trip time and variation gain shifts (new samples weighted 1/8 and 1/4), minimum
+  //retransmission timeout (us) and most times the timeout is doubled after unanswered sends
+  static const uint32_t SRTT_SHIFT = 3;
+  static const uint32_t RTTVAR_SHIFT = 2;
+  static const uint32_t RTO_MIN = 10000;
+  static const uint32_t BACKOFF_MAX = 6;
+
+public:
+  HCReplica(HCClient* cli, Device* dev, uint32_t index);
+  ~HCReplica();
+  Device* GetDevice(void);
+  uint32_t GetIndex(void);
+  void Start(void);
+  bool IsEnabled(void);
+  void Disable(void);
+  bool IsVerified(void);
+  void Verify(void);
+  bool IsAvailable(uint64_t now, uint32_t holdoff);
+  void Success(void);
+  void Failure(uint64_t now);
+  void Sample(uint64_t rtt);
+  void Backoff(void);
+  uint64_t GetTimeout(uint64_t initial);
+  int GetUp(bool& val);
+  int GetSRTT(uint32_t& val);
+  int GetRTTVar(uint32_t& val);
+  int GetRTO(uint32_t& val);
+  int GetFailCount(uint32_t& val);
+
+private:
+  uint64_t CalcTimeout(uint64_t initial);
+  void ReadThread(void);
+
+private:
+  HCClient* _cli;
+  Device* _dev;
+  uint32_t _index;
+  HCMessage* _imsg;
+  Mutex* _mutex;
+  bool _enabled;
+  bool _verified;
+  bool _up;
+  uint32_t _srtt;
+  uint32_t _rttvar;
+  uint32_t _backoff;
+  uint64_t _failtime;
+  uint32_t _failcount;
+  Thread<HCReplica>* _readthread;
+};
@@ -0,0 +1,180 @@
+// HC reply cache
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "hcreplycache.hh"
+#include "crc.hh"
+#include <cassert>
+#include <cstring>
+
+using namespace std;
+
+HCReplyCache::HCReplyCache(uint32_t count, uint32_t size)
+{
+  uint32_t buckets;
+
+  //Assert valid arguments
+  assert((count > 0) && (size > 0));
+
+  //Initialize member variables
+  _count = count;
+  _size = size;
+  _entries = new Entry[count];
+  _replies = new uint8_t[count * size];
+
+  //Create hash buckets (power of two at least twice the entry count keeps chains short)
+  for(buckets=1; buckets < (count * 2); buckets <<= 1);
+  _mask = buckets - 1;
+  _buckets = new uint32_t[buckets];
+
+  //Start empty
+  Clear();
+}
+
+HCReplyCache::~HCReplyCache()
+{
+  //Cleanup
+  delete[] _buckets;
+  delete[] _replies;
+  delete[] _entries;
+}
+
+uint32_t HCReplyCache::Lookup(uint64_t peer, uint32_t transaction, const uint8_t* req, uint32_t reqlen, uint64_t now, uint64_t maxage, uint8_t* reply, uint32_t maxlen)
+{
+  uint32_t seq;
+  uint32_t index;
+  Entry* entry;
+
+  //Assert valid arguments
+  assert((req != 0) && (reply != 0));
+
+  //Forget everything once too many peers have been seen (bounds memory, remembered replies no longer checkable)
+  if((_peerseqs.size() >= PEER_MAX) && (_peerseqs.find(peer) == _peerseqs.end()))
+    Clear();
+
+  //Count request from peer
+  seq = ++_peerseqs[peer];
+
+  //Find newest reply to same transaction from peer
+  for(index=_buckets[Bucket(peer, transaction)]; index != NONE; index=_entries[index].next)
+  {
+    entry = &_entries[index];
+    if((entry->peer == peer) && (entry->transaction == transaction))
+      break;
+  }
+
+  //Check for none
+  if(index == NONE)
+    return 0;
+
+  //Check for reply too old, transaction number since come round again or request not the same
+  if(((now - entry->time) > maxage) || ((seq - entry->seq) > WINDOW) || (entry->reqlen != reqlen) || (entry->replen > maxlen) || (entry->crc != CRC32(0, req, reqlen)))
+    return 0;
+
+  //Copy out reply
+  memcpy(reply, &_replies[index * _size], entry->replen);
+
+  return entry->replen;
+}
+
+void HCReplyCache::Store(uint64_t peer, uint32_t transaction, const uint8_t* req, uint32_t reqlen, uint64_t now, const uint8_t* reply, uint32_t replen)
+{
+  map<uint64_t, uint32_t>::iterator it;
+  uint32_t bucket;
+  uint32_t index;
+  Entry* entry;
+
+  //Assert valid arguments
+  assert((req != 0) && (reply != 0));
+
+  //Check for reply too big to remember or peer not looked up first
+  if((replen > _size) || ((it = _peerseqs.find(peer)) == _peerseqs.end()))
+    return;
+
+  //Take oldest entry
+  index = _oldest;
+  _oldest = (_oldest + 1) % _count;
+  entry = &_entries[index];
+  if(entry->used)
+    Unlink(index);
+
+  //Fill in entry and remember reply
+  entry->peer = peer;
+  entry->time = now;
+  entry->transaction = transaction;
+  entry->seq = it->second;
+  entry->crc = CRC32(0, req, reqlen);
+  entry->reqlen = reqlen;
+  entry->replen = replen;
+  entry->used = true;
+  memcpy(&_replies[index * _size], reply, replen);
+
+  //Put at head of bucket chain so it is found before any older reply to same transaction
+  bucket = Bucket(peer, transaction);
+  entry->next = _buckets[bucket];
+  _buckets[bucket] = index;
+}
+
+void HCReplyCache::Clear(void)
+{
+  uint32_t i;
+
+  //Forget all replies and peers
+  for(i=0; i<_count; i++)
+    _entries[i].used = false;
+
+  for(i=0; i<=_mask; i++)
+    _buckets[i] = NONE;
+
+  _oldest = 0;
+  _peerseqs.clear();
+}
+
+uint32_t HCReplyCache::Bucket(uint64_t peer, uint32_t transaction)
+{
+  uint64_t hash;
+
+  //Mix peer and transaction (Fibonacci hashing)
+  hash = (peer ^ ((uint64_t)transaction << 32) ^ transaction) * 0x9E3779B97F4A7C15ULL;
+
+  return (uint32_t)(hash >> 32) & _mask;
+}
+
+void HCReplyCache::Unlink(uint32_t index)
+{
+  uint32_t* link;
+
+  //Find link to entry in its bucket chain and skip over entry
+  for(link=&_buckets[Bucket(_entries[index].peer, _entries[index].transaction)]; *link != NONE; link=&_entries[*link].next)
+  {
+    if(*link == index)
+    {
+      *link = _entries[index].next;
+      break;
+    }
+  }
+
+  _entries[index].used = false;
+}
@@ -0,0 +1,85 @@
+// HC reply cache
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "hcmessage.hh"
+#include <inttypes.h>
+#include <map>
+
+//Replies to requests that change server state, remembered per peer and transaction so a request
+//sent again after its reply was lost gets the same reply without being carried out twice
+class HCReplyCache
+{
+public:
+  //Default number of replies remembered and size (bytes) of each
+  static const uint32_t COUNT_DEFAULT = 128;
+  static const uint32_t SIZE_DEFAULT = HCMessage::OVERHEAD + HCMessage::PAYLOAD_MAX;
+
+  //Requests a peer may send before its transaction numbers can come round again (clients never
+  //reuse a number sooner), and most peers tracked before forgetting them all
+  static const uint32_t WINDOW = 63;
+  static const uint32_t PEER_MAX = 4096;
+
+public:
+  HCReplyCache(uint32_t count=COUNT_DEFAULT, uint32_t size=SIZE_DEFAULT);
+  ~HCReplyCache();
+  uint32_t Lookup(uint64_t peer, uint32_t transaction, const uint8_t* req, uint32_t reqlen, uint64_t now, uint64_t maxage, uint8_t* reply, uint32_t maxlen);
+  void Store(uint64_t peer, uint32_t transaction, const uint8_t* req, uint32_t reqlen, uint64_t now, const uint8_t* reply, uint32_t replen);
+  void Clear(void);
+
+private:
+  //Remembered reply (chained with others in same hash bucket)
+  struct Entry
+  {
+    uint64_t peer;
+    uint64_t time;
+    uint32_t transaction;
+    uint32_t seq;
+    uint32_t crc;
+    uint32_t reqlen;
+    uint32_t replen;
+    uint32_t next;
+    bool used;
+  };
+
+  //End of bucket chain
+  static const uint32_t NONE = 0xFFFFFFFF;
+
+private:
+  uint32_t Bucket(uint64_t peer, uint32_t transaction);
+  void Unlink(uint32_t index);
+
+private:
+  uint32_t _count;
+  uint32_t _size;
+  Entry* _entries;
+  uint8_t* _replies;
+  uint32_t _mask;
+  uint32_t* _buckets;
+  uint32_t _oldest;
+  std::map<uint64_t, uint32_t> _peerseqs;
+};
@@ -28,6 +28,7 @@
 #include "error.hh"
 #include "hcboolean.hh"
 #include "hccall.hh"
+#include "hcclient.hh"
 #include "hcfile.hh"
 #include "hcinteger.hh"
 #include "hcserver.hh"
@@ -46,18 +47,17 @@ static const HCBooleanEnum Offon[] =
   HCBooleanEnum()
 };
 
-HCServer::HCServer(Device* lowdev, HCContainer* top, const string& name, const string& version, uint32_t pidmax)
+HCServer::HCServer(Device* lowdev, HCContainer* top, const string& name, const string& version, uint32_t pidmax, int core)
 {
   HCContainer* cont;
   uint32_t i;
   HCParameter* param;
 
   //Assert valid arguments
-  assert((lowdev != 0) && (top != 0) && (pidmax <= HCServer::PID_MAX));
+  assert((lowdev != 0) && (top != 0) && (pidmax > 0));
 
-  //Initialize low device and top container
-  _lowdev = lowdev;
-  _top = top;
+  //Primary server owns the parameter table
+  _primary = this;
 
   //Copy name, version and information file name
   _name = name;
@@ -70,32 +70,19 @@ HCServer::HCServer(Device* lowdev, HCContainer* top, const string& name, const s
   _pidtop = 0;
   _pidmax = pidmax;
 
-  //Allocate memory for the parameter array
-  _params = new HCParameter*[_pidmax];
+  //Allocate chunk table for the parameter array (chunks themselves allocated on demand)
+  _chunkcount = (_pidmax >> PID_CHUNK_SHIFT) + (((_pidmax & (PID_CHUNK_SIZE - 1)) != 0) ? 1 : 0);
+  _chunks = new HCParameter**[_chunkcount];
 
-  //Zero out parameter array
-  for(i=0; i<_pidmax; i++)
-    _params[i] = 0;
+  //Zero out chunk table
+  for(i=0; i<_chunkcount; i++)
+    _chunks[i] = 0;
 
-  //Clear started flag
-  _started = false;
+  //Create information file mutex
+  _infomutex = new Mutex();
 
-  //Create inbound and outbound message and cell storage
-  _imsg = new HCMessage();
-  _icell = new HCCell();
-  _omsg = new HCMessage();
-  _ocell = new HCCell();
-
-  //Initialize debug flag and counts
-  _debug = false;
-  _senderrcount = 0;
-  _recverrcount = 0;
-  _deserrcount = 0;
-  _cellerrcount = 0;
-  _opcodeerrcount = 0;
-  _piderrcount = 0;
-  _interrcount = 0;
-  _goodxactcount = 0;
+  //Initialize per device state
+  Init(lowdev, top, core);
 
   //Create server container and add to top container
   cont = new HCContainer(".server");
@@ -125,23 +112,129 @@ HCServer::HCServer(Device* lowdev, HCContainer* top, const string& name, const s
   cont->Add(new HCUns32<HCServer>("piderrcount", this, &HCServer::GetPIDErrCount, 0));
   cont->Add(new HCUns32<HCServer>("interrcount", this, &HCServer::GetIntErrCount, 0));
   cont->Add(new HCUns32<HCServer>("goodxactcount", this, &HCServer::GetGoodXactCount, 0));
+  cont->Add(new HCUns32<HCServer>("fwdxactcount", this, &HCServer::GetFwdXactCount, 0));
+  cont->Add(new HCUns32<HCServer>("fwderrcount", this, &HCServer::GetFwdErrCount, 0));
+  cont->Add(new HCUns32<HCServer>("rcvbufsize", this, &HCServer::GetRecvBufSize, &HCServer::SetRecvBufSize));
+  cont->Add(new HCUns32<HCServer>("sndbufsize", this, &HCServer::GetSendBufSize, &HCServer::SetSendBufSize));
+  cont->Add(new HCUns32<HCServer>("kerneldropcount", this, &HCServer::GetKernelDropCount, 0));
+  cont->Add(new HCUns32<HCServer>("shardcount", this, &HCServer::GetShardCount, 0));
+  cont->Add(new HCUns32<HCServer>("cachehitcount", this, &HCServer::GetCacheHitCount, 0));
+  cont->Add(new HCUns32<HCServer>("cacheage", this, &HCServer::GetCacheAge, &HCServer::SetCacheAge));
+}
+
+HCServer::HCServer(Device* lowdev, HCServer* primary, int core)
+{
+  //Assert valid arguments
+  assert((lowdev != 0) && (primary != 0));
+
+  //Shard uses the primary server's parameter table
+  _primary = primary;
+
+  //Copy name, version and information file name
+  _name = primary->_name;
+  _version = primary->_version;
+  _infofilename = primary->_infofilename;
+
+  //Indicate no parameter table of its own
+  _pidtop = 0;
+  _pidmax = primary->_pidmax;
+  _chunkcount = 0;
+  _chunks = 0;
+
+  //Share primary server's information file mutex
+  _infomutex = primary->_infomutex;
+
+  //Initialize per device state
+  Init(lowdev, primary->_top, core);
+}
+
+void HCServer::Init(Device* lowdev, HCContainer* top, int core)
+{
+  //Initialize low device and top container
+  _lowdev = lowdev;
+  _top = top;
+
+  //Initialize shard list
+  _shardcount = 0;
+
+  //Clear started flag
+  _started = false;
+
+  //Create inbound and outbound message and cell storage
+  _imsg = new HCMessage();
+  _icell = new HCCell();
+  _omsg = new HCMessage();
+  _ocell = new HCCell();
+  _qcell = new HCCell();
+  _rcell = new HCCell();
+
+  //Create fan-out query engine for wildcard gets (batches run in threads of their own until an executor is set)
+  _fanout = new HCFanOut(top);
+  _qpeer = 0;
+  _qtime = 0;
+  _qcount = 0;
+  _exec = 0;
+
+  //Create reply cache for requests sent again (age set on primary applies to all shards)
+  _cache = new HCReplyCache(HCReplyCache::COUNT_DEFAULT, MSG_SIZE);
+  _mutating = false;
+  _cacheage = CACHE_AGE_DEFAULT;
+
+  //Create batch receive and transmit buffers
+  _rxbufs = new uint8_t[BATCH_MAX * MSG_SIZE];
+  _txbufs = new uint8_t[BATCH_MAX * MSG_SIZE];
+  _peer = 0;
+
+  //Initialize debug flag and counts
+  _debug = false;
+  _senderrcount = 0;
+  _recverrcount = 0;
+  _deserrcount = 0;
+  _cellerrcount = 0;
+  _opcodeerrcount = 0;
+  _piderrcount = 0;
+  _interrcount = 0;
+  _goodxactcount = 0;
+  _fwdxactcount = 0;
+  _fwderrcount = 0;
+  _cachehitcount = 0;
 
   //Create control thread
-  _ctlthread = new Thread<HCServer>(this, &HCServer::CtlThread);
+  _ctlthread = new Thread<HCServer>(this, &HCServer::CtlThread, core);
 }
 
 HCServer::~HCServer()
 {
+  uint32_t i;
+
+  //Delete shards
+  for(i=0; i<_shardcount; i++)
+    delete _shards[i];
+
   //Cleanup
   delete _ctlthread;
   delete _imsg;
   delete _icell;
   delete _omsg;
   delete _ocell;
-  delete[] _params;
+  delete _qcell;
+  delete _rcell;
+  delete _fanout;
+  delete _cache;
+  delete[] _rxbufs;
+  delete[] _txbufs;
+
+  //Information file mutex is owned by primary server
+  if(_primary == this)
+    delete _infomutex;
+
+  for(i=0; i<_chunkcount; i++)
+    delete[] _chunks[i];
+
+  delete[] _chunks;
 }
 
-HCParameter* HCServer::GetParam(uint16_t pid)
+HCParameter* HCServer::GetParam(uint32_t pid)
 {
   //Check for parameter id out of bounds
   if(pid >= _pidmax)
@@ -151,7 +244,7 @@ HCParameter* HCServer::GetParam(uint16_t pid)
   }
 
   //Return parameter
-  return _params[pid];
+  return FindParam(pid);
 }
 
 void HCServer::Add(HCParameter* param)
@@ -171,11 +264,50 @@ void HCServer::Add(HCParameter* param)
     return;
 
   //Add parameter to parameter array
-  _params[_pidtop++] = param;
+  StoreParam(param);
+}
+
+int HCServer::AddShard(Device* lowdev, int core)
+{
+  HCServer* shard;
+
+  //Assert valid arguments
+  assert(lowdev != 0);
+
+  //Check for shard of a shard or shard list full
+  if((_primary != this) || (_shardcount >= SHARD_MAX))
+    return ERR_RANGE;
+
+  //Create shard sharing this server's parameter table
+  shard = new HCServer(lowdev, this, core);
+  shard->_fanout->SetExecutor(_exec);
+  _shards[_shardcount++] = shard;
+
+  //Start shard now if server is already running
+  if(_started)
+  {
+    shard->_started = true;
+    shard->_ctlthread->Start();
+  }
+
+  return ERR_NONE;
+}
+
+void HCServer::SetExecutor(Executor* exec)
+{
+  uint32_t i;
+
+  //Run wildcard get batches on executor in this server and all its shards
+  _exec = exec;
+  _fanout->SetExecutor(exec);
+  for(i=0; i<_shardcount; i++)
+    _shards[i]->_fanout->SetExecutor(exec);
 }
 
 void HCServer::Start(void)
 {
+  uint32_t i;
+
   //Save to XML file
   SaveInfo();
 
@@ -184,6 +316,35 @@ void HCServer::Start(void)
 
   //Start the control thread
   _ctlthread->Start();
+
+  //Start shard control threads
+  for(i=0; i<_shardcount; i++)
+  {
+    _shards[i]->_started = true;
+    _shards[i]->_ctlthread->Start();
+  }
+}
+
+void HCServer::Graft(HCContainer* startcont)
+{
+  //Assert valid arguments
+  assert(startcont != 0);
+
+  //Check for not started (parameters will be picked up by normal add)
+  if(!_started)
+    return;
+
+  //Begin mutual exclusion
+  _infomutex->Wait();
+
+  //Add parameters to the running server
+  GraftParams(startcont);
+
+  //Save to XML file so clients see new parameters
+  SaveInfo();
+
+  //End mutual exclusion
+  _infomutex->Give();
 }
 
 int HCServer::GetName(string& val)
@@ -203,7 +364,9 @@ int HCServer::GetVersion(string& val)
 int HCServer::GetInfoFileCRC(uint32_t& val)
 {
   //Calculate CRC of info file
+  _infomutex->Wait();
   val = CRC32File(_infofilename);
+  _infomutex->Give();
   return ERR_NONE;
 }
 
@@ -211,9 +374,15 @@ int HCServer::ReadInfoFile(uint32_t offset, uint8_t* val, uint16_t maxlen, uint1
 {
   FILE* file;
 
+  //Begin mutual exclusion
+  _infomutex->Wait();
+
   //Open info file and check for error
   if((file = fopen(_infofilename.c_str(), "r")) == NULL)
   {
+    //End mutual exclusion
+    _infomutex->Give();
+
     //Indicate zero bytes read
     len = 0;
     return ERR_ACCESS;
@@ -225,6 +394,9 @@ int HCServer::ReadInfoFile(uint32_t offset, uint8_t* val, uint16_t maxlen, uint1
     //Close file
     fclose(file);
 
+    //End mutual exclusion
+    _infomutex->Give();
+
     //Indicate zero bytes read
     len = 0;
     return ERR_RANGE;
@@ -235,6 +407,9 @@ int HCServer::ReadInfoFile(uint32_t offset, uint8_t* val, uint16_t maxlen, uint1
 
   //Close file
   fclose(file);
+
+  //End mutual exclusion
+  _infomutex->Give();
   return ERR_NONE;
 }
 
@@ -256,74 +431,217 @@ int HCServer::SetDebug(bool val)
 
 int HCServer::GetSendErrCount(uint32_t& val)
 {
-  //Get count value
-  val = _senderrcount;
+  //Get count value summed over shards
+  val = SumCount(&HCServer::_senderrcount);
 
   return ERR_NONE;
 }
 
 int HCServer::GetRecvErrCount(uint32_t& val)
 {
-  //Get count value
-  val = _recverrcount;
+  //Get count value summed over shards
+  val = SumCount(&HCServer::_recverrcount);
 
   return ERR_NONE;
 }
 
 int HCServer::GetDesErrCount(uint32_t& val)
 {
-  //Get count value
-  val = _deserrcount;
+  //Get count value summed over shards
+  val = SumCount(&HCServer::_deserrcount);
 
   return ERR_NONE;
 }
 
 int HCServer::GetCellErrCount(uint32_t& val)
 {
-  //Get count value
-  val = _cellerrcount;
+  //Get count value summed over shards
+  val = SumCount(&HCServer::_cellerrcount);
 
   return ERR_NONE;
 }
 
 int HCServer::GetOpCodeErrCount(uint32_t& val)
 {
-  //Get count value
-  val = _opcodeerrcount;
+  //Get count value summed over shards
+  val = SumCount(&HCServer::_opcodeerrcount);
 
   return ERR_NONE;
 }
 
 int HCServer::GetPIDErrCount(uint32_t& val)
 {
-  //Get count value
-  val = _piderrcount;
+  //Get count value summed over shards
+  val = SumCount(&HCServer::_piderrcount);
 
   return ERR_NONE;
 }
 
 int HCServer::GetIntErrCount(uint32_t& val)
 {
-  //Get count value
-  val = _interrcount;
+  //Get count value summed over shards
+  val = SumCount(&HCServer::_interrcount);
 
   return ERR_NONE;
 }
 
 int HCServer::GetGoodXactCount(uint32_t& val)
 {
-  //Get count value
-  val = _goodxactcount;
+  //Get count value summed over shards
+  val = SumCount(&HCServer::_goodxactcount);
+
+  return ERR_NONE;
+}
+
+int HCServer::GetFwdXactCount(uint32_t& val)
+{
+  //Get count value summed over shards
+  val = SumCount(&HCServer::_fwdxactcount);
+
+  return ERR_NONE;
+}
+
+int HCServer::GetFwdErrCount(uint32_t& val)
+{
+  //Get count value summed over shards
+  val = SumCount(&HCServer::_fwderrcount);
+
+  return ERR_NONE;
+}
+
+int HCServer::GetRecvBufSize(uint32_t& val)
+{
+  //Get from low device
+  return _lowdev->GetRecvBufSize(val);
+}
+
+int HCServer::SetRecvBufSize(uint32_t val)
+{
+  uint32_t i;
+  int err;
+
+  //Set on low device of every shard
+  for(i=0, err=_lowdev->SetRecvBufSize(val); (i<_shardcount) && (err == ERR_NONE); i++)
+    err = _shards[i]->_lowdev->SetRecvBufSize(val);
+
+  return err;
+}
+
+int HCServer::GetSendBufSize(uint32_t& val)
+{
+  //Get from low device
+  return _lowdev->GetSendBufSize(val);
+}
+
+int HCServer::SetSendBufSize(uint32_t val)
+{
+  uint32_t i;
+  int err;
+
+  //Set on low device of every shard
+  for(i=0, err=_lowdev->SetSendBufSize(val); (i<_shardcount) && (err == ERR_NONE); i++)
+    err = _shards[i]->_lowdev->SetSendBufSize(val);
+
+  return err;
+}
+
+int HCServer::GetKernelDropCount(uint32_t& val)
+{
+  uint32_t count;
+  uint32_t i;
+  int err;
+
+  //Get count of requests the kernel dropped because the receive buffer was full
+  if((err = _lowdev->GetDropCount(val)) != ERR_NONE)
+    return err;
+
+  //Add counts of every shard
+  for(i=0; i<_shardcount; i++)
+  {
+    if((err = _shards[i]->_lowdev->GetDropCount(count)) != ERR_NONE)
+      return err;
+
+    val += count;
+  }
+
+  return ERR_NONE;
+}
+
+int HCServer::GetShardCount(uint32_t& val)
+{
+  //Get count of devices served (primary included)
+  val = _shardcount + 1;
+
+  return ERR_NONE;
+}
+
+int HCServer::GetCacheHitCount(uint32_t& val)
+{
+  //Get count value summed over shards
+  val = SumCount(&HCServer::_cachehitcount);
+
+  return ERR_NONE;
+}
+
+int HCServer::GetCacheAge(uint32_t& val)
+{
+  //Get the value
+  val = _cacheage;
+
+  return ERR_NONE;
+}
+
+int HCServer::SetCacheAge(uint32_t val)
+{
+  //Set the value (zero turns reply cache off)
+  _cacheage = val;
 
   return ERR_NONE;
 }
 
+uint32_t HCServer::SumCount(uint32_t HCServer::* count)
+{
+  uint32_t sum;
+  uint32_t i;
+
+  //Add count of this server and all its shards
+  for(i=0, sum=this->*count; i<_shardcount; i++)
+    sum += _shards[i]->*count;
+
+  return sum;
+}
+
+void HCServer::GraftParams(HCContainer* startcont)
+{
+  HCParameter* param;
+  HCContainer* cont;
+
+  //Loop through all parameters adding to parameter array
+  for(param=startcont->GetFirstSubParam(); param!=0; param=param->GetNext())
+  {
+    //Check for parameter array full
+    if(_pidtop >= _pidmax)
+    {
+      cout << __FILE__ << ' ' << __LINE__ << " - Parameter top (" << _pidtop << ") is at max (" << _pidmax << ')' << "\n";
+      return;
+    }
+
+    //Publish parameter to control thread
+    if(!StoreParam(param))
+      return;
+  }
+
+  //Loop through all containers recursively
+  for(cont=startcont->GetFirstSubCont(); cont!=0; cont=cont->GetNext())
+    GraftParams(cont);
+}
+
 void HCServer::SaveInfo(void)
 {
   ofstream file;
   HCParameter* param;
   HCContainer* cont;
-  uint16_t pid;
+  uint32_t pid;
 
   //Open information file
   file.open(_infofilename.c_str());
@@ -340,6 +658,13 @@ void HCServer::SaveInfo(void)
   file << "  <name>" << _name << "</name>" << "\n";
   file << "  <version>" << _version << "</version>" << "\n";
 
+  //Advertise newest message header version understood (clients stay on version 1 unless advertised)
+  file << "  <protocol>" << (uint32_t)HCMessage::VERSION_MAX << "</protocol>" << "\n";
+
+  //Advertise wide PIDs if parameter array extends past narrow PID range
+  if(_pidmax > PID_MAX)
+    file << "  <pidwidth>32</pidwidth>" << "\n";
+
   //Save child parameters if contained in PID table
   for(param=_top->GetFirstSubParam(); param!=0; param=param->GetNext())
     if(ParamToPID(param, &pid))
@@ -360,7 +685,7 @@ void HCServer::SaveInfo(ofstream& file, uint32_t indent, HCContainer* startcont)
 {
   HCParameter* param;
   HCContainer* cont;
-  uint16_t pid;
+  uint32_t pid;
 
   //Assert valid arguments
   assert(startcont != 0);
@@ -382,36 +707,212 @@ void HCServer::SaveInfo(ofstream& file, uint32_t indent, HCContainer* startcont)
   file << string(indent, ' ') << "</cont>" << "\n";
 }
 
-bool HCServer::ParamToPID(HCParameter* param, uint16_t* pid)
+bool HCServer::ParamToPID(HCParameter* param, uint32_t* pid)
 {
-  uint32_t i;
+  std::map<HCParameter*, uint32_t>::iterator it;
 
   //Assert valid arguments
   assert((param != 0) && (pid != 0));
 
-  //Find matching parameter
-  for(i=0; i<_pidmax; i++)
+  //Shards use the primary server's table
+  if(_primary != this)
+    return _primary->ParamToPID(param, pid);
+
+  //Find matching parameter and check for not found
+  if((it = _pids.find(param)) == _pids.end())
+    return false;
+
+  //Return PID
+  *pid = it->second;
+  return true;
+}
+
+HCParameter* HCServer::FindParam(uint32_t pid)
+{
+  HCParameter** chunk;
+
+  //Shards use the primary server's table
+  if(_primary != this)
+    return _primary->FindParam(pid);
+
+  //Check for parameter id out of bounds
+  if(pid >= _pidmax)
+    return 0;
+
+  //Get chunk containing parameter and check for not allocated
+  if((chunk = __atomic_load_n(&_chunks[pid >> PID_CHUNK_SHIFT], __ATOMIC_ACQUIRE)) == 0)
+    return 0;
+
+  //Return parameter
+  return __atomic_load_n(&chunk[pid & (PID_CHUNK_SIZE - 1)], __ATOMIC_ACQUIRE);
+}
+
+bool HCServer::StoreParam(HCParameter* param)
+{
+  uint32_t i;
+  HCParameter** chunk;
+
+  //Check for parameter array full
+  if(_pidtop >= _pidmax)
+    return false;
+
+  //Get chunk for next PID and check for not allocated
+  if((chunk = _chunks[_pidtop >> PID_CHUNK_SHIFT]) == 0)
   {
-    if(_params[i] == param)
-    {
-      *pid = i;
-      return true;
-    }
+    //Allocate and zero out chunk
+    chunk = new HCParameter*[PID_CHUNK_SIZE];
+    for(i=0; i<PID_CHUNK_SIZE; i++)
+      chunk[i] = 0;
+
+    //Publish chunk to control thread
+    __atomic_store_n(&_chunks[_pidtop >> PID_CHUNK_SHIFT], chunk, __ATOMIC_RELEASE);
+  }
+
+  //Remember PID for information file and publish parameter to control thread
+  _pids[param] = _pidtop;
+  __atomic_store_n(&chunk[_pidtop & (PID_CHUNK_SIZE - 1)], param, __ATOMIC_RELEASE);
+  _pidtop++;
+
+  return true;
+}
+
+bool HCServer::ForwardCell(void)
+{
+  uint8_t opcode;
+  uint32_t pid;
+  HCParameter* param;
+  HCClient* cli;
+  uint32_t dpid;
+  bool wide;
+  int ierr;
+
+  //Get opcode
+  opcode = _icell->GetOpCode() & ~HCCell::OPCODE_WIDE;
+
+  //Check for opcode other than a command addressed by PID (handled by this server, status and unknown opcodes counted there as opcode errors)
+  if((!HCCell::IsReadOpCode(opcode) && !HCCell::IsWriteOpCode(opcode)) || (opcode == HCCell::OPCODE_QGET_CMD))
+    return false;
+
+  //Read PID from inbound cell and rewind so cell can be handled normally if not forwarded
+  if(!_icell->ReadPID(pid))
+  {
+    _icell->Rewind();
+    return false;
+  }
+  _icell->Rewind();
+
+  //Check for parameter not bound to a downstream server
+  if((param = FindParam(pid)) == 0 || !param->GetProxy(cli, dpid))
+    return false;
+
+  //Replace PID with downstream PID in downstream width (rest of cell is passed through untouched)
+  wide = _icell->IsWide();
+  if(!_icell->ReplacePID(dpid, cli->GetWidePID()))
+    return false;
+
+  //Forward raw cell to downstream server and check for error
+  if((ierr = cli->Forward(_icell, _ocell)) != ERR_NONE)
+  {
+    //Increment forward error count
+    _fwderrcount++;
+
+    //Restore upstream PID and reply with error
+    _icell->ReplacePID(pid, wide);
+    ForwardErrHandler(ierr);
+    return true;
+  }
+
+  //Replace downstream PID in reply with upstream PID in upstream width and check for error
+  if(!_ocell->ReplacePID(pid, wide))
+  {
+    //Increment internal error count
+    _interrcount++;
+
+    //Stop processing
+    return true;
+  }
+
+  //Write relayed cell to outbound message
+  _omsg->Write(_ocell);
+
+  //Increment forward transaction count
+  _fwdxactcount++;
+
+  return true;
+}
+
+void HCServer::ForwardErrHandler(int err)
+{
+  uint8_t opcode;
+  uint32_t pid;
+  uint32_t eid;
+  uint32_t offset;
+  uint16_t maxlen;
+
+  //Get opcode and reset outbound cell (status opcode always follows command opcode)
+  opcode = _icell->GetOpCode();
+  _ocell->Reset(opcode + 1);
+  opcode &= ~HCCell::OPCODE_WIDE;
+
+  //Read PID from inbound cell and write to outbound cell
+  if(!_icell->ReadPID(pid) || !_ocell->WritePID(pid))
+    return;
+
+  //Build error reply with same layout the downstream server would have used
+  switch(opcode)
+  {
+  case HCCell::OPCODE_CALL_CMD:
+    if(!_ocell->Write((int8_t)err))
+      return;
+    break;
+  case HCCell::OPCODE_GET_CMD:
+    if(!HCParameter::HandleGetError(_icell, _ocell, err))
+      return;
+    break;
+  case HCCell::OPCODE_SET_CMD:
+  case HCCell::OPCODE_ADD_CMD:
+  case HCCell::OPCODE_SUB_CMD:
+    if(!_ocell->Write((int8_t)err))
+      return;
+    break;
+  case HCCell::OPCODE_ICALL_CMD:
+    if(!_icell->Read(eid) || !_ocell->Write(eid) || !_ocell->Write((int8_t)err))
+      return;
+    break;
+  case HCCell::OPCODE_IGET_CMD:
+    if(!_icell->Read(eid) || !_ocell->Write(eid) || !HCParameter::HandleGetError(_icell, _ocell, err))
+      return;
+    break;
+  case HCCell::OPCODE_ISET_CMD:
+    if(!_icell->Read(eid) || !_ocell->Write(eid) || !_ocell->Write((int8_t)err))
+      return;
+    break;
+  case HCCell::OPCODE_READ_CMD:
+    if(!_icell->Read(offset) || !_icell->Read(maxlen) || !_ocell->Write(offset) || !_ocell->Write((uint16_t)0) || !_ocell->Write((int8_t)err))
+      return;
+    break;
+  case HCCell::OPCODE_WRITE_CMD:
+    if(!_icell->Read(offset) || !_ocell->Write(offset) || !_ocell->Write((int8_t)err))
+      return;
+    break;
+  default:
+    return;
   }
 
-  return false;
+  //Write outbound cell to message
+  _omsg->Write(_ocell);
 }
 
 void HCServer::CallCmdHandler(void)
 {
-  uint16_t pid;
+  uint32_t pid;
   HCParameter* param;
 
   //Reset outbound cell
-  _ocell->Reset(HCCell::OPCODE_CALL_STS);
+  _ocell->Reset(HCCell::OPCODE_CALL_STS | (_icell->GetOpCode() & HCCell::OPCODE_WIDE));
 
   //Read PID from inbound cell and check for error
-  if(!_icell->Read(pid))
+  if(!_icell->ReadPID(pid))
   {
     //Increment deserialization error count
     _deserrcount++;
@@ -421,13 +922,13 @@ void HCServer::CallCmdHandler(void)
   }
 
   //Get a pointer to parameter and check for error
-  if((pid >= _pidmax) || ((param = _params[pid]) == 0))
+  if((param = FindParam(pid)) == 0)
   {
     //Increment PID error count
     _piderrcount++;
 
     //Write PID to outbound cell and check for error
-    if(!_ocell->Write(pid))
+    if(!_ocell->WritePID(pid))
       return;
 
     //Write PID error code to outbound cell and check for error
@@ -442,7 +943,7 @@ void HCServer::CallCmdHandler(void)
   }
 
   //Write PID to outbound cell and check for error
-  if(!_ocell->Write(pid))
+  if(!_ocell->WritePID(pid))
   {
     //Increment internal error count
     _interrcount++;
@@ -467,14 +968,14 @@ void HCServer::CallCmdHandler(void)
 
 void HCServer::GetCmdHandler(void)
 {
-  uint16_t pid;
+  uint32_t pid;
   HCParameter* param;
 
   //Reset outbound cell
-  _ocell->Reset(HCCell::OPCODE_GET_STS);
+  _ocell->Reset(HCCell::OPCODE_GET_STS | (_icell->GetOpCode() & HCCell::OPCODE_WIDE));
 
   //Read PID from inbound cell and check for error
-  if(!_icell->Read(pid))
+  if(!_icell->ReadPID(pid))
   {
     //Increment deserialization error count
     _deserrcount++;
@@ -484,13 +985,13 @@ void HCServer::GetCmdHandler(void)
   }
 
   //Get a pointer to parameter and check for error
-  if((pid >= _pidmax) || ((param = _params[pid]) == 0))
+  if((param = FindParam(pid)) == 0)
   {
     //Increment PID error count
     _piderrcount++;
 
     //Write PID to outbound cell and check for error
-    if(!_ocell->Write(pid))
+    if(!_ocell->WritePID(pid))
       return;
 
     //Handle PID error for get transaction
@@ -505,7 +1006,7 @@ void HCServer::GetCmdHandler(void)
   }
 
   //Write PID to outbound cell and check for error
-  if(!_ocell->Write(pid))
+  if(!_ocell->WritePID(pid))
   {
     //Increment internal error count
     _interrcount++;
@@ -530,14 +1031,14 @@ void HCServer::GetCmdHandler(void)
 
 void HCServer::SetCmdHandler(void)
 {
-  uint16_t pid;
+  uint32_t pid;
   HCParameter* param;
 
   //Reset outbound cell
-  _ocell->Reset(HCCell::OPCODE_SET_STS);
+  _ocell->Reset(HCCell::OPCODE_SET_STS | (_icell->GetOpCode() & HCCell::OPCODE_WIDE));
 
   //Read PID from inbound cell and check for error
-  if(!_icell->Read(pid))
+  if(!_icell->ReadPID(pid))
   {
     //Increment deserialization error count
     _deserrcount++;
@@ -547,13 +1048,13 @@ void HCServer::SetCmdHandler(void)
   }
 
   //Get a pointer to parameter and check for error
-  if((pid >= _pidmax) || ((param = _params[pid]) == 0))
+  if((param = FindParam(pid)) == 0)
   {
     //Increment PID error count
     _piderrcount++;
 
     //Write PID to outbound cell and check for error
-    if(!_ocell->Write(pid))
+    if(!_ocell->WritePID(pid))
       return;
 
     //Handle PID error for set transaction
@@ -568,7 +1069,7 @@ void HCServer::SetCmdHandler(void)
   }
 
   //Write PID to outbound cell and check for error
-  if(!_ocell->Write(pid))
+  if(!_ocell->WritePID(pid))
   {
     //Increment internal error count
     _interrcount++;
@@ -593,15 +1094,15 @@ void HCServer::SetCmdHandler(void)
 
 void HCServer::ICallCmdHandler(void)
 {
-  uint16_t pid;
+  uint32_t pid;
   uint32_t eid;
   HCParameter* param;
 
   //Reset outbound cell
-  _ocell->Reset(HCCell::OPCODE_ICALL_STS);
+  _ocell->Reset(HCCell::OPCODE_ICALL_STS | (_icell->GetOpCode() & HCCell::OPCODE_WIDE));
 
   //Read PID from inbound cell and check for error
-  if(!_icell->Read(pid))
+  if(!_icell->ReadPID(pid))
   {
     //Increment deserialization error count
     _deserrcount++;
@@ -621,13 +1122,13 @@ void HCServer::ICallCmdHandler(void)
   }
 
   //Get a pointer to parameter and check for error
-  if((pid >= _pidmax) || ((param = _params[pid]) == 0))
+  if((param = FindParam(pid)) == 0)
   {
     //Increment PID error count
     _piderrcount++;
 
     //Write PID to outbound cell and check for error
-    if(!_ocell->Write(pid))
+    if(!_ocell->WritePID(pid))
       return;
 
     //Write EID to outbound cell and check for error
@@ -646,7 +1147,7 @@ void HCServer::ICallCmdHandler(void)
   }
 
   //Write PID to outbound cell and check for error
-  if(!_ocell->Write(pid))
+  if(!_ocell->WritePID(pid))
   {
     //Increment internal error count
     _interrcount++;
@@ -681,15 +1182,15 @@ void HCServer::ICallCmdHandler(void)
 
 void HCServer::IGetCmdHandler(void)
 {
-  uint16_t pid;
+  uint32_t pid;
   uint32_t eid;
   HCParameter* param;
 
   //Reset outbound cell
-  _ocell->Reset(HCCell::OPCODE_IGET_STS);
+  _ocell->Reset(HCCell::OPCODE_IGET_STS | (_icell->GetOpCode() & HCCell::OPCODE_WIDE));
 
   //Read PID from inbound cell and check for error
-  if(!_icell->Read(pid))
+  if(!_icell->ReadPID(pid))
   {
     //Increment deserialization error count
     _deserrcount++;
@@ -709,13 +1210,13 @@ void HCServer::IGetCmdHandler(void)
   }
 
   //Get a pointer to parameter and check for error
-  if((pid >= _pidmax) || ((param = _params[pid]) == 0))
+  if((param = FindParam(pid)) == 0)
   {
     //Increment PID error count
     _piderrcount++;
 
     //Write PID to outbound cell and check for error
-    if(!_ocell->Write(pid))
+    if(!_ocell->WritePID(pid))
       return;
 
     //Write EID to outbound cell and check for error
@@ -734,7 +1235,7 @@ void HCServer::IGetCmdHandler(void)
   }
 
   //Write PID to outbound cell and check for error
-  if(!_ocell->Write(pid))
+  if(!_ocell->WritePID(pid))
   {
     //Increment internal error count
     _interrcount++;
@@ -769,15 +1270,15 @@ void HCServer::IGetCmdHandler(void)
 
 void HCServer::ISetCmdHandler(void)
 {
-  uint16_t pid;
+  uint32_t pid;
   uint32_t eid;
   HCParameter* param;
 
   //Reset outbound cell
-  _ocell->Reset(HCCell::OPCODE_ISET_STS);
+  _ocell->Reset(HCCell::OPCODE_ISET_STS | (_icell->GetOpCode() & HCCell::OPCODE_WIDE));
 
   //Read PID from inbound cell and check for error
-  if(!_icell->Read(pid))
+  if(!_icell->ReadPID(pid))
   {
     //Increment deserialization error count
     _deserrcount++;
@@ -797,13 +1298,13 @@ void HCServer::ISetCmdHandler(void)
   }
 
   //Get a pointer to parameter and check for error
-  if((pid >= _pidmax) || ((param = _params[pid]) == 0))
+  if((param = FindParam(pid)) == 0)
   {
     //Increment PID error count
     _piderrcount++;
 
     //Write PID to outbound cell and check for error
-    if(!_ocell->Write(pid))
+    if(!_ocell->WritePID(pid))
       return;
 
     //Write EID to outbound cell and check for error
@@ -822,7 +1323,7 @@ void HCServer::ISetCmdHandler(void)
   }
 
   //Write PID to outbound cell and check for error
-  if(!_ocell->Write(pid))
+  if(!_ocell->WritePID(pid))
   {
     //Increment internal error count
     _interrcount++;
@@ -857,14 +1358,14 @@ void HCServer::ISetCmdHandler(void)
 
 void HCServer::AddCmdHandler(void)
 {
-  uint16_t pid;
+  uint32_t pid;
   HCParameter* param;
 
   //Reset outbound cell
-  _ocell->Reset(HCCell::OPCODE_ADD_STS);
+  _ocell->Reset(HCCell::OPCODE_ADD_STS | (_icell->GetOpCode() & HCCell::OPCODE_WIDE));
 
   //Read PID from inbound cell and check for error
-  if(!_icell->Read(pid))
+  if(!_icell->ReadPID(pid))
   {
     //Increment deserialization error count
     _deserrcount++;
@@ -874,13 +1375,13 @@ void HCServer::AddCmdHandler(void)
   }
 
   //Get a pointer to parameter and check for error
-  if((pid >= _pidmax) || ((param = _params[pid]) == 0))
+  if((param = FindParam(pid)) == 0)
   {
     //Increment PID error count
     _piderrcount++;
 
     //Write PID to outbound cell and check for error
-    if(!_ocell->Write(pid))
+    if(!_ocell->WritePID(pid))
       return;
 
     //Handle PID error for add transaction same as set
@@ -895,7 +1396,7 @@ void HCServer::AddCmdHandler(void)
   }
 
   //Write PID to outbound cell and check for error
-  if(!_ocell->Write(pid))
+  if(!_ocell->WritePID(pid))
   {
     //Increment internal error count
     _interrcount++;
@@ -920,14 +1421,14 @@ void HCServer::AddCmdHandler(void)
 
 void HCServer::SubCmdHandler(void)
 {
-  uint16_t pid;
+  uint32_t pid;
   HCParameter* param;
 
   //Reset outbound cell
-  _ocell->Reset(HCCell::OPCODE_SUB_STS);
+  _ocell->Reset(HCCell::OPCODE_SUB_STS | (_icell->GetOpCode() & HCCell::OPCODE_WIDE));
 
   //Read PID from inbound cell and check for error
-  if(!_icell->Read(pid))
+  if(!_icell->ReadPID(pid))
   {
     //Increment deserialization error count
     _deserrcount++;
@@ -937,13 +1438,13 @@ void HCServer::SubCmdHandler(void)
   }
 
   //Get a pointer to parameter and check for error
-  if((pid >= _pidmax) || ((param = _params[pid]) == 0))
+  if((param = FindParam(pid)) == 0)
   {
     //Increment PID error count
     _piderrcount++;
 
     //Write PID to outbound cell and check for error
-    if(!_ocell->Write(pid))
+    if(!_ocell->WritePID(pid))
       return;
 
     //Handle PID error for subtract transaction same as set
@@ -958,7 +1459,7 @@ void HCServer::SubCmdHandler(void)
   }
 
   //Write PID to outbound cell and check for error
-  if(!_ocell->Write(pid))
+  if(!_ocell->WritePID(pid))
   {
     //Increment internal error count
     _interrcount++;
@@ -983,16 +1484,16 @@ void HCServer::SubCmdHandler(void)
 
 void HCServer::ReadCmdHandler(void)
 {
-  uint16_t pid;
+  uint32_t pid;
   uint32_t offset;
   uint16_t maxlen;
   HCParameter* param;
 
   //Reset outbound cell
-  _ocell->Reset(HCCell::OPCODE_READ_STS);
+  _ocell->Reset(HCCell::OPCODE_READ_STS | (_icell->GetOpCode() & HCCell::OPCODE_WIDE));
 
   //Read PID from inbound cell and check for error
-  if(!_icell->Read(pid))
+  if(!_icell->ReadPID(pid))
   {
     //Increment deserialization error count
     _deserrcount++;
@@ -1022,13 +1523,13 @@ void HCServer::ReadCmdHandler(void)
   }
 
   //Get a pointer to parameter and check for error
-  if((pid >= _pidmax) || ((param = _params[pid]) == 0))
+  if((param = FindParam(pid)) == 0)
   {
     //Increment PID error count
     _piderrcount++;
 
     //Write PID to outbound cell and check for error
-    if(!_ocell->Write(pid))
+    if(!_ocell->WritePID(pid))
       return;
 
     //Write offset to outbound cell and check for error
@@ -1047,7 +1548,7 @@ void HCServer::ReadCmdHandler(void)
   }
 
   //Write PID to outbound cell and check for error
-  if(!_ocell->Write(pid))
+  if(!_ocell->WritePID(pid))
   {
     //Increment internal error count
     _interrcount++;
@@ -1082,15 +1583,15 @@ void HCServer::ReadCmdHandler(void)
 
 void HCServer::WriteCmdHandler(void)
 {
-  uint16_t pid;
+  uint32_t pid;
   uint32_t offset;
   HCParameter* param;
 
   //Reset outbound cell
-  _ocell->Reset(HCCell::OPCODE_WRITE_STS);
+  _ocell->Reset(HCCell::OPCODE_WRITE_STS | (_icell->GetOpCode() & HCCell::OPCODE_WIDE));
 
   //Read PID from inbound cell and check for error
-  if(!_icell->Read(pid))
+  if(!_icell->ReadPID(pid))
   {
     //Increment deserialization error count
     _deserrcount++;
@@ -1110,13 +1611,13 @@ void HCServer::WriteCmdHandler(void)
   }
 
   //Get a pointer to parameter and check for error
-  if((pid >= _pidmax) || ((param = _params[pid]) == 0))
+  if((param = FindParam(pid)) == 0)
   {
     //Increment PID error count
     _piderrcount++;
 
     //Write PID to outbound cell and check for error
-    if(!_ocell->Write(pid))
+    if(!_ocell->WritePID(pid))
       return;
 
     //Write offset to outbound cell and check for error
@@ -1135,7 +1636,7 @@ void HCServer::WriteCmdHandler(void)
   }
 
   //Write PID to outbound cell and check for error
-  if(!_ocell->Write(pid))
+  if(!_ocell->WritePID(pid))
   {
     //Increment internal error count
     _interrcount++;
@@ -1168,93 +1669,265 @@ void HCServer::WriteCmdHandler(void)
   _omsg->Write(_ocell);
 }
 
-void HCServer::CtlThread(void)
+void HCServer::QGetCmdHandler(void)
+{
+  bool wide;
+  string name;
+  uint32_t start;
+  uint32_t count;
+  uint32_t i;
+  uint32_t pid;
+  bool found;
+  HCCell* reply;
+  uint64_t now;
+
+  //Reset outbound cell (results use the PID width of the request)
+  wide = _icell->IsWide();
+  _ocell->Reset(HCCell::OPCODE_QGET_STS | (_icell->GetOpCode() & HCCell::OPCODE_WIDE));
+
+  //Read expression and starting result index from inbound cell and check for error
+  if(!_icell->Read(name) || !_icell->Read(start))
+  {
+    //Increment deserialization error count
+    _deserrcount++;
+
+    //Stop processing
+    return;
+  }
+
+  //Check for new query rather than continuation of a recent one from same peer (result kept so later pages match first)
+  now = ThreadTimeUS();
+  if((start == 0) || (name != _qname) || (_peer != _qpeer) || ((now - _qtime) > ((uint64_t)QUERY_AGE * 1000)))
+  {
+    //Resolve expression and get all matching parameters (downstream servers queried in parallel)
+    _qcount = _fanout->Get(name);
+    _qname = name;
+    _qpeer = _peer;
+    _qtime = now;
+  }
+  count = _qcount;
+
+  //Clamp starting index
+  if(start > count)
+    start = count;
+
+  //Write result count to outbound cell and check for error
+  if(!_ocell->Write(count))
+  {
+    //Increment internal error count
+    _interrcount++;
+
+    //Stop processing
+    return;
+  }
+
+  //Pack get status payloads into results until reply is full
+  _rcell->Reset(HCCell::OPCODE_QGET_STS);
+  for(i=start; i<count; i++)
+  {
+    //Look up PID clients use for parameter
+    _primary->_infomutex->Wait();
+    found = ParamToPID(_fanout->GetParam(i), &pid);
+    _primary->_infomutex->Give();
+
+    //Skip parameters not addressable through this server
+    if(!found)
+      continue;
+
+    //Format result using upstream PID in request width
+    if((reply = _fanout->GetReply(i)) != 0)
+    {
+      _qcell->Copy(reply);
+      if(!_qcell->ReplacePID(pid, wide))
+        break;
+    }
+    else
+    {
+      _qcell->Reset(HCCell::OPCODE_GET_STS | (wide ? HCCell::OPCODE_WIDE : 0));
+      if(!_qcell->WritePID(pid) || !HCParameter::HandleGetError(_icell, _qcell, _fanout->GetErr(i)))
+        break;
+    }
+
+    //Check for result not fitting (next index is returned so client can continue)
+    if((_ocell->GetLength() + sizeof(uint32_t) + _rcell->GetLength() + _qcell->GetLength()) > HCCell::PAYLOAD_MAX)
+      break;
+
+    //Append result
+    _rcell->Append(_qcell);
+  }
+
+  //Write index of next result followed by results and check for error
+  if(!_ocell->Write(i) || !_ocell->Append(_rcell))
+  {
+    //Increment internal error count
+    _interrcount++;
+
+    //Stop processing
+    return;
+  }
+
+  //Write outbound cell to message
+  _omsg->Write(_ocell);
+}
+
+void HCServer::ProcessMessage(void)
 {
   uint8_t opcode;
 
+  //Print inbound message if requested
+  if(_primary->_debug)
+    _imsg->Print("Rx");
+
+  //Reset outbound message (reply in version of request, with total length if request had one)
+  _omsg->SetVersion(_imsg->GetVersion());
+  _omsg->SetFlags(_imsg->GetFlags() & HCMessage::FLAG_LENGTH);
+  _omsg->Reset(_imsg->GetTransaction());
+
+  //Nothing changed by message yet
+  _mutating = false;
+
+  //Process all cells from inbound message
+  while(_imsg->Read(_icell))
+  {
+    //Note command that changes server state (reply is remembered in case message is sent again)
+    if(HCCell::IsWriteOpCode(_icell->GetOpCode()))
+      _mutating = true;
+
+    //Forward cell straight through if parameter belongs to a downstream server
+    if(ForwardCell())
+      continue;
+
+    //Get opcode (handlers read PID in whichever width the cell uses)
+    opcode = _icell->GetOpCode() & ~HCCell::OPCODE_WIDE;
+
+    //Process cells depending on opcode
+    switch(opcode)
+    {
+    case HCCell::OPCODE_CALL_CMD:
+      CallCmdHandler();
+      break;
+    case HCCell::OPCODE_GET_CMD:
+      GetCmdHandler();
+      break;
+    case HCCell::OPCODE_SET_CMD:
+      SetCmdHandler();
+      break;
+    case HCCell::OPCODE_ICALL_CMD:
+      ICallCmdHandler();
+      break;
+    case HCCell::OPCODE_IGET_CMD:
+      IGetCmdHandler();
+      break;
+    case HCCell::OPCODE_ISET_CMD:
+      ISetCmdHandler();
+      break;
+    case HCCell::OPCODE_ADD_CMD:
+      AddCmdHandler();
+      break;
+    case HCCell::OPCODE_SUB_CMD:
+      SubCmdHandler();
+      break;
+    case HCCell::OPCODE_READ_CMD:
+      ReadCmdHandler();
+      break;
+    case HCCell::OPCODE_WRITE_CMD:
+      WriteCmdHandler();
+      break;
+    case HCCell::OPCODE_QGET_CMD:
+      QGetCmdHandler();
+      break;
+    default:
+      //Increment opcode error count
+      _opcodeerrcount++;
+
+      //Ignore rest of loop
+      continue;
+    }
+  }
+
+  //Print outbound message if requested
+  if(_primary->_debug)
+    _omsg->Print("Tx");
+}
+
+void HCServer::CtlThread(void)
+{
+  uint32_t count;
+  uint32_t txcount;
+  uint32_t sent;
+  uint64_t now;
+  uint64_t maxage;
+  uint32_t i;
+
   //Go forever
   while(true)
   {
-    //Receive inbound message and check for error
-    if(_imsg->Recv(_lowdev) != ERR_NONE)
+    //Receive all queued inbound messages (up to batch size) and their source peers
+    if((count = _lowdev->ReadBatch(_rxbufs, MSG_SIZE, BATCH_MAX, _rxlens, _rxpeers)) == 0)
     {
       //Increment receive error count
       _recverrcount++;
 
+      //Block until device is readable again (at most a while) rather than spin and starve other threads
+      _lowdev->WaitReadable(1000);
+
       //Ignore rest of loop
       continue;
     }
 
-    //Print inbound message if requested
-    if(_debug)
-      _imsg->Print("Rx");
+    //Take time and age limit for reply cache once per batch
+    now = ThreadTimeUS();
+    maxage = (uint64_t)_primary->_cacheage * 1000;
 
-    //Reset outbound message
-    _omsg->Reset(_imsg->GetTransaction());
-
-    //Process all cells from inbound message
-    while(_imsg->Read(_icell))
+    //Process each inbound message into the outbound batch
+    for(i=0, txcount=0; i<count; i++)
     {
-      //Get opcode
-      opcode = _icell->GetOpCode();
-
-      //Process cells depending on opcode
-      switch(opcode)
+      //Load inbound message and check for error
+      if(_imsg->Load(&_rxbufs[i * MSG_SIZE], _rxlens[i]) != ERR_NONE)
       {
-      case HCCell::OPCODE_CALL_CMD:
-        CallCmdHandler();
-        break;
-      case HCCell::OPCODE_GET_CMD:
-        GetCmdHandler();
-        break;
-      case HCCell::OPCODE_SET_CMD:
-        SetCmdHandler();
-        break;
-      case HCCell::OPCODE_ICALL_CMD:
-        ICallCmdHandler();
-        break;
-      case HCCell::OPCODE_IGET_CMD:
-        IGetCmdHandler();
-        break;
-      case HCCell::OPCODE_ISET_CMD:
-        ISetCmdHandler();
-        break;
-      case HCCell::OPCODE_ADD_CMD:
-        AddCmdHandler();
-        break;
-      case HCCell::OPCODE_SUB_CMD:
-        SubCmdHandler();
-        break;
-      case HCCell::OPCODE_READ_CMD:
-        ReadCmdHandler();
-        break;
-      case HCCell::OPCODE_WRITE_CMD:
-        WriteCmdHandler();
-        break;
-      default:
-        //Increment opcode error count
-        _opcodeerrcount++;
+        //Increment receive error count
+        _recverrcount++;
 
         //Ignore rest of loop
         continue;
       }
-    }
 
-    //Print outbound message if requested
-    if(_debug)
-      _omsg->Print("Tx");
+      //Check for message sent again whose reply is remembered (answered again without carrying it out)
+      if((maxage != 0) && ((_txlens[txcount] = _cache->Lookup(_rxpeers[i], _imsg->GetTransaction(), &_rxbufs[i * MSG_SIZE], _rxlens[i], now, maxage, &_txbufs[txcount * MSG_SIZE], MSG_SIZE)) != 0))
+      {
+        //Increment cache hit count
+        _cachehitcount++;
 
-    //Send outbound message and check for error
-    if(_omsg->Send(_lowdev) != ERR_NONE)
-    {
-      //Increment send error count
-      _senderrcount++;
+        _txpeers[txcount++] = _rxpeers[i];
+        continue;
+      }
 
-      //Ignore rest of loop
-      continue;
+      //Process cells into outbound message on behalf of source peer
+      _peer = _rxpeers[i];
+      ProcessMessage();
+
+      //Store outbound message addressed back to source peer
+      if((_txlens[txcount] = _omsg->Store(&_txbufs[txcount * MSG_SIZE], MSG_SIZE)) == 0)
+      {
+        //Increment send error count
+        _senderrcount++;
+
+        //Ignore rest of loop
+        continue;
+      }
+
+      //Remember reply to message that changed server state
+      if(_mutating && (maxage != 0))
+        _cache->Store(_rxpeers[i], _imsg->GetTransaction(), &_rxbufs[i * MSG_SIZE], _rxlens[i], now, &_txbufs[txcount * MSG_SIZE], _txlens[txcount]);
+
+      _txpeers[txcount++] = _rxpeers[i];
     }
 
-    //Increment good transaction count
-    _goodxactcount++;
+    //Flush all replies at once
+    sent = _lowdev->WriteBatch(_txbufs, MSG_SIZE, _txlens, _txpeers, txcount);
+
+    //Update good transaction and send error counts
+    _goodxactcount += sent;
+    _senderrcount += txcount - sent;
   }
 }
@@ -27,20 +27,29 @@
 #pragma once
 
 #include "device.hh"
+#include "mutex.hh"
 #include "thread.hh"
 #include "hccell.hh"
 #include "hccontainer.hh"
+#include "hcfanout.hh"
 #include "hcmessage.hh"
 #include "hcparameter.hh"
+#include "hcreplycache.hh"
 #include <fstream>
 #include <inttypes.h>
+#include <map>
 #include <string>
 
 class HCServer
 {
 public:
-  //Maximum number of supported PIDs
+  //Maximum number of supported PIDs (narrow and wide PID servers)
   static const uint32_t PID_MAX = 65536;
+  static const uint32_t PID_MAX_WIDE = 0xFFFFFFFF;
+
+  //Parameter table chunk size (chunks allocated as PIDs are assigned)
+  static const uint32_t PID_CHUNK_SHIFT = 16;
+  static const uint32_t PID_CHUNK_SIZE = 1 << PID_CHUNK_SHIFT;
 
   //Special reserved PIDs
   static const uint16_t PID_NAME = 0;
@@ -48,12 +57,30 @@ public:
   static const uint16_t PID_INFOFILECRC = 2;
   static const uint16_t PID_INFOFILE = 3;
 
+  //Maximum queued requests drained (and replies flushed) per wakeup
+  static const uint32_t BATCH_MAX = 32;
+
+  //Maximum number of additional shards (each with its own device and thread)
+  static const uint32_t SHARD_MAX = 63;
+
+  //Serialized message buffer size
+  static const uint32_t MSG_SIZE = HCMessage::OVERHEAD + HCMessage::PAYLOAD_MAX;
+
+  //Default time (ms) replies to requests that change server state are remembered for requests sent again
+  static const uint32_t CACHE_AGE_DEFAULT = 10000;
+
+  //Time (ms) a wildcard get result is kept for continuation pages requested by the same peer
+  static const uint32_t QUERY_AGE = 1000;
+
 public:
-  HCServer(Device* lowdev, HCContainer* top, const std::string& name, const std::string& version, uint32_t pidmax=PID_MAX);
+  HCServer(Device* lowdev, HCContainer* top, const std::string& name, const std::string& version, uint32_t pidmax=PID_MAX, int core=-1);
   ~HCServer();
-  HCParameter* GetParam(uint16_t pid);
+  int AddShard(Device* lowdev, int core=-1);
+  void SetExecutor(Executor* exec);
+  HCParameter* GetParam(uint32_t pid);
   void Add(HCParameter* param);
   void Start(void);
+  void Graft(HCContainer* startcont);
   int GetName(std::string& val);
   int GetVersion(std::string& val);
   int GetInfoFileCRC(uint32_t& val);
@@ -68,11 +95,30 @@ public:
   int GetPIDErrCount(uint32_t& val);
   int GetIntErrCount(uint32_t& val);
   int GetGoodXactCount(uint32_t& val);
+  int GetFwdXactCount(uint32_t& val);
+  int GetFwdErrCount(uint32_t& val);
+  int GetRecvBufSize(uint32_t& val);
+  int SetRecvBufSize(uint32_t val);
+  int GetSendBufSize(uint32_t& val);
+  int SetSendBufSize(uint32_t val);
+  int GetKernelDropCount(uint32_t& val);
+  int GetShardCount(uint32_t& val);
+  int GetCacheHitCount(uint32_t& val);
+  int GetCacheAge(uint32_t& val);
+  int SetCacheAge(uint32_t val);
 
 private:
+  HCServer(Device* lowdev, HCServer* primary, int core);
+  void Init(Device* lowdev, HCContainer* top, int core);
+  uint32_t SumCount(uint32_t HCServer::* count);
+  HCParameter* FindParam(uint32_t pid);
+  bool StoreParam(HCParameter* param);
+  void GraftParams(HCContainer* startcont);
   void SaveInfo(void);
   void SaveInfo(std::ofstream& file, uint32_t indent, HCContainer* startcont);
-  bool ParamToPID(HCParameter* param, uint16_t* pid);
+  bool ParamToPID(HCParameter* param, uint32_t* pid);
+  bool ForwardCell(void);
+  void ForwardErrHandler(int err);
   void CallCmdHandler(void);
   void GetCmdHandler(void);
   void SetCmdHandler(void);
@@ -83,22 +129,48 @@ private:
   void SubCmdHandler(void);
   void ReadCmdHandler(void);
   void WriteCmdHandler(void);
+  void QGetCmdHandler(void);
+  void ProcessMessage(void);
   void CtlThread(void);
 
 private:
   Device* _lowdev;
+  HCServer* _primary;
+  HCServer* _shards[SHARD_MAX];
+  uint32_t _shardcount;
   HCContainer* _top;
   std::string _name;
   std::string _version;
   std::string _infofilename;
   uint32_t _pidtop;
   uint32_t _pidmax;
-  HCParameter** _params;
+  uint32_t _chunkcount;
+  HCParameter*** _chunks;
+  std::map<HCParameter*, uint32_t> _pids;
   bool _started;
+  Mutex* _infomutex;
   HCMessage* _imsg;
   HCCell* _icell;
   HCMessage* _omsg;
   HCCell* _ocell;
+  HCCell* _qcell;
+  HCCell* _rcell;
+  HCFanOut* _fanout;
+  std::string _qname;
+  uint64_t _qpeer;
+  uint64_t _qtime;
+  uint32_t _qcount;
+  HCReplyCache* _cache;
+  bool _mutating;
+  uint32_t _cacheage;
+  Executor* _exec;
+  uint8_t* _rxbufs;
+  uint32_t _rxlens[BATCH_MAX];
+  uint64_t _rxpeers[BATCH_MAX];
+  uint8_t* _txbufs;
+  uint32_t _txlens[BATCH_MAX];
+  uint64_t _txpeers[BATCH_MAX];
+  uint64_t _peer;
   bool _debug;
   uint32_t _senderrcount;
   uint32_t _recverrcount;
@@ -108,5 +180,8 @@ private:
   uint32_t _piderrcount;
   uint32_t _interrcount;
   uint32_t _goodxactcount;
+  uint32_t _fwdxactcount;
+  uint32_t _fwderrcount;
+  uint32_t _cachehitcount;
   Thread<HCServer>* _ctlthread;
 };
@@ -42,7 +42,7 @@
 class HCStringCli
 {
 public:
-  HCStringCli(HCClient* cli, uint16_t pid)
+  HCStringCli(HCClient* cli, uint32_t pid)
   {
     //Assert valid arguments
     assert(cli != 0);
@@ -93,9 +93,33 @@ public:
     return _cli->ISet(_pid, eid, val);
   }
 
+  int Get(std::string& val, HCAsync* xact)
+  {
+    //Delegate to client (value stored when transaction completes)
+    return _cli->Get(_pid, val, xact);
+  }
+
+  int Set(const std::string& val, HCAsync* xact)
+  {
+    //Delegate to client
+    return _cli->Set(_pid, val, xact);
+  }
+
+  int IGet(uint32_t eid, std::string& val, HCAsync* xact)
+  {
+    //Delegate to client (value stored when transaction completes)
+    return _cli->IGet(_pid, eid, val, xact);
+  }
+
+  int ISet(uint32_t eid, const std::string& val, HCAsync* xact)
+  {
+    //Delegate to client
+    return _cli->ISet(_pid, eid, val, xact);
+  }
+
 private:
   HCClient* _cli;
-  uint16_t _pid;
+  uint32_t _pid;
 };
 
 //-----------------------------------------------------------------------------
@@ -201,7 +225,7 @@ public:
     st << "\n  Savable: " << (IsSavable() ? "Yes" : "No");
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     //Generate XML information
     file << std::string(indent, ' ') << "<str>" << "\n";
@@ -566,7 +590,7 @@ public:
     }
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     uint32_t i;
 
@@ -957,7 +981,7 @@ public:
     st << "\n  Max Size: " << _maxsize;
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     //Generate XML information
     file << std::string(indent, ' ') << "<strl>" << "\n";
@@ -183,6 +183,76 @@ HCParameter* HCUtility::GetParam(const string& name, HCContainer* startcont, siz
   return 0;
 }
 
+uint32_t HCUtility::FindParams(const string& name, HCContainer* startcont, HCParameter** params, string* paths, uint32_t maxcount, uint32_t count, size_t index)
+{
+  string nodename;
+  string path;
+  HCContainer* cont;
+  HCParameter* param;
+  size_t nextindex;
+
+  //Assert valid arguments
+  assert((startcont != 0) && (params != 0) && (paths != 0));
+
+  //Loop through directory names in path
+  while((nextindex = name.find('/', index)) != string::npos)
+  {
+    //Extract node name
+    nodename = name.substr(index, nextindex-index);
+
+    //Update index
+    index = nextindex+1;
+
+    //Check for special strings first
+    if((nodename == "") || (nodename == "."))
+    {
+      //Continue to next iteration
+      continue;
+    }
+    else if(nodename == "..")
+    {
+      //If no parent, then continue to next iteration
+      if(startcont->GetParent() == 0)
+      {
+        //Continue to next iteration
+        continue;
+      }
+
+      //Recurse
+      return FindParams(name, startcont->GetParent(), params, paths, maxcount, count, index);
+    }
+    else
+    {
+      //Loop through all containers recursing into those with matching name (expressions allowed)
+      for(cont=startcont->GetFirstSubCont(); (cont!=0) && (count<maxcount); cont=cont->GetNext())
+        if(cont->NameMatchesExpression(nodename))
+          count = FindParams(name, cont, params, paths, maxcount, count, index);
+    }
+
+    //Done
+    return count;
+  }
+
+  //Extract node name
+  nodename = name.substr(index, name.length()-index);
+
+  //Get path of start container
+  startcont->GetPath(path);
+
+  //Collect parameters with matching name (expressions allowed)
+  for(param=startcont->GetFirstSubParam(); (param!=0) && (count<maxcount); param=param->GetNext())
+  {
+    if(param->NameMatchesExpression(nodename))
+    {
+      params[count] = param;
+      paths[count] = path + param->GetName();
+      count++;
+    }
+  }
+
+  return count;
+}
+
 void HCAdd(HCParameter* param, HCContainer* cont, HCServer* srv)
 {
   //Assert valid arguments
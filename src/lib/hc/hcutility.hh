@@ -39,6 +39,7 @@ class HCUtility
 public:
   static HCContainer* GetCont(const std::string& name, HCContainer* startcont, size_t index=0);
   static HCParameter* GetParam(const std::string& name, HCContainer* startcont, size_t index=0);
+  static uint32_t FindParams(const std::string& name, HCContainer* startcont, HCParameter** params, std::string* paths, uint32_t maxcount, uint32_t count=0, size_t index=0);
 };
 
 void HCAdd(HCParameter* param, HCContainer* cont, HCServer* srv=0);
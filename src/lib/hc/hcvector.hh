@@ -44,7 +44,7 @@ template <class T>
 class HCVec2Cli
 {
 public:
-  HCVec2Cli(HCClient* cli, uint16_t pid)
+  HCVec2Cli(HCClient* cli, uint32_t pid)
   {
     //Assert valid arguments
     assert(cli != 0);
@@ -85,7 +85,7 @@ public:
 
 private:
   HCClient* _cli;
-  uint16_t _pid;
+  uint32_t _pid;
 };
 
 //-----------------------------------------------------------------------------
@@ -128,7 +128,7 @@ public:
   virtual uint8_t GetType(void)
   {
     T val;
-    return TypeCode(val, val, val);
+    return TypeCode(val, val);
   }
 
   virtual bool IsReadable(void)
@@ -211,7 +211,7 @@ public:
     st << "\n  Scale1: " << _scale1;
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     T dummy;
 
@@ -507,7 +507,7 @@ public:
   virtual uint8_t GetType(void)
   {
     T val;
-    return TypeCode(val, val, val);
+    return TypeCode(val, val);
   }
 
   virtual bool IsReadable(void)
@@ -677,7 +677,7 @@ public:
     }
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     T dummy;
     uint32_t i;
@@ -1078,7 +1078,7 @@ template <class T>
 class HCVec3Cli
 {
 public:
-  HCVec3Cli(HCClient* cli, uint16_t pid)
+  HCVec3Cli(HCClient* cli, uint32_t pid)
   {
     //Assert valid arguments
     assert(cli != 0);
@@ -1119,7 +1119,7 @@ public:
 
 private:
   HCClient* _cli;
-  uint16_t _pid;
+  uint32_t _pid;
 };
 
 //-----------------------------------------------------------------------------
@@ -1251,7 +1251,7 @@ public:
     st << "\n  Scale2: " << _scale2;
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     T dummy;
 
@@ -1730,7 +1730,7 @@ public:
     }
   }
 
-  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint16_t pid)
+  virtual void SaveInfo(std::ofstream& file, uint32_t indent, uint32_t pid)
   {
     T dummy;
     uint32_t i;
@@ -0,0 +1,159 @@
+// HC coroutine client
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "hccoclient.hh"
+#include "const.hh"
+#include "error.hh"
+#include <cassert>
+
+HCAwaitable::HCAwaitable(HCClient* cli, uint32_t pid)
+{
+  //Assert valid arguments
+  assert(cli != 0);
+
+  //Initialize member variables
+  _cli = cli;
+  _pid = pid;
+  _sched = 0;
+}
+
+HCAwaitable::~HCAwaitable()
+{
+  //Let completing thread finish with transaction before it goes away
+  ExecutorTask::Wait(WAIT_INF);
+}
+
+void HCAwaitable::Run(void)
+{
+  //Resume awaiting task on its scheduler
+  _sched->Post(_handle);
+}
+
+bool HCAwaitable::await_ready(void)
+{
+  return false;
+}
+
+void HCAwaitable::await_suspend(std::coroutine_handle<HCTask::promise_type> handle)
+{
+  //Remember task to resume and its scheduler
+  _handle = handle;
+  _sched = handle.promise()._sched;
+  assert(_sched != 0);
+
+  //Start transaction (completion always resumes task, even on immediate failure)
+  Start();
+}
+
+int HCAwaitable::await_resume(void)
+{
+  return GetError();
+}
+
+HCCallAwaitable::HCCallAwaitable(HCClient* cli, uint32_t pid, bool indexed, uint32_t eid)
+: HCAwaitable(cli, pid)
+{
+  //Initialize member variables
+  _indexed = indexed;
+  _eid = eid;
+}
+
+int HCCallAwaitable::Start(void)
+{
+  //Start transaction
+  if(_indexed)
+    return _cli->ICall(_pid, _eid, this);
+
+  return _cli->Call(_pid, this);
+}
+
+HCReadAwaitable::HCReadAwaitable(HCClient* cli, uint32_t pid, uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len)
+: HCAwaitable(cli, pid), _len(len)
+{
+  //Initialize member variables
+  _offset = offset;
+  _val = val;
+  _maxlen = maxlen;
+}
+
+int HCReadAwaitable::Start(void)
+{
+  //Start transaction (data and length stored on completion)
+  return _cli->Read(_pid, _offset, _val, _maxlen, _len, this);
+}
+
+HCWriteAwaitable::HCWriteAwaitable(HCClient* cli, uint32_t pid, uint32_t offset, uint8_t* val, uint16_t len)
+: HCAwaitable(cli, pid)
+{
+  //Initialize member variables
+  _offset = offset;
+  _val = val;
+  _len = len;
+}
+
+int HCWriteAwaitable::Start(void)
+{
+  //Start transaction (data copied into command)
+  return _cli->Write(_pid, _offset, _val, _len, this);
+}
+
+HCCoClient::HCCoClient(HCClient* cli)
+{
+  //Assert valid arguments
+  assert(cli != 0);
+
+  //Initialize member variables
+  _cli = cli;
+}
+
+HCCoClient::~HCCoClient()
+{
+}
+
+HCClient* HCCoClient::GetClient(void)
+{
+  return _cli;
+}
+
+HCCallAwaitable HCCoClient::CallAsync(uint32_t pid)
+{
+  return HCCallAwaitable(_cli, pid);
+}
+
+HCCallAwaitable HCCoClient::ICallAsync(uint32_t pid, uint32_t eid)
+{
+  return HCCallAwaitable(_cli, pid, true, eid);
+}
+
+HCReadAwaitable HCCoClient::ReadAsync(uint32_t pid, uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len)
+{
+  return HCReadAwaitable(_cli, pid, offset, val, maxlen, len);
+}
+
+HCWriteAwaitable HCCoClient::WriteAsync(uint32_t pid, uint32_t offset, uint8_t* val, uint16_t len)
+{
+  return HCWriteAwaitable(_cli, pid, offset, val, len);
+}
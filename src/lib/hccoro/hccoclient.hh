@@ -0,0 +1,196 @@
+// HC coroutine client
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "hcasync.hh"
+#include "hcclient.hh"
+#include "hcscheduler.hh"
+#include <cassert>
+#include <coroutine>
+#include <inttypes.h>
+#include <string>
+
+//Asynchronous transaction awaited by a task (resumes it on its scheduler once the client completes it)
+class HCAwaitable : public HCAsync
+{
+public:
+  HCAwaitable(HCClient* cli, uint32_t pid);
+  HCAwaitable(const HCAwaitable&) = delete;
+  virtual ~HCAwaitable();
+  virtual void Run(void);
+  bool await_ready(void);
+  void await_suspend(std::coroutine_handle<HCTask::promise_type> handle);
+  int await_resume(void);
+
+protected:
+  virtual int Start(void) = 0;
+
+protected:
+  HCClient* _cli;
+  uint32_t _pid;
+  HCScheduler* _sched;
+  std::coroutine_handle<> _handle;
+};
+
+//Awaitable get (or indexed get if given an EID)
+template <typename T>
+class HCGetAwaitable : public HCAwaitable
+{
+public:
+  HCGetAwaitable(HCClient* cli, uint32_t pid, T& val, bool indexed=false, uint32_t eid=0)
+  : HCAwaitable(cli, pid), _val(val)
+  {
+    //Initialize member variables
+    _indexed = indexed;
+    _eid = eid;
+  }
+
+protected:
+  virtual int Start(void)
+  {
+    //Start transaction (value stored on completion)
+    if(_indexed)
+      return _cli->IGet(_pid, _eid, _val, this);
+
+    return _cli->Get(_pid, _val, this);
+  }
+
+private:
+  T& _val;
+  bool _indexed;
+  uint32_t _eid;
+};
+
+//Awaitable set (or indexed set if given an EID)
+template <typename T>
+class HCSetAwaitable : public HCAwaitable
+{
+public:
+  HCSetAwaitable(HCClient* cli, uint32_t pid, const T& val, bool indexed=false, uint32_t eid=0)
+  : HCAwaitable(cli, pid), _val(val)
+  {
+    //Initialize member variables
+    _indexed = indexed;
+    _eid = eid;
+  }
+
+protected:
+  virtual int Start(void)
+  {
+    //Start transaction (value copied into command)
+    if(_indexed)
+      return _cli->ISet(_pid, _eid, _val, this);
+
+    return _cli->Set(_pid, _val, this);
+  }
+
+private:
+  const T& _val;
+  bool _indexed;
+  uint32_t _eid;
+};
+
+//Awaitable call (or indexed call if given an EID)
+class HCCallAwaitable : public HCAwaitable
+{
+public:
+  HCCallAwaitable(HCClient* cli, uint32_t pid, bool indexed=false, uint32_t eid=0);
+
+protected:
+  virtual int Start(void);
+
+private:
+  bool _indexed;
+  uint32_t _eid;
+};
+
+//Awaitable file read
+class HCReadAwaitable : public HCAwaitable
+{
+public:
+  HCReadAwaitable(HCClient* cli, uint32_t pid, uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len);
+
+protected:
+  virtual int Start(void);
+
+private:
+  uint32_t _offset;
+  uint8_t* _val;
+  uint16_t _maxlen;
+  uint16_t& _len;
+};
+
+//Awaitable file write
+class HCWriteAwaitable : public HCAwaitable
+{
+public:
+  HCWriteAwaitable(HCClient* cli, uint32_t pid, uint32_t offset, uint8_t* val, uint16_t len);
+
+protected:
+  virtual int Start(void);
+
+private:
+  uint32_t _offset;
+  uint8_t* _val;
+  uint16_t _len;
+};
+
+//Client operations to co_await from a task (e.g. err = co_await cocli.GetAsync(pid, val))
+class HCCoClient
+{
+public:
+  HCCoClient(HCClient* cli);
+  ~HCCoClient();
+  HCClient* GetClient(void);
+  HCCallAwaitable CallAsync(uint32_t pid);
+  HCCallAwaitable ICallAsync(uint32_t pid, uint32_t eid);
+  HCReadAwaitable ReadAsync(uint32_t pid, uint32_t offset, uint8_t* val, uint16_t maxlen, uint16_t& len);
+  HCWriteAwaitable WriteAsync(uint32_t pid, uint32_t offset, uint8_t* val, uint16_t len);
+
+  template <typename T> HCGetAwaitable<T> GetAsync(uint32_t pid, T& val)
+  {
+    return HCGetAwaitable<T>(_cli, pid, val);
+  }
+
+  template <typename T> HCSetAwaitable<T> SetAsync(uint32_t pid, const T& val)
+  {
+    return HCSetAwaitable<T>(_cli, pid, val);
+  }
+
+  template <typename T> HCGetAwaitable<T> IGetAsync(uint32_t pid, uint32_t eid, T& val)
+  {
+    return HCGetAwaitable<T>(_cli, pid, val, true, eid);
+  }
+
+  template <typename T> HCSetAwaitable<T> ISetAsync(uint32_t pid, uint32_t eid, const T& val)
+  {
+    return HCSetAwaitable<T>(_cli, pid, val, true, eid);
+  }
+
+private:
+  HCClient* _cli;
+};
@@ -0,0 +1,152 @@
+// HC coroutine task and scheduler
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "hcscheduler.hh"
+#include "const.hh"
+#include <cassert>
+
+std::coroutine_handle<> HCTask::promise_type::FinalAwaiter::await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+{
+  HCScheduler* sched;
+
+  //Continue with awaiting task if there is one
+  if(handle.promise()._continuation)
+    return handle.promise()._continuation;
+
+  //Detached task owns itself so retire it from its scheduler and free it
+  if(handle.promise()._detached)
+  {
+    sched = handle.promise()._sched;
+    handle.destroy();
+    sched->Retire();
+  }
+
+  return std::noop_coroutine();
+}
+
+HCTask::HCTask(std::coroutine_handle<promise_type> handle)
+{
+  //Initialize member variables
+  _handle = handle;
+}
+
+HCTask::HCTask(HCTask&& task)
+{
+  //Take coroutine from other task
+  _handle = task._handle;
+  task._handle = nullptr;
+}
+
+HCTask::~HCTask()
+{
+  //Free coroutine if still owned
+  if(_handle)
+    _handle.destroy();
+}
+
+bool HCTask::await_ready(void)
+{
+  return false;
+}
+
+std::coroutine_handle<> HCTask::await_suspend(std::coroutine_handle<promise_type> handle)
+{
+  //Run on awaiting task's scheduler and continue it when done
+  _handle.promise()._sched = handle.promise()._sched;
+  _handle.promise()._continuation = handle;
+
+  //Start task straight away
+  return _handle;
+}
+
+int HCTask::await_resume(void)
+{
+  return _handle.promise()._result;
+}
+
+HCScheduler::HCScheduler(uint32_t depth)
+{
+  //Assert valid arguments
+  assert(depth > 0);
+
+  //Initialize member variables
+  _ready = new Queue(depth, sizeof(void*));
+  _taskcount = 0;
+}
+
+HCScheduler::~HCScheduler()
+{
+  //Cleanup
+  delete _ready;
+}
+
+uint32_t HCScheduler::GetTaskCount(void)
+{
+  return _taskcount;
+}
+
+void HCScheduler::Spawn(HCTask&& task)
+{
+  std::coroutine_handle<HCTask::promise_type> handle;
+
+  //Assert valid arguments
+  assert(task._handle);
+
+  //Take coroutine from task (it frees itself when done)
+  handle = task._handle;
+  task._handle = nullptr;
+  handle.promise()._sched = this;
+  handle.promise()._detached = true;
+  _taskcount++;
+
+  //Queue task to start
+  Post(handle);
+}
+
+void HCScheduler::Post(std::coroutine_handle<> handle)
+{
+  void* addr;
+
+  //Queue coroutine to resume (may be called from any thread)
+  addr = handle.address();
+  _ready->Write(&addr, sizeof(addr), WAIT_INF);
+}
+
+void HCScheduler::Retire(void)
+{
+  //Count detached task done
+  _taskcount--;
+}
+
+void HCScheduler::Run(void)
+{
+  void* addr;
+
+  //Resume coroutines as they become ready until every spawned task is done
+  while(_taskcount > 0)
+    if(_ready->Read(&addr, sizeof(addr), WAIT_INF) == sizeof(addr))
+      std::coroutine_handle<>::from_address(addr).resume();
+}
@@ -0,0 +1,135 @@
+// HC coroutine task and scheduler
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "queue.hh"
+#include <coroutine>
+#include <exception>
+#include <inttypes.h>
+
+class HCScheduler;
+
+//Coroutine returning an error code (started by a scheduler or by being awaited from another task)
+class HCTask
+{
+public:
+  class promise_type
+  {
+  public:
+    //Resumes awaiting task when done, or retires detached task from its scheduler
+    class FinalAwaiter
+    {
+    public:
+      bool await_ready(void) noexcept
+      {
+        return false;
+      }
+
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+
+      void await_resume(void) noexcept
+      {
+      }
+    };
+
+  public:
+    promise_type()
+    {
+      //Initialize member variables
+      _sched = 0;
+      _detached = false;
+      _result = 0;
+    }
+
+    HCTask get_return_object(void)
+    {
+      return HCTask(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend(void) noexcept
+    {
+      return std::suspend_always();
+    }
+
+    FinalAwaiter final_suspend(void) noexcept
+    {
+      return FinalAwaiter();
+    }
+
+    void return_value(int result)
+    {
+      _result = result;
+    }
+
+    void unhandled_exception(void)
+    {
+      std::terminate();
+    }
+
+  public:
+    HCScheduler* _sched;
+    std::coroutine_handle<> _continuation;
+    bool _detached;
+    int _result;
+  };
+
+public:
+  HCTask(HCTask&& task);
+  HCTask(const HCTask&) = delete;
+  ~HCTask();
+  bool await_ready(void);
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle);
+  int await_resume(void);
+
+private:
+  explicit HCTask(std::coroutine_handle<promise_type> handle);
+
+private:
+  friend class HCScheduler;
+  std::coroutine_handle<promise_type> _handle;
+};
+
+//Single threaded scheduler resuming tasks as their transactions complete
+class HCScheduler
+{
+public:
+  //Default number of resumptions that can be waiting at once
+  static const uint32_t DEPTH_DEFAULT = 1024;
+
+public:
+  HCScheduler(uint32_t depth=DEPTH_DEFAULT);
+  ~HCScheduler();
+  uint32_t GetTaskCount(void);
+  void Spawn(HCTask&& task);
+  void Post(std::coroutine_handle<> handle);
+  void Retire(void);
+  void Run(void);
+
+private:
+  Queue* _ready;
+  uint32_t _taskcount;
+};
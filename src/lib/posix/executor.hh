@@ -0,0 +1,142 @@
+// Executor
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "const.hh"
+#include "queue.hh"
+#include "thread.hh"
+#include <inttypes.h>
+
+//Unit of work run by an executor (owned by the submitter, which must not wait on it from inside another task)
+class ExecutorTask
+{
+public:
+  ExecutorTask();
+  virtual ~ExecutorTask();
+  virtual void Run(void) = 0;
+  void Arm(void);
+  void Execute(void);
+  int Wait(uint32_t msecs=WAIT_INF);
+
+private:
+  //Completion states
+  static const uint32_t STATE_PENDING = 0;
+  static const uint32_t STATE_WAITED = 1;
+  static const uint32_t STATE_DONE = 2;
+
+private:
+  uint32_t _state;
+};
+
+//Task that calls a method of an object
+template <class T>
+class ExecutorMethod : public ExecutorTask
+{
+public:
+  //Signature of method to run as task
+  typedef void (T::*TaskMethod)(void);
+
+public:
+  ExecutorMethod(T* object, TaskMethod method)
+  {
+    //Assert valid arguments
+    assert((object != 0) && (method != 0));
+
+    //Initialize object and method pointers
+    _object = object;
+    _method = method;
+  }
+
+  virtual ~ExecutorMethod()
+  {
+  }
+
+  virtual void Run(void)
+  {
+    //Call the task method
+    (_object->*_method)();
+  }
+
+private:
+  T* _object;
+  TaskMethod _method;
+};
+
+class Executor;
+
+class ExecutorWorker
+{
+public:
+  ExecutorWorker(Executor* exec, uint32_t index, int core);
+  ~ExecutorWorker();
+  void Start(void);
+  void Join(void);
+
+private:
+  void WorkThread(void);
+
+private:
+  Executor* _exec;
+  uint32_t _index;
+  Thread<ExecutorWorker>* _thread;
+};
+
+class Executor
+{
+public:
+  //Default number of tasks each worker queue holds
+  static const uint32_t DEPTH_DEFAULT = 1024;
+
+public:
+  Executor(uint32_t workers=0, bool pin=false, uint32_t depth=DEPTH_DEFAULT);
+  ~Executor();
+  uint32_t GetWorkerCount(void);
+  int GetSubmitCount(uint32_t& val);
+  int GetRunCount(uint32_t& val);
+  int GetStealCount(uint32_t& val);
+  int GetOverflowCount(uint32_t& val);
+  int Submit(ExecutorTask* task);
+  void Shutdown(void);
+  void Work(uint32_t index);
+
+private:
+  ExecutorTask* Take(uint32_t index);
+
+private:
+  uint32_t _workercount;
+  Queue** _queues;
+  ExecutorWorker** _workers;
+  QueueWaiter _idle;
+  uint32_t _next;
+  uint32_t _pending;
+  bool _stopping;
+  bool _joined;
+  uint32_t _submitcount;
+  uint32_t _runcount;
+  uint32_t _stealcount;
+  uint32_t _overflowcount;
+};
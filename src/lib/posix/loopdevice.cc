@@ -0,0 +1,315 @@
+// Loopback device
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "const.hh"
+#include "error.hh"
+#include "loopdevice.hh"
+#include "thread.hh"
+#include <cassert>
+#include <string.h>
+#include <time.h>
+
+//Size (bytes) of send time stamp in front of each queued message
+static const uint32_t STAMP_SIZE = sizeof(uint64_t);
+
+LoopDevice::LoopDevice(LoopDevice* peer, uint32_t bufcount, uint32_t bufsiz)
+: Device()
+{
+  //Assert valid arguments
+  assert((bufcount > 0) && (bufsiz > 0));
+
+  //Initialize member variables
+  _peer = peer;
+  _queue = new SPSCQueue(bufcount, STAMP_SIZE + bufsiz);
+  _txmutex = new Mutex();
+  _txbuf = new uint8_t[STAMP_SIZE + bufsiz];
+  _bufsiz = bufsiz;
+  _latency = 0;
+  _loss = 0;
+  _reorder = 0;
+  _rand = 1;
+  _dropcount = 0;
+  _next.buf = new uint8_t[STAMP_SIZE + bufsiz];
+  _next.len = 0;
+  _next.due = 0;
+  _held.buf = new uint8_t[STAMP_SIZE + bufsiz];
+  _held.len = 0;
+  _held.due = 0;
+
+  //Link peer back to this device to complete the pair
+  if(_peer != 0)
+    _peer->_peer = this;
+}
+
+LoopDevice::~LoopDevice()
+{
+  //Unlink peer (its writes are dropped from now on)
+  if(_peer != 0)
+    _peer->_peer = 0;
+
+  //Cleanup
+  delete[] _held.buf;
+  delete[] _next.buf;
+  delete[] _txbuf;
+  delete _txmutex;
+  delete _queue;
+}
+
+void LoopDevice::SetLatency(uint32_t usecs)
+{
+  //Set delay added to each message received
+  _latency = usecs;
+}
+
+void LoopDevice::SetLoss(uint32_t ppm)
+{
+  //Set fraction of received messages dropped
+  _loss = (ppm > RATE_SCALE) ? RATE_SCALE : ppm;
+}
+
+void LoopDevice::SetReorder(uint32_t ppm)
+{
+  //Set fraction of received messages held back for a later message to overtake
+  _reorder = (ppm > RATE_SCALE) ? RATE_SCALE : ppm;
+}
+
+void LoopDevice::SetSeed(uint32_t seed)
+{
+  //Seed loss and reorder decisions (zero would stick the generator)
+  _rand = (seed == 0) ? 1 : seed;
+}
+
+uint32_t LoopDevice::Read(void* buf, uint32_t maxlen)
+{
+  Slot* slot;
+  uint8_t* tmp;
+  uint64_t now;
+  uint32_t len;
+
+  //Assert valid arguments
+  assert((buf != 0) && (maxlen > 0));
+
+  while(true)
+  {
+    //Block until a message is due (like a socket read)
+    WaitReadable(WAIT_INF);
+
+    //Get current time
+    now = ThreadTimeUS();
+
+    //Take next message off queue if none is waiting
+    if(_next.len == 0)
+      Fetch(_next, WAIT_NONE);
+
+    //Check for held message that is due (overtaken or held long enough)
+    if((_held.len != 0) && (_held.due <= now))
+    {
+      slot = &_held;
+    }
+    else if((_next.len != 0) && (_next.due <= now))
+    {
+      //Check for reorder injected (only one message held back at a time)
+      if((_held.len == 0) && Roll(_reorder))
+      {
+        //Hold message back by swapping buffers
+        tmp = _held.buf;
+        _held.buf = _next.buf;
+        _held.len = _next.len;
+        _held.due = now + HOLD_TIME;
+        _next.buf = tmp;
+        _next.len = 0;
+
+        //Take another message off queue and check for none due to overtake held message (wait for one)
+        if(!Fetch(_next, WAIT_NONE) || (_next.due > now))
+          continue;
+      }
+
+      //Release any held message right after this one
+      if(_held.len != 0)
+        _held.due = now;
+
+      slot = &_next;
+    }
+    else
+    {
+      //Nothing due yet
+      continue;
+    }
+
+    //Mark slot empty
+    len = slot->len;
+    slot->len = 0;
+
+    //Check for message too big for caller's buffer
+    if(len > maxlen)
+    {
+      __atomic_add_fetch(&_dropcount, 1, __ATOMIC_RELAXED);
+      return 0;
+    }
+
+    //Copy message to caller's buffer
+    memcpy(buf, slot->buf + STAMP_SIZE, len);
+
+    return len;
+  }
+}
+
+uint32_t LoopDevice::Write(const void* buf, uint32_t len)
+{
+  uint64_t now;
+  LoopDevice* peer;
+
+  //Assert valid arguments
+  assert(buf != 0);
+
+  //Check for message too big
+  if(len > _bufsiz)
+    return 0;
+
+  //Begin mutual exclusion of send buffer
+  _txmutex->Wait();
+
+  //Check for no peer
+  if((peer = _peer) == 0)
+  {
+    _txmutex->Give();
+    return 0;
+  }
+
+  //Stamp message with send time (receiver adds its latency to this)
+  now = ThreadTimeUS();
+  memcpy(_txbuf, &now, STAMP_SIZE);
+  memcpy(_txbuf + STAMP_SIZE, buf, len);
+
+  //Queue message toward peer without waiting (full queue drops it like a full socket buffer)
+  if(peer->_queue->Write(_txbuf, STAMP_SIZE + len, WAIT_NONE) == 0)
+    __atomic_add_fetch(&peer->_dropcount, 1, __ATOMIC_RELAXED);
+
+  //End mutual exclusion of send buffer
+  _txmutex->Give();
+
+  return len;
+}
+
+int LoopDevice::GetDropCount(uint32_t& val)
+{
+  //Get messages lost to a full queue, injected loss or a short read buffer
+  val = __atomic_load_n(&_dropcount, __ATOMIC_RELAXED);
+
+  return ERR_NONE;
+}
+
+int LoopDevice::WaitReadable(uint32_t msecs)
+{
+  uint64_t deadline;
+  uint64_t wake;
+  uint64_t now;
+
+  //Calculate time to give up
+  deadline = ThreadTimeUS() + (uint64_t)msecs * 1000;
+
+  while(true)
+  {
+    //Take message off queue if none taken off yet (so a zero wait still sees queued messages)
+    if(_next.len == 0)
+      Fetch(_next, WAIT_NONE);
+
+    //Check for a message already due
+    now = ThreadTimeUS();
+    if(((_next.len != 0) && (_next.due <= now)) || ((_held.len != 0) && (_held.due <= now)))
+      return ERR_NONE;
+
+    //Check for timeout
+    if(now >= deadline)
+      return ERR_TIMEOUT;
+
+    //Determine earliest time a waiting message becomes due
+    wake = deadline;
+    if((_next.len != 0) && (_next.due < wake))
+      wake = _next.due;
+    if((_held.len != 0) && (_held.due < wake))
+      wake = _held.due;
+
+    //Wait for a message on the queue if none taken off yet, otherwise sleep until one is due
+    if(_next.len == 0)
+      Fetch(_next, (uint32_t)((wake - now + 999) / 1000));
+    else
+      SleepUntil(wake);
+  }
+}
+
+bool LoopDevice::Fetch(Slot& slot, uint32_t msecs)
+{
+  uint32_t rlen;
+  uint64_t sent;
+
+  //Take message off queue and check for none
+  if((rlen = _queue->Read(slot.buf, STAMP_SIZE + _bufsiz, msecs)) < STAMP_SIZE)
+    return false;
+
+  //Check for loss injected
+  if(Roll(_loss))
+  {
+    __atomic_add_fetch(&_dropcount, 1, __ATOMIC_RELAXED);
+    return false;
+  }
+
+  //Message becomes readable once latency has passed since it was sent
+  memcpy(&sent, slot.buf, STAMP_SIZE);
+  slot.len = rlen - STAMP_SIZE;
+  slot.due = sent + _latency;
+
+  return true;
+}
+
+bool LoopDevice::Roll(uint32_t ppm)
+{
+  //Check for impairment disabled (keeps generator sequence independent of unused rates)
+  if(ppm == 0)
+    return false;
+
+  //Advance xorshift generator
+  _rand ^= _rand << 13;
+  _rand ^= _rand >> 17;
+  _rand ^= _rand << 5;
+
+  return (_rand % RATE_SCALE) < ppm;
+}
+
+void LoopDevice::SleepUntil(uint64_t time)
+{
+  struct timespec ts;
+  uint64_t now;
+
+  //Check for time already passed
+  if((now = ThreadTimeUS()) >= time)
+    return;
+
+  //Sleep for remaining time
+  ts.tv_sec = (time - now) / 1000000;
+  ts.tv_nsec = ((time - now) % 1000000) * 1000;
+  nanosleep(&ts, 0);
+}
@@ -0,0 +1,86 @@
+// Loopback device
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "device.hh"
+#include "mutex.hh"
+#include "queue.hh"
+#include <inttypes.h>
+
+class LoopDevice : public Device
+{
+public:
+  //Default number and size (bytes) of messages queued toward each device
+  static const uint32_t BUF_COUNT_DEFAULT = 256;
+  static const uint32_t BUF_SIZE_DEFAULT = 2048;
+
+  //Time (us) a reordered message waits for a later message to overtake it
+  static const uint32_t HOLD_TIME = 1000;
+
+  //Denominator of loss and reorder rates (parts per million)
+  static const uint32_t RATE_SCALE = 1000000;
+
+public:
+  LoopDevice(LoopDevice* peer=0, uint32_t bufcount=BUF_COUNT_DEFAULT, uint32_t bufsiz=BUF_SIZE_DEFAULT);
+  virtual ~LoopDevice();
+  void SetLatency(uint32_t usecs);
+  void SetLoss(uint32_t ppm);
+  void SetReorder(uint32_t ppm);
+  void SetSeed(uint32_t seed);
+  virtual uint32_t Read(void* buf, uint32_t maxlen);
+  virtual uint32_t Write(const void* buf, uint32_t len);
+  virtual int GetDropCount(uint32_t& val);
+  virtual int WaitReadable(uint32_t msecs);
+
+private:
+  //Message taken off the queue but not yet returned by a read
+  struct Slot
+  {
+    uint8_t* buf;
+    uint32_t len;
+    uint64_t due;
+  };
+
+private:
+  bool Fetch(Slot& slot, uint32_t msecs);
+  bool Roll(uint32_t ppm);
+  void SleepUntil(uint64_t time);
+
+private:
+  LoopDevice* _peer;
+  SPSCQueue* _queue;
+  Mutex* _txmutex;
+  uint8_t* _txbuf;
+  uint32_t _bufsiz;
+  uint32_t _latency;
+  uint32_t _loss;
+  uint32_t _reorder;
+  uint32_t _rand;
+  uint32_t _dropcount;
+  Slot _next;
+  Slot _held;
+};
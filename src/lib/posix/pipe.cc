@@ -25,8 +25,11 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "pipe.hh"
+#include "const.hh"
 #include "error.hh"
+#include "thread.hh"
 #include <cassert>
+#include <string.h>
 
 Pipe::Pipe(uint32_t size)
 {
@@ -180,3 +183,216 @@ uint32_t Pipe::Write(const void* buf, uint32_t len, uint32_t msecs)
 
   return len;
 }
+
+SPSCPipe::SPSCPipe(uint32_t size)
+{
+  //Assert valid arguments
+  assert(size > 0);
+
+  //Initialize member variables
+  _size = size;
+  _buffer = new uint8_t[size];
+
+  //Set pipe empty
+  Reset();
+}
+
+SPSCPipe::~SPSCPipe()
+{
+  //Cleanup
+  delete[] _buffer;
+}
+
+void SPSCPipe::Reset(void)
+{
+  //Reset write and read positions
+  _wrpos = 0;
+  _rdpos = 0;
+}
+
+uint32_t SPSCPipe::GetCount(void)
+{
+  //Bytes written but not yet consumed
+  return (uint32_t)(__atomic_load_n(&_wrpos, __ATOMIC_ACQUIRE) - __atomic_load_n(&_rdpos, __ATOMIC_ACQUIRE));
+}
+
+uint32_t SPSCPipe::Read(void* buf, uint32_t maxlen, uint32_t msecs)
+{
+  uint32_t off;
+  uint32_t len;
+  uint32_t part;
+
+  //Assert valid arguments
+  assert((buf != 0) && (maxlen > 0));
+
+  //Wait for data to become available
+  if((len = WaitData(msecs)) == 0)
+    return 0;
+
+  //Limit the amount of bytes to be read
+  if(maxlen < len)
+    len = maxlen;
+
+  //Copy the data (in two parts when it wraps)
+  off = _rdpos % _size;
+  part = (len < (_size - off)) ? len : (_size - off);
+  memcpy(buf, &_buffer[off], part);
+  memcpy((uint8_t*)buf + part, _buffer, len - part);
+
+  //Hand space back to writer
+  Consume(len);
+
+  return len;
+}
+
+uint32_t SPSCPipe::Write(const void* buf, uint32_t len, uint32_t msecs)
+{
+  uint32_t off;
+  uint32_t part;
+
+  //Assert valid arguments
+  assert((buf != 0) && (len > 0));
+
+  //Check for overflow
+  if(len > _size)
+    return 0;
+
+  //Wait for free space
+  if(WaitSpace(len, msecs) == 0)
+    return 0;
+
+  //Copy the data (in two parts when it wraps)
+  off = _wrpos % _size;
+  part = (len < (_size - off)) ? len : (_size - off);
+  memcpy(&_buffer[off], buf, part);
+  memcpy(_buffer, (const uint8_t*)buf + part, len - part);
+
+  //Publish data to reader
+  Commit(len);
+
+  return len;
+}
+
+uint32_t SPSCPipe::Peek(const uint8_t*& buf, uint32_t msecs)
+{
+  uint32_t off;
+  uint32_t len;
+
+  //Wait for data to become available
+  if((len = WaitData(msecs)) == 0)
+    return 0;
+
+  //Point at readable bytes up to the end of the ring
+  off = _rdpos % _size;
+  buf = &_buffer[off];
+
+  return (len < (_size - off)) ? len : (_size - off);
+}
+
+void SPSCPipe::Consume(uint32_t len)
+{
+  //Check for nothing consumed
+  if(len == 0)
+    return;
+
+  //Hand space back to writer (only the reader moves read position)
+  __atomic_store_n(&_rdpos, _rdpos + len, __ATOMIC_RELEASE);
+
+  //Wake writer if waiting for free space
+  _notfull.Wake();
+}
+
+uint32_t SPSCPipe::Reserve(uint8_t*& buf, uint32_t msecs)
+{
+  uint32_t off;
+  uint32_t len;
+
+  //Wait for free space
+  if((len = WaitSpace(1, msecs)) == 0)
+    return 0;
+
+  //Point at free bytes up to the end of the ring
+  off = _wrpos % _size;
+  buf = &_buffer[off];
+
+  return (len < (_size - off)) ? len : (_size - off);
+}
+
+void SPSCPipe::Commit(uint32_t len)
+{
+  //Check for nothing committed
+  if(len == 0)
+    return;
+
+  //Publish data to reader (only the writer moves write position)
+  __atomic_store_n(&_wrpos, _wrpos + len, __ATOMIC_RELEASE);
+
+  //Wake reader if waiting for data
+  _notempty.Wake();
+}
+
+uint32_t SPSCPipe::WaitData(uint32_t msecs)
+{
+  uint64_t deadline;
+  uint32_t spin;
+  uint32_t key;
+  uint32_t len;
+
+  //Spin briefly before sleeping since the writer is usually close behind (just check once if not waiting)
+  for(spin=0; spin<((msecs == WAIT_NONE) ? 1 : SPIN_COUNT); spin++)
+    if((len = (uint32_t)(__atomic_load_n(&_wrpos, __ATOMIC_ACQUIRE) - _rdpos)) != 0)
+      return len;
+
+  //Check for no waiting
+  if(msecs == WAIT_NONE)
+    return 0;
+
+  //Calculate time to give up (zero means never)
+  deadline = (msecs == WAIT_INF) ? 0 : ThreadTimeUS() + (uint64_t)msecs * 1000;
+
+  //Keep checking until data arrives or time runs out
+  while(true)
+  {
+    //Arm waiter then recheck so a write made meanwhile is not slept through
+    key = _notempty.Begin();
+    if((len = (uint32_t)(__atomic_load_n(&_wrpos, __ATOMIC_ACQUIRE) - _rdpos)) != 0)
+      return len;
+
+    //Sleep until woken and check for time up
+    if(_notempty.Sleep(key, deadline) != ERR_NONE)
+      return 0;
+  }
+}
+
+uint32_t SPSCPipe::WaitSpace(uint32_t need, uint32_t msecs)
+{
+  uint64_t deadline;
+  uint32_t spin;
+  uint32_t key;
+  uint32_t len;
+
+  //Spin briefly before sleeping since the reader is usually close behind (just check once if not waiting)
+  for(spin=0; spin<((msecs == WAIT_NONE) ? 1 : SPIN_COUNT); spin++)
+    if((len = _size - (uint32_t)(_wrpos - __atomic_load_n(&_rdpos, __ATOMIC_ACQUIRE))) >= need)
+      return len;
+
+  //Check for no waiting
+  if(msecs == WAIT_NONE)
+    return 0;
+
+  //Calculate time to give up (zero means never)
+  deadline = (msecs == WAIT_INF) ? 0 : ThreadTimeUS() + (uint64_t)msecs * 1000;
+
+  //Keep checking until space frees up or time runs out
+  while(true)
+  {
+    //Arm waiter then recheck so a read made meanwhile is not slept through
+    key = _notfull.Begin();
+    if((len = _size - (uint32_t)(_wrpos - __atomic_load_n(&_rdpos, __ATOMIC_ACQUIRE))) >= need)
+      return len;
+
+    //Sleep until woken and check for time up
+    if(_notfull.Sleep(key, deadline) != ERR_NONE)
+      return 0;
+  }
+}
@@ -25,170 +25,353 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "queue.hh"
+#include "const.hh"
 #include "error.hh"
+#include "thread.hh"
 #include <cassert>
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+QueueWaiter::QueueWaiter()
+{
+  //Initialize member variables
+  _word = 0;
+  _armed = 0;
+}
+
+QueueWaiter::~QueueWaiter()
+{
+}
+
+uint32_t QueueWaiter::Begin(void)
+{
+  uint32_t key;
+
+  //Sample word before arming so any wake after this point changes it
+  key = __atomic_load_n(&_word, __ATOMIC_SEQ_CST);
+  __atomic_store_n(&_armed, 1, __ATOMIC_SEQ_CST);
+
+  //Keep caller's recheck of the queue from moving ahead of arming (pairs with fence in Wake)
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  return key;
+}
+
+int QueueWaiter::Sleep(uint32_t key, uint64_t deadline)
+{
+  struct timespec ts;
+  uint64_t now;
+
+  //Check for finite wait
+  if(deadline != 0)
+  {
+    //Check for time already up
+    if((now = ThreadTimeUS()) >= deadline)
+      return ERR_TIMEOUT;
+
+    ts.tv_sec = (deadline - now) / 1000000;
+    ts.tv_nsec = ((deadline - now) % 1000000) * 1000;
+  }
+
+  //Sleep until woken or time runs out (returns at once if word already moved past key)
+  if((syscall(SYS_futex, &_word, FUTEX_WAIT_PRIVATE, key, (deadline == 0) ? 0 : &ts, 0, 0) != 0) && (errno == ETIMEDOUT))
+    return ERR_TIMEOUT;
+
+  return ERR_NONE;
+}
+
+void QueueWaiter::Wake(void)
+{
+  //Order caller's publish before checking for waiters (pairs with arming in Begin)
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  //Only pay for a system call when someone is asleep (first waker disarms so the rest skip it)
+  if(__atomic_load_n(&_armed, __ATOMIC_SEQ_CST) == 0)
+    return;
+
+  if(__atomic_exchange_n(&_armed, 0, __ATOMIC_SEQ_CST) == 0)
+    return;
+
+  //Move word past any sampled key and wake all waiters (each rechecks the queue and rearms)
+  __atomic_add_fetch(&_word, 1, __ATOMIC_SEQ_CST);
+  syscall(SYS_futex, &_word, FUTEX_WAKE_PRIVATE, INT_MAX, 0, 0, 0);
+}
 
-QueueBuffer::QueueBuffer(uint32_t size)
+Queue::Queue(uint32_t bufcount, uint32_t bufsiz)
 {
   //Assert valid arguments
-  assert(size > 0);
+  assert((bufcount > 0) && (bufsiz > 0));
 
   //Initialize member variables
-  _buffer = new uint8_t[size];
-  _size = size;
-  _head = 0;
+  _bufcount = bufcount;
+  _bufsiz = bufsiz;
+  _cells = new Cell[bufcount];
+  _buffers = new uint8_t[(uint64_t)bufcount * bufsiz];
+
+  //Set all buffers empty
+  Reset();
 }
 
-QueueBuffer::~QueueBuffer()
+Queue::~Queue()
 {
-  //Deallocate memory for the queue buffer
-  delete[] _buffer;
+  //Cleanup
+  delete[] _buffers;
+  delete[] _cells;
 }
 
-void QueueBuffer::Reset(void)
+void Queue::Reset(void)
 {
-  //Reset the head
-  _head = 0;
+  uint32_t i;
+
+  //Each buffer is ready to be written on the first lap
+  for(i=0; i<_bufcount; i++)
+  {
+    _cells[i].seq = i;
+    _cells[i].len = 0;
+  }
+
+  //Reset read and write positions
+  _wrpos = 0;
+  _rdpos = 0;
 }
 
-uint32_t QueueBuffer::Read(void* buf, uint32_t maxlen)
+uint32_t Queue::Read(void* buf, uint32_t maxlen, uint32_t msecs)
 {
-  uint32_t i;
+  uint64_t deadline;
+  uint32_t spin;
+  uint32_t key;
+  uint32_t len;
 
   //Assert valid arguments
   assert((buf != 0) && (maxlen > 0));
 
-  //Check for overflow
-  if((maxlen < _head) || (_head == 0))
+  //Nothing read yet
+  len = 0;
+
+  //Calculate time to give up (zero means never)
+  deadline = ((msecs == WAIT_NONE) || (msecs == WAIT_INF)) ? 0 : ThreadTimeUS() + (uint64_t)msecs * 1000;
+
+  //Check once without waiting
+  if((msecs == WAIT_NONE) && !TryRead(buf, maxlen, len))
     return 0;
 
-  //Copy remaining data
-  for(i=0; i<_head; i++)
-    *((uint8_t*)buf + i) = *(_buffer + i);
+  //Spin briefly before sleeping since the writer is usually close behind
+  for(spin=0; (msecs != WAIT_NONE) && (spin < SPIN_COUNT) && !TryRead(buf, maxlen, len); spin++);
 
-  //Reset head
-  _head = 0;
+  //Keep trying until a buffer is read or time runs out
+  while((spin == SPIN_COUNT) && !TryRead(buf, maxlen, len))
+  {
+    //Arm waiter then retry so a write made meanwhile is not slept through
+    key = _notempty.Begin();
+    if(TryRead(buf, maxlen, len))
+      break;
+
+    //Sleep until woken and check for time up
+    if(_notempty.Sleep(key, deadline) != ERR_NONE)
+      return 0;
+  }
+
+  //Wake any writer waiting for an empty buffer
+  _notfull.Wake();
 
-  return i;
+  return len;
 }
 
-uint32_t QueueBuffer::Write(const void* buf, uint32_t len)
+uint32_t Queue::Write(const void* buf, uint32_t len, uint32_t msecs)
 {
-  uint32_t i;
+  uint64_t deadline;
+  uint32_t spin;
+  uint32_t key;
 
   //Assert valid arguments
   assert((buf != 0) && (len > 0));
 
   //Check for overflow
-  if((_head != 0) || (len > _size))
+  if(len > _bufsiz)
+    return 0;
+
+  //Calculate time to give up (zero means never)
+  deadline = ((msecs == WAIT_NONE) || (msecs == WAIT_INF)) ? 0 : ThreadTimeUS() + (uint64_t)msecs * 1000;
+
+  //Check once without waiting
+  if((msecs == WAIT_NONE) && !TryWrite(buf, len))
     return 0;
 
-  //Copy data
-  for(i=0; i<len; i++)
-    *(_buffer + i) = *((uint8_t*)buf + i);
+  //Spin briefly before sleeping since the reader is usually close behind
+  for(spin=0; (msecs != WAIT_NONE) && (spin < SPIN_COUNT) && !TryWrite(buf, len); spin++);
+
+  //Keep trying until a buffer is written or time runs out
+  while((spin == SPIN_COUNT) && !TryWrite(buf, len))
+  {
+    //Arm waiter then retry so a read made meanwhile is not slept through
+    key = _notfull.Begin();
+    if(TryWrite(buf, len))
+      break;
+
+    //Sleep until woken and check for time up
+    if(_notfull.Sleep(key, deadline) != ERR_NONE)
+      return 0;
+  }
 
-  //Adjust head
-  _head = len;
+  //Wake any reader waiting for a full buffer
+  _notempty.Wake();
 
   return len;
 }
 
-Queue::Queue(uint32_t bufcount, uint32_t bufsiz)
+bool Queue::TryRead(void* buf, uint32_t maxlen, uint32_t& len)
 {
-  uint32_t i;
+  Cell* cell;
+  uint64_t pos;
+  uint64_t seq;
+
+  //Claim oldest written buffer (retrying when another reader claims it first)
+  pos = __atomic_load_n(&_rdpos, __ATOMIC_RELAXED);
+  while(true)
+  {
+    cell = &_cells[pos % _bufcount];
+    seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+
+    //Check for buffer not yet written on this lap (queue empty)
+    if(seq < pos + 1)
+      return false;
+
+    //Check for buffer written and try to claim it (failed claim reloads position)
+    if((seq == pos + 1) && __atomic_compare_exchange_n(&_rdpos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      break;
+
+    //Another reader got there first
+    if(seq != pos + 1)
+      pos = __atomic_load_n(&_rdpos, __ATOMIC_RELAXED);
+  }
+
+  //Copy buffer out (message that does not fit is dropped)
+  len = (cell->len <= maxlen) ? cell->len : 0;
+  memcpy(buf, &_buffers[(pos % _bufcount) * _bufsiz], len);
+
+  //Hand buffer back to writers for next lap
+  __atomic_store_n(&cell->seq, pos + _bufcount, __ATOMIC_RELEASE);
+
+  return true;
+}
+
+bool Queue::TryWrite(const void* buf, uint32_t len)
+{
+  Cell* cell;
+  uint64_t pos;
+  uint64_t seq;
+
+  //Claim next empty buffer (retrying when another writer claims it first)
+  pos = __atomic_load_n(&_wrpos, __ATOMIC_RELAXED);
+  while(true)
+  {
+    cell = &_cells[pos % _bufcount];
+    seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+
+    //Check for buffer not yet read on last lap (queue full)
+    if(seq < pos)
+      return false;
+
+    //Check for buffer empty and try to claim it (failed claim reloads position)
+    if((seq == pos) && __atomic_compare_exchange_n(&_wrpos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      break;
+
+    //Another writer got there first
+    if(seq != pos)
+      pos = __atomic_load_n(&_wrpos, __ATOMIC_RELAXED);
+  }
+
+  //Copy buffer in
+  memcpy(&_buffers[(pos % _bufcount) * _bufsiz], buf, len);
+  cell->len = len;
+
+  //Publish buffer to readers
+  __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+
+  return true;
+}
 
+SPSCQueue::SPSCQueue(uint32_t bufcount, uint32_t bufsiz)
+{
   //Assert valid arguments
   assert((bufcount > 0) && (bufsiz > 0));
 
   //Initialize member variables
-  _bufarray = new QueueBuffer*[bufcount];
   _bufcount = bufcount;
   _bufsiz = bufsiz;
+  _lens = new uint32_t[bufcount];
+  _buffers = new uint8_t[(uint64_t)bufcount * bufsiz];
 
-  for(i=0; i<_bufcount; i++)
-    _bufarray[i] = new QueueBuffer(_bufsiz);
-
-  _wrbufind = 0;
-  _rdbufind = 0;
-  _writebuf = _bufarray[_wrbufind];
-  _readbuf = _bufarray[_rdbufind];
-  _mutex = new Mutex();
-  _emptysem = new Semaphore(bufcount);
-  _fullsem = new Semaphore(0);
+  //Set all buffers empty
+  Reset();
 }
 
-Queue::~Queue()
+SPSCQueue::~SPSCQueue()
 {
-  uint32_t i;
-
-  //Destroy the mutex and synchronizing semaphores
-  delete _mutex;
-  delete _emptysem;
-  delete _fullsem;
-
-  //Destroy the buffers
-  for(i=0; i<_bufcount; i++)
-    delete _bufarray[i];
-
-  //Deallocate memory for the buffer array
-  delete[] _bufarray;
+  //Cleanup
+  delete[] _buffers;
+  delete[] _lens;
 }
 
-void Queue::Reset(void)
+void SPSCQueue::Reset(void)
 {
-  uint32_t i;
-
-  //Reset the buffers
-  for(i=0; i<_bufcount; i++)
-    _bufarray[i]->Reset();
-
-  //Reset queue fields
-  _wrbufind = 0;
-  _rdbufind = 0;
-  _writebuf = _bufarray[_wrbufind];
-  _readbuf = _bufarray[_rdbufind];
-
-  //Reset the mutex and synchronizing semaphores
-  _mutex->Reset();
-  _emptysem->Reset();
-  _fullsem->Reset();
+  //Reset head and tail
+  _head = 0;
+  _tail = 0;
 }
 
-uint32_t Queue::Read(void* buf, uint32_t maxlen, uint32_t msecs)
+uint32_t SPSCQueue::Read(void* buf, uint32_t maxlen, uint32_t msecs)
 {
-  uint32_t retval;
+  uint64_t deadline;
+  uint32_t spin;
+  uint32_t key;
+  uint32_t len;
 
   //Assert valid arguments
   assert((buf != 0) && (maxlen > 0));
 
-  //Wait for a full buffer
-  if(_fullsem->Wait(msecs) != ERR_NONE)
-    return 0;
+  //Nothing read yet
+  len = 0;
 
-  //Begin mutual exclusion
-  _mutex->Wait();
+  //Calculate time to give up (zero means never)
+  deadline = ((msecs == WAIT_NONE) || (msecs == WAIT_INF)) ? 0 : ThreadTimeUS() + (uint64_t)msecs * 1000;
 
-  //Read from the current read buffer
-  retval = _readbuf->Read(buf, maxlen);
+  //Check once without waiting
+  if((msecs == WAIT_NONE) && !TryRead(buf, maxlen, len))
+    return 0;
 
-  //Advance the read buffer
-  if(++_rdbufind >= _bufcount)
-    _rdbufind = 0;
+  //Spin briefly before sleeping since the writer is usually close behind
+  for(spin=0; (msecs != WAIT_NONE) && (spin < SPIN_COUNT) && !TryRead(buf, maxlen, len); spin++);
 
-  _readbuf = _bufarray[_rdbufind];
+  //Keep trying until a buffer is read or time runs out
+  while((spin == SPIN_COUNT) && !TryRead(buf, maxlen, len))
+  {
+    //Arm waiter then retry so a write made meanwhile is not slept through
+    key = _notempty.Begin();
+    if(TryRead(buf, maxlen, len))
+      break;
 
-  //End mutual exclusion
-  _mutex->Give();
+    //Sleep until woken and check for time up
+    if(_notempty.Sleep(key, deadline) != ERR_NONE)
+      return 0;
+  }
 
-  //Give the empty semaphore
-  _emptysem->Give();
+  //Wake writer if waiting for an empty buffer
+  _notfull.Wake();
 
-  return retval;
+  return len;
 }
 
-uint32_t Queue::Write(const void* buf, uint32_t len, uint32_t msecs)
+uint32_t SPSCQueue::Write(const void* buf, uint32_t len, uint32_t msecs)
 {
-  uint32_t retval;
+  uint64_t deadline;
+  uint32_t spin;
+  uint32_t key;
 
   //Assert valid arguments
   assert((buf != 0) && (len > 0));
@@ -197,27 +380,73 @@ uint32_t Queue::Write(const void* buf, uint32_t len, uint32_t msecs)
   if(len > _bufsiz)
     return 0;
 
-  //Wait for an empty buffer
-  if(_emptysem->Wait(msecs) != ERR_NONE)
+  //Calculate time to give up (zero means never)
+  deadline = ((msecs == WAIT_NONE) || (msecs == WAIT_INF)) ? 0 : ThreadTimeUS() + (uint64_t)msecs * 1000;
+
+  //Check once without waiting
+  if((msecs == WAIT_NONE) && !TryWrite(buf, len))
     return 0;
 
-  //Begin mutual exclusion
-  _mutex->Wait();
+  //Spin briefly before sleeping since the reader is usually close behind
+  for(spin=0; (msecs != WAIT_NONE) && (spin < SPIN_COUNT) && !TryWrite(buf, len); spin++);
+
+  //Keep trying until a buffer is written or time runs out
+  while((spin == SPIN_COUNT) && !TryWrite(buf, len))
+  {
+    //Arm waiter then retry so a read made meanwhile is not slept through
+    key = _notfull.Begin();
+    if(TryWrite(buf, len))
+      break;
+
+    //Sleep until woken and check for time up
+    if(_notfull.Sleep(key, deadline) != ERR_NONE)
+      return 0;
+  }
 
-  //Write to the current write buffer
-  retval = _writebuf->Write(buf, len);
+  //Wake reader if waiting for a full buffer
+  _notempty.Wake();
 
-  //Advance the write buffer
-  if(++_wrbufind >= _bufcount)
-    _wrbufind = 0;
+  return len;
+}
+
+bool SPSCQueue::TryRead(void* buf, uint32_t maxlen, uint32_t& len)
+{
+  uint64_t tail;
+  uint32_t ind;
+
+  //Check for empty (only the writer moves head)
+  tail = _tail;
+  if(__atomic_load_n(&_head, __ATOMIC_ACQUIRE) == tail)
+    return false;
+
+  //Copy buffer out (message that does not fit is dropped)
+  ind = tail % _bufcount;
+  len = (_lens[ind] <= maxlen) ? _lens[ind] : 0;
+  memcpy(buf, &_buffers[(uint64_t)ind * _bufsiz], len);
+
+  //Hand buffer back to writer
+  __atomic_store_n(&_tail, tail + 1, __ATOMIC_RELEASE);
+
+  return true;
+}
+
+bool SPSCQueue::TryWrite(const void* buf, uint32_t len)
+{
+  uint64_t head;
+  uint32_t ind;
 
-  _writebuf = _bufarray[_wrbufind];
+  //Check for full (only the reader moves tail)
+  head = _head;
+  if((head - __atomic_load_n(&_tail, __ATOMIC_ACQUIRE)) >= _bufcount)
+    return false;
 
-  //End mutual exclusion
-  _mutex->Give();
+  //Copy buffer in
+  ind = head % _bufcount;
+  memcpy(&_buffers[(uint64_t)ind * _bufsiz], buf, len);
+  _lens[ind] = len;
 
-  //Give the full semaphore
-  _fullsem->Give();
+  //Publish buffer to reader
+  __atomic_store_n(&_head, head + 1, __ATOMIC_RELEASE);
 
-  return retval;
+  return true;
 }
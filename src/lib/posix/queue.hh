@@ -26,27 +26,28 @@
 
 #pragma once
 
-#include "mutex.hh"
-#include "semaphore.hh"
 #include <inttypes.h>
 
-class QueueBuffer
+class QueueWaiter
 {
 public:
-  QueueBuffer(uint32_t size);
-  ~QueueBuffer();
-  void Reset(void);
-  uint32_t Read(void* buf, uint32_t maxlen);
-  uint32_t Write(const void* buf, uint32_t len);
+  QueueWaiter();
+  ~QueueWaiter();
+  uint32_t Begin(void);
+  int Sleep(uint32_t key, uint64_t deadline);
+  void Wake(void);
 
 private:
-  uint32_t _head;
-  uint32_t _size;
-  uint8_t* _buffer;
+  uint32_t _word;
+  uint32_t _armed;
 };
 
 class Queue
 {
+public:
+  //Attempts made before sleeping on an empty or full queue
+  static const uint32_t SPIN_COUNT = 256;
+
 public:
   Queue(uint32_t bufcount, uint32_t bufsiz);
   ~Queue();
@@ -55,14 +56,56 @@ public:
   uint32_t Write(const void* buf, uint32_t len, uint32_t msecs);
 
 private:
-  Mutex* _mutex;
-  Semaphore* _emptysem;
-  Semaphore* _fullsem;
-  uint32_t _wrbufind;
-  uint32_t _rdbufind;
+  //Buffer sequence number tells which lap of the ring it is ready for
+  struct Cell
+  {
+    uint64_t seq;
+    uint32_t len;
+  };
+
+private:
+  bool TryRead(void* buf, uint32_t maxlen, uint32_t& len);
+  bool TryWrite(const void* buf, uint32_t len);
+
+private:
+  uint64_t _wrpos;
+  uint8_t _pad0[56];
+  uint64_t _rdpos;
+  uint8_t _pad1[56];
+  QueueWaiter _notempty;
+  QueueWaiter _notfull;
+  uint32_t _bufcount;
+  uint32_t _bufsiz;
+  Cell* _cells;
+  uint8_t* _buffers;
+};
+
+class SPSCQueue
+{
+public:
+  //Attempts made before sleeping on an empty or full queue
+  static const uint32_t SPIN_COUNT = 256;
+
+public:
+  SPSCQueue(uint32_t bufcount, uint32_t bufsiz);
+  ~SPSCQueue();
+  void Reset(void);
+  uint32_t Read(void* buf, uint32_t maxlen, uint32_t msecs);
+  uint32_t Write(const void* buf, uint32_t len, uint32_t msecs);
+
+private:
+  bool TryRead(void* buf, uint32_t maxlen, uint32_t& len);
+  bool TryWrite(const void* buf, uint32_t len);
+
+private:
+  uint64_t _head;
+  uint8_t _pad0[56];
+  uint64_t _tail;
+  uint8_t _pad1[56];
+  QueueWaiter _notempty;
+  QueueWaiter _notfull;
   uint32_t _bufcount;
   uint32_t _bufsiz;
-  QueueBuffer** _bufarray;
-  QueueBuffer* _writebuf;
-  QueueBuffer* _readbuf;
+  uint32_t* _lens;
+  uint8_t* _buffers;
 };
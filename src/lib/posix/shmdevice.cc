@@ -0,0 +1,331 @@
+// Shared memory device
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "const.hh"
+#include "error.hh"
+#include "shmdevice.hh"
+#include "thread.hh"
+#include <cassert>
+#include <errno.h>
+#include <fcntl.h>
+#include <iostream>
+#include <limits.h>
+#include <linux/futex.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace std;
+
+SHMDevice::SHMDevice(const char* name, bool create, uint32_t ringsize)
+: Device()
+{
+  //Assert valid arguments
+  assert((name != 0) && (ringsize >= 64) && ((ringsize & (ringsize - 1)) == 0));
+
+  //Initialize member variables
+  _name = string("/hc-") + name;
+  _create = create;
+  _ringsize = ringsize;
+  _ringmask = ringsize - 1;
+  _attachmutex = new Mutex();
+  _wrmutex = new Mutex();
+  _hdr = 0;
+  _segsize = 0;
+  _rxring = 0;
+  _rxdata = 0;
+  _txring = 0;
+  _txdata = 0;
+
+  //Creator sets up segment right away so opener can find it
+  if(_create && !Attach())
+    cout << __FILE__ << ":" << __LINE__ << " - Error creating shared memory segment " << _name << "\n";
+}
+
+SHMDevice::~SHMDevice()
+{
+  //Unmap segment (left in place so peer stays attached across restarts of creator)
+  if(_hdr != 0)
+    munmap(_hdr, _segsize);
+
+  //Cleanup
+  delete _wrmutex;
+  delete _attachmutex;
+}
+
+uint32_t SHMDevice::Read(void* buf, uint32_t maxlen)
+{
+  uint32_t head;
+  uint32_t tail;
+  uint32_t len;
+
+  //Assert valid arguments
+  assert((buf != 0) && (maxlen > 0));
+
+  //Wait until attached
+  while(!Attach())
+    ThreadSleep(ATTACH_PERIOD);
+
+  //Wait for a message (head is only changed here so plain read is fine)
+  head = _rxring->head;
+  while((tail = __atomic_load_n(&_rxring->tail, __ATOMIC_ACQUIRE)) == head)
+    WaitChange(&_rxring->tail, &_rxring->readerwaiting, tail, WAIT_INF);
+
+  //Get message length (records are word aligned so length never wraps)
+  len = *(uint32_t*)&_rxdata[head & _ringmask];
+
+  //Copy payload (truncated to fit caller's buffer)
+  CopyOut(_rxdata, head + sizeof(uint32_t), buf, (len < maxlen) ? len : maxlen);
+
+  //Release record and wake writer if it waits for room
+  __atomic_store_n(&_rxring->head, head + sizeof(uint32_t) + ((len + 3) & ~3U), __ATOMIC_SEQ_CST);
+  Wake(&_rxring->head, &_rxring->writerwaiting);
+
+  return (len < maxlen) ? len : maxlen;
+}
+
+uint32_t SHMDevice::Write(const void* buf, uint32_t len)
+{
+  uint32_t head;
+  uint32_t tail;
+  uint32_t reclen;
+  uint64_t deadline;
+  uint64_t now;
+
+  //Assert valid arguments
+  assert((buf != 0) && (len > 0));
+
+  //Check for peer not there yet
+  if(!Attach())
+    return 0;
+
+  //Check for message that can never fit
+  reclen = sizeof(uint32_t) + ((len + 3) & ~3U);
+  if(reclen > _ringsize)
+    return 0;
+
+  //Begin mutual exclusion
+  _wrmutex->Wait();
+
+  //Wait for room (tail is only changed here so plain read is fine)
+  tail = _txring->tail;
+  deadline = ThreadTimeUS() + WRITE_TIMEOUT * 1000;
+  while(_ringsize - (tail - (head = __atomic_load_n(&_txring->head, __ATOMIC_ACQUIRE))) < reclen)
+  {
+    //Drop message if reader has stalled
+    if((now = ThreadTimeUS()) >= deadline)
+    {
+      _wrmutex->Give();
+      return 0;
+    }
+
+    WaitChange(&_txring->head, &_txring->writerwaiting, head, (uint32_t)((deadline - now + 999) / 1000));
+  }
+
+  //Copy length and payload
+  *(uint32_t*)&_txdata[tail & _ringmask] = len;
+  CopyIn(_txdata, tail + sizeof(uint32_t), buf, len);
+
+  //Publish record and wake reader if it waits for one
+  __atomic_store_n(&_txring->tail, tail + reclen, __ATOMIC_SEQ_CST);
+  Wake(&_txring->tail, &_txring->readerwaiting);
+
+  //End mutual exclusion
+  _wrmutex->Give();
+
+  return len;
+}
+
+int SHMDevice::WaitReadable(uint32_t msecs)
+{
+  uint32_t tail;
+
+  //Check for peer not there yet
+  if(!Attach())
+  {
+    ThreadSleep(msecs);
+    return ERR_TIMEOUT;
+  }
+
+  //Check for message already waiting
+  if((tail = __atomic_load_n(&_rxring->tail, __ATOMIC_ACQUIRE)) != _rxring->head)
+    return ERR_NONE;
+
+  //Wait for one
+  WaitChange(&_rxring->tail, &_rxring->readerwaiting, tail, msecs);
+
+  return (__atomic_load_n(&_rxring->tail, __ATOMIC_ACQUIRE) != _rxring->head) ? ERR_NONE : ERR_TIMEOUT;
+}
+
+bool SHMDevice::Attach(void)
+{
+  Header* hdr;
+  struct stat st;
+  uint32_t segsize;
+  int fd;
+
+  //Check for already attached
+  if(__atomic_load_n(&_hdr, __ATOMIC_ACQUIRE) != 0)
+    return true;
+
+  //Begin mutual exclusion
+  _attachmutex->Wait();
+
+  //Check for attached while waiting
+  if(_hdr != 0)
+  {
+    _attachmutex->Give();
+    return true;
+  }
+
+  //Open segment (creator makes it and sizes it for both rings, opener takes size from it)
+  if(_create)
+  {
+    segsize = sizeof(Header) + 2 * _ringsize;
+    if(((fd = shm_open(_name.c_str(), O_CREAT | O_RDWR, 0600)) < 0) || (ftruncate(fd, segsize) != 0))
+    {
+      if(fd >= 0)
+        close(fd);
+      _attachmutex->Give();
+      return false;
+    }
+  }
+  else
+  {
+    if((fd = shm_open(_name.c_str(), O_RDWR, 0)) < 0)
+    {
+      _attachmutex->Give();
+      return false;
+    }
+
+    if((fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof(Header)))
+    {
+      close(fd);
+      _attachmutex->Give();
+      return false;
+    }
+
+    segsize = (uint32_t)st.st_size;
+  }
+
+  //Map segment (mapping outlives descriptor)
+  hdr = (Header*)mmap(0, segsize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(hdr == MAP_FAILED)
+  {
+    _attachmutex->Give();
+    return false;
+  }
+
+  if(_create)
+  {
+    //Reset rings and mark segment ready (a previous creator's opener picks up where the new one starts)
+    memset(hdr, 0, sizeof(Header));
+    hdr->ringsize = _ringsize;
+    __atomic_store_n(&hdr->magic, MAGIC, __ATOMIC_RELEASE);
+  }
+  else
+  {
+    //Check for segment not set up yet or inconsistent with its size
+    if((__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != MAGIC) || (hdr->ringsize < 64) || ((hdr->ringsize & (hdr->ringsize - 1)) != 0) || (sizeof(Header) + 2 * hdr->ringsize != segsize))
+    {
+      munmap(hdr, segsize);
+      _attachmutex->Give();
+      return false;
+    }
+
+    _ringsize = hdr->ringsize;
+    _ringmask = _ringsize - 1;
+  }
+
+  //Creator receives on first ring and sends on second, opener the other way around
+  _segsize = segsize;
+  _rxring = &hdr->rings[_create ? 0 : 1];
+  _rxdata = (uint8_t*)(hdr + 1) + (_create ? 0 : _ringsize);
+  _txring = &hdr->rings[_create ? 1 : 0];
+  _txdata = (uint8_t*)(hdr + 1) + (_create ? _ringsize : 0);
+  __atomic_store_n(&_hdr, hdr, __ATOMIC_RELEASE);
+
+  //End mutual exclusion
+  _attachmutex->Give();
+
+  return true;
+}
+
+int SHMDevice::WaitChange(uint32_t* word, uint32_t* waiting, uint32_t val, uint32_t msecs)
+{
+  struct timespec ts;
+  int retval;
+
+  //Announce waiter then recheck so a change made before the announcement is not slept through
+  __atomic_store_n(waiting, 1, __ATOMIC_SEQ_CST);
+  retval = ERR_NONE;
+  if(__atomic_load_n(word, __ATOMIC_SEQ_CST) == val)
+  {
+    //Sleep until word changes, a wake arrives or time runs out (kernel rechecks value atomically)
+    ts.tv_sec = msecs / 1000;
+    ts.tv_nsec = (msecs % 1000) * 1000000;
+    if((syscall(SYS_futex, word, FUTEX_WAIT, val, (msecs == WAIT_INF) ? 0 : &ts, 0, 0) != 0) && (errno == ETIMEDOUT))
+      retval = ERR_TIMEOUT;
+  }
+  __atomic_store_n(waiting, 0, __ATOMIC_RELAXED);
+
+  return retval;
+}
+
+void SHMDevice::Wake(uint32_t* word, uint32_t* waiting)
+{
+  //Only pay for a system call when the other side is asleep
+  if(__atomic_load_n(waiting, __ATOMIC_SEQ_CST))
+    syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, 0, 0, 0);
+}
+
+void SHMDevice::CopyIn(uint8_t* data, uint32_t pos, const void* buf, uint32_t len)
+{
+  uint32_t ind;
+  uint32_t first;
+
+  //Copy in up to two pieces when record wraps around end of ring
+  ind = pos & _ringmask;
+  first = (len < _ringsize - ind) ? len : _ringsize - ind;
+  memcpy(&data[ind], buf, first);
+  memcpy(data, (const uint8_t*)buf + first, len - first);
+}
+
+void SHMDevice::CopyOut(const uint8_t* data, uint32_t pos, void* buf, uint32_t len)
+{
+  uint32_t ind;
+  uint32_t first;
+
+  //Copy out up to two pieces when record wraps around end of ring
+  ind = pos & _ringmask;
+  first = (len < _ringsize - ind) ? len : _ringsize - ind;
+  memcpy(buf, &data[ind], first);
+  memcpy((uint8_t*)buf + first, data, len - first);
+}
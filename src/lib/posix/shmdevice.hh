@@ -0,0 +1,95 @@
+// Shared memory device
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "device.hh"
+#include "mutex.hh"
+#include <inttypes.h>
+#include <string>
+
+class SHMDevice : public Device
+{
+public:
+  //Default size (bytes) of each direction's ring
+  static const uint32_t RING_SIZE_DEFAULT = 65536;
+
+  //Time (ms) a write may wait for room in a full ring before the message is dropped
+  static const uint32_t WRITE_TIMEOUT = 1000;
+
+public:
+  SHMDevice(const char* name, bool create, uint32_t ringsize=RING_SIZE_DEFAULT);
+  virtual ~SHMDevice();
+  virtual uint32_t Read(void* buf, uint32_t maxlen);
+  virtual uint32_t Write(const void* buf, uint32_t len);
+  virtual int WaitReadable(uint32_t msecs);
+
+private:
+  //One direction of traffic (producer and consumer fields on separate cache lines)
+  struct Ring
+  {
+    uint32_t head;
+    uint32_t writerwaiting;
+    uint8_t pad0[56];
+    uint32_t tail;
+    uint32_t readerwaiting;
+    uint8_t pad1[56];
+  };
+
+  //Start of segment (rings' data areas follow)
+  struct Header
+  {
+    uint32_t magic;
+    uint32_t ringsize;
+    uint8_t pad[56];
+    Ring rings[2];
+  };
+
+  //Segment initialized marker and time (ms) between attach attempts by opener
+  static const uint32_t MAGIC = 0x48435348;
+  static const uint32_t ATTACH_PERIOD = 100;
+
+private:
+  bool Attach(void);
+  int WaitChange(uint32_t* word, uint32_t* waiting, uint32_t val, uint32_t msecs);
+  void Wake(uint32_t* word, uint32_t* waiting);
+  void CopyIn(uint8_t* data, uint32_t pos, const void* buf, uint32_t len);
+  void CopyOut(const uint8_t* data, uint32_t pos, void* buf, uint32_t len);
+
+private:
+  std::string _name;
+  bool _create;
+  uint32_t _ringsize;
+  uint32_t _ringmask;
+  Mutex* _attachmutex;
+  Mutex* _wrmutex;
+  Header* _hdr;
+  uint32_t _segsize;
+  Ring* _rxring;
+  uint8_t* _rxdata;
+  Ring* _txring;
+  uint8_t* _txdata;
+};
@@ -0,0 +1,110 @@
+// TCP reactor
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "device.hh"
+#include "mutex.hh"
+#include "queue.hh"
+#include "slipframer.hh"
+#include "thread.hh"
+#include <inttypes.h>
+
+class TCPReactor : public Device
+{
+public:
+  //Default and absolute maximum number of concurrent connections
+  static const uint32_t CONNS_DEFAULT = 1024;
+  static const uint32_t CONNS_MAX = 65535;
+
+  //Number of inbound messages buffered between reactor and reader
+  static const uint32_t QUEUE_DEPTH = 256;
+
+  //Time (ms) a reply may wait for a congested connection before it is dropped
+  static const uint32_t WRITE_TIMEOUT = 1000;
+
+public:
+  TCPReactor(uint16_t port, uint32_t maxpldsiz, uint32_t maxconns=CONNS_DEFAULT);
+  virtual ~TCPReactor();
+  virtual uint32_t Read(void* buf, uint32_t maxlen);
+  virtual uint32_t Write(const void* buf, uint32_t len);
+  virtual uint32_t ReadFrom(void* buf, uint32_t maxlen, uint64_t& peer);
+  virtual uint32_t WriteTo(const void* buf, uint32_t len, uint64_t peer);
+  uint32_t GetConnCount(void);
+
+protected:
+  TCPReactor(int listenfd, uint32_t maxpldsiz, uint32_t maxconns, bool framed);
+  int GetFD(uint32_t slot);
+  uint32_t GetMaxConns(void);
+  void Stop(void);
+  virtual bool OpenConn(uint32_t slot, int fd);
+  virtual int RecvConn(uint32_t slot, void* buf, uint32_t maxlen);
+  virtual int SendConn(uint32_t slot, const void* buf, uint32_t len);
+  virtual void CloseConn(uint32_t slot);
+
+private:
+  void Init(int listenfd, uint32_t maxpldsiz, uint32_t maxconns, bool framed);
+  void Accept(void);
+  void Service(uint32_t slot);
+  void Close(uint32_t slot);
+  void ReactorThread(void);
+
+private:
+  //Epoll tag of listening socket
+  static const uint32_t SLOT_LISTEN = 0xFFFFFFFF;
+
+  //Maximum events handled per wakeup
+  static const uint32_t EVENTS_MAX = 64;
+
+  //Socket read size and maximum reads per connection per wakeup (for fairness)
+  static const uint32_t READ_SIZE = 4096;
+  static const uint32_t READ_BURST = 16;
+
+  //Connection handle fields (slot in low half, nonzero generation in high half)
+  static const uint32_t HANDLE_SLOT_MASK = 0xFFFF;
+  static const uint32_t HANDLE_GEN_SHIFT = 16;
+
+private:
+  Mutex* _mutex;
+  int _listenfd;
+  int _epollfd;
+  uint32_t _maxpldsiz;
+  uint32_t _maxconns;
+  bool _framed;
+  uint32_t _conncount;
+  int* _fds;
+  uint16_t* _gens;
+  SLIPDecoder** _decoders;
+  SPSCQueue* _rxqueue;
+  uint8_t* _pushitem;
+  uint8_t* _rxitem;
+  uint8_t* _rdbuf;
+  uint32_t _rdbufsize;
+  uint8_t* _txbuf;
+  uint64_t _rxpeer;
+  bool _started;
+  Thread<TCPReactor>* _reactorthread;
+};
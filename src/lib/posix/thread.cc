@@ -40,6 +40,16 @@ int ThreadSleep(uint32_t msecs)
   return ERR_NONE;
 }
 
+uint64_t ThreadTimeUS(void)
+{
+  struct timespec ts;
+
+  //Get monotonic time in microseconds
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ((uint64_t)ts.tv_sec * 1000000) + ((uint64_t)ts.tv_nsec / 1000);
+}
+
 uint32_t ThreadNumProcsOnline(void)
 {
   long numcores;
@@ -0,0 +1,202 @@
+// TLS reactor
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "tlsreactor.hh"
+#include <cassert>
+#include <iostream>
+#include <openssl/err.h>
+
+using namespace std;
+
+TLSReactor::TLSReactor(uint16_t port, uint32_t maxpldsiz, const char* certfile, const char* keyfile, uint32_t authcode, uint32_t maxconns)
+: TCPReactor(port, maxpldsiz, maxconns)
+{
+  const SSL_METHOD* sslmethod;
+  uint32_t i;
+
+  //Assert valid arguments
+  assert((certfile != 0) && (keyfile != 0));
+
+  //Remember authorization code
+  _authcode = authcode;
+
+  //Create per connection TLS state
+  _ssls = new SSL*[GetMaxConns()];
+  _states = new uint8_t[GetMaxConns()];
+  _authhashes = new uint32_t[GetMaxConns()];
+  _authcounts = new uint8_t[GetMaxConns()];
+  for(i=0; i<GetMaxConns(); i++)
+    _ssls[i] = NULL;
+
+  //Create SSL context and check for error
+#if defined(__APPLE__) || defined(__arm__)
+  sslmethod = TLSv1_2_server_method();
+#else
+  sslmethod = TLS_server_method();
+#endif
+  if((_sslctx = SSL_CTX_new(sslmethod)) == NULL)
+    cout << __FILE__ << ":" << __LINE__ << " - Error creating SSL context" << "\n";
+
+  //Allow a congested write to be retried from a different offset in the transmit buffer
+  SSL_CTX_set_mode(_sslctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+  //Set certificate and check for error
+  if(SSL_CTX_use_certificate_file(_sslctx, certfile, SSL_FILETYPE_PEM) <= 0)
+    cout << __FILE__ << ":" << __LINE__ << " - Error setting SSL certificate" << "\n";
+
+  //Set key and check for error
+  if(SSL_CTX_use_PrivateKey_file(_sslctx, keyfile, SSL_FILETYPE_PEM) <= 0 )
+    cout << __FILE__ << ":" << __LINE__ << " - Error setting SSL private key" << "\n";
+}
+
+TLSReactor::~TLSReactor()
+{
+  uint32_t i;
+
+  //Stop reactor thread before freeing state it uses
+  Stop();
+
+  //Free SSL wrappers (sockets are closed by base class)
+  for(i=0; i<GetMaxConns(); i++)
+  {
+    if(_ssls[i] != NULL)
+      SSL_free(_ssls[i]);
+  }
+
+  //Free SSL context
+  SSL_CTX_free(_sslctx);
+
+  //Cleanup
+  delete[] _authcounts;
+  delete[] _authhashes;
+  delete[] _states;
+  delete[] _ssls;
+}
+
+bool TLSReactor::OpenConn(uint32_t slot, int fd)
+{
+  //Create new SSL wrapper around socket
+  if((_ssls[slot] = SSL_new(_sslctx)) == NULL)
+    return false;
+
+  SSL_set_fd(_ssls[slot], fd);
+  SSL_set_accept_state(_ssls[slot]);
+
+  //Handshake happens as data arrives
+  _states[slot] = STATE_HANDSHAKE;
+  _authhashes[slot] = 0;
+  _authcounts[slot] = 0;
+
+  return true;
+}
+
+int TLSReactor::RecvConn(uint32_t slot, void* buf, uint32_t maxlen)
+{
+  uint8_t bytes[4];
+  int retval;
+  int i;
+
+  //Advance handshake
+  if(_states[slot] == STATE_HANDSHAKE)
+  {
+    if((retval = SSL_accept(_ssls[slot])) <= 0)
+      return CheckError(slot, retval);
+
+    _states[slot] = STATE_AUTH;
+  }
+
+  //Collect authorization hash
+  if(_states[slot] == STATE_AUTH)
+  {
+    if((retval = SSL_read(_ssls[slot], bytes, 4 - _authcounts[slot])) <= 0)
+      return CheckError(slot, retval);
+
+    //Update hash
+    for(i=0; i<retval; i++, _authcounts[slot]++)
+      _authhashes[slot] |= (uint32_t)bytes[i] << (24 - _authcounts[slot]*8);
+
+    //Wait for rest of hash
+    if(_authcounts[slot] < 4)
+      return 0;
+
+    //Compare hash against authorized code
+    if(_authhashes[slot] != _authcode)
+    {
+      cout << __FILE__ << ":" << __LINE__ << " - Error authenticating" << "\n";
+      return -1;
+    }
+
+    _states[slot] = STATE_OPEN;
+  }
+
+  //Read application data
+  if((retval = SSL_read(_ssls[slot], buf, maxlen)) <= 0)
+    return CheckError(slot, retval);
+
+  return retval;
+}
+
+int TLSReactor::SendConn(uint32_t slot, const void* buf, uint32_t len)
+{
+  int retval;
+
+  //Only authenticated connections carry application data
+  if(_states[slot] != STATE_OPEN)
+    return -1;
+
+  //Write application data
+  if((retval = SSL_write(_ssls[slot], buf, len)) <= 0)
+    return CheckError(slot, retval);
+
+  return retval;
+}
+
+void TLSReactor::CloseConn(uint32_t slot)
+{
+  //Free SSL wrapper
+  if(_ssls[slot] != NULL)
+    SSL_free(_ssls[slot]);
+
+  _ssls[slot] = NULL;
+}
+
+int TLSReactor::CheckError(uint32_t slot, int retval)
+{
+  //Check for operation that must wait for socket readiness
+  switch(SSL_get_error(_ssls[slot], retval))
+  {
+  case SSL_ERROR_WANT_READ:
+  case SSL_ERROR_WANT_WRITE:
+    return 0;
+  default:
+    break;
+  }
+
+  //Clear error queue so it does not leak into other connections
+  ERR_clear_error();
+
+  return -1;
+}
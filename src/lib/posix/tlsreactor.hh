@@ -0,0 +1,61 @@
+// TLS reactor
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "tcpreactor.hh"
+#include <inttypes.h>
+#include <openssl/ssl.h>
+
+class TLSReactor : public TCPReactor
+{
+public:
+  TLSReactor(uint16_t port, uint32_t maxpldsiz, const char* certfile, const char* keyfile, uint32_t authcode, uint32_t maxconns=CONNS_DEFAULT);
+  virtual ~TLSReactor();
+
+protected:
+  virtual bool OpenConn(uint32_t slot, int fd);
+  virtual int RecvConn(uint32_t slot, void* buf, uint32_t maxlen);
+  virtual int SendConn(uint32_t slot, const void* buf, uint32_t len);
+  virtual void CloseConn(uint32_t slot);
+
+private:
+  int CheckError(uint32_t slot, int retval);
+
+private:
+  //Connection states
+  static const uint8_t STATE_HANDSHAKE = 0;
+  static const uint8_t STATE_AUTH = 1;
+  static const uint8_t STATE_OPEN = 2;
+
+private:
+  SSL_CTX* _sslctx;
+  uint32_t _authcode;
+  SSL** _ssls;
+  uint8_t* _states;
+  uint32_t* _authhashes;
+  uint8_t* _authcounts;
+};
@@ -0,0 +1,160 @@
+// Unix domain sequenced packet client
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "thread.hh"
+#include "unixclient.hh"
+#include <cassert>
+#include <iostream>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+UnixClient::UnixClient(const char* path)
+: Device()
+{
+  //Assert valid arguments
+  assert((path != 0) && (strlen(path) < sizeof(((struct sockaddr_un*)0)->sun_path)));
+
+  //Create mutex
+  _mutex = new Mutex();
+
+  //Remember server socket path
+  _path = path;
+
+  //Initialize connection socket to indicate not connected
+  _connfd = -1;
+}
+
+UnixClient::~UnixClient()
+{
+  //Close connection socket
+  if(_connfd >= 0)
+    close(_connfd);
+
+  //Cleanup
+  delete _mutex;
+}
+
+uint32_t UnixClient::Read(void* buf, uint32_t maxlen)
+{
+  int connfd;
+  ssize_t retval;
+
+  //Assert valid arguments
+  assert((buf != 0) && (maxlen > 0));
+
+  //Wait until connected
+  _mutex->Wait();
+  connfd = WaitForConnection();
+  _mutex->Give();
+
+  //Read one whole message from the socket and keep trying until success
+  while((retval = recv(connfd, buf, maxlen, 0)) <= 0)
+  {
+    //Close connection and wait for new connection
+    _mutex->Wait();
+    CloseConnection();
+    connfd = WaitForConnection();
+    _mutex->Give();
+  }
+
+  return (uint32_t)retval;
+}
+
+uint32_t UnixClient::Write(const void* buf, uint32_t len)
+{
+  int connfd;
+  ssize_t wlen;
+
+  //Assert valid arguments
+  assert((buf != 0) && (len > 0));
+
+  //Wait until connected
+  _mutex->Wait();
+  connfd = WaitForConnection();
+  _mutex->Give();
+
+  //Write one whole message to the socket and keep trying until success
+  while((wlen = send(connfd, buf, len, MSG_NOSIGNAL)) <= 0)
+  {
+    //Close connection and wait for new connection
+    _mutex->Wait();
+    CloseConnection();
+    connfd = WaitForConnection();
+    _mutex->Give();
+  }
+
+  return (uint32_t)wlen;
+}
+
+void UnixClient::CloseConnection(void)
+{
+  //Close the connection socket (another thread may have done so already)
+  if(_connfd >= 0)
+    close(_connfd);
+
+  //Invalidate connection socket
+  _connfd = -1;
+}
+
+int UnixClient::WaitForConnection(void)
+{
+  struct sockaddr_un addr;
+
+  //Check for connection
+  if(_connfd >= 0)
+    return _connfd;
+
+  //Try forever
+  while(true)
+  {
+    //Create connection socket
+    if((_connfd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0)) < 0)
+    {
+      cout << __FILE__ << ":" << __LINE__ << " - Error creating connection socket" << "\n";
+      ThreadSleep(1000);
+      continue;
+    }
+
+    //Connect to the server
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, _path.c_str(), sizeof(addr.sun_path) - 1);
+    if(connect(_connfd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+      close(_connfd);
+      cout << __FILE__ << ":" << __LINE__ << " - Error connecting to " << _path << "\n";
+      ThreadSleep(1000);
+      continue;
+    }
+
+    //Connection established
+    return _connfd;
+  }
+}
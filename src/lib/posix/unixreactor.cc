@@ -0,0 +1,107 @@
+// Unix domain sequenced packet reactor
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "unixreactor.hh"
+#include <cassert>
+#include <iostream>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+UnixReactor::UnixReactor(const char* path, uint32_t maxpldsiz, int allowuid, int allowgid, uint32_t maxconns)
+: TCPReactor(Listen(path), maxpldsiz, maxconns, false)
+{
+  //Remember socket path so it can be removed
+  _path = path;
+
+  //Remember who may connect besides root (defaults to user running server)
+  _allowuid = (allowuid < 0) ? geteuid() : (uid_t)allowuid;
+  _allowgid = allowgid;
+}
+
+UnixReactor::~UnixReactor()
+{
+  //Stop reactor thread before socket path goes away
+  Stop();
+
+  //Remove socket path
+  unlink(_path.c_str());
+}
+
+bool UnixReactor::OpenConn(uint32_t slot, int fd)
+{
+  struct ucred cred;
+  socklen_t credlen;
+
+  //Get credentials kernel recorded for connecting process and check for error
+  credlen = sizeof(cred);
+  if(getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &credlen) != 0)
+  {
+    cout << __FILE__ << ":" << __LINE__ << " - Error getting peer credentials" << "\n";
+    return false;
+  }
+
+  //Allow root, the allowed user and members of the allowed group
+  if((cred.uid == 0) || (cred.uid == _allowuid) || ((_allowgid >= 0) && (cred.gid == (gid_t)_allowgid)))
+    return true;
+
+  cout << "Refused connection from process " << cred.pid << " (uid " << cred.uid << ", gid " << cred.gid << ")" << "\n";
+  return false;
+}
+
+int UnixReactor::Listen(const char* path)
+{
+  struct sockaddr_un addr;
+  int listenfd;
+
+  //Assert valid arguments
+  assert((path != 0) && (strlen(path) < sizeof(addr.sun_path)));
+
+  //Create the non-blocking listening socket (message boundaries are kept so no framing needed)
+  if((listenfd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) < 0)
+    cout << __FILE__ << ":" << __LINE__ << " - Error creating listening socket" << "\n";
+
+  //Remove socket left behind by an earlier run then bind to path
+  unlink(path);
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  if(bind(listenfd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    cout << __FILE__ << ":" << __LINE__ << " - Error binding listening socket to " << path << "\n";
+
+  //Let any local process reach socket (access is decided by peer credentials instead)
+  chmod(path, 0666);
+
+  //Listen
+  if(listen(listenfd, SOMAXCONN) != 0)
+    cout << __FILE__ << ":" << __LINE__ << " - Error listening" << "\n";
+
+  return listenfd;
+}
@@ -0,0 +1,341 @@
+// io_uring submission and completion rings
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "error.hh"
+#include "uring.hh"
+#include <cassert>
+#include <errno.h>
+#include <iostream>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+
+URing::URing(uint32_t entries)
+{
+  struct io_uring_params params;
+  uint8_t* cqbase;
+
+  //Assert valid arguments
+  assert(entries > 0);
+
+  //Start out with nothing set up
+  _fd = -1;
+  _sqentries = 0;
+  _sqring = MAP_FAILED;
+  _sqringsize = 0;
+  _cqring = MAP_FAILED;
+  _cqringsize = 0;
+  _sqes = (struct io_uring_sqe*)MAP_FAILED;
+  _sqessize = 0;
+  _sqlocaltail = 0;
+  _bufring = 0;
+  _bufringsize = 0;
+  _bufcount = 0;
+  _bufsiz = 0;
+  _bufs = 0;
+  _bufgroup = 0;
+
+  //Create ring (no libc wrapper exists so go straight to the kernel, failure just leaves ring closed)
+  memset(&params, 0, sizeof(params));
+  if((_fd = (int)syscall(__NR_io_uring_setup, entries, &params)) < 0)
+  {
+    _fd = -1;
+    return;
+  }
+
+  //Determine ring sizes (newer kernels map both rings with one call)
+  _sqentries = params.sq_entries;
+  _sqringsize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  _cqringsize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if((params.features & IORING_FEAT_SINGLE_MMAP) && (_cqringsize > _sqringsize))
+    _sqringsize = _cqringsize;
+
+  //Map submission ring
+  if((_sqring = mmap(0, _sqringsize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING)) == MAP_FAILED)
+  {
+    cout << __FILE__ << ":" << __LINE__ << " - Error mapping submission ring" << "\n";
+    Close();
+    return;
+  }
+
+  //Map completion ring unless it shares the submission ring mapping
+  if(!(params.features & IORING_FEAT_SINGLE_MMAP) && ((_cqring = mmap(0, _cqringsize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_CQ_RING)) == MAP_FAILED))
+  {
+    cout << __FILE__ << ":" << __LINE__ << " - Error mapping completion ring" << "\n";
+    Close();
+    return;
+  }
+
+  //Map submission queue entries
+  _sqessize = params.sq_entries * sizeof(struct io_uring_sqe);
+  if((_sqes = (struct io_uring_sqe*)mmap(0, _sqessize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES)) == MAP_FAILED)
+  {
+    cout << __FILE__ << ":" << __LINE__ << " - Error mapping submission queue entries" << "\n";
+    Close();
+    return;
+  }
+
+  //Locate ring fields
+  _sqhead = (uint32_t*)((uint8_t*)_sqring + params.sq_off.head);
+  _sqtail = (uint32_t*)((uint8_t*)_sqring + params.sq_off.tail);
+  _sqmask = (uint32_t*)((uint8_t*)_sqring + params.sq_off.ring_mask);
+  _sqarray = (uint32_t*)((uint8_t*)_sqring + params.sq_off.array);
+  _sqlocaltail = *_sqtail;
+  cqbase = (uint8_t*)((_cqring == MAP_FAILED) ? _sqring : _cqring);
+  _cqhead = (uint32_t*)(cqbase + params.cq_off.head);
+  _cqtail = (uint32_t*)(cqbase + params.cq_off.tail);
+  _cqmask = (uint32_t*)(cqbase + params.cq_off.ring_mask);
+  _cqes = (struct io_uring_cqe*)(cqbase + params.cq_off.cqes);
+}
+
+URing::~URing()
+{
+  //Close ring first so kernel lets go of provided buffers
+  Close();
+
+  //Cleanup
+  if(_bufring != 0)
+    munmap(_bufring, _bufringsize);
+  if(_bufs != 0)
+    delete[] _bufs;
+}
+
+bool URing::IsOpen(void)
+{
+  return _fd >= 0;
+}
+
+int URing::GetFD(void)
+{
+  return _fd;
+}
+
+struct io_uring_sqe* URing::GetSQE(void)
+{
+  struct io_uring_sqe* sqe;
+  uint32_t index;
+
+  //Check for full submission ring
+  if(_sqlocaltail - __atomic_load_n(_sqhead, __ATOMIC_ACQUIRE) >= _sqentries)
+    return 0;
+
+  //Claim next entry and clear it
+  index = _sqlocaltail & *_sqmask;
+  sqe = &_sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  _sqarray[index] = index;
+  _sqlocaltail++;
+
+  return sqe;
+}
+
+int URing::Submit(uint32_t waitcount)
+{
+  uint32_t tosubmit;
+  int retval;
+
+  //Publish claimed entries to kernel
+  __atomic_store_n(_sqtail, _sqlocaltail, __ATOMIC_RELEASE);
+
+  while(true)
+  {
+    //Determine number of entries kernel has not consumed yet
+    tosubmit = _sqlocaltail - __atomic_load_n(_sqhead, __ATOMIC_ACQUIRE);
+
+    //Done if nothing to submit or wait for
+    if((tosubmit == 0) && (waitcount == 0))
+      return ERR_NONE;
+
+    //Submit and optionally wait for completions in one system call
+    if((retval = (int)syscall(__NR_io_uring_enter, _fd, tosubmit, waitcount, (waitcount > 0) ? IORING_ENTER_GETEVENTS : 0, 0, 0)) >= 0)
+      return ERR_NONE;
+
+    //Retry if interrupted
+    if(errno != EINTR)
+      return ERR_UNSPEC;
+  }
+}
+
+struct io_uring_cqe* URing::PeekCQE(void)
+{
+  uint32_t head;
+
+  //Check for empty completion ring
+  head = *_cqhead;
+  if(head == __atomic_load_n(_cqtail, __ATOMIC_ACQUIRE))
+    return 0;
+
+  return &_cqes[head & *_cqmask];
+}
+
+void URing::SeenCQE(void)
+{
+  //Hand oldest completion entry back to kernel
+  __atomic_store_n(_cqhead, *_cqhead + 1, __ATOMIC_RELEASE);
+}
+
+int URing::RegisterBufRing(uint16_t group, uint32_t count, uint32_t bufsiz)
+{
+  struct io_uring_buf_reg reg;
+  uint32_t i;
+
+  //Assert valid arguments
+  assert(bufsiz > 0);
+
+  //Check for closed ring or buffers already registered
+  if((_fd < 0) || (_bufring != 0))
+    return ERR_UNSPEC;
+
+  //Check range (kernel wants power of two count that fits in buffer ID)
+  if((count == 0) || (count > 32768) || ((count & (count - 1)) != 0))
+    return ERR_RANGE;
+
+  //Allocate page aligned ring of buffer descriptors shared with kernel
+  _bufringsize = count * sizeof(struct io_uring_buf);
+  if((_bufring = (struct io_uring_buf_ring*)mmap(0, _bufringsize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)
+  {
+    _bufring = 0;
+    return ERR_UNSPEC;
+  }
+
+  //Register descriptor ring so kernel picks buffers itself for receives in this group
+  memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = (uint64_t)(uintptr_t)_bufring;
+  reg.ring_entries = count;
+  reg.bgid = group;
+  if(syscall(__NR_io_uring_register, _fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+  {
+    munmap(_bufring, _bufringsize);
+    _bufring = 0;
+    return ERR_UNSPEC;
+  }
+
+  //Allocate buffers
+  _bufcount = count;
+  _bufsiz = bufsiz;
+  _bufgroup = group;
+  _bufs = new uint8_t[count * bufsiz];
+
+  //Hand every buffer to kernel
+  for(i=0; i<count; i++)
+    RecycleBuf((uint16_t)i);
+
+  return ERR_NONE;
+}
+
+uint8_t* URing::GetBuf(uint16_t bid)
+{
+  //Assert valid arguments
+  assert(bid < _bufcount);
+
+  return &_bufs[bid * _bufsiz];
+}
+
+uint32_t URing::GetBufSize(void)
+{
+  return _bufsiz;
+}
+
+void URing::RecycleBuf(uint16_t bid)
+{
+  struct io_uring_buf* buf;
+  uint16_t tail;
+
+  //Assert valid arguments
+  assert(bid < _bufcount);
+
+  //Describe buffer in next free descriptor (tail overlays a reserved field so only set the others)
+  //Index from ring start rather than through the bufs member, which the kernel header pads in C++
+  tail = _bufring->tail;
+  buf = &((struct io_uring_buf*)_bufring)[tail & (_bufcount - 1)];
+  buf->addr = (uint64_t)(uintptr_t)&_bufs[bid * _bufsiz];
+  buf->len = _bufsiz;
+  buf->bid = bid;
+
+  //Publish descriptor to kernel
+  __atomic_store_n(&_bufring->tail, (uint16_t)(tail + 1), __ATOMIC_RELEASE);
+}
+
+bool URing::IsSupported(void)
+{
+  static int supported = -1;
+  URing* ring;
+  struct io_uring_probe* probe;
+  uint32_t probelen;
+
+  //Only probe kernel once
+  if(supported >= 0)
+    return supported == 1;
+
+  //Create small ring (fails if kernel lacks io_uring or it is blocked)
+  supported = 0;
+  ring = new URing(2);
+
+  if(ring->IsOpen())
+  {
+    //Ask kernel which operations it supports
+    probelen = sizeof(struct io_uring_probe) + IORING_OP_LAST * sizeof(struct io_uring_probe_op);
+    probe = (struct io_uring_probe*)new uint8_t[probelen];
+    memset(probe, 0, probelen);
+
+    //Multishot message receive arrived in the same kernel release as zero copy send, so use it to check for that too
+    if((syscall(__NR_io_uring_register, ring->_fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) == 0) &&
+       (probe->last_op >= IORING_OP_SEND_ZC) &&
+       (probe->ops[IORING_OP_RECVMSG].flags & IO_URING_OP_SUPPORTED) &&
+       (probe->ops[IORING_OP_SENDMSG].flags & IO_URING_OP_SUPPORTED) &&
+       (probe->ops[IORING_OP_SEND_ZC].flags & IO_URING_OP_SUPPORTED) &&
+       (ring->RegisterBufRing(0, 2, 64) == ERR_NONE))
+      supported = 1;
+
+    delete[] (uint8_t*)probe;
+  }
+
+  delete ring;
+
+  return supported == 1;
+}
+
+void URing::Close(void)
+{
+  //Unmap rings
+  if(_sqes != MAP_FAILED)
+    munmap(_sqes, _sqessize);
+  if(_cqring != MAP_FAILED)
+    munmap(_cqring, _cqringsize);
+  if(_sqring != MAP_FAILED)
+    munmap(_sqring, _sqringsize);
+  _sqes = (struct io_uring_sqe*)MAP_FAILED;
+  _cqring = MAP_FAILED;
+  _sqring = MAP_FAILED;
+
+  //Close ring
+  if(_fd >= 0)
+    close(_fd);
+  _fd = -1;
+}
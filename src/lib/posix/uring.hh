@@ -0,0 +1,76 @@
+// io_uring submission and completion rings
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <inttypes.h>
+#include <linux/io_uring.h>
+
+class URing
+{
+public:
+  URing(uint32_t entries);
+  virtual ~URing();
+  bool IsOpen(void);
+  int GetFD(void);
+  struct io_uring_sqe* GetSQE(void);
+  int Submit(uint32_t waitcount=0);
+  struct io_uring_cqe* PeekCQE(void);
+  void SeenCQE(void);
+  int RegisterBufRing(uint16_t group, uint32_t count, uint32_t bufsiz);
+  uint8_t* GetBuf(uint16_t bid);
+  uint32_t GetBufSize(void);
+  void RecycleBuf(uint16_t bid);
+  static bool IsSupported(void);
+
+private:
+  void Close(void);
+
+private:
+  int _fd;
+  uint32_t _sqentries;
+  void* _sqring;
+  uint32_t _sqringsize;
+  void* _cqring;
+  uint32_t _cqringsize;
+  struct io_uring_sqe* _sqes;
+  uint32_t _sqessize;
+  uint32_t* _sqhead;
+  uint32_t* _sqtail;
+  uint32_t* _sqmask;
+  uint32_t* _sqarray;
+  uint32_t _sqlocaltail;
+  uint32_t* _cqhead;
+  uint32_t* _cqtail;
+  uint32_t* _cqmask;
+  struct io_uring_cqe* _cqes;
+  struct io_uring_buf_ring* _bufring;
+  uint32_t _bufringsize;
+  uint32_t _bufcount;
+  uint32_t _bufsiz;
+  uint8_t* _bufs;
+  uint16_t _bufgroup;
+};
@@ -0,0 +1,388 @@
+// io_uring UDP device
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "const.hh"
+#include "error.hh"
+#include "uringudpdevice.hh"
+#include <arpa/inet.h>
+#include <cassert>
+#include <errno.h>
+#include <iostream>
+#include <poll.h>
+#include <string.h>
+
+using namespace std;
+
+URingUDPDevice::URingUDPDevice(uint16_t port, const char* bindif, const char* dstipaddr, uint16_t dstport, bool reuseport, uint32_t bufsiz)
+{
+  //Create socket (same options as a plain UDP device)
+  _sock = new UDPSocket(port, bindif, reuseport);
+
+  //Create receive ring with buffers kernel fills directly and send ring sized for one batch
+  _rxring = new URing(BUF_COUNT);
+  _txring = new URing(UDPSocket::BATCH_MAX);
+  if(!_rxring->IsOpen() || !_txring->IsOpen())
+    cout << __FILE__ << ":" << __LINE__ << " - Error creating rings" << "\n";
+  else if(_rxring->RegisterBufRing(BUF_GROUP, BUF_COUNT, sizeof(struct io_uring_recvmsg_out) + sizeof(struct sockaddr_in) + CMSG_SPACE(sizeof(uint32_t)) + bufsiz) != ERR_NONE)
+    cout << __FILE__ << ":" << __LINE__ << " - Error registering receive buffers" << "\n";
+
+  //Create mutex
+  _mutex = new Mutex();
+
+  //Check for null pointer passed in for destination IP address string
+  if(dstipaddr == 0)
+  {
+    _dstipaddr = 0;
+  }
+  else
+  {
+    //Convert destination IP address string to integer and check for error
+    if(inet_pton(AF_INET, dstipaddr, &_dstipaddr) != 1)
+      cout << __FILE__ << ":" << __LINE__ << " - Error converting destination IP address" << "\n";
+
+    //Convert destination IP address to host byte order
+    _dstipaddr = ntohl(_dstipaddr);
+  }
+
+  //Set destination port
+  _dstport = dstport;
+
+  //Set destination information on read if zero passed in for IP address or port
+  _setdstonread = ((_dstipaddr == 0) || (_dstport == 0));
+
+  //Receive template tells kernel how much room to leave for source address and drop count ahead of payload
+  _rxarmed = false;
+  memset(&_rxmsg, 0, sizeof(_rxmsg));
+  _rxmsg.msg_namelen = sizeof(struct sockaddr_in);
+  _rxmsg.msg_controllen = CMSG_SPACE(sizeof(uint32_t));
+  _dropcount = 0;
+}
+
+URingUDPDevice::~URingUDPDevice()
+{
+  //Cleanup (rings before socket so no operation outlives it)
+  delete _mutex;
+  delete _txring;
+  delete _rxring;
+  delete _sock;
+}
+
+uint32_t URingUDPDevice::Read(void* buf, uint32_t maxlen)
+{
+  uint64_t peer;
+  uint32_t retval;
+
+  //Read from socket
+  if((retval = ReadFrom(buf, maxlen, peer)) == 0)
+    return 0;
+
+  //Begin mutual exclusion
+  _mutex->Wait();
+
+  //Check for destination information to be set to source of received packet
+  if(_setdstonread)
+  {
+    //Set destination to source of incoming datagram
+    _dstipaddr = (uint32_t)(peer >> 16);
+    _dstport = (uint16_t)peer;
+  }
+
+  //End mutual exclusion
+  _mutex->Give();
+
+  return retval;
+}
+
+uint32_t URingUDPDevice::Write(const void* buf, uint32_t len)
+{
+  //Write to default destination
+  return WriteTo(buf, len, PEER_NONE);
+}
+
+uint32_t URingUDPDevice::ReadFrom(void* buf, uint32_t maxlen, uint64_t& peer)
+{
+  uint32_t len;
+
+  //Assert valid arguments
+  assert((buf != 0) && (maxlen > 0));
+
+  //Read batch of one
+  if(ReadBatch((uint8_t*)buf, maxlen, 1, &len, &peer) != 1)
+    return 0;
+
+  return len;
+}
+
+uint32_t URingUDPDevice::WriteTo(const void* buf, uint32_t len, uint64_t peer)
+{
+  //Assert valid arguments
+  assert((buf != 0) && (len > 0));
+
+  //Write batch of one
+  if(WriteBatch((const uint8_t*)buf, len, &len, &peer, 1) != 1)
+    return 0;
+
+  return len;
+}
+
+uint32_t URingUDPDevice::ReadBatch(uint8_t* bufs, uint32_t bufsiz, uint32_t maxcount, uint32_t* lens, uint64_t* peers)
+{
+  struct io_uring_cqe* cqe;
+  uint16_t bid;
+  uint32_t count;
+
+  //Assert valid arguments
+  assert((bufs != 0) && (bufsiz > 0) && (lens != 0) && (peers != 0));
+
+  for(count=0; ; )
+  {
+    //Rearm receive if kernel ended it (first call or ran out of buffers)
+    if(!_rxarmed && !ArmRecv())
+      return 0;
+
+    //Take every completion already posted (up to limit)
+    while((count < maxcount) && ((cqe = _rxring->PeekCQE()) != 0))
+    {
+      //Kernel stops a multishot receive when it posts a completion without more to follow
+      if(!(cqe->flags & IORING_CQE_F_MORE))
+        _rxarmed = false;
+
+      //Unpack datagram from kernel chosen buffer into caller buffer then hand buffer back
+      if(cqe->flags & IORING_CQE_F_BUFFER)
+      {
+        bid = (uint16_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        if((cqe->res > 0) && ((lens[count] = Unpack(_rxring->GetBuf(bid), (uint32_t)cqe->res, &bufs[count * bufsiz], bufsiz, peers[count])) > 0))
+          count++;
+        _rxring->RecycleBuf(bid);
+      }
+      else if((cqe->res < 0) && (cqe->res != -ENOBUFS))
+      {
+        //Give up on anything other than running out of buffers
+        cout << __FILE__ << ":" << __LINE__ << " - Error receiving (" << -cqe->res << ")" << "\n";
+        _rxring->SeenCQE();
+        return count;
+      }
+
+      _rxring->SeenCQE();
+    }
+
+    //Done once something arrived
+    if(count > 0)
+      return count;
+
+    //Submit any rearm and wait for next completion
+    if(_rxring->Submit(1) != ERR_NONE)
+      return 0;
+  }
+}
+
+uint32_t URingUDPDevice::WriteBatch(const uint8_t* bufs, uint32_t bufsiz, const uint32_t* lens, const uint64_t* peers, uint32_t count)
+{
+  struct io_uring_sqe* sqe;
+  struct io_uring_cqe* cqe;
+  uint32_t sent;
+  uint32_t done;
+  uint32_t n;
+  uint32_t i;
+
+  //Assert valid arguments
+  assert((bufs != 0) && (bufsiz > 0) && (lens != 0) && (peers != 0));
+
+  //Begin mutual exclusion
+  _mutex->Wait();
+
+  //Send in chunks of send ring size
+  for(done=0, sent=0; done<count; done+=n)
+  {
+    //Determine chunk size
+    n = count - done;
+    if(n > UDPSocket::BATCH_MAX)
+      n = UDPSocket::BATCH_MAX;
+
+    //Queue send of each datagram of chunk (no peer means default destination)
+    for(i=0; i<n; i++)
+    {
+      memset(&_txdsts[i], 0, sizeof(_txdsts[i]));
+      _txdsts[i].sin_family = AF_INET;
+      if(peers[done + i] == PEER_NONE)
+      {
+        _txdsts[i].sin_addr.s_addr = htonl(_dstipaddr);
+        _txdsts[i].sin_port = htons(_dstport);
+      }
+      else
+      {
+        _txdsts[i].sin_addr.s_addr = htonl((uint32_t)(peers[done + i] >> 16));
+        _txdsts[i].sin_port = htons((uint16_t)peers[done + i]);
+      }
+      _txiovs[i].iov_base = (void*)&bufs[(done + i) * bufsiz];
+      _txiovs[i].iov_len = lens[done + i];
+      memset(&_txmsgs[i], 0, sizeof(_txmsgs[i]));
+      _txmsgs[i].msg_name = &_txdsts[i];
+      _txmsgs[i].msg_namelen = sizeof(_txdsts[i]);
+      _txmsgs[i].msg_iov = &_txiovs[i];
+      _txmsgs[i].msg_iovlen = 1;
+
+      if((sqe = _txring->GetSQE()) == 0)
+        break;
+      sqe->opcode = IORING_OP_SENDMSG;
+      sqe->fd = _sock->GetFD();
+      sqe->addr = (uint64_t)(uintptr_t)&_txmsgs[i];
+      sqe->len = 1;
+    }
+
+    //Submit whole chunk and wait for all of it in one system call
+    _txring->Submit(i);
+
+    //Count datagrams kernel accepted
+    while((cqe = _txring->PeekCQE()) != 0)
+    {
+      if(cqe->res >= 0)
+        sent++;
+      _txring->SeenCQE();
+    }
+  }
+
+  //End mutual exclusion
+  _mutex->Give();
+
+  return sent;
+}
+
+int URingUDPDevice::GetRecvBufSize(uint32_t& val)
+{
+  return _sock->GetRecvBufSize(val);
+}
+
+int URingUDPDevice::SetRecvBufSize(uint32_t val)
+{
+  return _sock->SetRecvBufSize(val);
+}
+
+int URingUDPDevice::GetSendBufSize(uint32_t& val)
+{
+  return _sock->GetSendBufSize(val);
+}
+
+int URingUDPDevice::SetSendBufSize(uint32_t val)
+{
+  return _sock->SetSendBufSize(val);
+}
+
+int URingUDPDevice::GetDropCount(uint32_t& val)
+{
+  val = _dropcount;
+  return ERR_NONE;
+}
+
+int URingUDPDevice::WaitReadable(uint32_t msecs)
+{
+  struct pollfd pfds[2];
+  int retval;
+
+  //Check for completions already posted
+  if(_rxring->PeekCQE() != 0)
+    return ERR_NONE;
+
+  //Wait for completions (armed receive) or a datagram still queued on socket (receive not armed)
+  pfds[0].fd = _rxring->GetFD();
+  pfds[0].events = POLLIN;
+  pfds[0].revents = 0;
+  pfds[1].fd = _sock->GetFD();
+  pfds[1].events = POLLIN;
+  pfds[1].revents = 0;
+  if((retval = poll(pfds, 2, (msecs == WAIT_INF) ? -1 : (int)msecs)) < 0)
+    return ERR_UNSPEC;
+
+  //Check for timeout
+  if(retval == 0)
+    return ERR_TIMEOUT;
+
+  return ERR_NONE;
+}
+
+bool URingUDPDevice::IsSupported(void)
+{
+  return URing::IsSupported();
+}
+
+bool URingUDPDevice::ArmRecv(void)
+{
+  struct io_uring_sqe* sqe;
+
+  //Get submission entry
+  if((sqe = _rxring->GetSQE()) == 0)
+    return false;
+
+  //Queue one receive that keeps posting a completion per datagram into buffers of receive group
+  sqe->opcode = IORING_OP_RECVMSG;
+  sqe->fd = _sock->GetFD();
+  sqe->addr = (uint64_t)(uintptr_t)&_rxmsg;
+  sqe->len = 1;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = BUF_GROUP;
+  _rxarmed = true;
+
+  return true;
+}
+
+uint32_t URingUDPDevice::Unpack(const uint8_t* rxbuf, uint32_t rxlen, uint8_t* buf, uint32_t maxlen, uint64_t& peer)
+{
+  const struct io_uring_recvmsg_out* out;
+  const struct sockaddr_in* src;
+  struct msghdr ctlmsg;
+  struct cmsghdr* cmsg;
+  uint32_t hdrlen;
+  uint32_t len;
+
+  //Buffer holds receive header, then source address and control data at template sizes, then payload
+  out = (const struct io_uring_recvmsg_out*)rxbuf;
+  hdrlen = sizeof(*out) + _rxmsg.msg_namelen + _rxmsg.msg_controllen;
+  if((rxlen <= hdrlen) || (out->namelen < sizeof(*src)))
+    return 0;
+
+  //Peer is source IP address and port of incoming datagram
+  src = (const struct sockaddr_in*)(out + 1);
+  peer = ((uint64_t)ntohl(src->sin_addr.s_addr) << 16) | ntohs(src->sin_port);
+
+  //Remember latest kernel drop count
+  memset(&ctlmsg, 0, sizeof(ctlmsg));
+  ctlmsg.msg_control = (uint8_t*)(out + 1) + _rxmsg.msg_namelen;
+  ctlmsg.msg_controllen = out->controllen;
+  for(cmsg=CMSG_FIRSTHDR(&ctlmsg); cmsg!=NULL; cmsg=CMSG_NXTHDR(&ctlmsg, cmsg))
+    if((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SO_RXQ_OVFL))
+      memcpy(&_dropcount, CMSG_DATA(cmsg), sizeof(uint32_t));
+
+  //Copy payload (truncated to what fit in both buffers)
+  len = rxlen - hdrlen;
+  if(len > out->payloadlen)
+    len = out->payloadlen;
+  if(len > maxlen)
+    len = maxlen;
+  memcpy(buf, rxbuf + hdrlen, len);
+
+  return len;
+}
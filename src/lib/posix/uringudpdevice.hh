@@ -0,0 +1,83 @@
+// io_uring UDP device
+//
+// Copyright 2019 Democosm
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "device.hh"
+#include "mutex.hh"
+#include "udpsocket.hh"
+#include "uring.hh"
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+class URingUDPDevice : public Device
+{
+public:
+  //Default size and number of receive buffers handed to kernel (size covers largest HC message plus receive header)
+  static const uint32_t BUF_SIZE_DEFAULT = 2048;
+  static const uint32_t BUF_COUNT = 256;
+
+public:
+  URingUDPDevice(uint16_t port, const char* bindif=0, const char* destipaddr=0, uint16_t destport=0, bool reuseport=false, uint32_t bufsiz=BUF_SIZE_DEFAULT);
+  virtual ~URingUDPDevice();
+  uint32_t Read(void* buf, uint32_t maxlen);
+  uint32_t Write(const void* buf, uint32_t len);
+  uint32_t ReadFrom(void* buf, uint32_t maxlen, uint64_t& peer);
+  uint32_t WriteTo(const void* buf, uint32_t len, uint64_t peer);
+  uint32_t ReadBatch(uint8_t* bufs, uint32_t bufsiz, uint32_t maxcount, uint32_t* lens, uint64_t* peers);
+  uint32_t WriteBatch(const uint8_t* bufs, uint32_t bufsiz, const uint32_t* lens, const uint64_t* peers, uint32_t count);
+  int GetRecvBufSize(uint32_t& val);
+  int SetRecvBufSize(uint32_t val);
+  int GetSendBufSize(uint32_t& val);
+  int SetSendBufSize(uint32_t val);
+  int GetDropCount(uint32_t& val);
+  int WaitReadable(uint32_t msecs);
+  static bool IsSupported(void);
+
+private:
+  bool ArmRecv(void);
+  uint32_t Unpack(const uint8_t* rxbuf, uint32_t rxlen, uint8_t* buf, uint32_t maxlen, uint64_t& peer);
+
+private:
+  //Provided buffer group used for receives
+  static const uint16_t BUF_GROUP = 0;
+
+private:
+  UDPSocket* _sock;
+  URing* _rxring;
+  URing* _txring;
+  Mutex* _mutex;
+  uint32_t _dstipaddr;
+  uint16_t _dstport;
+  bool _setdstonread;
+  bool _rxarmed;
+  struct msghdr _rxmsg;
+  uint32_t _dropcount;
+  struct msghdr _txmsgs[UDPSocket::BATCH_MAX];
+  struct iovec _txiovs[UDPSocket::BATCH_MAX];
+  struct sockaddr_in _txdsts[UDPSocket::BATCH_MAX];
+};